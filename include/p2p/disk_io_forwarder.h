@@ -0,0 +1,106 @@
+/**
+ * PS4 Store P2P - Relais du Stockage libtorrent
+ *
+ * Base des couches placées devant le stockage de libtorrent 2.0 (cache des
+ * pièces, regroupement des écritures): chaque appel est transmis au stockage
+ * enveloppé, les classes dérivées ne redéfinissent que ce qu'elles
+ * interceptent. Les couches s'empilent via session_params::disk_io_constructor
+ */
+
+#ifndef DISK_IO_FORWARDER_H
+#define DISK_IO_FORWARDER_H
+
+#ifndef NO_LIBTORRENT
+#include <libtorrent/version.hpp>
+#if LIBTORRENT_VERSION_NUM >= 20000
+
+#include <libtorrent/disk_interface.hpp>
+#include <libtorrent/disk_buffer_holder.hpp>
+#include <libtorrent/storage_defs.hpp>
+#include <libtorrent/session_params.hpp>
+#include <libtorrent/io_context.hpp>
+
+#include <map>
+#include <memory>
+
+class DiskIOForwarder : public libtorrent::disk_interface {
+public:
+    DiskIOForwarder(libtorrent::io_context& ioc, std::unique_ptr<libtorrent::disk_interface> disk);
+    
+    /**
+     * Constructeur du stockage déjà installé dans les paramètres de session
+     * (celui par défaut si aucun), à envelopper par une nouvelle couche
+     * @param params Paramètres de création de la session
+     * @return Constructeur du stockage enveloppé
+     */
+    static libtorrent::disk_io_constructor_type innerConstructor(const libtorrent::session_params& params);
+    
+    /**
+     * Copie des données dans un tampon remis à libtorrent (libéré par delete[])
+     * @param data Données
+     * @param length Taille
+     * @return Tampon
+     */
+    static libtorrent::disk_buffer_holder copyBuffer(const char* data, int length);
+    
+    /**
+     * Index numérique d'un stockage
+     */
+    static int storageId(libtorrent::storage_index_t storage);
+    
+    libtorrent::storage_holder new_torrent(libtorrent::storage_params const& params,
+                                           std::shared_ptr<void> const& torrent) override;
+    void remove_torrent(libtorrent::storage_index_t storage) override;
+    
+    void async_read(libtorrent::storage_index_t storage, libtorrent::peer_request const& request,
+                    std::function<void(libtorrent::disk_buffer_holder, libtorrent::storage_error const&)> handler,
+                    libtorrent::disk_job_flags_t flags) override;
+    bool async_write(libtorrent::storage_index_t storage, libtorrent::peer_request const& request,
+                     char const* buffer, std::shared_ptr<libtorrent::disk_observer> observer,
+                     std::function<void(libtorrent::storage_error const&)> handler,
+                     libtorrent::disk_job_flags_t flags) override;
+    void async_hash(libtorrent::storage_index_t storage, libtorrent::piece_index_t piece,
+                    libtorrent::span<libtorrent::sha256_hash> v2, libtorrent::disk_job_flags_t flags,
+                    std::function<void(libtorrent::piece_index_t, libtorrent::sha1_hash const&,
+                                       libtorrent::storage_error const&)> handler) override;
+    void async_hash2(libtorrent::storage_index_t storage, libtorrent::piece_index_t piece, int offset,
+                     libtorrent::disk_job_flags_t flags,
+                     std::function<void(libtorrent::piece_index_t, libtorrent::sha256_hash const&,
+                                        libtorrent::storage_error const&)> handler) override;
+    void async_move_storage(libtorrent::storage_index_t storage, std::string path, libtorrent::move_flags_t flags,
+                            std::function<void(libtorrent::status_t, std::string const&,
+                                               libtorrent::storage_error const&)> handler) override;
+    void async_release_files(libtorrent::storage_index_t storage, std::function<void()> handler) override;
+    void async_check_files(libtorrent::storage_index_t storage, libtorrent::add_torrent_params const* resume_data,
+                           libtorrent::aux::vector<std::string, libtorrent::file_index_t> links,
+                           std::function<void(libtorrent::status_t, libtorrent::storage_error const&)> handler) override;
+    void async_stop_torrent(libtorrent::storage_index_t storage, std::function<void()> handler) override;
+    void async_rename_file(libtorrent::storage_index_t storage, libtorrent::file_index_t index, std::string name,
+                           std::function<void(std::string const&, libtorrent::file_index_t,
+                                              libtorrent::storage_error const&)> handler) override;
+    void async_delete_files(libtorrent::storage_index_t storage, libtorrent::remove_flags_t options,
+                            std::function<void(libtorrent::storage_error const&)> handler) override;
+    void async_set_file_priority(libtorrent::storage_index_t storage,
+                                 libtorrent::aux::vector<libtorrent::download_priority_t, libtorrent::file_index_t> priorities,
+                                 std::function<void(libtorrent::storage_error const&,
+                                                    libtorrent::aux::vector<libtorrent::download_priority_t,
+                                                                            libtorrent::file_index_t>)> handler) override;
+    void async_clear_piece(libtorrent::storage_index_t storage, libtorrent::piece_index_t index,
+                           std::function<void(libtorrent::piece_index_t)> handler) override;
+    
+    void update_stats_counters(libtorrent::counters& counters) const override;
+    std::vector<libtorrent::open_file_state> get_status(libtorrent::storage_index_t storage) const override;
+    void abort(bool wait) override;
+    void submit_jobs() override;
+    void settings_updated() override;
+
+protected:
+    libtorrent::io_context& m_ioc;
+    std::unique_ptr<libtorrent::disk_interface> m_disk;
+    std::map<libtorrent::storage_index_t, libtorrent::storage_holder> m_holders;  // Détruits avant m_disk
+};
+
+#endif // LIBTORRENT_VERSION_NUM >= 20000
+#endif // NO_LIBTORRENT
+
+#endif // DISK_IO_FORWARDER_H
@@ -0,0 +1,173 @@
+/**
+ * PS4 Store P2P - Planificateur de Téléchargements
+ *
+ * File d'attente des téléchargements: limite le nombre de téléchargements
+ * simultanés, ordonne par priorité puis position, concentre le débit sur la
+ * tête de file et applique des plages horaires de bande passante. Les
+ * premiers téléchargements en attente sont annoncés en avance pour démarrer
+ * avec des peers déjà connectés
+ */
+
+#ifndef DOWNLOAD_SCHEDULER_H
+#define DOWNLOAD_SCHEDULER_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+#ifndef NO_LIBTORRENT
+namespace libtorrent {
+    struct torrent_handle;
+}
+#endif
+
+// Priorité utilisateur d'un téléchargement
+enum class DownloadPriority {
+    LOW = 0,
+    NORMAL = 1,
+    HIGH = 2
+};
+
+// Plage horaire de bande passante (heure locale, peut passer minuit)
+struct BandwidthWindow {
+    int start_minute;     // Minutes depuis minuit
+    int end_minute;       // Minutes depuis minuit (exclu)
+    int download_limit;   // bytes/sec, 0 = illimité
+    int upload_limit;     // bytes/sec, 0 = illimité
+};
+
+// Position d'un téléchargement dans la file
+struct QueuedDownload {
+    std::string name;
+    DownloadPriority priority;
+    int queue_position;   // Ordre d'arrivée ou position imposée
+    bool active;          // En cours de téléchargement
+    bool user_paused;     // Mis en pause par l'utilisateur
+    bool pre_announced;   // En file, annoncé en mode upload (peers et métadonnées prêts)
+    int download_limit;   // Limite appliquée au torrent (bytes/sec, 0 = illimité)
+};
+
+// Paramètres de la file
+struct DownloadSchedulerConfig {
+    int max_concurrent_downloads = 3;
+    int pre_announce_count = 2;          // Téléchargements en file annoncés en avance
+    float secondary_share = 0.2f;        // Part du débit laissée aux téléchargements hors tête
+    int min_secondary_rate = 16 * 1024;  // Débit plancher d'un téléchargement hors tête (bytes/sec)
+    int default_download_limit = 0;      // Limites hors plages horaires (bytes/sec)
+    int default_upload_limit = 0;
+    std::vector<BandwidthWindow> windows;
+};
+
+class DownloadScheduler {
+public:
+    /**
+     * Configure la file de téléchargement
+     * @param config Paramètres de la file
+     */
+    static void configure(const DownloadSchedulerConfig& config);
+    
+    /**
+     * Obtient la configuration actuelle
+     * @return Paramètres de la file
+     */
+    static DownloadSchedulerConfig getConfig();
+
+#ifndef NO_LIBTORRENT
+    /**
+     * Ajoute un téléchargement en fin de file (torrent en pause, non auto-géré)
+     * @param name Nom du téléchargement
+     * @param handle Handle du torrent
+     * @param priority Priorité utilisateur
+     */
+    static void enqueue(const std::string& name, const libtorrent::torrent_handle& handle,
+                        DownloadPriority priority = DownloadPriority::NORMAL);
+#endif
+
+    /**
+     * Retire un téléchargement de la file (terminé ou supprimé)
+     * @param name Nom du téléchargement
+     */
+    static void remove(const std::string& name);
+    
+    /**
+     * Définit la priorité d'un téléchargement
+     * @param name Nom du téléchargement
+     * @param priority Nouvelle priorité
+     * @return true si le téléchargement est dans la file
+     */
+    static bool setPriority(const std::string& name, DownloadPriority priority);
+    
+    /**
+     * Déplace un téléchargement dans la file
+     * @param name Nom du téléchargement
+     * @param position Nouvelle position (0 = tête de file)
+     * @return true si le téléchargement est dans la file
+     */
+    static bool moveTo(const std::string& name, int position);
+    
+    /**
+     * Met en pause ou reprend un téléchargement de la file
+     * @param name Nom du téléchargement
+     * @param paused true pour mettre en pause
+     * @return true si le téléchargement est dans la file
+     */
+    static bool setUserPaused(const std::string& name, bool paused);
+    
+    /**
+     * Obtient la file dans l'ordre de service
+     * @return Téléchargements ordonnés
+     */
+    static std::vector<QueuedDownload> getQueue();
+    
+    /**
+     * Met à jour la file (à appeler depuis TorrentManager::update)
+     */
+    static void update();
+    
+    /**
+     * Vide la file
+     */
+    static void clear();
+    
+    /**
+     * Obtient les limites de session à une heure donnée
+     * @param config Paramètres de la file
+     * @param minute_of_day Minutes depuis minuit
+     * @return Plage active, ou limites de base hors plage (start_minute = -1)
+     */
+    static BandwidthWindow limitsAt(const DownloadSchedulerConfig& config, int minute_of_day);
+    
+    /**
+     * Obtient les dernières limites appliquées à la session
+     * @return Limites appliquées par update (start_minute = -1 hors plage)
+     */
+    static BandwidthWindow getAppliedLimits();
+    
+    /**
+     * Analyse une liste de plages horaires
+     * Format: "HH:MM-HH:MM=download/upload" séparées par des virgules, en KB/s
+     * (fin à 24:00 acceptée)
+     * @param spec Chaîne de configuration
+     * @return Plages valides
+     */
+    static std::vector<BandwidthWindow> parseWindows(const std::string& spec);
+
+private:
+    struct QueueEntry;
+    static std::vector<QueueEntry> s_queue;
+    static DownloadSchedulerConfig s_config;
+    static int s_next_position;
+    static int64_t s_last_tick;
+    static int s_active_window;
+    static BandwidthWindow s_applied_limits;
+    static int64_t s_capacity_estimate;
+    static bool s_dirty;
+    
+    static void sortQueue();
+    static void applyBandwidthWindow();
+    static void applyActivation();
+    static void applyThroughputShares();
+    static int findWindow(const DownloadSchedulerConfig& config, int minute_of_day);
+};
+
+#endif // DOWNLOAD_SCHEDULER_H
@@ -0,0 +1,176 @@
+/**
+ * PS4 Store P2P - Démarrage Rapide des Téléchargements
+ *
+ * Réduit le délai avant le premier octet d'un téléchargement: trackers par
+ * défaut ajoutés aux liens magnet, annonces simultanées à tous les niveaux de
+ * trackers, peers déjà connus injectés depuis un cache persistant. Le délai
+ * jusqu'aux métadonnées, au premier peer et au premier octet (TTFB) est
+ * mesuré pour chaque téléchargement
+ */
+
+#ifndef FAST_START_H
+#define FAST_START_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdint>
+
+#ifndef NO_LIBTORRENT
+namespace libtorrent {
+    class settings_pack;
+    struct torrent_handle;
+    struct torrent_status;
+    struct add_torrent_params;
+    struct peer_info;
+}
+#endif
+
+// Paramètres du démarrage rapide
+struct FastStartConfig {
+    bool enabled = true;
+    std::vector<std::string> default_trackers;  // [Trackers] default_trackers
+    std::string peer_cache_file;                // Vide = cache non persisté
+    int max_peers_per_torrent = 32;             // Peers conservés par torrent
+    int max_cached_torrents = 256;
+    int peer_ttl_hours = 168;                   // Peers non revus depuis plus longtemps oubliés
+};
+
+// Mesures du démarrage d'un téléchargement (délais en ms depuis startDownload, -1 = pas encore)
+struct TtfbRecord {
+    std::string name;
+    int64_t started_at;
+    int64_t metadata_ms;
+    int64_t first_peer_ms;
+    int64_t first_byte_ms;
+    int cached_peers;       // Peers injectés depuis le cache
+    int added_trackers;     // Trackers par défaut ajoutés
+};
+
+class FastStart {
+public:
+    /**
+     * Configure le démarrage rapide et charge le cache de peers
+     * @param config Trackers par défaut et cache de peers
+     */
+    static void configure(const FastStartConfig& config);
+    
+    /**
+     * Obtient la configuration actuelle
+     * @return Configuration
+     */
+    static FastStartConfig getConfig();
+
+#ifndef NO_LIBTORRENT
+    /**
+     * Écrit les réglages d'annonce dans les réglages de création de la session
+     * @param settings Réglages de la session
+     */
+    static void applySettings(libtorrent::settings_pack& settings);
+    
+    /**
+     * Complète un téléchargement avant son ajout: trackers par défaut et peers
+     * en cache. Démarre la mesure du TTFB
+     * @param name Nom du téléchargement
+     * @param params Paramètres d'ajout (modifiés)
+     */
+    static void prepare(const std::string& name, libtorrent::add_torrent_params& params);
+    
+    /**
+     * Associe le handle reçu par add_torrent_alert à la mesure en cours
+     * @param name Nom du téléchargement
+     * @param handle Handle du torrent
+     */
+    static void attach(const std::string& name, const libtorrent::torrent_handle& handle);
+    
+    /**
+     * Retient les peers d'un torrent qui ont fourni des données
+     * @param status État du torrent
+     * @param peers Peers connectés
+     */
+    static void recordPeers(const libtorrent::torrent_status& status, const std::vector<libtorrent::peer_info>& peers);
+    
+    /**
+     * Avance les mesures en cours (à appeler depuis TorrentManager::update)
+     */
+    static void update();
+#endif
+
+    /**
+     * Ajoute les trackers par défaut au niveau suivant ceux du lien magnet
+     * @param trackers Trackers du téléchargement (complétés)
+     * @param tiers Niveau de chaque tracker (complétés, alignés sur trackers)
+     * @param defaults Trackers par défaut, déjà présents ignorés
+     * @return Nombre de trackers ajoutés
+     */
+    static int addDefaultTrackers(std::vector<std::string>& trackers, std::vector<int>& tiers,
+                                  const std::vector<std::string>& defaults);
+    
+    /**
+     * Retient un peer qui a fourni des données
+     * @param info_hash Info-hash du torrent (hex)
+     * @param address Adresse du peer
+     * @param port Port d'écoute du peer
+     * @param now Timestamp actuel (secondes, epoch)
+     * @return true si le cache doit être réécrit (peer nouveau ou retiré, contact ancien rafraîchi)
+     */
+    static bool rememberPeer(const std::string& info_hash, const std::string& address, int port, int64_t now);
+    
+    /**
+     * Obtient les peers en cache d'un torrent
+     * @param info_hash Info-hash du torrent (hex)
+     * @return Adresses et ports, les plus récents en tête
+     */
+    static std::vector<std::pair<std::string, int>> getCachedPeers(const std::string& info_hash);
+    
+    /**
+     * Obtient les mesures de démarrage
+     * @return Mesures, par ordre de démarrage
+     */
+    static std::vector<TtfbRecord> getRecords();
+    
+    /**
+     * Obtient le TTFB d'un téléchargement
+     * @param name Nom du téléchargement
+     * @return Délai en ms, -1 si aucun octet reçu
+     */
+    static int64_t getTtfb(const std::string& name);
+    
+    /**
+     * Abandonne la mesure d'un téléchargement supprimé
+     * @param name Nom du téléchargement
+     */
+    static void forget(const std::string& name);
+    
+    /**
+     * Écrit le cache de peers (fichier temporaire puis renommage)
+     * @return true en cas de succès
+     */
+    static bool savePeerCache();
+    
+    /**
+     * Sauvegarde le cache de peers et vide les mesures
+     */
+    static void clear();
+
+private:
+    struct CachedPeer {
+        std::string address;
+        int port;
+        int64_t last_seen;  // secondes (epoch)
+    };
+    struct Tracking;
+    
+    static FastStartConfig s_config;
+    static std::map<std::string, std::vector<CachedPeer>> s_peer_cache;  // Par info-hash (hex)
+    static std::map<std::string, Tracking> s_tracking;
+    static std::vector<TtfbRecord> s_records;
+    static bool s_cache_dirty;
+    static int64_t s_last_poll;
+    
+    static bool loadPeerCache();
+    static void trimPeerCache();
+    static TtfbRecord* findRecord(const std::string& name);
+};
+
+#endif // FAST_START_H
@@ -0,0 +1,135 @@
+/**
+ * PS4 Store P2P - Liste de Blocage IP
+ *
+ * Charge des listes de blocage publiques (formats P2P et DAT) en une seule
+ * passe, fusionne les plages qui se chevauchent dans un tableau trié
+ * d'intervalles et le conserve sous forme binaire pour un rechargement
+ * immédiat. Le tableau est installé comme ip_filter de la session et
+ * consulté par recherche dichotomique, restreinte par un index des 16 bits
+ * de poids fort
+ */
+
+#ifndef IP_BLOCKLIST_H
+#define IP_BLOCKLIST_H
+
+#include <string>
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+
+// Plage d'adresses IPv4 bloquées (bornes incluses, ordre de l'hôte)
+struct IpRange {
+    uint32_t first;
+    uint32_t last;
+};
+
+// Résultat d'un chargement
+struct BlocklistStats {
+    int64_t lines;          // Lignes lues dans les sources
+    int64_t parsed;         // Plages valides avant fusion
+    int64_t merged;         // Intervalles après fusion
+    int64_t load_ms;        // Durée totale du chargement
+    bool from_cache;        // Chargé depuis le cache binaire
+};
+
+class IpBlocklist {
+public:
+    /**
+     * Charge les listes de blocage (cache binaire si les sources n'ont pas changé)
+     * @param sources Fichiers P2P ou DAT
+     * @param cache_file Cache binaire (vide = pas de cache)
+     * @param stats Statistiques du chargement (optionnel)
+     * @return Nombre d'intervalles bloqués, -1 si aucune source n'est lisible
+     */
+    static int64_t load(const std::vector<std::string>& sources, const std::string& cache_file,
+                        BlocklistStats* stats = nullptr);
+    
+    /**
+     * Remplace les intervalles actifs
+     * @param ranges Plages (triées et fusionnées par l'appel)
+     */
+    static void setRanges(std::vector<IpRange> ranges);
+    
+    /**
+     * Obtient les intervalles actifs (triés, disjoints)
+     * @return Intervalles, jamais nul
+     */
+    static std::shared_ptr<const std::vector<IpRange>> getRanges();
+    
+    /**
+     * Vérifie si une adresse IPv4 est bloquée
+     * @param address Adresse (ordre de l'hôte)
+     * @return true si l'adresse appartient à un intervalle
+     */
+    static bool isBlocked(uint32_t address);
+    
+    /**
+     * Vérifie si une adresse textuelle est bloquée (IPv6 jamais bloquée)
+     * @param address Adresse "a.b.c.d"
+     * @return true si l'adresse appartient à un intervalle
+     */
+    static bool isBlocked(const std::string& address);
+    
+    /**
+     * Vide la liste active
+     */
+    static void clear();
+    
+    /**
+     * Analyse une liste de blocage en flux
+     * @param path Fichier P2P ("nom:a.b.c.d-e.f.g.h") ou DAT ("a.b.c.d - e.f.g.h , niveau , nom")
+     * @param ranges Plages ajoutées (non fusionnées)
+     * @param lines Lignes lues (optionnel)
+     * @return false si le fichier est illisible
+     */
+    static bool parseFile(const std::string& path, std::vector<IpRange>& ranges, int64_t* lines = nullptr);
+    
+    /**
+     * Analyse une ligne de liste de blocage
+     * @param line Ligne P2P ou DAT
+     * @param range Plage lue
+     * @return true si la ligne décrit une plage bloquée
+     */
+    static bool parseLine(const std::string& line, IpRange& range);
+    
+    /**
+     * Trie les plages et fusionne celles qui se chevauchent ou se touchent
+     * @param ranges Plages à fusionner (modifiées sur place)
+     */
+    static void mergeRanges(std::vector<IpRange>& ranges);
+    
+    /**
+     * Écrit le cache binaire
+     * @param cache_file Fichier de cache
+     * @param sources Sources dont la taille et la date valident le cache
+     * @param ranges Intervalles fusionnés
+     * @return true en cas de succès
+     */
+    static bool saveCache(const std::string& cache_file, const std::vector<std::string>& sources,
+                          const std::vector<IpRange>& ranges);
+    
+    /**
+     * Lit le cache binaire s'il correspond encore aux sources
+     * @param cache_file Fichier de cache
+     * @param sources Sources attendues
+     * @param ranges Intervalles lus
+     * @return true si le cache est valide
+     */
+    static bool loadCache(const std::string& cache_file, const std::vector<std::string>& sources,
+                          std::vector<IpRange>& ranges);
+
+private:
+    struct Table;
+    static std::shared_ptr<const Table> s_table;        // Propriétaire (protégé par s_mutex)
+    static std::atomic<const Table*> s_current;         // Lecture sans verrou
+    static std::atomic<unsigned> s_epoch;               // Époque de lecture (changée à chaque publication)
+    static std::atomic<int> s_readers[2];               // Recherches en cours, par parité d'époque
+    static std::mutex s_mutex;
+    
+    static void publish(std::vector<IpRange>&& ranges);
+    static uint64_t sourcesFingerprint(const std::vector<std::string>& sources);
+};
+
+#endif // IP_BLOCKLIST_H
@@ -0,0 +1,132 @@
+/**
+ * PS4 Store P2P - Cache de Métadonnées
+ *
+ * Résout en arrière-plan les métadonnées des liens magnet du catalogue
+ * (torrents ajoutés en mode upload, sans téléchargement de données) et les
+ * conserve dans cache_path: un téléchargement connu démarre directement
+ * sur les données au lieu de repasser par downloading_metadata
+ */
+
+#ifndef METADATA_CACHE_H
+#define METADATA_CACHE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <set>
+#include <memory>
+
+#ifndef NO_LIBTORRENT
+namespace libtorrent {
+    class session;
+    class torrent_info;
+    struct torrent_handle;
+    struct add_torrent_params;
+    struct add_torrent_alert;
+}
+#endif
+
+class MetadataCache {
+public:
+    /**
+     * Configure le cache
+     * @param cache_path Dossier de cache (les métadonnées vont dans cache_path/metadata)
+     * @param max_concurrent Résolutions simultanées
+     * @param timeout_s Abandon d'une résolution sans réponse
+     */
+    static void configure(const std::string& cache_path, int max_concurrent = 2, int timeout_s = 120);
+    
+    /**
+     * Planifie la résolution de liens magnet (ignorés s'ils sont déjà en cache)
+     * @param magnet_links Liens magnet du catalogue
+     */
+    static void prefetch(const std::vector<std::string>& magnet_links);
+    
+    /**
+     * Vérifie si les métadonnées d'un lien magnet sont en cache
+     * @param magnet_link Lien magnet
+     * @return true si le fichier .torrent est en cache
+     */
+    static bool isCached(const std::string& magnet_link);
+    
+    /**
+     * Obtient le nombre de résolutions en attente ou en cours
+     * @return Nombre de liens à résoudre
+     */
+    static int getPendingCount();
+
+#ifndef NO_LIBTORRENT
+    /**
+     * Cherche les métadonnées d'un torrent en cache
+     * @param params Paramètres issus du lien magnet
+     * @return Métadonnées, nullptr si absentes ou invalides
+     */
+    static std::shared_ptr<libtorrent::torrent_info> lookup(const libtorrent::add_torrent_params& params);
+    
+    /**
+     * Abandonne la résolution en cours d'un torrent (avant son ajout réel)
+     * @param session Session libtorrent
+     * @param params Paramètres issus du lien magnet
+     */
+    static void cancel(libtorrent::session& session, const libtorrent::add_torrent_params& params);
+    
+    /**
+     * Indique si l'ajout d'un torrent a échoué à cause d'une résolution annulée
+     * encore en cours d'ajout (l'ajout peut alors être renouvelé)
+     * @param params Paramètres de l'ajout refusé
+     * @return true une seule fois par résolution annulée
+     */
+    static bool takeCancelled(const libtorrent::add_torrent_params& params);
+    
+    /**
+     * Indique si un nom interne désigne une résolution de métadonnées
+     * @param name Nom transporté dans add_torrent_params
+     * @return true pour une résolution
+     */
+    static bool isResolver(const std::string& name);
+    
+    /**
+     * Enregistre le handle d'une résolution ajoutée à la session
+     * @param session Session libtorrent
+     * @param alert Alerte d'ajout
+     */
+    static void handleAdded(libtorrent::session& session, const libtorrent::add_torrent_alert* alert);
+    
+    /**
+     * Sauvegarde les métadonnées reçues et retire la résolution de la session
+     * @param session Session libtorrent
+     * @param handle Handle du torrent
+     * @return true si le torrent était une résolution
+     */
+    static bool handleMetadataReceived(libtorrent::session& session, const libtorrent::torrent_handle& handle);
+    
+    /**
+     * Lance les résolutions en attente et abandonne celles expirées
+     * @param session Session libtorrent
+     */
+    static void update(libtorrent::session& session);
+#endif
+
+    /**
+     * Vide les files (le cache sur disque est conservé)
+     */
+    static void clear();
+
+private:
+    struct Resolution;
+    static std::map<std::string, Resolution> s_resolving;
+    static std::vector<std::string> s_queue;
+    static std::set<std::string> s_failed;
+    static std::set<std::string> s_cancelled;
+    static std::string s_cache_dir;
+    static int s_max_concurrent;
+    static int s_timeout_s;
+    
+    static std::string cacheFile(const std::string& hash);
+#ifndef NO_LIBTORRENT
+    static std::string hashKey(const libtorrent::add_torrent_params& params);
+    static bool saveMetadata(const libtorrent::torrent_handle& handle, const std::string& hash);
+#endif
+};
+
+#endif // METADATA_CACHE_H
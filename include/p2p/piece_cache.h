@@ -0,0 +1,192 @@
+/**
+ * PS4 Store P2P - Cache Mémoire des Pièces Partagées
+ *
+ * Cache de lecture des blocs envoyés aux peers, placé devant le stockage de
+ * libtorrent: les blocs les plus demandés restent en RAM au lieu de provoquer
+ * une lecture aléatoire sur le disque dur ou la clé USB à chaque requête.
+ * L'admission suit TinyLFU (un bloc n'entre que s'il est plus fréquemment
+ * demandé que celui qu'il évincerait), et les lectures séquentielles d'un
+ * peer déclenchent une lecture anticipée des blocs suivants. Les blocs lus
+ * en avance attendent dans un segment de probation (1/8 de la capacité) et
+ * ne rejoignent le segment principal qu'une fois demandés et admis
+ */
+
+#ifndef PIECE_CACHE_H
+#define PIECE_CACHE_H
+
+#include <string>
+#include <vector>
+#include <list>
+#include <unordered_map>
+#include <mutex>
+#include <cstdint>
+
+#ifndef NO_LIBTORRENT
+namespace libtorrent {
+    class settings_pack;
+    struct session_params;
+}
+#endif
+
+// Paramètres du cache
+struct PieceCacheConfig {
+    bool enabled = true;
+    int64_t capacity = 64LL * 1024 * 1024;      // [Performance] disk_cache_size
+    float max_memory_fraction = 0.25f;          // Part maximale de la mémoire physique disponible
+    int read_ahead_blocks = 8;                  // Blocs lus en avance pour un flux séquentiel
+    int sequential_threshold = 2;               // Requêtes consécutives avant lecture anticipée
+};
+
+// Compteurs du cache
+struct PieceCacheStats {
+    int64_t hits;               // Requêtes servies depuis la RAM
+    int64_t misses;             // Requêtes lues sur le disque
+    int64_t read_ahead;         // Blocs lus en avance
+    int64_t read_ahead_hits;    // Blocs lus en avance puis demandés
+    int64_t admitted;           // Blocs entrés dans le cache
+    int64_t rejected;           // Blocs refusés par l'admission TinyLFU
+    int64_t evictions;
+    int64_t bytes;              // Octets en cache
+    int64_t capacity;           // Capacité effective (octets)
+};
+
+// Bloc à lire en avance
+struct ReadAheadBlock {
+    int piece;
+    int offset;
+    int length;
+};
+
+class PieceCache {
+public:
+    static const int BLOCK_SIZE = 16 * 1024;
+    
+    /**
+     * Configure le cache (capacité bornée par la mémoire disponible) et le vide
+     * @param config Capacité et lecture anticipée
+     */
+    static void configure(const PieceCacheConfig& config);
+    
+    /**
+     * Obtient la configuration actuelle
+     * @return Configuration
+     */
+    static PieceCacheConfig getConfig();
+    
+    /**
+     * Obtient les compteurs du cache
+     * @return Compteurs
+     */
+    static PieceCacheStats getStats();
+    
+    /**
+     * Calcule le taux de succès
+     * @return Part des requêtes servies depuis la RAM (0.0 à 1.0)
+     */
+    static double getHitRate();
+
+#ifndef NO_LIBTORRENT
+    /**
+     * Installe le cache devant le stockage de la session (libtorrent 2.0)
+     * ou règle le cache de lecture intégré (libtorrent 1.2)
+     * @param params Paramètres de création de la session
+     */
+    static void install(libtorrent::session_params& params);
+#endif
+
+    /**
+     * Déclare la géométrie d'un stockage (nécessaire à la lecture anticipée)
+     * @param storage Index du stockage
+     * @param piece_length Taille des pièces
+     * @param total_size Taille totale du torrent
+     */
+    static void registerStorage(int storage, int piece_length, int64_t total_size);
+    
+    /**
+     * Cherche un bloc demandé par un peer et enregistre l'accès
+     * @param storage Index du stockage
+     * @param piece Pièce
+     * @param offset Position dans la pièce
+     * @param length Taille demandée
+     * @param out Données copiées en cas de succès (au moins length octets)
+     * @param read_ahead Blocs à lire en avance (flux séquentiel détecté)
+     * @return true si le bloc est en cache
+     */
+    static bool lookup(int storage, int piece, int offset, int length, char* out,
+                       std::vector<ReadAheadBlock>* read_ahead = nullptr);
+    
+    /**
+     * Propose un bloc lu sur le disque au cache
+     * @param storage Index du stockage
+     * @param piece Pièce
+     * @param offset Position dans la pièce
+     * @param data Données
+     * @param length Taille
+     * @param read_ahead Bloc lu en avance (placé en probation, sans évincer de bloc demandé)
+     * @return true si le bloc est admis
+     */
+    static bool offer(int storage, int piece, int offset, const char* data, int length, bool read_ahead = false);
+    
+    /**
+     * Retire un bloc, une pièce ou un stockage du cache (écriture, suppression)
+     * @param storage Index du stockage
+     * @param piece Pièce (-1 = tout le stockage)
+     * @param offset Position du bloc (-1 = toute la pièce)
+     */
+    static void invalidate(int storage, int piece = -1, int offset = -1);
+    
+    /**
+     * Vide le cache et les compteurs
+     */
+    static void clear();
+
+private:
+    struct Entry {
+        uint64_t key;
+        std::vector<char> data;
+        bool probation;         // Lu en avance, dans le segment de probation
+        bool requested;         // Demandé par un peer au moins une fois
+    };
+    
+    struct Stream {
+        int64_t next;           // Position attendue de la prochaine requête (octets)
+        int64_t prefetched;     // Fin de la lecture anticipée déjà demandée
+        int run;                // Requêtes consécutives
+        int64_t last_used;
+    };
+    
+    struct Geometry {
+        int id;                 // Index du stockage
+        int piece_length;
+        int64_t total_size;
+        std::vector<Stream> streams;
+    };
+    
+    static PieceCacheConfig s_config;
+    static PieceCacheStats s_stats;
+    static std::list<Entry> s_lru;                  // Segment principal, plus récent en tête
+    static std::list<Entry> s_probation;            // Blocs lus en avance, plus récent en tête
+    static int64_t s_probation_bytes;
+    static std::unordered_map<uint64_t, std::list<Entry>::iterator> s_index;
+    static std::unordered_map<int, Geometry> s_storages;
+    static std::vector<uint8_t> s_sketch;           // Count-min, 4 lignes de compteurs 4 bits (un par octet)
+    static std::vector<uint64_t> s_doorkeeper;      // Filtre de Bloom des blocs vus une fois
+    static uint64_t s_sketch_mask;
+    static int64_t s_samples;
+    static int64_t s_sample_limit;
+    static int64_t s_clock;
+    static std::mutex s_mutex;
+    
+    static uint64_t makeKey(int storage, int piece, int offset);
+    static void recordAccess(uint64_t key);
+    static int estimateFrequency(uint64_t key);
+    static void resetSketch(int64_t capacity_blocks);
+    static int64_t probationCapacity();
+    static bool makeRoom(uint64_t key, int64_t length);
+    static void evictOne(std::list<Entry>& segment);
+    static void eraseKey(uint64_t key);
+    static void planReadAhead(Geometry& geometry, int piece, int offset, int length,
+                              std::vector<ReadAheadBlock>& read_ahead);
+};
+
+#endif // PIECE_CACHE_H
@@ -0,0 +1,121 @@
+/**
+ * PS4 Store P2P - Planificateur de Pièces PKG
+ *
+ * Ordonne les pièces d'un téléchargement PKG: l'en-tête, la table des
+ * entrées, param.sfo et l'icône d'abord, puis le corps du fichier par
+ * fenêtre séquentielle glissante lorsque l'essaim est en bonne santé
+ * (rarest-first sinon)
+ */
+
+#ifndef PIECE_PLANNER_H
+#define PIECE_PLANNER_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+#ifndef NO_LIBTORRENT
+namespace libtorrent {
+    struct torrent_handle;
+    struct torrent_status;
+}
+#endif
+
+// Phase de sélection des pièces
+enum class PiecePhase {
+    WAITING_METADATA,   // Métadonnées du torrent pas encore reçues
+    HEAD,               // Pièces de métadonnées PKG en priorité maximale
+    SEQUENTIAL,         // Fenêtre séquentielle sur le corps
+    RAREST_FIRST,       // Essaim trop faible pour le séquentiel
+    DISABLED            // Pas de fichier .pkg dans le torrent
+};
+
+// Paramètres de sélection
+struct PiecePlannerConfig {
+    int64_t head_bytes = 2 * 1024 * 1024;   // Début du PKG prioritaire (en-tête, entrées, icône)
+    int window_seconds = 8;                 // Profondeur de la fenêtre en secondes de débit
+    int min_window_pieces = 4;
+    int max_window_pieces = 64;
+    int deadline_step_ms = 250;             // Écart d'échéance entre deux pièces consécutives
+    float min_distributed_copies = 1.5f;    // Copies disponibles minimales sans seeder
+    int min_seeds = 1;                      // Seeders connectés suffisant pour le séquentiel
+};
+
+// État de sélection d'un téléchargement
+struct PiecePlan {
+    std::string name;
+    PiecePhase phase;
+    int head_pieces;    // Pièces prioritaires (métadonnées PKG)
+    int cursor;         // Première pièce manquante du corps
+    int window;         // Taille de la fenêtre séquentielle (pièces)
+};
+
+class PiecePlanner {
+public:
+    /**
+     * Configure la sélection des pièces
+     * @param config Paramètres de sélection
+     */
+    static void configure(const PiecePlannerConfig& config);
+    
+    /**
+     * Obtient la configuration actuelle
+     * @return Paramètres de sélection
+     */
+    static PiecePlannerConfig getConfig();
+
+#ifndef NO_LIBTORRENT
+    /**
+     * Place un téléchargement sous le contrôle du planificateur
+     * @param name Nom du téléchargement
+     * @param handle Handle du torrent
+     */
+    static void track(const std::string& name, const libtorrent::torrent_handle& handle);
+#endif
+
+    /**
+     * Retire un téléchargement du planificateur (terminé ou supprimé)
+     * @param name Nom du téléchargement
+     */
+    static void untrack(const std::string& name);
+    
+    /**
+     * Met à jour les priorités et échéances (à appeler depuis TorrentManager::update)
+     */
+    static void update();
+    
+    /**
+     * Obtient l'état de sélection d'un téléchargement
+     * @param name Nom du téléchargement
+     * @return État (phase DISABLED si inconnu)
+     */
+    static PiecePlan getPlan(const std::string& name);
+    
+    /**
+     * Obtient le libellé d'une phase
+     * @param phase Phase de sélection
+     * @return Libellé
+     */
+    static std::string getPhaseString(PiecePhase phase);
+    
+    /**
+     * Vide le planificateur
+     */
+    static void clear();
+
+private:
+    struct PlanEntry;
+    static std::map<std::string, PlanEntry> s_plans;
+    static PiecePlannerConfig s_config;
+    static int64_t s_last_tick;
+
+#ifndef NO_LIBTORRENT
+    static bool preparePlan(PlanEntry& entry);
+    static void prioritizeHead(PlanEntry& entry, const std::vector<int>& pieces);
+    static bool refineHead(PlanEntry& entry, const libtorrent::torrent_status& status);
+    static void advanceWindow(PlanEntry& entry, const libtorrent::torrent_status& status);
+    static void addRange(PlanEntry& entry, int64_t offset, int64_t size, std::vector<int>& pieces);
+#endif
+};
+
+#endif // PIECE_PLANNER_H
@@ -0,0 +1,107 @@
+/**
+ * PS4 Store P2P - Service de Scrape UDP
+ *
+ * Interroge les trackers UDP (BEP 15) pour obtenir le nombre de seeders et
+ * de leechers des entrées du catalogue. Les info-hashes sont regroupés par
+ * tracker dans des requêtes multi-hash, les résultats sont mis en cache avec
+ * une durée de validité et seules les lignes proches de l'affichage sont
+ * rafraîchies
+ */
+
+#ifndef SCRAPE_SERVICE_H
+#define SCRAPE_SERVICE_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <atomic>
+#include <cstdint>
+
+// Compteurs d'un essaim issus du dernier scrape
+struct SwarmCounts {
+    int seeders;
+    int leechers;
+    int completed;
+    int64_t updated_at;     // Timestamp du dernier scrape réussi (ms)
+};
+
+class ScrapeService {
+public:
+    // Nombre maximal d'info-hashes par requête de scrape UDP
+    static const int MAX_HASHES_PER_SCRAPE = 74;
+    
+    /**
+     * Démarre le thread de scrape
+     * @return 0 en cas de succès
+     */
+    static int initialize();
+    
+    /**
+     * Arrête le thread de scrape
+     */
+    static void cleanup();
+    
+    /**
+     * Définit les trackers utilisés pour les liens magnet sans tracker UDP
+     * @param trackers URLs udp://hôte:port
+     */
+    static void setDefaultTrackers(const std::vector<std::string>& trackers);
+    
+    /**
+     * Définit la durée de validité des résultats
+     * @param seconds Durée en secondes
+     */
+    static void setTtl(int seconds);
+    
+    /**
+     * Demande le rafraîchissement des entrées expirées (lignes visibles)
+     * @param magnet_links Liens magnet à rafraîchir
+     */
+    static void requestRefresh(const std::vector<std::string>& magnet_links);
+    
+    /**
+     * Obtient les compteurs en cache d'un lien magnet
+     * @param magnet_link Lien magnet
+     * @param counts Compteurs (remplis si disponibles)
+     * @return true si un scrape a réussi pour ce lien
+     */
+    static bool getCounts(const std::string& magnet_link, SwarmCounts& counts);
+    
+    /**
+     * Extrait l'info-hash et les trackers UDP d'un lien magnet
+     * @param magnet_link Lien magnet
+     * @param info_hash Info-hash brut (20 octets)
+     * @param trackers Trackers UDP du lien
+     * @return true si l'info-hash est valide
+     */
+    static bool parseMagnet(const std::string& magnet_link, std::string& info_hash,
+                            std::vector<std::string>& trackers);
+
+private:
+    struct SwarmEntry;
+    struct TrackerState;
+    
+    static std::map<std::string, SwarmEntry> s_entries;         // Par info-hash brut
+    static std::map<std::string, std::string> s_magnet_hashes;  // Lien magnet -> info-hash
+    static std::map<std::string, TrackerState> s_trackers;      // Utilisé par le thread uniquement
+    static std::vector<std::string> s_pending;                  // Info-hashes à rafraîchir
+    static std::vector<std::string> s_default_trackers;
+    static int s_ttl_s;
+    
+    static std::mutex s_mutex;
+    static std::condition_variable s_wakeup;
+    static std::thread s_worker;
+    static std::atomic<bool> s_running;
+    
+    static void workerLoop();
+    static bool scrapeTracker(const std::string& tracker, const std::vector<std::string>& hashes,
+                              std::map<std::string, SwarmCounts>& results);
+    static bool connectTracker(int sock, TrackerState& state);
+    static bool transact(int sock, TrackerState& state, const std::vector<uint8_t>& request,
+                         std::vector<uint8_t>& response, uint32_t transaction_id);
+};
+
+#endif // SCRAPE_SERVICE_H
@@ -0,0 +1,138 @@
+/**
+ * PS4 Store P2P - Planificateur de Partage
+ *
+ * Fait tourner les packages partagés selon la demande des essaims:
+ * les essaims les plus demandés (leechers / seeders) sont servis en priorité,
+ * les partages inactifs sont mis en pause jusqu'au prochain rééquilibrage
+ */
+
+#ifndef SEED_SCHEDULER_H
+#define SEED_SCHEDULER_H
+
+#include <string>
+#include <vector>
+#include <map>
+
+#ifndef NO_LIBTORRENT
+namespace libtorrent {
+    struct torrent_handle;
+}
+#endif
+
+// Demande observée pour un package partagé
+struct SeedDemand {
+    std::string name;
+    int seeders;            // Issu du dernier scrape (-1 = inconnu)
+    int leechers;           // Issu du dernier scrape (-1 = inconnu)
+    float score;            // Leechers par seeder, plus élevé = plus demandé
+    bool active;            // En partage actif (false = en pause)
+    int64_t last_scrape;    // Timestamp du dernier scrape (ms)
+    int64_t activated_at;   // Timestamp de la dernière activation (ms)
+    int64_t last_upload;    // Timestamp du dernier upload observé (ms)
+    int64_t total_upload;   // Octets envoyés (cumul)
+};
+
+// Paramètres de rotation
+struct SeedSchedulerConfig {
+    int max_active_seeds = 12;        // Partages actifs simultanés
+    int rebalance_interval_s = 300;   // Période de rééquilibrage
+    int scrape_interval_s = 1800;     // Période minimale entre deux scrapes d'un package
+    int scrapes_per_tick = 4;         // Scrapes envoyés par seconde au maximum
+    int idle_timeout_s = 900;         // Pause d'un partage sans upload ni leecher
+    int min_active_s = 600;           // Durée minimale d'activité avant rotation
+};
+
+class SeedScheduler {
+public:
+    /**
+     * Configure la rotation des partages
+     * @param config Paramètres de rotation
+     */
+    static void configure(const SeedSchedulerConfig& config);
+    
+    /**
+     * Obtient la configuration actuelle
+     * @return Paramètres de rotation
+     */
+    static SeedSchedulerConfig getConfig();
+
+#ifndef NO_LIBTORRENT
+    /**
+     * Place un package partagé sous le contrôle du planificateur
+     * @param name Nom du partage
+     * @param handle Handle du torrent (non auto-géré, mis en pause jusqu'au rééquilibrage)
+     */
+    static void registerSeed(const std::string& name, const libtorrent::torrent_handle& handle);
+    
+    /**
+     * Enregistre le résultat d'un scrape
+     * @param handle Handle du torrent scrapé
+     * @param seeders Nombre de seeders (complete)
+     * @param leechers Nombre de leechers (incomplete)
+     */
+    static void handleScrapeReply(const libtorrent::torrent_handle& handle, int seeders, int leechers);
+#endif
+
+    /**
+     * Retire un package du planificateur
+     * @param name Nom du partage
+     */
+    static void unregisterSeed(const std::string& name);
+    
+    /**
+     * Met à jour le planificateur (à appeler depuis TorrentManager::update)
+     */
+    static void update();
+    
+    /**
+     * Force un rééquilibrage au prochain update
+     */
+    static void requestRebalance();
+    
+    /**
+     * Obtient la demande observée de chaque partage
+     * @return Liste triée par score décroissant
+     */
+    static std::vector<SeedDemand> getSeedDemand();
+    
+    /**
+     * Choisit les partages à garder actifs lors d'un rééquilibrage
+     * @param demands Demande de chaque partage
+     * @param config Paramètres de rotation
+     * @param now Timestamp actuel (ms)
+     * @return Pour chaque partage, dans l'ordre de demands, true s'il doit être actif
+     */
+    static std::vector<bool> planRotation(const std::vector<SeedDemand>& demands,
+                                          const SeedSchedulerConfig& config, int64_t now);
+    
+    /**
+     * Vérifie si un partage actif peut être mis en pause avant le rééquilibrage
+     * @param demand Demande du partage
+     * @param config Paramètres de rotation
+     * @param now Timestamp actuel (ms)
+     * @return true sans leecher ni upload depuis le délai d'inactivité
+     */
+    static bool isIdle(const SeedDemand& demand, const SeedSchedulerConfig& config, int64_t now);
+    
+    /**
+     * Vide le planificateur
+     */
+    static void clear();
+
+private:
+    struct SeedEntry;
+    static std::map<std::string, SeedEntry> s_seeds;
+    static SeedSchedulerConfig s_config;
+    static int64_t s_last_tick;
+    static int64_t s_last_rebalance;
+    static bool s_rebalance_requested;
+    
+    static void sendScrapes(int64_t now);
+    static void refreshUploadStats(int64_t now);
+    static void parkIdleSeeds(int64_t now);
+    static void rebalance(int64_t now);
+    static float computeScore(const SeedDemand& demand);
+    static void setActive(SeedEntry& entry, bool active, int64_t now);
+};
+
+#endif // SEED_SCHEDULER_H
@@ -0,0 +1,154 @@
+/**
+ * PS4 Store P2P - Statistiques de Session
+ *
+ * Décode les compteurs de session libtorrent (session_stats_alert) dans un
+ * tableau de métriques de taille fixe et conserve un historique circulaire
+ * pour calculer débits, percentiles et le facteur limitant (réseau, disque, CPU)
+ */
+
+#ifndef SESSION_STATS_H
+#define SESSION_STATS_H
+
+#include <string>
+#include <array>
+#include <cstdint>
+
+#ifndef NO_LIBTORRENT
+namespace libtorrent {
+    struct session_stats_alert;
+}
+#endif
+
+// Métriques suivies (index dans le tableau d'échantillon)
+enum class SessionMetric : int {
+    RECV_BYTES,             // Compteur: octets reçus (protocole inclus)
+    SENT_BYTES,             // Compteur: octets envoyés (protocole inclus)
+    RECV_PAYLOAD_BYTES,     // Compteur: octets de données reçus
+    SENT_PAYLOAD_BYTES,     // Compteur: octets de données envoyés
+    PEERS_CONNECTED,        // Jauge: peers connectés
+    TCP_PEERS,              // Jauge: peers TCP
+    UTP_PEERS,              // Jauge: peers uTP
+    PEERS_DOWN_DISK,        // Jauge: peers en attente du disque (réception)
+    PEERS_UP_DISK,          // Jauge: peers en attente du disque (envoi)
+    DISK_QUEUE_DEPTH,       // Jauge: travaux disque en file
+    DISK_QUEUED_WRITE_BYTES,// Jauge: octets en attente d'écriture
+    DISK_BLOCKS_READ,       // Compteur: blocs lus
+    DISK_BLOCKS_WRITTEN,    // Compteur: blocs écrits
+    DISK_READ_CACHE_HITS,   // Compteur: blocs servis depuis le cache
+    DISK_READ_OPS,          // Compteur: opérations de lecture
+    DISK_WRITE_OPS,         // Compteur: opérations d'écriture
+    DISK_HASH_TIME,         // Compteur: temps de hachage (µs)
+    HASH_QUEUE,             // Jauge: travaux de hachage en attente
+    LIMITER_UP_QUEUE,       // Jauge: peers bloqués par la limite d'upload
+    LIMITER_DOWN_QUEUE,     // Jauge: peers bloqués par la limite de téléchargement
+    WRITE_CACHE_BLOCKS,     // Jauge: blocs dans le cache d'écriture
+    DISK_BLOCKS_HASHED,     // Compteur: blocs hachés
+    DISK_READ_BACK,         // Compteur: blocs relus sur disque pour le hachage (absents du cache d'écriture)
+    COUNT
+};
+
+static const int SESSION_METRIC_COUNT = static_cast<int>(SessionMetric::COUNT);
+
+// Échantillon de métriques à un instant donné
+struct SessionSample {
+    int64_t timestamp;  // ms
+    std::array<int64_t, SESSION_METRIC_COUNT> values;
+};
+
+// Facteur limitant d'un transfert
+enum class Bottleneck {
+    IDLE,
+    NETWORK,
+    DISK,
+    CPU
+};
+
+class SessionStats {
+public:
+    /**
+     * Résout les index des compteurs libtorrent
+     */
+    static void initialize();
+
+#ifndef NO_LIBTORRENT
+    /**
+     * Enregistre un échantillon à partir d'une alerte de statistiques
+     * @param alert Alerte reçue après post_session_stats()
+     */
+    static void handleStatsAlert(const libtorrent::session_stats_alert* alert);
+#endif
+
+    /**
+     * Ajoute un échantillon à l'historique
+     * @param sample Échantillon décodé
+     */
+    static void record(const SessionSample& sample);
+    
+    /**
+     * Vide l'historique
+     */
+    static void clear();
+    
+    /**
+     * Obtient le nombre d'échantillons disponibles
+     * @return Nombre d'échantillons (au plus la taille de l'historique)
+     */
+    static int getSampleCount();
+    
+    /**
+     * Obtient la dernière valeur d'une métrique
+     * @param metric Métrique
+     * @return Valeur, 0 si aucun échantillon
+     */
+    static int64_t getLatest(SessionMetric metric);
+    
+    /**
+     * Calcule le débit d'un compteur sur les derniers échantillons
+     * @param metric Métrique de type compteur
+     * @param window Nombre d'échantillons
+     * @return Variation par seconde
+     */
+    static double getRate(SessionMetric metric, int window = 2);
+    
+    /**
+     * Calcule un percentile d'une jauge sur les derniers échantillons
+     * @param metric Métrique de type jauge
+     * @param percentile Percentile entre 0.0 et 1.0
+     * @param window Nombre d'échantillons
+     * @return Valeur du percentile
+     */
+    static int64_t getPercentile(SessionMetric metric, float percentile, int window = 30);
+    
+    /**
+     * Calcule la part des blocs hachés depuis le cache d'écriture
+     * @param window Nombre d'échantillons
+     * @return Ratio entre 0.0 et 1.0, -1.0 si aucun bloc haché
+     */
+    static double getWriteCacheHitRatio(int window = 10);
+    
+    /**
+     * Détermine le facteur limitant sur les derniers échantillons
+     * @param window Nombre d'échantillons
+     * @return Réseau, disque, CPU ou inactif
+     */
+    static Bottleneck classifyBottleneck(int window = 10);
+    
+    /**
+     * Obtient le libellé d'un facteur limitant
+     * @param bottleneck Facteur limitant
+     * @return Libellé
+     */
+    static std::string getBottleneckString(Bottleneck bottleneck);
+
+private:
+    static const int HISTORY_SIZE = 120;
+    
+    static std::array<SessionSample, HISTORY_SIZE> s_history;
+    static std::array<int, SESSION_METRIC_COUNT> s_metric_index;
+    static int s_head;
+    static int s_count;
+    
+    static const SessionSample& sampleAt(int age);
+};
+
+#endif // SESSION_STATS_H
@@ -0,0 +1,150 @@
+/**
+ * PS4 Store P2P - Réglage Automatique de la Session
+ *
+ * Boucle de rétroaction sur les compteurs de session: ajuste la limite de
+ * connexions, le nombre de slots d'unchoke et la profondeur de la file de
+ * requêtes par peer selon le débit mesuré par connexion, la charge CPU et la
+ * marge mémoire, dans des bornes configurées. Chaque décision est journalisée
+ * et conservée pour l'analyse des bancs de mesure
+ */
+
+#ifndef SESSION_TUNER_H
+#define SESSION_TUNER_H
+
+#include <string>
+#include <vector>
+#include <cstdint>
+
+#ifndef NO_LIBTORRENT
+namespace libtorrent {
+    class session;
+    class settings_pack;
+}
+#endif
+
+// Bornes et objectifs du réglage
+struct SessionTunerConfig {
+    bool enabled = true;
+    int interval_ms = 10000;                    // Période entre deux décisions
+    int min_connections = 16;
+    int max_connections = 50;                   // [Network] max_connections
+    int min_unchoke_slots = 2;
+    int max_unchoke_slots = 16;
+    int min_request_queue = 50;                 // max_out_request_queue (blocs de 16 KiB)
+    int max_request_queue = 1000;
+    int slot_upload_rate = 32 * 1024;           // Débit visé par slot d'unchoke (bytes/sec)
+    float max_cpu_load = 0.80f;                 // Charge CPU du processus (1.0 = un cœur)
+    int64_t memory_budget = 192LL * 1024 * 1024;    // [Performance] memory_budget (cache et réserve d'écriture compris)
+    int64_t min_memory_headroom = 16LL * 1024 * 1024;
+};
+
+// Valeurs appliquées à la session
+struct SessionTuning {
+    int connections_limit;
+    int unchoke_slots;
+    int request_queue;
+};
+
+// Décision du contrôleur (journalisée)
+struct TuningDecision {
+    int64_t timestamp;                  // ms
+    SessionTuning before;
+    SessionTuning after;
+    double download_rate_per_peer;      // bytes/sec
+    double upload_rate_per_slot;        // bytes/sec
+    float cpu_load;
+    int64_t memory_headroom;            // bytes
+    int peers;
+    std::string reason;
+};
+
+class SessionTuner {
+public:
+    /**
+     * Configure le contrôleur et remet les valeurs initiales
+     * @param config Bornes et objectifs
+     */
+    static void configure(const SessionTunerConfig& config);
+    
+    /**
+     * Obtient la configuration actuelle
+     * @return Bornes et objectifs
+     */
+    static SessionTunerConfig getConfig();
+    
+    /**
+     * Obtient les valeurs actuellement appliquées
+     * @return Limites de la session
+     */
+    static SessionTuning getTuning();
+    
+    /**
+     * Obtient l'historique des décisions (les plus récentes en dernier)
+     * @return Décisions
+     */
+    static std::vector<TuningDecision> getDecisions();
+
+#ifndef NO_LIBTORRENT
+    /**
+     * Écrit les valeurs initiales dans les réglages de création de la session
+     * @param settings Réglages de la session
+     */
+    static void applyInitial(libtorrent::settings_pack& settings);
+    
+    /**
+     * Évalue les compteurs et ajuste la session (à appeler depuis TorrentManager::update)
+     * @param session Session libtorrent
+     */
+    static void update(libtorrent::session& session);
+#endif
+
+    /**
+     * Calcule les nouvelles limites à partir des mesures (sans effet de bord)
+     * @param config Bornes et objectifs
+     * @param current Limites actuelles
+     * @param upload_limit Limite d'upload globale (bytes/sec, 0 = illimité)
+     * @param rate_limited Des peers attendent le limiteur de débit
+     * @param decision Mesures en entrée; limites et motif en sortie
+     * @return true si une limite change
+     */
+    static bool decide(const SessionTunerConfig& config, const SessionTuning& current,
+                       int upload_limit, bool rate_limited, TuningDecision& decision);
+    
+    /**
+     * Détermine si le limiteur de débit doit réduire les connexions
+     * @param up_queue Peers en attente du limiteur d'upload (médiane)
+     * @param down_queue Peers en attente du limiteur de téléchargement (médiane)
+     * @param upload_limit Limite d'upload globale (bytes/sec, 0 = illimité)
+     * @param download_limit Limite de téléchargement globale (bytes/sec, 0 = illimité)
+     * @return true si une direction plafonnée retient des peers
+     */
+    static bool isRateLimited(int64_t up_queue, int64_t down_queue, int upload_limit, int download_limit);
+    
+    /**
+     * Obtient la mémoire réservée par les tampons bornés: un cache plein est
+     * leur régime normal, seule leur capacité est retirée du budget
+     * @return Capacités du cache des pièces et de la réserve d'écriture (octets)
+     */
+    static int64_t getReservedMemory();
+    
+    /**
+     * Vide l'historique et remet les valeurs initiales
+     */
+    static void clear();
+
+private:
+    static const int MAX_DECISIONS = 64;
+    
+    static SessionTunerConfig s_config;
+    static SessionTuning s_tuning;
+    static std::vector<TuningDecision> s_decisions;
+    static int64_t s_last_decision;
+    static int64_t s_last_cpu_time;     // µs
+    static int64_t s_last_cpu_sample;   // ms
+    
+    static float sampleCpuLoad(int64_t now);
+    static int64_t memoryHeadroom(int peers);
+    static void record(const TuningDecision& decision);
+};
+
+#endif // SESSION_TUNER_H
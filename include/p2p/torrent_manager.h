@@ -13,6 +13,9 @@
 #include <map>
 #include <functional>
 #include <memory>
+#include <mutex>
+
+#include "utils/thread_pool.h"
 
 // Forward declarations pour libtorrent
 #ifndef NO_LIBTORRENT
@@ -20,7 +23,8 @@ namespace libtorrent {
     class session;
     class torrent_handle;
     class torrent_status;
-    class add_torrent_params;
+    struct add_torrent_params;
+    struct add_torrent_alert;
 }
 #endif
 
@@ -39,8 +43,50 @@ struct DownloadInfo {
     bool is_finished;
     bool is_seeding;
     std::string status;
+    int64_t ttfb_ms;    // Délai jusqu'au premier octet (ms, -1 = pas encore)
+};
+
+// Package à partager lors d'une admission groupée
+struct ShareRequest {
+    std::string pkg_path;
+    std::string name;
 };
 
+// Budget d'admission des torrents ajoutés en lot
+struct AdmissionBudget {
+    int max_in_flight = 8;              // Ajouts asynchrones simultanés
+    int max_activations_per_tick = 4;   // Activations par intervalle
+    int activation_interval_ms = 250;   // Intervalle entre deux vagues d'activation
+    int connections_per_torrent = 4;    // Connexions estimées par torrent actif
+    int64_t memory_budget = 64LL * 1024 * 1024; // Mémoire max des métadonnées en cours d'ajout
+};
+
+// Options de session appliquées par initialize()
+struct SessionOptions {
+    std::string listen_interfaces;      // Liste explicite (vide = construite par buildListenInterfaces)
+    int listen_port = 6881;
+    bool enable_ipv6 = true;            // Écoute aussi en IPv6 si l'hôte a une adresse IPv6 routable
+    std::vector<std::string> listen_devices; // Interfaces à lier, par nom (vide = toutes)
+    std::string outgoing_interfaces;    // Vide = choix du système
+    std::string download_path = "/data/ps4_store/downloads";
+    std::string state_file = "/data/ps4_store/session.state";
+    bool enable_dht = true;
+    bool enable_lsd = true;
+    bool enable_port_mapping = true;    // UPnP et NAT-PMP
+    bool enable_trackers = true;        // false = trackers retirés des torrents ajoutés
+    int state_save_interval = 300;      // Sauvegarde périodique de l'état (secondes, 0 = à l'arrêt seulement)
+};
+
+// Peers connectés par famille d'adresses
+struct PeerFamilyCounts {
+    int ipv4;
+    int ipv6;
+    int incoming_ipv4;      // Connexions entrantes (preuve d'accessibilité)
+    int incoming_ipv6;
+};
+
+struct NetworkInterface;
+
 // Callbacks pour les événements
 using DownloadProgressCallback = std::function<void(const std::string&, float)>;
 using DownloadCompleteCallback = std::function<void(const std::string&, const std::string&)>;
@@ -54,6 +100,12 @@ public:
      */
     static int initialize();
     
+    /**
+     * Définit les options de session (à appeler avant initialize)
+     * @param options Interfaces, chemins et services réseau
+     */
+    static void setSessionOptions(const SessionOptions& options);
+    
     /**
      * Nettoie les ressources du gestionnaire
      */
@@ -98,6 +150,40 @@ public:
      */
     static bool sharePackage(const std::string& pkg_path, const std::string& name);
     
+    /**
+     * Partage une bibliothèque de packages en lot
+     * Les fichiers .torrent sont chargés en parallèle en arrière-plan puis
+     * ajoutés via async_add_torrent et activés progressivement selon le budget
+     * @param packages Packages à partager
+     * @return Nombre de packages planifiés
+     */
+    static int shareLibrary(const std::vector<ShareRequest>& packages);
+    
+    /**
+     * Définit le budget d'admission des ajouts groupés
+     * @param budget Budget mémoire et connexions
+     */
+    static void setAdmissionBudget(const AdmissionBudget& budget);
+    
+    /**
+     * Compte les admissions à lancer en tête de file
+     * Le budget mémoire porte sur les ajouts en cours: l'estimation est rendue
+     * dès que la session a répondu, succès ou échec
+     * @param estimates Mémoire estimée des admissions en file, dans l'ordre
+     * @param in_flight Ajouts en cours
+     * @param in_flight_memory Mémoire estimée des ajouts en cours
+     * @param budget Budget d'admission
+     * @return Nombre d'admissions à lancer
+     */
+    static size_t countAdmissible(const std::vector<int64_t>& estimates, int in_flight, int64_t in_flight_memory,
+                                  const AdmissionBudget& budget);
+    
+    /**
+     * Obtient le nombre de torrents en attente d'admission ou d'activation
+     * @return Nombre de torrents en attente
+     */
+    static int getPendingAdmissions();
+    
     /**
      * Obtient la liste des téléchargements actifs
      * @return Liste des téléchargements
@@ -112,7 +198,8 @@ public:
     static DownloadInfo getDownloadInfo(const std::string& name);
     
     /**
-     * Définit le callback de progression
+     * Définit le callback de progression (appelé depuis EventQueue::dispatch,
+     * au plus une fois par téléchargement et par image)
      * @param callback Fonction à appeler lors de la progression
      */
     static void setProgressCallback(DownloadProgressCallback callback);
@@ -131,20 +218,69 @@ public:
     
     /**
      * Configure les limites de bande passante
+     * Les peers du réseau local (classe LAN) ne sont pas concernés
      * @param download_limit Limite de téléchargement (bytes/sec, 0 = illimité)
      * @param upload_limit Limite d'upload (bytes/sec, 0 = illimité)
      */
     static void setBandwidthLimits(int download_limit, int upload_limit);
     
+    /**
+     * Reconstruit la classe de peers LAN à partir des sous-réseaux locaux
+     * Les peers LAN sont exemptés des limites globales et prioritaires à l'unchoke
+     * @return true si la classe est en place
+     */
+    static bool refreshLanPeerClass();
+    
+    /**
+     * Installe la liste de blocage IP active (IpBlocklist) comme ip_filter de la session
+     * Le filtre s'applique aussi aux connexions vers les trackers
+     * @return true si le filtre est en place
+     */
+    static bool applyIpBlocklist();
+    
+    /**
+     * Connecte directement un peer à un torrent (sans tracker ni DHT)
+     * @param name Nom du téléchargement ou du partage
+     * @param address Adresse IP du peer
+     * @param port Port du peer
+     * @return true si la connexion a été demandée
+     */
+    static bool addPeer(const std::string& name, const std::string& address, int port);
+    
     /**
      * Configure le port d'écoute
+     * Les sockets sont recréés sur toutes les interfaces sans redémarrer la session
+     * (la liste explicite listen_interfaces est abandonnée)
      * @param port Port à utiliser (0 = automatique)
      * @return true en cas de succès
      */
     static bool setListenPort(int port);
     
     /**
-     * Obtient les statistiques globales
+     * Reconstruit la liste d'écoute et l'applique si les interfaces ont changé
+     * @return true si la liste est en place
+     */
+    static bool refreshListenInterfaces();
+    
+    /**
+     * Construit la valeur de listen_interfaces
+     * Sans liste d'interfaces: 0.0.0.0 et [::] si l'hôte a une adresse IPv6 routable.
+     * Avec liste: chaque adresse des interfaces nommées (IPv6 lien-local exclue)
+     * @param options Options de session
+     * @param interfaces Interfaces de l'hôte
+     * @return Liste "adresse:port" séparée par des virgules
+     */
+    static std::string buildListenInterfaces(const SessionOptions& options,
+                                             const std::vector<NetworkInterface>& interfaces);
+    
+    /**
+     * Obtient le nombre de peers connectés par famille d'adresses
+     * @return Compteurs du dernier échantillon
+     */
+    static PeerFamilyCounts getPeerFamilyCounts();
+    
+    /**
+     * Obtient les statistiques globales (compteurs de session échantillonnés)
      * @param total_download Téléchargement total (bytes)
      * @param total_upload Upload total (bytes)
      * @param download_rate Vitesse de téléchargement (bytes/sec)
@@ -174,17 +310,55 @@ private:
 #endif
     static std::string s_download_path;
     static std::string s_state_file;
+    static SessionOptions s_session_options;
     
     static DownloadProgressCallback s_progress_callback;
     static DownloadCompleteCallback s_complete_callback;
     static DownloadErrorCallback s_error_callback;
     
+    // Admission asynchrone
+#ifndef NO_LIBTORRENT
+    struct PendingAdmission;
+    static std::vector<PendingAdmission> s_admission_queue;
+    static std::map<std::string, int64_t> s_admissions_in_flight;
+    static std::vector<std::string> s_staged_activations;
+    static std::vector<TaskFuture<void>> s_admission_jobs;
+    static std::mutex s_admission_mutex;
+    static AdmissionBudget s_admission_budget;
+    static int64_t s_admitted_memory;
+    static bool s_admission_held;
+    static int64_t s_last_activation_time;
+#endif
+    
+    // Classe de peers LAN
+    static int s_lan_peer_class;
+    static std::string s_lan_subnets;
+    static int64_t s_last_lan_check;
+    
+    // Échantillonnage des compteurs de session
+    static int64_t s_last_stats_request;
+    
+    // Écoute et peers par famille d'adresses
+    static std::string s_listen_interfaces;
+    static PeerFamilyCounts s_peer_counts;
+    static int64_t s_last_peer_count;
+    
+    // Sauvegarde périodique de l'état
+    static int64_t s_last_state_save;
+    
     // Méthodes internes
 #ifndef NO_LIBTORRENT
     static void processAlerts();
     static void handleTorrentAlert(const libtorrent::torrent_status& status);
+    static void handleAddTorrentAlert(const libtorrent::add_torrent_alert* alert);
+    static void pumpAdmissions();
+    static bool prepareSeedParams(const ShareRequest& request, PendingAdmission& admission);
+    static std::string findTorrentName(const libtorrent::torrent_handle& handle);
+    static void countPeersByFamily();
 #endif
     static std::string getStatusString(int state);
+    static void subscribeEvents();
+    static void postError(const std::string& name, const std::string& message);
     static void createTorrentFile(const std::string& file_path, const std::string& output_path);
 };
 
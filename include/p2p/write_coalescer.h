@@ -0,0 +1,116 @@
+/**
+ * PS4 Store P2P - Regroupement des Écritures
+ *
+ * Les pièces choisies "rarest first" arrivent dans le désordre: écrites telles
+ * quelles, elles font sauter la tête du disque dur (ou de la clé USB) d'un
+ * bout à l'autre du fichier à chaque bloc de 16 KiB. Les blocs reçus sont
+ * retenus dans une réserve bornée, puis écrits triés par position en longues
+ * séquences contiguës, avec synchronisation optionnelle après chaque vidage
+ */
+
+#ifndef WRITE_COALESCER_H
+#define WRITE_COALESCER_H
+
+#include <mutex>
+#include <cstdint>
+
+#ifndef NO_LIBTORRENT
+namespace libtorrent {
+    struct session_params;
+}
+#endif
+
+// Synchronisation des fichiers après un vidage
+enum class WriteSyncMode {
+    NONE,       // Laissée au système
+    BATCH       // fsync des fichiers écrits, après chaque vidage
+};
+
+// Paramètres du regroupement
+struct WriteCoalescerConfig {
+    bool enabled = true;
+    int64_t pool_bytes = 16LL * 1024 * 1024;    // Réserve maximale, vidée lorsqu'elle est pleine
+    int max_delay_ms = 1000;                    // Délai maximal d'un bloc dans la réserve
+    WriteSyncMode sync_mode = WriteSyncMode::NONE;
+};
+
+// Compteurs du regroupement
+struct WriteCoalescerStats {
+    int64_t blocks;             // Blocs écrits
+    int64_t bytes;
+    int64_t flushes;            // Vidages de la réserve
+    int64_t runs;               // Séquences contiguës écrites (déplacements de tête)
+    int64_t arrival_runs;       // Séquences contiguës dans l'ordre d'arrivée (sans regroupement)
+    int64_t read_hits;          // Lectures servies depuis la réserve
+    int64_t syncs;              // Fichiers synchronisés
+    int64_t pool_bytes;         // Octets en réserve
+    int64_t peak_pool_bytes;
+};
+
+class WriteCoalescer {
+public:
+    /**
+     * Configure le regroupement (avant la création de la session)
+     * @param config Réserve, délai et synchronisation
+     */
+    static void configure(const WriteCoalescerConfig& config);
+    
+    /**
+     * Obtient la configuration actuelle
+     * @return Configuration
+     */
+    static WriteCoalescerConfig getConfig();
+    
+    /**
+     * Obtient les compteurs
+     * @return Compteurs
+     */
+    static WriteCoalescerStats getStats();
+
+#ifndef NO_LIBTORRENT
+    /**
+     * Place la réserve devant le stockage de la session (libtorrent 2.0) et
+     * autorise libtorrent à garder autant d'écritures en attente
+     * @param params Paramètres de création de la session
+     */
+    static void install(libtorrent::session_params& params);
+#endif
+
+    /**
+     * Enregistre l'arrivée d'un bloc (fragmentation sans regroupement)
+     */
+    static void recordArrival(int64_t position, int length);
+    
+    /**
+     * Enregistre un vidage de la réserve
+     */
+    static void recordFlush(int64_t blocks, int64_t bytes, int64_t runs);
+    
+    /**
+     * Met à jour la taille de la réserve
+     */
+    static void recordPoolBytes(int64_t pool_bytes);
+    
+    /**
+     * Enregistre une lecture servie depuis la réserve
+     */
+    static void recordReadHit();
+    
+    /**
+     * Enregistre une synchronisation de fichier
+     */
+    static void recordSync();
+    
+    /**
+     * Remet les compteurs à zéro
+     */
+    static void clear();
+
+private:
+    static WriteCoalescerConfig s_config;
+    static WriteCoalescerStats s_stats;
+    static int64_t s_last_arrival_end;
+    static std::mutex s_mutex;
+};
+
+#endif // WRITE_COALESCER_H
@@ -12,6 +12,10 @@
 #include <vector>
 #include <map>
 #include <functional>
+#include <mutex>
+#include <atomic>
+
+#include "utils/thread_pool.h"
 
 // Structure pour les informations d'un package
 struct PackageInfo {
@@ -52,11 +56,15 @@ struct InstallProgress {
     std::string error_message;
     int64_t bytes_copied;
     int64_t total_bytes;
+    int64_t bytes_per_second;   // Débit lissé de la copie
+    int64_t eta_seconds;        // Temps restant de la copie (-1 si inconnu)
 };
 
 // Callbacks pour les événements d'installation
 using InstallProgressCallback = std::function<void(const InstallProgress&)>;
-using InstallCompleteCallback = std::function<void(const std::string&, bool)>;
+using InstallCompleteCallback = std::function<void(const std::string&, bool, const std::string&)>;
+using PackageInfoCallback = std::function<void(const PackageInfo&)>;
+using VerifyCallback = std::function<void(bool)>;
 
 class PkgManager {
 public:
@@ -71,11 +79,6 @@ public:
      */
     static void cleanup();
     
-    /**
-     * Met à jour le gestionnaire (à appeler dans la boucle principale)
-     */
-    static void update();
-    
     /**
      * Analyse un fichier .pkg et extrait ses informations
      * @param pkg_path Chemin vers le fichier .pkg
@@ -93,10 +96,30 @@ public:
                              const std::string& expected_checksum = "");
     
     /**
-     * Installe un package .pkg
+     * Analyse un fichier .pkg dans la réserve de threads (priorité interactive)
+     * @param pkg_path Chemin vers le fichier .pkg
+     * @param on_done Appelé depuis EventQueue::dispatch, sur le thread principal (optionnel)
+     * @return Informations du package à venir
+     */
+    static TaskFuture<PackageInfo> analyzePackageAsync(const std::string& pkg_path,
+                                                       PackageInfoCallback on_done = nullptr);
+    
+    /**
+     * Vérifie un fichier .pkg dans la réserve de threads (travail de fond)
+     * @param pkg_path Chemin vers le fichier .pkg
+     * @param expected_checksum Checksum attendu (optionnel)
+     * @param on_done Appelé depuis EventQueue::dispatch, sur le thread principal (optionnel)
+     * @return Validité à venir
+     */
+    static TaskFuture<bool> verifyPackageAsync(const std::string& pkg_path, const std::string& expected_checksum = "",
+                                               VerifyCallback on_done = nullptr);
+    
+    /**
+     * Installe un package .pkg dans la réserve de threads (analyse comprise)
+     * L'échec de l'analyse ou des vérifications est signalé par le callback de fin
      * @param pkg_path Chemin vers le fichier .pkg
      * @param force_install Forcer l'installation même si déjà installé
-     * @return true si l'installation a démarré avec succès
+     * @return true si l'installation a été planifiée (false si une autre est en cours)
      */
     static bool installPackage(const std::string& pkg_path, bool force_install = false);
     
@@ -134,7 +157,7 @@ public:
     static InstallProgress getCurrentInstallProgress();
     
     /**
-     * Annule l'installation en cours
+     * Annule l'installation en cours (arrêtée à la fin du bloc ou de l'étape en cours)
      * @return true en cas de succès
      */
     static bool cancelCurrentInstall();
@@ -161,14 +184,15 @@ public:
     static void cleanupTempFiles();
     
     /**
-     * Définit le callback de progression d'installation
+     * Définit le callback de progression d'installation (appelé depuis
+     * EventQueue::dispatch, au plus une fois par image)
      * @param callback Fonction à appeler
      */
     static void setInstallProgressCallback(InstallProgressCallback callback);
     
     /**
-     * Définit le callback de fin d'installation
-     * @param callback Fonction à appeler
+     * Définit le callback de fin d'installation (appelé depuis EventQueue::dispatch)
+     * @param callback Fonction à appeler (nom, succès, message d'erreur de cette installation)
      */
     static void setInstallCompleteCallback(InstallCompleteCallback callback);
     
@@ -209,7 +233,9 @@ private:
     static std::string s_install_path;
     static std::string s_temp_path;
     static InstallProgress s_current_install;
-    static bool s_install_in_progress;
+    static std::mutex s_install_mutex;          // s_current_install (écrit par la tâche d'installation)
+    static std::atomic<bool> s_install_in_progress;
+    static TaskFuture<bool> s_install_task;     // Installation en cours dans la réserve de threads
     
     static InstallProgressCallback s_progress_callback;
     static InstallCompleteCallback s_complete_callback;
@@ -219,7 +245,11 @@ private:
     static bool extractPkgMetadata(const std::string& pkg_path, PackageInfo& info);
     static bool validatePkgStructure(const std::string& pkg_path);
     static void updateInstallProgress(const std::string& operation, float progress);
-    static bool copyFileWithProgress(const std::string& source, const std::string& dest);
+    static void setInstallStatus(InstallStatus status, const std::string& error_message = "");
+    static void finishInstall(bool success);
+    static void subscribeEvents();
+    static bool copyFileWithProgress(const std::string& source, const std::string& dest,
+                                     const CancellationToken& token = CancellationToken());
     static std::string formatFileSize(int64_t bytes);
     static bool createDirectoryRecursive(const std::string& path);
 };
@@ -113,6 +113,9 @@ private:
     static void renderGameCard(const GameInfo& game, int x, int y, int width, int height, bool selected = false);
     static void renderNotification();
     
+    // Compteurs d'essaim des lignes visibles
+    static void refreshSwarmCounts();
+    
     // Gestion des événements pour chaque état
     static void handleMainMenuEvent(const SDL_Event& event);
     static void handleGameListEvent(const SDL_Event& event);
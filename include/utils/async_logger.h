@@ -0,0 +1,142 @@
+/**
+ * PS4 Store P2P - Journal Asynchrone
+ *
+ * Les appels à Utils::log déposent leur message dans un anneau sans verrou
+ * (plusieurs producteurs, un consommateur) et rendent la main aussitôt. Un
+ * thread d'écriture met en forme l'horodatage, écrit les messages par lots
+ * sur la console et dans le fichier de log gardé ouvert, et fait tourner le
+ * fichier à sa taille maximale. Anneau plein: le message est abandonné et
+ * compté, la perte est signalée dans le journal
+ */
+
+#ifndef ASYNC_LOGGER_H
+#define ASYNC_LOGGER_H
+
+#include "utils/utils.h"
+
+#include <string>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <condition_variable>
+#include <memory>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+
+class AsyncLogger {
+public:
+    /**
+     * Démarre le thread d'écriture
+     * @param capacity Messages en attente au maximum (arrondi à une puissance de deux)
+     */
+    static void start(size_t capacity = 16384);
+    
+    /**
+     * Écrit les messages en attente et arrête le thread d'écriture
+     */
+    static void stop();
+    
+    /**
+     * Vérifie si le thread d'écriture tourne
+     * @return true si les messages sont écrits en arrière-plan
+     */
+    static bool isRunning();
+    
+    /**
+     * Dépose un message (écrit immédiatement si le thread d'écriture est arrêté)
+     * @param level Niveau
+     * @param timestamp Horodatage (ms depuis l'epoch)
+     * @param file Fichier source (littéral, peut être nul)
+     * @param line Ligne source
+     * @param message Message
+     * @return false si le message a été abandonné (anneau plein)
+     */
+    static bool push(Utils::LogLevel level, int64_t timestamp, const char* file, int line, std::string message);
+    
+    /**
+     * Attend que les messages déposés avant l'appel soient écrits
+     */
+    static void flush();
+    
+    /**
+     * Définit le fichier de log (vide = console seulement)
+     * @param path Chemin du fichier
+     */
+    static void setFile(const std::string& path);
+    
+    /**
+     * Définit la taille à partir de laquelle le fichier est renommé en .1
+     * @param bytes Taille maximale (0 = illimitée)
+     * @param backups Anciens fichiers conservés (.1 à .N)
+     */
+    static void setMaxFileSize(int64_t bytes, int backups = 2);
+    
+    /**
+     * Obtient le nombre de messages abandonnés depuis le démarrage
+     * @return Messages perdus
+     */
+    static int64_t getDropped();
+    
+    /**
+     * Obtient le nombre de messages déposés et pas encore écrits
+     * @return Messages en attente
+     */
+    static int64_t getQueueDepth();
+    
+    /**
+     * Met en forme un message comme dans le journal
+     * @return Ligne sans fin de ligne
+     */
+    static std::string formatRecord(Utils::LogLevel level, int64_t timestamp, const char* file, int line,
+                                    const std::string& message);
+
+private:
+    struct Record {
+        Utils::LogLevel level;
+        int64_t timestamp;
+        const char* file;
+        int line;
+        std::string message;
+    };
+    
+    struct Slot {
+        std::atomic<size_t> sequence;
+        Record record;
+    };
+    
+    static std::unique_ptr<Slot[]> s_slots;
+    static size_t s_mask;
+    static std::atomic<size_t> s_enqueue_pos;
+    static size_t s_dequeue_pos;                    // Thread d'écriture seulement
+    static std::atomic<bool> s_running;
+    static std::atomic<int64_t> s_dropped;
+    static std::atomic<int64_t> s_pushed;
+    static std::atomic<int64_t> s_written;
+    static std::atomic<int> s_producers;            // Dépôts en cours dans l'anneau
+    static int64_t s_reported_dropped;
+    static std::thread s_thread;
+    static std::mutex s_wakeup_mutex;
+    static std::condition_variable s_wakeup;
+    static std::condition_variable s_drained;
+    
+    // Sortie (thread d'écriture ou écriture directe), sous s_output_mutex
+    static std::mutex s_output_mutex;
+    static std::string s_file_path;
+    static FILE* s_file;
+    static int64_t s_file_size;
+    static int64_t s_max_file_size;
+    static int s_backups;
+    static int64_t s_cached_second;
+    static std::string s_cached_time;
+    
+    static bool pop(Record& record);
+    static void run();
+    static void writeRecords(std::vector<Record>& records);
+    static void writeBatch(const std::string& batch);
+    static void openFile();
+    static void rotateFile();
+    static void appendFormatted(std::string& out, const Record& record);
+};
+
+#endif // ASYNC_LOGGER_H
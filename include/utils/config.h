@@ -0,0 +1,264 @@
+/**
+ * PS4 Store P2P - Configuration Typée
+ *
+ * config.ini est lu section par section dans une structure typée par section
+ * (AppConfig): les valeurs sont converties et bornées une seule fois, puis
+ * lues directement par champ, sans recherche dans une map. Une clé inconnue,
+ * en double ou hors bornes est signalée et garde sa valeur par défaut (sa
+ * valeur en cours lors d'un rechargement).
+ *
+ * Le fichier est surveillé depuis la boucle principale (Config::update): une
+ * modification stable est relue, et les abonnés reçoivent la liste des clés
+ * changées (limites de débit, taille des caches, niveau de log...). Les clés
+ * qui ne s'appliquent qu'à la création de la session gardent leur valeur
+ * jusqu'au prochain démarrage
+ */
+
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include "utils/utils.h"
+
+#include <string>
+#include <vector>
+#include <set>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+
+// [Network]
+struct NetworkSection {
+    int listen_port = 6881;
+    bool enable_ipv6 = true;
+    std::vector<std::string> listen_devices;
+    int download_limit = 0;             // KB/s, 0 = illimité
+    int upload_limit = 512;
+    std::string bandwidth_schedule;
+    int max_connections = 50;
+    bool autotune = true;
+    int min_connections = 16;
+    int max_unchoke_slots = 16;
+    bool enable_dht = true;
+    bool enable_lsd = true;
+    bool enable_upnp = true;
+};
+
+// [Paths]
+struct PathsSection {
+    std::string download_path = "/data/ps4_store/downloads";
+    std::string install_path = "/user/app";
+    std::string temp_path = "/data/ps4_store/temp";
+    std::string cache_path = "/data/ps4_store/cache";
+    std::string state_file = "/data/ps4_store/session.state";
+};
+
+// [UI]
+struct UISection {
+    int screen_width = 1920;
+    int screen_height = 1080;
+    bool fullscreen = true;
+    std::string language = "fr";
+    std::string theme = "dark";
+};
+
+// [Logging]
+struct LoggingSection {
+    Utils::LogLevel log_level = Utils::LogLevel::INFO;
+    bool file_logging = false;
+    std::string log_file = "ps4_store.log";
+    int max_log_size = 10;              // MB, 0 = illimitée
+};
+
+// [Security]
+struct SecuritySection {
+    bool verify_checksums = true;
+    bool scan_downloads = false;
+    bool block_malicious_trackers = true;
+    std::vector<std::string> blocklist_files;
+};
+
+// [Performance]
+struct PerformanceSection {
+    int disk_cache_size = 64;           // MB, 0 = désactivé
+    int memory_budget = 192;            // MB, cache et réserve d'écriture compris
+    int read_ahead_blocks = 8;
+    bool write_coalescing = true;
+    int write_pool_size = 16;           // MB
+    int write_flush_delay = 1000;       // ms
+    std::string write_sync = "none";    // none, batch
+    int io_threads = 4;
+    int worker_threads = 0;             // 0 = cœurs disponibles moins un
+    int auto_save_interval = 300;       // Secondes
+    bool auto_cleanup = true;
+};
+
+// [Trackers]
+struct TrackersSection {
+    std::vector<std::string> default_trackers;
+    bool fast_start = true;
+    int tracker_timeout = 30;
+    int max_tracker_retries = 3;
+    int scrape_ttl = 1800;
+};
+
+// [Advanced]
+struct AdvancedSection {
+    bool debug_mode = false;
+    bool trace_enabled = false;
+    std::string trace_file = "/data/ps4_store/trace.json";
+    int trace_buffer_events = 262144;
+    bool metrics_enabled = true;
+    int metrics_interval = 10;          // Secondes
+    int metrics_file_size = 4;          // MB, 0 = illimitée
+    int ui_update_interval = 100;
+    int error_retry_delay = 5;
+    int max_concurrent_downloads = 3;
+    int pre_announce_downloads = 2;
+    bool enable_compression = true;
+    int network_timeout = 30;
+};
+
+// Configuration complète, une structure par section
+struct AppConfig {
+    NetworkSection network;
+    PathsSection paths;
+    UISection ui;
+    LoggingSection logging;
+    SecuritySection security;
+    PerformanceSection performance;
+    TrackersSection trackers;
+    AdvancedSection advanced;
+};
+
+// Valeur d'une clé, sous forme de texte
+struct ConfigEntry {
+    std::string section;
+    std::string key;
+    std::string value;
+    bool live;                          // false = appliquée au prochain démarrage
+};
+
+// Clés modifiées par un rechargement ("Section.clé")
+class ConfigChanges {
+public:
+    void add(const std::string& section, const std::string& key) { m_keys.insert(section + "." + key); }
+    
+    /**
+     * Vérifie si une clé (ou une section entière si key est vide) a changé
+     */
+    bool has(const std::string& section, const std::string& key = "") const {
+        if (!key.empty()) return m_keys.count(section + "." + key) > 0;
+        auto it = m_keys.lower_bound(section + ".");
+        return it != m_keys.end() && it->compare(0, section.size() + 1, section + ".") == 0;
+    }
+    
+    bool empty() const { return m_keys.empty(); }
+    const std::set<std::string>& keys() const { return m_keys; }
+
+private:
+    std::set<std::string> m_keys;
+};
+
+// Abonné aux rechargements (appelé depuis Config::update, thread principal)
+using ConfigListener = std::function<void(const AppConfig& config, const ConfigChanges& changes)>;
+
+class Config {
+public:
+    /**
+     * Charge le fichier de configuration (valeurs par défaut s'il est absent)
+     * @param path Chemin de config.ini
+     * @return false si le fichier est illisible
+     */
+    static bool load(const std::string& path);
+    
+    /**
+     * Obtient la configuration courante (thread principal)
+     * @return Configuration, valide jusqu'au prochain Config::update
+     */
+    static const AppConfig& get();
+    
+    /**
+     * Obtient une copie partagée de la configuration courante (autres threads)
+     * @return Configuration, immuable
+     */
+    static std::shared_ptr<const AppConfig> snapshot();
+    
+    /**
+     * Abonne une fonction aux rechargements
+     * @param listener Fonction appelée avec la nouvelle configuration et les clés changées
+     * @return Identifiant de l'abonnement
+     */
+    static int subscribe(ConfigListener listener);
+    
+    /**
+     * Résilie un abonnement
+     * @param id Identifiant rendu par subscribe
+     */
+    static void unsubscribe(int id);
+    
+    /**
+     * Surveille le fichier (à appeler dans la boucle principale) et le relit
+     * lorsqu'il a changé et n'a plus bougé depuis la vérification précédente
+     */
+    static void update();
+    
+    /**
+     * Relit le fichier et prévient les abonnés des clés modifiées (une valeur
+     * invalide garde la valeur en cours)
+     * @return true si des clés ont changé
+     */
+    static bool reload();
+    
+    /**
+     * Définit l'intervalle de surveillance du fichier
+     * @param interval_ms Intervalle (0 = surveillance désactivée)
+     */
+    static void setWatchInterval(int interval_ms);
+    
+    /**
+     * Convertit le texte d'un fichier INI en configuration
+     * @param text Contenu du fichier
+     * @param warnings Clés inconnues, en double ou invalides (optionnel)
+     * @return Configuration, valeurs par défaut pour les clés absentes ou invalides
+     */
+    static AppConfig parse(const std::string& text, std::vector<std::string>* warnings = nullptr);
+    
+    /**
+     * Décrit chaque clé d'une configuration
+     * @param config Configuration
+     * @return Clés dans l'ordre du fichier
+     */
+    static std::vector<ConfigEntry> describe(const AppConfig& config);
+    
+    /**
+     * Compare deux configurations
+     * @return Clés dont la valeur diffère
+     */
+    static ConfigChanges diff(const AppConfig& before, const AppConfig& after);
+
+private:
+    using Sections = std::map<std::string, std::map<std::string, std::string>>;
+    
+    static std::string s_path;
+    static std::shared_ptr<const AppConfig> s_current;
+    static std::mutex s_mutex;                  // s_current (snapshot depuis d'autres threads)
+    static std::map<int, ConfigListener> s_listeners;
+    static int s_next_listener;
+    static int s_watch_interval_ms;
+    static int64_t s_last_check;
+    static int64_t s_seen_mtime;                // Dernier état observé du fichier
+    static int64_t s_seen_size;
+    static int64_t s_loaded_mtime;              // État du fichier chargé
+    static int64_t s_loaded_size;
+    
+    static Sections parseSections(const std::string& text, std::vector<std::string>* warnings);
+    static AppConfig build(const Sections& sections, std::vector<std::string>* warnings,
+                           std::set<std::string>* invalid = nullptr);
+    static bool readFile(const std::string& path, std::string& text);
+    static bool statFile(int64_t& mtime, int64_t& size);
+    static void setCurrent(const AppConfig& config);
+};
+
+#endif // CONFIG_H
@@ -0,0 +1,106 @@
+/**
+ * PS4 Store P2P - File d'Événements de l'Interface
+ *
+ * Les gestionnaires (torrents, installation, tâches de la réserve) déposent
+ * leurs événements depuis n'importe quel thread, sans verrou (pile de Treiber:
+ * un échange atomique par dépôt). Le thread principal vide la file une fois
+ * par image et appelle les abonnés: l'interface n'est jamais modifiée
+ * ailleurs que sur son thread.
+ *
+ * Les événements de progression d'un même travail sont fusionnés: seule la
+ * dernière valeur de l'image est livrée, à la place du dernier dépôt. Les
+ * autres événements (fin, erreur, appels) sont livrés dans l'ordre de dépôt
+ */
+
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <string>
+#include <vector>
+#include <atomic>
+#include <functional>
+#include <cstdint>
+
+enum class EventType {
+    DOWNLOAD_PROGRESS,          // Fusionné par téléchargement
+    DOWNLOAD_COMPLETE,
+    DOWNLOAD_ERROR,
+    INSTALL_PROGRESS,           // Fusionné par package
+    INSTALL_COMPLETE,
+    CALL,                       // Fonction à exécuter sur le thread principal
+    COUNT
+};
+
+struct UiEvent {
+    EventType type;
+    std::string job;                    // Téléchargement ou package concerné
+    float progress = 0.0f;
+    bool success = false;
+    std::string text;                   // Chemin de sauvegarde, message d'erreur...
+    std::function<void()> call;         // EventType::CALL
+};
+
+using EventHandler = std::function<void(const UiEvent&)>;
+
+class EventQueue {
+public:
+    /**
+     * Dépose un événement (tout thread, sans verrou)
+     * @param event Événement
+     */
+    static void post(UiEvent event);
+    
+    /**
+     * Dépose une fonction à exécuter sur le thread principal
+     * @param call Fonction
+     */
+    static void postCall(std::function<void()> call);
+    
+    /**
+     * Abonne une fonction à un type d'événement (tout thread; effectif pour
+     * les événements déposés après l'appel)
+     * @param type Type d'événement
+     * @param handler Fonction appelée par dispatch
+     * @return Identifiant de l'abonnement
+     */
+    static int subscribe(EventType type, EventHandler handler);
+    
+    /**
+     * Résilie un abonnement (tout thread; effectif pour les événements
+     * déposés après l'appel)
+     * @param id Identifiant rendu par subscribe
+     */
+    static void unsubscribe(int id);
+    
+    /**
+     * Livre les événements déposés avant l'appel (thread principal, une fois par image)
+     * @return Nombre d'événements livrés
+     */
+    static int dispatch();
+    
+    /**
+     * Vérifie si une progression est fusionnée avec la suivante du même travail
+     * @param type Type d'événement
+     * @return true pour les progressions
+     */
+    static bool isCoalesced(EventType type);
+
+private:
+    struct Node {
+        UiEvent event;
+        Node* next;
+    };
+    
+    struct Subscription {
+        int id;
+        EventHandler handler;
+    };
+    
+    static std::atomic<Node*> s_head;                   // Dernier déposé
+    static std::atomic<int> s_next_id;
+    static std::vector<Subscription> s_handlers[static_cast<int>(EventType::COUNT)];    // Thread principal
+    
+    static std::vector<UiEvent> drain();
+};
+
+#endif // EVENT_QUEUE_H
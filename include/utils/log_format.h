@@ -0,0 +1,92 @@
+/**
+ * PS4 Store P2P - Mise en Forme Différée des Logs
+ *
+ * Remplace les concaténations de std::string des messages de log par un
+ * gabarit "{}" rempli dans un tampon propre au thread: aucune chaîne
+ * temporaire par argument, et rien n'est évalué si le niveau est filtré
+ * (voir LOG_DEBUGF et les macros voisines dans utils.h)
+ *
+ *   LOG_DEBUGF("Progrès d'installation: {} ({})", operation, percentage);
+ *
+ * "{{" et "}}" écrivent une accolade. Les arguments en trop sont ignorés,
+ * les "{}" sans argument restent tels quels
+ */
+
+#ifndef LOG_FORMAT_H
+#define LOG_FORMAT_H
+
+#include <string>
+#include <type_traits>
+#include <cstdint>
+
+class LogFormat {
+public:
+    /**
+     * Ajoute un gabarit rempli à une chaîne
+     * @param out Chaîne complétée
+     * @param format Gabarit ("{}" par argument)
+     * @param args Arguments (chaînes, caractères, nombres, booléens, pointeurs)
+     */
+    template <typename... Args>
+    static void format(std::string& out, const char* format, const Args&... args) {
+        formatNext(out, format, args...);
+    }
+    
+    /**
+     * Obtient le tampon de mise en forme du thread appelant (capacité conservée)
+     * @return Tampon vidé
+     */
+    static std::string& threadBuffer();
+    
+    // Conversion d'un argument
+    static void append(std::string& out, const std::string& value) { out += value; }
+    static void append(std::string& out, const char* value) { out += value ? value : "(null)"; }
+    static void append(std::string& out, char value) { out += value; }
+    static void append(std::string& out, bool value) { out += value ? "true" : "false"; }
+    static void append(std::string& out, const void* value);
+    static void appendSigned(std::string& out, int64_t value);
+    static void appendUnsigned(std::string& out, uint64_t value);
+    static void appendFloating(std::string& out, double value);
+    
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value && std::is_signed<T>::value>::type
+    append(std::string& out, T value) { appendSigned(out, static_cast<int64_t>(value)); }
+    
+    template <typename T>
+    static typename std::enable_if<std::is_integral<T>::value && std::is_unsigned<T>::value>::type
+    append(std::string& out, T value) { appendUnsigned(out, static_cast<uint64_t>(value)); }
+    
+    template <typename T>
+    static typename std::enable_if<std::is_floating_point<T>::value>::type
+    append(std::string& out, T value) { appendFloating(out, static_cast<double>(value)); }
+    
+    template <typename T>
+    static typename std::enable_if<std::is_enum<T>::value>::type
+    append(std::string& out, T value) {
+        appendSigned(out, static_cast<int64_t>(static_cast<typename std::underlying_type<T>::type>(value)));
+    }
+
+private:
+    /**
+     * Copie le gabarit jusqu'au prochain "{}"
+     * @return Position après le "{}", nullptr à la fin du gabarit
+     */
+    static const char* appendLiteral(std::string& out, const char* format);
+    
+    static void formatNext(std::string& out, const char* format) {
+        while (format) {
+            format = appendLiteral(out, format);
+            if (format) out += "{}";
+        }
+    }
+    
+    template <typename First, typename... Rest>
+    static void formatNext(std::string& out, const char* format, const First& first, const Rest&... rest) {
+        format = appendLiteral(out, format);
+        if (!format) return;
+        append(out, first);
+        formatNext(out, format, rest...);
+    }
+};
+
+#endif // LOG_FORMAT_H
@@ -0,0 +1,225 @@
+/**
+ * PS4 Store P2P - Métriques
+ *
+ * Registre de compteurs, de jauges et d'histogrammes de latence, pour
+ * comparer objectivement firmwares, réglages et versions. L'enregistrement
+ * est sans verrou: chaque thread incrémente sa propre tranche (compteurs et
+ * histogrammes), les tranches sont additionnées à la lecture. Les
+ * histogrammes sont à échelle log-linéaire (type HDR, 32 sous-intervalles
+ * par puissance de deux, soit 3 % de précision relative).
+ *
+ * Un thread d'export ajoute périodiquement un relevé au format texte de
+ * Prometheus (une valeur par ligne, horodatée en ms) à un fichier tournant,
+ * lisible par un tail, node_exporter ou un simple script
+ *
+ * Les métriques sont créées une fois et jamais détruites: une référence
+ * obtenue du registre peut être gardée dans une variable statique
+ */
+
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <string>
+#include <vector>
+#include <map>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <memory>
+#include <cstdint>
+
+// Tranches par métrique: threads répartis à tour de rôle
+static const int METRIC_SHARDS = 8;
+
+// Histogramme: 64 valeurs exactes, puis 32 intervalles par puissance de deux jusqu'à 2^40
+static const int HISTOGRAM_SUB_BUCKETS = 32;
+static const int HISTOGRAM_MAX_EXPONENT = 40;
+static const int HISTOGRAM_BUCKETS = (HISTOGRAM_MAX_EXPONENT - 4) * HISTOGRAM_SUB_BUCKETS;
+
+class MetricCounter {
+public:
+    /**
+     * Ajoute une valeur au compteur
+     * @param delta Valeur ajoutée
+     */
+    void add(int64_t delta = 1);
+    
+    /**
+     * Obtient le total, toutes tranches confondues
+     * @return Total
+     */
+    int64_t value() const;
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<int64_t> value{0};
+    };
+    Shard m_shards[METRIC_SHARDS];
+};
+
+class MetricGauge {
+public:
+    void set(int64_t value) { m_value.store(value, std::memory_order_relaxed); }
+    int64_t value() const { return m_value.load(std::memory_order_relaxed); }
+
+private:
+    std::atomic<int64_t> m_value{0};
+};
+
+// Relevé d'un histogramme (tranches additionnées)
+struct HistogramSnapshot {
+    int64_t count = 0;              // Somme des intervalles
+    int64_t sum = 0;
+    int64_t min = 0;
+    int64_t max = 0;
+    std::vector<int64_t> buckets;
+    
+    /**
+     * Obtient la valeur sous laquelle se trouve une fraction des mesures
+     * @param quantile Fraction (0.5 = médiane)
+     * @return Borne haute de l'intervalle, 0 sans mesure
+     */
+    int64_t percentile(double quantile) const;
+};
+
+class MetricHistogram {
+public:
+    MetricHistogram();
+    
+    /**
+     * Enregistre une mesure
+     * @param value Valeur (négative ramenée à 0)
+     */
+    void record(int64_t value);
+    
+    /**
+     * Additionne les tranches
+     * @return Relevé courant
+     */
+    HistogramSnapshot snapshot() const;
+    
+    /**
+     * Calcule l'intervalle d'une valeur
+     * @return Indice, de 0 à HISTOGRAM_BUCKETS - 1
+     */
+    static int bucketIndex(int64_t value);
+    
+    /**
+     * Obtient la plus grande valeur d'un intervalle
+     * @param index Indice de l'intervalle
+     * @return Borne haute
+     */
+    static int64_t bucketUpperBound(int index);
+
+private:
+    struct alignas(64) Shard {
+        std::atomic<int64_t> buckets[HISTOGRAM_BUCKETS];     // Nombre de mesures: somme des intervalles
+        std::atomic<int64_t> sum;
+        std::atomic<int64_t> min;
+        std::atomic<int64_t> max;
+    };
+    std::unique_ptr<Shard[]> m_shards;
+};
+
+// Durée du bloc englobant, enregistrée en microsecondes à la sortie
+class MetricTimer {
+public:
+    explicit MetricTimer(MetricHistogram& histogram)
+        : m_histogram(histogram), m_start(std::chrono::steady_clock::now()) {}
+    
+    ~MetricTimer() {
+        m_histogram.record(std::chrono::duration_cast<std::chrono::microseconds>(
+            std::chrono::steady_clock::now() - m_start).count());
+    }
+    
+    MetricTimer(const MetricTimer&) = delete;
+    MetricTimer& operator=(const MetricTimer&) = delete;
+
+private:
+    MetricHistogram& m_histogram;
+    std::chrono::steady_clock::time_point m_start;
+};
+
+class Metrics {
+public:
+    /**
+     * Obtient un compteur, créé au premier appel
+     * @param name Nom (lettres, chiffres et _, unité en suffixe: _bytes, _us...)
+     * @param help Description exportée
+     * @return Compteur, valide jusqu'à la fin du programme
+     */
+    static MetricCounter& counter(const std::string& name, const std::string& help = "");
+    
+    /**
+     * Obtient une jauge, créée au premier appel
+     * @return Jauge, valide jusqu'à la fin du programme
+     */
+    static MetricGauge& gauge(const std::string& name, const std::string& help = "");
+    
+    /**
+     * Enregistre une jauge lue au moment du relevé (profondeur d'une file...)
+     * @param name Nom
+     * @param sample Fonction appelée par le thread d'export (sans appel à Metrics)
+     * @param help Description exportée
+     */
+    static void sampledGauge(const std::string& name, std::function<int64_t()> sample, const std::string& help = "");
+    
+    /**
+     * Obtient un histogramme, créé au premier appel
+     * @return Histogramme, valide jusqu'à la fin du programme
+     */
+    static MetricHistogram& histogram(const std::string& name, const std::string& help = "");
+    
+    /**
+     * Met en forme un relevé de toutes les métriques (format texte Prometheus)
+     * @param timestamp Horodatage des lignes (ms depuis l'epoch)
+     * @return Lignes "nom{étiquettes} valeur horodatage"
+     */
+    static std::string format(int64_t timestamp);
+    
+    /**
+     * Démarre l'export périodique
+     * @param path Fichier de sortie (relevés ajoutés à la suite)
+     * @param interval_seconds Intervalle entre deux relevés
+     * @param max_file_size Taille à partir de laquelle le fichier est renommé en .1 (0 = illimitée)
+     */
+    static void startExporter(const std::string& path, int interval_seconds, int64_t max_file_size);
+    
+    /**
+     * Écrit un dernier relevé et arrête l'export
+     */
+    static void stopExporter();
+    
+    /**
+     * Ajoute un relevé au fichier d'export
+     * @return true en cas de succès
+     */
+    static bool exportNow();
+
+private:
+    struct Entry {
+        std::string help;
+        std::unique_ptr<MetricCounter> counter;
+        std::unique_ptr<MetricGauge> gauge;
+        std::function<int64_t()> sample;
+        std::unique_ptr<MetricHistogram> histogram;
+    };
+    
+    static std::map<std::string, Entry> s_entries;     // Trié par nom: relevés stables
+    static std::mutex s_mutex;
+    static std::string s_path;
+    static int s_interval_seconds;
+    static int64_t s_max_file_size;
+    static std::thread s_thread;
+    static std::mutex s_export_mutex;
+    static std::condition_variable s_wakeup;
+    static bool s_stop;
+    
+    static Entry& entry(const std::string& name, const std::string& help);
+    static void run();
+};
+
+#endif // METRICS_H
@@ -0,0 +1,91 @@
+/**
+ * PS4 Store P2P - Publication de Progression
+ *
+ * Les boucles de copie comptent leurs octets par une addition atomique;
+ * la progression n'est publiée (callback, journal, événement d'interface)
+ * qu'une fois franchis à la fois un écart minimal d'octets et un intervalle
+ * de temps. L'horloge n'est lue qu'au franchissement de l'écart. Chaque
+ * publication porte un débit lissé (moyenne exponentielle sur ~2 s) et le
+ * temps restant estimé
+ */
+
+#ifndef PROGRESS_PUBLISHER_H
+#define PROGRESS_PUBLISHER_H
+
+#include <atomic>
+#include <chrono>
+#include <functional>
+#include <mutex>
+#include <cstdint>
+
+struct ProgressSample {
+    int64_t done;
+    int64_t total;
+    float fraction;                 // 0.0 à 1.0 (0 si total inconnu)
+    int64_t bytes_per_second;       // Débit lissé
+    int64_t eta_seconds;            // -1 si inconnu
+};
+
+using ProgressSink = std::function<void(const ProgressSample&)>;
+
+class ProgressPublisher {
+public:
+    /**
+     * @param total Total attendu (0 = inconnu)
+     * @param sink Fonction appelée à chaque publication, par le thread qui la déclenche
+     * @param interval_ms Intervalle minimal entre deux publications
+     * @param min_delta Octets minimaux entre deux publications (0 = 1 Mo ou 0,1 % du total)
+     */
+    ProgressPublisher(int64_t total, ProgressSink sink, int interval_ms = 50, int64_t min_delta = 0);
+    
+    ProgressPublisher(const ProgressPublisher&) = delete;
+    ProgressPublisher& operator=(const ProgressPublisher&) = delete;
+    
+    /**
+     * Compte des octets (tout thread); publie si l'écart et l'intervalle sont franchis
+     * @param bytes Octets ajoutés
+     */
+    void add(int64_t bytes) {
+        int64_t done = m_done.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+        if (done >= m_next_check.load(std::memory_order_relaxed)) {
+            publishIfDue(done);
+        }
+    }
+    
+    /**
+     * Publie l'état final, quel que soit l'intervalle écoulé
+     */
+    void finish();
+    
+    /**
+     * Obtient les octets comptés
+     * @return Total ajouté
+     */
+    int64_t done() const { return m_done.load(std::memory_order_relaxed); }
+    
+    /**
+     * Obtient la dernière publication
+     * @return Relevé publié
+     */
+    ProgressSample lastSample();
+
+private:
+    std::atomic<int64_t> m_done{0};
+    std::atomic<int64_t> m_next_check{0};
+    const int64_t m_total;
+    const int64_t m_min_delta;
+    const std::chrono::steady_clock::duration m_interval;
+    ProgressSink m_sink;
+    
+    // Publication, sous m_mutex
+    std::mutex m_mutex;
+    std::chrono::steady_clock::time_point m_last_time;
+    int64_t m_last_done = 0;
+    double m_rate = 0.0;
+    ProgressSample m_sample;
+    
+    void publishIfDue(int64_t done);
+    void publish(int64_t done, std::chrono::steady_clock::time_point now);
+};
+
+#endif // PROGRESS_PUBLISHER_H
@@ -0,0 +1,137 @@
+/**
+ * PS4 Store P2P - Démarrage par Étapes
+ *
+ * Le démarrage est découpé en étapes nommées qui déclarent celles dont
+ * elles dépendent. Seules la fenêtre et la configuration précèdent la
+ * première image; les étapes prêtes s'exécutent ensuite en parallèle dans
+ * la réserve de threads (session, état et reprises, listes de blocage...)
+ * pendant que la boucle principale affiche la progression. Les étapes liées
+ * au thread principal (interface SDL) y sont exécutées une par image.
+ *
+ * Une étape en échec fait sauter celles qui en dépendent; l'échec d'une
+ * étape requise est signalé par hasFailed. Une fois tout terminé, la
+ * chronologie (début et durée de chaque étape, première image) est écrite
+ * dans le journal, et chaque étape figure dans la trace
+ */
+
+#ifndef STARTUP_H
+#define STARTUP_H
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include <cstdint>
+
+enum class StageThread {
+    MAIN,                       // Thread principal (SDL, interface)
+    POOL                        // Réserve de threads
+};
+
+enum class StageState {
+    PENDING,
+    RUNNING,
+    DONE,
+    FAILED,
+    SKIPPED                     // Une dépendance a échoué
+};
+
+class Startup {
+public:
+    /**
+     * Marque l'origine de la chronologie (au plus tôt dans main)
+     */
+    static void begin();
+    
+    /**
+     * Déclare une étape (avant le premier appel à pump)
+     * @param name Nom (littéral: repris par la trace)
+     * @param after Étapes à terminer avant celle-ci
+     * @param run Fonction de l'étape, false en cas d'échec
+     * @param thread Thread d'exécution
+     * @param required Un échec arrête l'application
+     */
+    static void add(const char* name, const std::vector<std::string>& after, std::function<bool()> run,
+                    StageThread thread = StageThread::POOL, bool required = true);
+    
+    /**
+     * Lance les étapes prêtes et exécute au plus une étape du thread principal
+     * (thread principal, une fois par image)
+     * @return true quand toutes les étapes sont terminées
+     */
+    static bool pump();
+    
+    /**
+     * Enregistre l'affichage de la première image
+     */
+    static void markFirstFrame();
+    
+    /**
+     * Vérifie si une étape s'est terminée avec succès
+     * @param name Nom de l'étape
+     * @return true si ses effets sont visibles par le thread appelant
+     */
+    static bool isReady(const std::string& name);
+    
+    /**
+     * Vérifie si toutes les étapes sont terminées (succès, échec ou sautées)
+     * @return true à la fin du démarrage
+     */
+    static bool isComplete();
+    
+    /**
+     * Vérifie si une étape requise a échoué ou a été sautée
+     * @return true si l'application doit s'arrêter
+     */
+    static bool hasFailed();
+    
+    /**
+     * Obtient l'avancement du démarrage
+     * @return Fraction des étapes terminées (0.0 à 1.0)
+     */
+    static float getProgress();
+    
+    /**
+     * Abandonne les étapes non commencées et attend celles en cours (avant le nettoyage)
+     */
+    static void wait();
+    
+    /**
+     * Met en forme la chronologie du démarrage
+     * @return Une ligne par étape, dans l'ordre de début
+     */
+    static std::string report();
+
+private:
+    struct Stage {
+        const char* name;
+        std::vector<std::string> after;
+        std::function<bool()> run;
+        StageThread thread;
+        bool required;
+        StageState state;
+        int64_t start_us;
+        int64_t end_us;
+    };
+    
+    static std::vector<Stage> s_stages;
+    static std::mutex s_mutex;
+    static std::condition_variable s_finished;
+    static std::chrono::steady_clock::time_point s_begin;
+    static int64_t s_first_frame_us;
+    static int64_t s_complete_us;
+    static int s_running;
+    static bool s_abandoned;
+    static bool s_failed;
+    
+    static int64_t elapsedUs();
+    static std::vector<size_t> scheduleReady();
+    static void launch(const std::vector<size_t>& stages);
+    static void runStage(size_t index);
+    static void finishStage(size_t index, bool ok);
+    static void logReport();
+};
+
+#endif // STARTUP_H
@@ -0,0 +1,294 @@
+/**
+ * PS4 Store P2P - Exécuteur de Tâches
+ *
+ * Réserve de threads partagée par tout le programme (installation, analyse
+ * des packages, préparation des partages), dimensionnée sur les cœurs
+ * réellement disponibles: la PS4 n'en laisse que quelques-uns, lents, aux
+ * applications. Chaque thread a sa propre file par priorité; un thread sans
+ * travail prend les tâches des autres (vol de travail), les tâches
+ * interactives passant toujours avant les tâches de fond.
+ *
+ * submit rend un TaskFuture: attente, résultat ou exception, annulation
+ * (la tâche qui n'a pas démarré est abandonnée, celle qui tourne consulte son
+ * CancellationToken) et suite exécutée à la fin de la tâche (then).
+ * Attendre un TaskFuture depuis un thread de la réserve exécute les tâches
+ * en attente plutôt que de bloquer le thread
+ */
+
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include <chrono>
+#include <cstdint>
+
+enum class TaskPriority {
+    INTERACTIVE,                // Attendue par l'interface (analyse d'un package sélectionné...)
+    BULK                        // Travail de fond (installation, partage, hachage)
+};
+
+// Levée par TaskFuture::get pour une tâche annulée avant son exécution
+class TaskCancelled : public std::runtime_error {
+public:
+    TaskCancelled() : std::runtime_error("Tâche annulée") {}
+};
+
+// Demande d'annulation partagée entre le demandeur et la tâche
+class CancellationToken {
+public:
+    CancellationToken() : m_flag(std::make_shared<std::atomic<bool>>(false)) {}
+    
+    void cancel() const { m_flag->store(true, std::memory_order_relaxed); }
+    bool isCancelled() const { return m_flag->load(std::memory_order_relaxed); }
+
+private:
+    std::shared_ptr<std::atomic<bool>> m_flag;
+};
+
+struct ThreadPoolStats {
+    int threads;
+    int busy;                   // Threads exécutant une tâche
+    int64_t queued;             // Tâches en attente, toutes priorités
+    int64_t completed;
+    int64_t stolen;             // Tâches prises dans la file d'un autre thread
+};
+
+class ThreadPool {
+public:
+    /**
+     * Démarre les threads (sinon démarrés à la première tâche)
+     * @param threads Nombre de threads (0 = cœurs disponibles moins le thread principal)
+     */
+    static void start(int threads = 0);
+    
+    /**
+     * Exécute les tâches en attente puis arrête les threads; les tâches
+     * soumises ensuite s'exécutent sur le thread appelant
+     */
+    static void stop();
+    
+    /**
+     * Soumet une tâche
+     * @param fn Fonction sans paramètre
+     * @param priority Priorité
+     * @param token Annulation (une nouvelle par défaut)
+     * @return Résultat à venir de fn
+     */
+    template <typename F>
+    static auto submit(F fn, TaskPriority priority = TaskPriority::BULK, CancellationToken token = CancellationToken());
+    
+    /**
+     * Soumet une fonction sans résultat à suivre (exceptions journalisées)
+     * @param task Fonction
+     * @param priority Priorité
+     */
+    static void post(std::function<void()> task, TaskPriority priority = TaskPriority::BULK);
+    
+    /**
+     * Exécute une tâche en attente sur le thread appelant (thread de la réserve)
+     * @return false si aucune tâche n'attendait
+     */
+    static bool runPendingTask();
+    
+    /**
+     * Vérifie si le thread appelant appartient à la réserve
+     * @return true pour un thread de la réserve
+     */
+    static bool isWorkerThread();
+    
+    /**
+     * Obtient l'activité de la réserve
+     * @return Statistiques
+     */
+    static ThreadPoolStats getStats();
+};
+
+namespace TaskDetail {
+
+// Résultat rangé par l'état partagé (void: rien à ranger)
+template <typename T> struct Storage { using type = T; };
+template <> struct Storage<void> { using type = char; };
+
+template <typename T>
+struct State {
+    std::mutex mutex;
+    std::condition_variable ready_cv;
+    bool ready = false;
+    bool cancelled = false;
+    std::unique_ptr<typename Storage<T>::type> value;
+    std::exception_ptr error;
+    std::vector<std::function<void()>> continuations;
+    CancellationToken token;
+};
+
+template <typename T> struct Invoke {
+    template <typename F> static std::unique_ptr<T> run(F& fn) { return std::unique_ptr<T>(new T(fn())); }
+    static T get(State<T>& state) { return *state.value; }
+};
+
+template <> struct Invoke<void> {
+    template <typename F> static std::unique_ptr<char> run(F& fn) {
+        fn();
+        return std::unique_ptr<char>(new char(0));
+    }
+    static void get(State<void>&) {}
+};
+
+template <typename T>
+void complete(const std::shared_ptr<State<T>>& state, std::unique_ptr<typename Storage<T>::type> value,
+              std::exception_ptr error, bool cancelled) {
+    std::vector<std::function<void()>> continuations;
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        state->value = std::move(value);
+        state->error = error;
+        state->cancelled = cancelled;
+        state->ready = true;
+        continuations.swap(state->continuations);
+    }
+    state->ready_cv.notify_all();
+    
+    // Suites lancées hors verrou: elles peuvent relire l'état
+    for (auto& continuation : continuations) {
+        continuation();
+    }
+}
+
+template <typename T, typename F>
+void run(const std::shared_ptr<State<T>>& state, F& fn) {
+    if (state->token.isCancelled()) {
+        complete<T>(state, nullptr, nullptr, true);
+        return;
+    }
+    
+    try {
+        auto value = Invoke<T>::run(fn);
+        complete<T>(state, std::move(value), nullptr, false);
+    } catch (...) {
+        complete<T>(state, nullptr, std::current_exception(), false);
+    }
+}
+
+} // namespace TaskDetail
+
+template <typename T>
+class TaskFuture {
+public:
+    TaskFuture() = default;
+    explicit TaskFuture(std::shared_ptr<TaskDetail::State<T>> state) : m_state(std::move(state)) {}
+    
+    bool valid() const { return m_state != nullptr; }
+    
+    bool isReady() const {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->ready;
+    }
+    
+    /**
+     * Vérifie si la tâche a été abandonnée avant son exécution
+     * @return true si get lèverait TaskCancelled
+     */
+    bool isCancelled() const {
+        std::lock_guard<std::mutex> lock(m_state->mutex);
+        return m_state->cancelled;
+    }
+    
+    /**
+     * Demande l'annulation (sans effet sur une tâche terminée)
+     */
+    void cancel() const { m_state->token.cancel(); }
+    
+    const CancellationToken& token() const { return m_state->token; }
+    
+    /**
+     * Attend la fin de la tâche
+     */
+    void wait() const {
+        // Thread de la réserve: exécuter d'autres tâches plutôt que d'en bloquer une
+        while (ThreadPool::isWorkerThread() && !isReady()) {
+            if (!ThreadPool::runPendingTask()) {
+                waitFor(1);
+            }
+        }
+        
+        std::unique_lock<std::mutex> lock(m_state->mutex);
+        m_state->ready_cv.wait(lock, [this] { return m_state->ready; });
+    }
+    
+    /**
+     * Attend la fin de la tâche, au plus timeout_ms
+     * @return true si la tâche est terminée
+     */
+    bool waitFor(int timeout_ms) const {
+        std::unique_lock<std::mutex> lock(m_state->mutex);
+        return m_state->ready_cv.wait_for(lock, std::chrono::milliseconds(timeout_ms), [this] { return m_state->ready; });
+    }
+    
+    /**
+     * Attend et obtient le résultat
+     * @return Valeur rendue par la tâche
+     * @throws Exception levée par la tâche, TaskCancelled si elle a été abandonnée
+     */
+    T get() const {
+        wait();
+        if (m_state->cancelled) throw TaskCancelled();
+        if (m_state->error) std::rethrow_exception(m_state->error);
+        return TaskDetail::Invoke<T>::get(*m_state);
+    }
+    
+    /**
+     * Exécute une suite à la fin de la tâche (résultat, exception ou annulation)
+     * @param fn Fonction recevant ce TaskFuture terminé
+     * @param priority Priorité de la suite
+     * @return Résultat à venir de fn
+     */
+    template <typename F>
+    auto then(F fn, TaskPriority priority = TaskPriority::BULK) const;
+
+private:
+    std::shared_ptr<TaskDetail::State<T>> m_state;
+};
+
+template <typename F>
+auto ThreadPool::submit(F fn, TaskPriority priority, CancellationToken token) {
+    using R = decltype(fn());
+    auto state = std::make_shared<TaskDetail::State<R>>();
+    state->token = token;
+    post([state, fn]() mutable { TaskDetail::run<R>(state, fn); }, priority);
+    return TaskFuture<R>(state);
+}
+
+template <typename T>
+template <typename F>
+auto TaskFuture<T>::then(F fn, TaskPriority priority) const {
+    using R = decltype(fn(std::declval<TaskFuture<T>>()));
+    auto next = std::make_shared<TaskDetail::State<R>>();
+    TaskFuture<T> self = *this;
+    
+    auto schedule = [self, next, fn, priority]() {
+        ThreadPool::post([self, next, fn]() mutable {
+            auto call = [&self, &fn]() { return fn(self); };
+            TaskDetail::run<R>(next, call);
+        }, priority);
+    };
+    
+    {
+        std::unique_lock<std::mutex> lock(m_state->mutex);
+        if (!m_state->ready) {
+            m_state->continuations.push_back(schedule);
+            return TaskFuture<R>(next);
+        }
+    }
+    schedule();
+    return TaskFuture<R>(next);
+}
+
+#endif // THREAD_POOL_H
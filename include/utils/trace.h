@@ -0,0 +1,153 @@
+/**
+ * PS4 Store P2P - Traçage des Événements
+ *
+ * Mesure où passe le temps entre une image, le traitement des alertes et une
+ * étape d'installation. Chaque thread remplit ses propres blocs d'événements
+ * sans verrou (le verrou n'est pris qu'une fois par bloc de 4096 événements),
+ * les blocs pleins sont conservés jusqu'à la limite fixée, les plus anciens
+ * étant recyclés. Le fichier produit se lit dans chrome://tracing ou Perfetto
+ * (format "Trace Event" JSON).
+ *
+ * Les macros TRACE_* disparaissent du binaire sans ENABLE_TRACING (option
+ * CMake du même nom). Compilées, elles ne coûtent qu'un test tant que le
+ * traçage n'est pas démarré; démarré, une durée coûte deux lectures du
+ * compteur du processeur en plus de l'écriture de l'événement (trace_bench
+ * mesure les deux séparément). Les noms doivent être des littéraux (seul le
+ * pointeur est conservé)
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#ifdef ENABLE_TRACING
+#define TRACE_CONCAT_INNER(a, b) a##b
+#define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#define TRACE_SCOPE(category, name) TraceSpan TRACE_CONCAT(trace_span_, __LINE__)(category, name)
+#define TRACE_COUNTER(name, value) Trace::counter(name, static_cast<int64_t>(value))
+#define TRACE_INSTANT(category, name) Trace::instant(category, name)
+#define TRACE_THREAD_NAME(name) Trace::setThreadName(name)
+#else
+#define TRACE_SCOPE(category, name) do {} while (0)
+#define TRACE_COUNTER(name, value) do {} while (0)
+#define TRACE_INSTANT(category, name) do {} while (0)
+#define TRACE_THREAD_NAME(name) do {} while (0)
+#endif
+
+class Trace {
+public:
+    /**
+     * Démarre l'enregistrement (une seule fois par exécution)
+     * @param max_events Événements conservés au maximum, tous threads confondus
+     */
+    static void start(size_t max_events = 262144);
+    
+    /**
+     * Arrête l'enregistrement (les événements restent disponibles pour dump)
+     */
+    static void stop();
+    
+    /**
+     * Vérifie si les événements sont enregistrés
+     * @return true si le traçage est démarré
+     */
+    static bool isEnabled() {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+    
+    /**
+     * Obtient l'horloge du traçage (compteur du processeur si disponible)
+     * @return Tics, convertis en microsecondes à l'écriture
+     */
+    static uint64_t ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+    
+    /**
+     * Nomme le thread appelant dans la trace
+     * @param name Nom (littéral)
+     */
+    static void setThreadName(const char* name);
+    
+    /**
+     * Enregistre une durée
+     * @param category Catégorie (littéral)
+     * @param name Nom (littéral)
+     * @param start Début (Trace::ticks)
+     * @param end Fin (Trace::ticks)
+     */
+    static void complete(const char* category, const char* name, uint64_t start, uint64_t end);
+    
+    /**
+     * Enregistre la valeur d'un compteur
+     * @param name Nom (littéral)
+     * @param value Valeur
+     */
+    static void counter(const char* name, int64_t value);
+    
+    /**
+     * Enregistre un événement ponctuel
+     * @param category Catégorie (littéral)
+     * @param name Nom (littéral)
+     */
+    static void instant(const char* category, const char* name);
+    
+    /**
+     * Écrit les événements conservés au format Chrome "Trace Event" JSON
+     * @param path Fichier de sortie
+     * @return true en cas de succès
+     */
+    static bool dump(const std::string& path);
+    
+    /**
+     * Obtient le nombre d'événements conservés
+     * @return Événements
+     */
+    static size_t getEventCount();
+    
+    /**
+     * Obtient le nombre d'événements écartés (blocs recyclés)
+     * @return Événements perdus
+     */
+    static int64_t getDropped();
+
+private:
+    static std::atomic<bool> s_enabled;
+};
+
+// Durée du bloc englobant, enregistrée à la sortie
+class TraceSpan {
+public:
+    TraceSpan(const char* category, const char* name)
+        : m_category(category), m_name(name), m_active(Trace::isEnabled()), m_start(m_active ? Trace::ticks() : 0) {}
+    
+    ~TraceSpan() {
+        if (m_active) {
+            Trace::complete(m_category, m_name, m_start, Trace::ticks());
+        }
+    }
+    
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+private:
+    const char* m_category;
+    const char* m_name;
+    bool m_active;
+    uint64_t m_start;
+};
+
+#endif // TRACE_H
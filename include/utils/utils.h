@@ -12,11 +12,50 @@
 #include <map>
 #include <chrono>
 
+#include "utils/log_format.h"
+
+// Niveau minimum compilé (0 = DEBUG, 1 = INFO, 2 = WARNING, 3 = ERROR): les
+// messages en dessous disparaissent du binaire. INFO par défaut en Release
+#ifndef LOG_COMPILE_LEVEL
+#ifdef RELEASE_BUILD
+#define LOG_COMPILE_LEVEL 1
+#else
+#define LOG_COMPILE_LEVEL 0
+#endif
+#endif
+
+// Niveau vérifié avant d'évaluer le message: un log filtré coûte une comparaison
+#define LOG_ENABLED(level) \
+    (static_cast<int>(level) >= LOG_COMPILE_LEVEL && Utils::isLogEnabled(level))
+
+#define LOG_AT(level, msg) \
+    do { if (LOG_ENABLED(level)) Utils::log(level, msg, __FILE__, __LINE__); } while (0)
+
+#define LOG_FORMAT_AT(level, ...) \
+    do { if (LOG_ENABLED(level)) Utils::logFormat(level, __FILE__, __LINE__, __VA_ARGS__); } while (0)
+
 // Macros pour le logging
-#define LOG_INFO(msg) Utils::log(Utils::LogLevel::INFO, msg, __FILE__, __LINE__)
-#define LOG_WARNING(msg) Utils::log(Utils::LogLevel::WARNING, msg, __FILE__, __LINE__)
-#define LOG_ERROR(msg) Utils::log(Utils::LogLevel::ERROR, msg, __FILE__, __LINE__)
-#define LOG_DEBUG(msg) Utils::log(Utils::LogLevel::DEBUG, msg, __FILE__, __LINE__)
+#define LOG_INFO(msg) LOG_AT(Utils::LogLevel::INFO, msg)
+#define LOG_WARNING(msg) LOG_AT(Utils::LogLevel::WARNING, msg)
+#define LOG_ERROR(msg) LOG_AT(Utils::LogLevel::ERROR, msg)
+#define LOG_DEBUG(msg) LOG_AT(Utils::LogLevel::DEBUG, msg)
+
+// Variantes à gabarit "{}" (voir log_format.h)
+#define LOG_INFOF(...) LOG_FORMAT_AT(Utils::LogLevel::INFO, __VA_ARGS__)
+#define LOG_WARNINGF(...) LOG_FORMAT_AT(Utils::LogLevel::WARNING, __VA_ARGS__)
+#define LOG_ERRORF(...) LOG_FORMAT_AT(Utils::LogLevel::ERROR, __VA_ARGS__)
+#define LOG_DEBUGF(...) LOG_FORMAT_AT(Utils::LogLevel::DEBUG, __VA_ARGS__)
+
+// Interface réseau locale et plage d'adresses de son sous-réseau
+struct NetworkInterface {
+    std::string name;
+    std::string address;
+    std::string netmask;
+    std::string first_address;  // Première adresse du sous-réseau
+    std::string last_address;   // Dernière adresse du sous-réseau
+    bool is_ipv6;
+    bool is_loopback;
+};
 
 class Utils {
 public:
@@ -234,6 +273,30 @@ public:
     static void log(LogLevel level, const std::string& message, 
                    const char* file = nullptr, int line = 0);
     
+    /**
+     * Vérifie si un niveau de log est écrit (test fait par les macros LOG_*)
+     * @param level Niveau
+     * @return true si le niveau atteint le minimum défini
+     */
+    static bool isLogEnabled(LogLevel level) {
+        return level >= s_log_level;
+    }
+    
+    /**
+     * Écrit un message mis en forme dans le tampon du thread (voir LogFormat)
+     * @param level Niveau de log
+     * @param file Fichier source
+     * @param line Ligne source
+     * @param format Gabarit ("{}" par argument)
+     * @param args Arguments
+     */
+    template <typename... Args>
+    static void logFormat(LogLevel level, const char* file, int line, const char* format, const Args&... args) {
+        std::string& buffer = LogFormat::threadBuffer();
+        LogFormat::format(buffer, format, args...);
+        log(level, buffer, file, line);
+    }
+    
     /**
      * Définit le niveau de log minimum
      * @param level Niveau minimum
@@ -247,14 +310,20 @@ public:
      */
     static void setFileLogging(bool enabled, const std::string& log_file = "ps4_store.log");
     
-    // === CONFIGURATION ===
+    /**
+     * Définit la taille à partir de laquelle le fichier de log est renouvelé
+     * @param bytes Taille maximale (0 = illimitée)
+     */
+    static void setMaxLogSize(int64_t bytes);
     
     /**
-     * Charge un fichier de configuration JSON
-     * @param config_file Chemin du fichier
-     * @return Map des paramètres
+     * Obtient le libellé d'un niveau de log
+     * @param level Niveau
+     * @return Libellé (DEBUG, INFO, WARN, ERROR)
      */
-    static std::map<std::string, std::string> loadConfig(const std::string& config_file);
+    static std::string getLogLevelString(LogLevel level);
+    
+    // === CONFIGURATION ===
     
     /**
      * Sauvegarde un fichier de configuration JSON
@@ -287,13 +356,16 @@ public:
      */
     static std::string getLocalIP();
     
+    /**
+     * Énumère les interfaces réseau locales (IPv4 et IPv6)
+     * @return Interfaces avec adresse, masque et plage du sous-réseau
+     */
+    static std::vector<NetworkInterface> getNetworkInterfaces();
+    
 private:
     static LogLevel s_log_level;
     static bool s_file_logging_enabled;
     static std::string s_log_file;
-    
-    static std::string getLogLevelString(LogLevel level);
-    static void writeToLogFile(const std::string& message);
 };
 
 #endif // UTILS_H
\ No newline at end of file
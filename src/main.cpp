@@ -31,14 +31,30 @@
 // Headers du projet
 #include "ui/main_window.h"
 #include "p2p/torrent_manager.h"
+#include "p2p/download_scheduler.h"
+#include "p2p/metadata_cache.h"
+#include "p2p/scrape_service.h"
+#include "p2p/ip_blocklist.h"
+#include "p2p/session_tuner.h"
+#include "p2p/fast_start.h"
+#include "p2p/piece_cache.h"
+#include "p2p/write_coalescer.h"
 #include "pkg/pkg_manager.h"
 #include "utils/utils.h"
+#include "utils/trace.h"
+#include "utils/config.h"
+#include "utils/metrics.h"
+#include "utils/thread_pool.h"
+#include "utils/event_queue.h"
+#include "utils/startup.h"
+#include "utils/async_logger.h"
 
 // Constantes
 #define SCREEN_WIDTH 1920
 #define SCREEN_HEIGHT 1080
 #define APP_NAME "PS4 Store P2P"
 #define APP_VERSION "1.0.0"
+#define CONFIG_FILE "/data/ps4_store/config.ini"
 
 // Variables globales
 #ifndef NO_SDL2_UI
@@ -46,6 +62,8 @@ SDL_Window* g_window = nullptr;
 SDL_Renderer* g_renderer = nullptr;
 #endif
 bool g_running = true;
+std::string g_trace_file;       // Trace écrite sur F12 et à la fermeture (vide = traçage inactif)
+bool g_piece_cache_started = false;   // Cache des pièces placé devant le stockage au démarrage
 
 /**
  * Initialise les modules système PS4
@@ -141,7 +159,7 @@ int initializeSDL() {
 /**
  * Gère les événements SDL
  */
-void handleEvents() {
+void handleEvents(bool ui_ready) {
 #ifndef NO_SDL2_UI
     SDL_Event event;
     
@@ -156,6 +174,12 @@ void handleEvents() {
                     case SDLK_ESCAPE:
                         g_running = false;
                         break;
+                        
+                    case SDLK_F12:
+                        if (!g_trace_file.empty()) {
+                            Trace::dump(g_trace_file);
+                        }
+                        break;
                 }
                 break;
                 
@@ -168,8 +192,10 @@ void handleEvents() {
                 break;
         }
         
-        // Transmettre l'événement à l'interface
-        MainWindow::handleEvent(event);
+        // Transmettre l'événement à l'interface (une fois initialisée)
+        if (ui_ready) {
+            MainWindow::handleEvent(event);
+        }
     }
 #else
     // Mode console - pas d'événements SDL à gérer
@@ -195,21 +221,268 @@ void render() {
 #endif
 }
 
+/**
+ * Applique la section [Logging]: niveau, fichier et taille maximale du journal
+ */
+void configureLogging(const LoggingSection& logging) {
+    Utils::setLogLevel(logging.log_level);
+    if (!LOG_ENABLED(Utils::LogLevel::DEBUG) && logging.log_level == Utils::LogLevel::DEBUG) {
+        LOG_WARNING("Messages DEBUG retirés de cette version (LOG_COMPILE_LEVEL=" +
+                    std::to_string(LOG_COMPILE_LEVEL) + ")");
+    }
+    
+    Utils::setMaxLogSize(static_cast<int64_t>(logging.max_log_size) * 1024 * 1024);
+    Utils::setFileLogging(logging.file_logging, logging.log_file);
+}
+
+/**
+ * Démarre le traçage des événements si demandé ([Advanced] trace_enabled)
+ */
+void configureTracing(const AdvancedSection& advanced) {
+    if (!advanced.trace_enabled) return;
+    
+#ifdef ENABLE_TRACING
+    g_trace_file = !advanced.trace_file.empty() ? advanced.trace_file : "/data/ps4_store/trace.json";
+    Trace::start(static_cast<size_t>(advanced.trace_buffer_events));
+#else
+    LOG_WARNING("Traçage demandé mais absent de cette version (option ENABLE_TRACING)");
+#endif
+}
+
+/**
+ * Démarre l'export périodique des métriques ([Advanced] metrics_enabled)
+ */
+void configureMetrics(const AppConfig& config) {
+    Metrics::sampledGauge("log_queue_depth", AsyncLogger::getQueueDepth, "Messages du journal en attente d'écriture");
+    if (!config.advanced.metrics_enabled) return;
+    
+    Utils::createDirectory(config.paths.cache_path);
+    Metrics::startExporter(config.paths.cache_path + "/metrics.prom", config.advanced.metrics_interval,
+                           static_cast<int64_t>(config.advanced.metrics_file_size) * 1024 * 1024);
+}
+
+/**
+ * Applique les options réseau de la session (écoute, services, chemins)
+ */
+void configureSessionOptions(const AppConfig& config) {
+    SessionOptions options;
+    options.listen_port = config.network.listen_port;
+    options.enable_ipv6 = config.network.enable_ipv6;
+    options.listen_devices = config.network.listen_devices;
+    options.enable_dht = config.network.enable_dht;
+    options.enable_lsd = config.network.enable_lsd;
+    options.enable_port_mapping = config.network.enable_upnp;
+    options.download_path = config.paths.download_path;
+    options.state_file = config.paths.state_file;
+    options.state_save_interval = config.performance.auto_save_interval;
+    
+    TorrentManager::setSessionOptions(options);
+}
+
+/**
+ * Applique la configuration du démarrage rapide des téléchargements
+ */
+void configureFastStart(const AppConfig& config) {
+    FastStartConfig fast_config;
+    fast_config.enabled = config.trackers.fast_start;
+    fast_config.default_trackers = config.trackers.default_trackers;
+    fast_config.peer_cache_file = config.paths.cache_path + "/peers.cache";
+    
+    FastStart::configure(fast_config);
+}
+
+/**
+ * Applique la taille du cache mémoire des pièces partagées
+ */
+void configurePieceCache(const PerformanceSection& performance) {
+    PieceCacheConfig cache_config;
+    cache_config.enabled = performance.disk_cache_size > 0;
+    cache_config.capacity = static_cast<int64_t>(performance.disk_cache_size) * 1024 * 1024;
+    cache_config.read_ahead_blocks = performance.read_ahead_blocks;
+    
+    PieceCache::configure(cache_config);
+}
+
+/**
+ * Applique la réserve de regroupement des écritures
+ */
+void configureWriteCoalescer(const PerformanceSection& performance) {
+    WriteCoalescerConfig write_config;
+    write_config.enabled = performance.write_coalescing;
+    write_config.pool_bytes = static_cast<int64_t>(performance.write_pool_size) * 1024 * 1024;
+    write_config.max_delay_ms = performance.write_flush_delay;
+    write_config.sync_mode = performance.write_sync == "batch" ? WriteSyncMode::BATCH : WriteSyncMode::NONE;
+    
+    WriteCoalescer::configure(write_config);
+}
+
+/**
+ * Applique les bornes du réglage automatique de la session
+ */
+void configureSessionTuner(const AppConfig& config) {
+    SessionTunerConfig tuner_config;
+    tuner_config.enabled = config.network.autotune;
+    tuner_config.max_connections = config.network.max_connections;
+    tuner_config.min_connections = config.network.min_connections;
+    tuner_config.max_unchoke_slots = config.network.max_unchoke_slots;
+    tuner_config.memory_budget = static_cast<int64_t>(config.performance.memory_budget) * 1024 * 1024;
+    
+    SessionTuner::configure(tuner_config);
+}
+
+/**
+ * Applique la configuration de la file de téléchargement
+ */
+void configureDownloadQueue(const AppConfig& config) {
+    DownloadSchedulerConfig queue_config;
+    queue_config.max_concurrent_downloads = config.advanced.max_concurrent_downloads;
+    queue_config.pre_announce_count = config.advanced.pre_announce_downloads;
+    queue_config.default_download_limit = config.network.download_limit * 1024;
+    queue_config.default_upload_limit = config.network.upload_limit * 1024;
+    queue_config.windows = DownloadScheduler::parseWindows(config.network.bandwidth_schedule);
+    
+    DownloadScheduler::configure(queue_config);
+}
+
+/**
+ * Applique à chaud les clés modifiées de config.ini (sans recréer la session)
+ */
+void applyConfigChanges(const AppConfig& config, const ConfigChanges& changes) {
+    if (changes.has("Logging")) {
+        configureLogging(config.logging);
+    }
+    
+    if (changes.has("Network", "download_limit") || changes.has("Network", "upload_limit") ||
+        changes.has("Network", "bandwidth_schedule") || changes.has("Advanced", "max_concurrent_downloads") ||
+        changes.has("Advanced", "pre_announce_downloads")) {
+        configureDownloadQueue(config);
+    }
+    
+    if (changes.has("Network", "autotune") || changes.has("Network", "max_connections") ||
+        changes.has("Network", "min_connections") || changes.has("Network", "max_unchoke_slots") ||
+        changes.has("Performance", "memory_budget")) {
+        configureSessionTuner(config);
+    }
+    
+    if (changes.has("Performance", "disk_cache_size") || changes.has("Performance", "read_ahead_blocks")) {
+        // Cache placé devant le stockage à la création de la session: activé au prochain démarrage
+        if (!g_piece_cache_started && config.performance.disk_cache_size > 0) {
+            LOG_WARNING("Cache des pièces activé au prochain démarrage");
+        }
+        configurePieceCache(config.performance);
+    }
+    
+    if (changes.has("Trackers", "scrape_ttl")) {
+        ScrapeService::setTtl(config.trackers.scrape_ttl);
+    }
+}
+
+/**
+ * Affiche l'écran de démarrage: fond et barre d'avancement des étapes
+ */
+void renderSplash() {
+#ifndef NO_SDL2_UI
+    SDL_SetRenderDrawColor(g_renderer, 0x1E, 0x1E, 0x2E, 0xFF);
+    SDL_RenderClear(g_renderer);
+    
+    // Sans police: chargée par l'étape "ui"
+    SDL_Rect track = {SCREEN_WIDTH / 4, SCREEN_HEIGHT / 2, SCREEN_WIDTH / 2, 8};
+    SDL_Rect bar = track;
+    bar.w = static_cast<int>(track.w * Startup::getProgress());
+    SDL_SetRenderDrawColor(g_renderer, 0x3A, 0x3A, 0x4E, 0xFF);
+    SDL_RenderFillRect(g_renderer, &track);
+    SDL_SetRenderDrawColor(g_renderer, 0x00, 0x7A, 0xFF, 0xFF);
+    SDL_RenderFillRect(g_renderer, &bar);
+    
+    SDL_RenderPresent(g_renderer);
+#endif
+}
+
+/**
+ * Déclare les étapes du démarrage qui suivent la première image
+ */
+void declareStartupStages(const AppConfig& config) {
+    Startup::add("metrics", {}, [&config]() {
+        configureMetrics(config);
+        return true;
+    });
+    
+    // Interface SDL: thread principal
+    Startup::add("ui", {}, []() {
+        return MainWindow::initialize(g_renderer) == 0;
+    }, StageThread::MAIN);
+    
+    Startup::add("metadata_cache", {}, [&config]() {
+        MetadataCache::configure(config.paths.cache_path);
+        return true;
+    });
+    
+    // Options lues avant la création de la session; état et données de reprise chargés par initialize
+    Startup::add("session", {}, [&config]() {
+        configureSessionOptions(config);
+        configureSessionTuner(config);
+        configureFastStart(config);
+        configurePieceCache(config.performance);
+        g_piece_cache_started = config.performance.disk_cache_size > 0;
+        configureWriteCoalescer(config.performance);
+        return TorrentManager::initialize() == 0;
+    });
+    
+    Startup::add("download_queue", {"session"}, [&config]() {
+        configureDownloadQueue(config);
+        return true;
+    });
+    
+    // Liste de blocage (peers et trackers malveillants)
+    Startup::add("blocklist", {"session"}, [&config]() {
+        if (config.security.block_malicious_trackers && !config.security.blocklist_files.empty()) {
+            if (IpBlocklist::load(config.security.blocklist_files, config.paths.cache_path + "/blocklist.bin") >= 0) {
+                TorrentManager::applyIpBlocklist();
+            }
+        }
+        return true;
+    }, StageThread::POOL, false);
+    
+    // Compteurs seeders/leechers du catalogue (trackers par défaut de FastStart)
+    Startup::add("scrape", {"session"}, [&config]() {
+        ScrapeService::setDefaultTrackers(FastStart::getConfig().default_trackers);
+        ScrapeService::setTtl(config.trackers.scrape_ttl);
+        return ScrapeService::initialize() == 0;
+    }, StageThread::POOL, false);
+    
+    // Session utilisable par le thread principal (TorrentManager::update, interface), sans
+    // attendre la liste de blocage: son étape l'applique à la session une fois chargée
+    Startup::add("p2p", {"session", "download_queue", "metadata_cache"}, []() {
+        return true;
+    });
+    
+    Startup::add("pkg", {}, []() {
+        return PkgManager::initialize() == 0;
+    });
+}
+
 /**
  * Nettoie les ressources avant la fermeture
  */
 void cleanup() {
     printf("Nettoyage des ressources...\n");
     
+    // Étapes de démarrage encore en cours terminées avant de libérer ce qu'elles touchent
+    Startup::wait();
+    
     // Nettoyer l'interface
     MainWindow::cleanup();
     
     // Nettoyer le gestionnaire P2P
+    ScrapeService::cleanup();
     TorrentManager::cleanup();
     
     // Nettoyer le gestionnaire PKG
     PkgManager::cleanup();
     
+    // Tâches de fond terminées avant de libérer le reste
+    ThreadPool::stop();
+    
     // Nettoyer SDL
 #ifndef NO_SDL2_UI
     if (g_renderer) {
@@ -227,6 +500,14 @@ void cleanup() {
     SDL_Quit();
 #endif
     
+    // Trace et métriques de la session, puis journal vidé en dernier
+    if (!g_trace_file.empty()) {
+        Trace::stop();
+        Trace::dump(g_trace_file);
+    }
+    Metrics::stopExporter();
+    Utils::cleanup();
+    
     printf("Nettoyage terminé\n");
 }
 
@@ -239,10 +520,14 @@ int main(int argc, char* argv[]) {
     
     // Initialiser les utilitaires
     Utils::initialize();
+    Startup::begin();
     LOG_INFO("Application démarrée");
     
-    // Note: Configuration sera chargée plus tard
-    printf("Configuration par défaut utilisée\n");
+    // Configuration lue avant tout le reste: journal et trace couvrent le démarrage
+    Config::load(CONFIG_FILE);
+    const AppConfig& config = Config::get();
+    configureLogging(config.logging);
+    configureTracing(config.advanced);
     
     // Initialiser les systèmes PS4
     if (initializePS4Systems() != 0) {
@@ -256,36 +541,61 @@ int main(int argc, char* argv[]) {
         return -1;
     }
     
-    // Initialiser les composants de l'application
-    if (MainWindow::initialize(g_renderer) != 0) {
-        printf("Erreur lors de l'initialisation de l'interface\n");
-        cleanup();
-        return -1;
-    }
-    
-    if (TorrentManager::initialize() != 0) {
-        printf("Erreur lors de l'initialisation du gestionnaire P2P\n");
-        cleanup();
-        return -1;
-    }
-    
-    if (PkgManager::initialize() != 0) {
-        printf("Erreur lors de l'initialisation du gestionnaire PKG\n");
-        cleanup();
-        return -1;
-    }
+    // Première image avant les étapes longues (session, état, listes de blocage)
+    renderSplash();
+    Startup::markFirstFrame();
     
-    printf("Application initialisée avec succès\n");
-    LOG_INFO("Application initialisée avec succès");
+    ThreadPool::start(config.performance.worker_threads);
+    declareStartupStages(config);
     
-    // Boucle principale
+    // Boucle principale, dès la première image: le démarrage se poursuit en arrière-plan
+    TRACE_THREAD_NAME("main");
+    MetricHistogram& frame_time = Metrics::histogram("frame_time_us", "Durée d'une image, attente comprise (µs)");
+    bool started = false;
     while (g_running) {
-        handleEvents();
-        render();
+        TRACE_SCOPE("ui", "frame");
+        MetricTimer frame_timer(frame_time);
+        bool ui_ready = Startup::isReady("ui");
+        {
+            TRACE_SCOPE("ui", "handleEvents");
+            handleEvents(ui_ready);
+        }
+        {
+            TRACE_SCOPE("ui", "render");
+            if (ui_ready) {
+                render();
+            } else {
+                renderSplash();
+            }
+        }
+        
+        // Étapes de démarrage prêtes, puis fin du démarrage
+        if (!started && Startup::pump()) {
+            started = true;
+            if (Startup::hasFailed()) {
+                printf("Erreur lors de l'initialisation de l'application\n");
+                LOG_ERROR("Démarrage interrompu: étape requise en échec");
+                g_running = false;
+            } else {
+                // Modifications de config.ini appliquées sans redémarrage
+                Config::subscribe(applyConfigChanges);
+                
+                printf("Application initialisée avec succès\n");
+                LOG_INFO("Application initialisée avec succès");
+            }
+        }
         
         // Mettre à jour les composants
-        TorrentManager::update();
-        PkgManager::update();
+        if (Startup::isReady("p2p")) {
+            TRACE_SCOPE("p2p", "TorrentManager::update");
+            TorrentManager::update();
+        }
+        if (started) {
+            Config::update();
+        }
+        
+        // Progressions (fusionnées), fins et erreurs déposées par les autres threads
+        EventQueue::dispatch();
         
         // Limiter le framerate
         SDL_Delay(16); // ~60 FPS
@@ -0,0 +1,151 @@
+/**
+ * PS4 Store P2P - Implémentation du Relais du Stockage libtorrent
+ */
+
+#include "p2p/disk_io_forwarder.h"
+
+#if !defined(NO_LIBTORRENT) && LIBTORRENT_VERSION_NUM >= 20000
+
+#include <libtorrent/performance_counters.hpp>
+
+#include <cstring>
+
+namespace {
+
+// Tampons alloués par les couches (libérés par disk_buffer_holder)
+struct HeapBufferAllocator : libtorrent::buffer_allocator_interface {
+    void free_disk_buffer(char* buffer) override { delete[] buffer; }
+};
+
+HeapBufferAllocator g_heap_allocator;
+
+} // namespace
+
+DiskIOForwarder::DiskIOForwarder(libtorrent::io_context& ioc, std::unique_ptr<libtorrent::disk_interface> disk)
+    : m_ioc(ioc), m_disk(std::move(disk)) {}
+
+libtorrent::disk_io_constructor_type DiskIOForwarder::innerConstructor(const libtorrent::session_params& params) {
+    if (params.disk_io_constructor) {
+        return params.disk_io_constructor;
+    }
+    return libtorrent::default_disk_io_constructor;
+}
+
+libtorrent::disk_buffer_holder DiskIOForwarder::copyBuffer(const char* data, int length) {
+    char* buffer = new char[length];
+    std::memcpy(buffer, data, length);
+    return libtorrent::disk_buffer_holder(g_heap_allocator, buffer, length);
+}
+
+int DiskIOForwarder::storageId(libtorrent::storage_index_t storage) {
+    return static_cast<int>(static_cast<std::uint32_t>(storage));
+}
+
+libtorrent::storage_holder DiskIOForwarder::new_torrent(libtorrent::storage_params const& params,
+                                                        std::shared_ptr<void> const& torrent) {
+    // Le handle rendu à libtorrent passe par remove_torrent() de cette couche
+    libtorrent::storage_holder inner = m_disk->new_torrent(params, torrent);
+    libtorrent::storage_index_t storage = inner.index();
+    m_holders[storage] = std::move(inner);
+    return libtorrent::storage_holder(storage, *this);
+}
+
+void DiskIOForwarder::remove_torrent(libtorrent::storage_index_t storage) {
+    m_holders.erase(storage);
+}
+
+void DiskIOForwarder::async_read(libtorrent::storage_index_t storage, libtorrent::peer_request const& request,
+                                 std::function<void(libtorrent::disk_buffer_holder, libtorrent::storage_error const&)> handler,
+                                 libtorrent::disk_job_flags_t flags) {
+    m_disk->async_read(storage, request, std::move(handler), flags);
+}
+
+bool DiskIOForwarder::async_write(libtorrent::storage_index_t storage, libtorrent::peer_request const& request,
+                                  char const* buffer, std::shared_ptr<libtorrent::disk_observer> observer,
+                                  std::function<void(libtorrent::storage_error const&)> handler,
+                                  libtorrent::disk_job_flags_t flags) {
+    return m_disk->async_write(storage, request, buffer, std::move(observer), std::move(handler), flags);
+}
+
+void DiskIOForwarder::async_hash(libtorrent::storage_index_t storage, libtorrent::piece_index_t piece,
+                                 libtorrent::span<libtorrent::sha256_hash> v2, libtorrent::disk_job_flags_t flags,
+                                 std::function<void(libtorrent::piece_index_t, libtorrent::sha1_hash const&,
+                                                    libtorrent::storage_error const&)> handler) {
+    m_disk->async_hash(storage, piece, v2, flags, std::move(handler));
+}
+
+void DiskIOForwarder::async_hash2(libtorrent::storage_index_t storage, libtorrent::piece_index_t piece, int offset,
+                                  libtorrent::disk_job_flags_t flags,
+                                  std::function<void(libtorrent::piece_index_t, libtorrent::sha256_hash const&,
+                                                     libtorrent::storage_error const&)> handler) {
+    m_disk->async_hash2(storage, piece, offset, flags, std::move(handler));
+}
+
+void DiskIOForwarder::async_move_storage(libtorrent::storage_index_t storage, std::string path,
+                                         libtorrent::move_flags_t flags,
+                                         std::function<void(libtorrent::status_t, std::string const&,
+                                                            libtorrent::storage_error const&)> handler) {
+    m_disk->async_move_storage(storage, std::move(path), flags, std::move(handler));
+}
+
+void DiskIOForwarder::async_release_files(libtorrent::storage_index_t storage, std::function<void()> handler) {
+    m_disk->async_release_files(storage, std::move(handler));
+}
+
+void DiskIOForwarder::async_check_files(libtorrent::storage_index_t storage,
+                                        libtorrent::add_torrent_params const* resume_data,
+                                        libtorrent::aux::vector<std::string, libtorrent::file_index_t> links,
+                                        std::function<void(libtorrent::status_t, libtorrent::storage_error const&)> handler) {
+    m_disk->async_check_files(storage, resume_data, std::move(links), std::move(handler));
+}
+
+void DiskIOForwarder::async_stop_torrent(libtorrent::storage_index_t storage, std::function<void()> handler) {
+    m_disk->async_stop_torrent(storage, std::move(handler));
+}
+
+void DiskIOForwarder::async_rename_file(libtorrent::storage_index_t storage, libtorrent::file_index_t index,
+                                        std::string name,
+                                        std::function<void(std::string const&, libtorrent::file_index_t,
+                                                           libtorrent::storage_error const&)> handler) {
+    m_disk->async_rename_file(storage, index, std::move(name), std::move(handler));
+}
+
+void DiskIOForwarder::async_delete_files(libtorrent::storage_index_t storage, libtorrent::remove_flags_t options,
+                                         std::function<void(libtorrent::storage_error const&)> handler) {
+    m_disk->async_delete_files(storage, options, std::move(handler));
+}
+
+void DiskIOForwarder::async_set_file_priority(libtorrent::storage_index_t storage,
+                                              libtorrent::aux::vector<libtorrent::download_priority_t, libtorrent::file_index_t> priorities,
+                                              std::function<void(libtorrent::storage_error const&,
+                                                                 libtorrent::aux::vector<libtorrent::download_priority_t,
+                                                                                         libtorrent::file_index_t>)> handler) {
+    m_disk->async_set_file_priority(storage, std::move(priorities), std::move(handler));
+}
+
+void DiskIOForwarder::async_clear_piece(libtorrent::storage_index_t storage, libtorrent::piece_index_t index,
+                                        std::function<void(libtorrent::piece_index_t)> handler) {
+    m_disk->async_clear_piece(storage, index, std::move(handler));
+}
+
+void DiskIOForwarder::update_stats_counters(libtorrent::counters& counters) const {
+    m_disk->update_stats_counters(counters);
+}
+
+std::vector<libtorrent::open_file_state> DiskIOForwarder::get_status(libtorrent::storage_index_t storage) const {
+    return m_disk->get_status(storage);
+}
+
+void DiskIOForwarder::abort(bool wait) {
+    m_disk->abort(wait);
+}
+
+void DiskIOForwarder::submit_jobs() {
+    m_disk->submit_jobs();
+}
+
+void DiskIOForwarder::settings_updated() {
+    m_disk->settings_updated();
+}
+
+#endif
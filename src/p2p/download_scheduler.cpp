@@ -0,0 +1,330 @@
+/**
+ * PS4 Store P2P - Implémentation du Planificateur de Téléchargements
+ */
+
+#include "p2p/download_scheduler.h"
+#include "p2p/torrent_manager.h"
+#include "utils/utils.h"
+
+#ifndef NO_LIBTORRENT
+#include <libtorrent/torrent_handle.hpp>
+#include <libtorrent/torrent_status.hpp>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+
+// Entrée interne: état de file et handle associé
+struct DownloadScheduler::QueueEntry {
+    QueuedDownload info;
+#ifndef NO_LIBTORRENT
+    libtorrent::torrent_handle handle;
+#endif
+};
+
+// Variables statiques
+std::vector<DownloadScheduler::QueueEntry> DownloadScheduler::s_queue;
+DownloadSchedulerConfig DownloadScheduler::s_config;
+int DownloadScheduler::s_next_position = 0;
+int64_t DownloadScheduler::s_last_tick = 0;
+int DownloadScheduler::s_active_window = -2;  // -2 = jamais appliqué, -1 = hors plage
+BandwidthWindow DownloadScheduler::s_applied_limits = {-1, -1, 0, 0};
+int64_t DownloadScheduler::s_capacity_estimate = 0;
+bool DownloadScheduler::s_dirty = false;
+
+// Période de réévaluation de la file
+static const int64_t SCHEDULER_TICK_MS = 2000;
+
+// Connexions d'un téléchargement annoncé en avance
+static const int PRE_ANNOUNCE_CONNECTIONS = 8;
+
+void DownloadScheduler::configure(const DownloadSchedulerConfig& config) {
+    s_config = config;
+    s_config.max_concurrent_downloads = std::max(1, config.max_concurrent_downloads);
+    s_config.secondary_share = std::min(1.0f, std::max(0.0f, config.secondary_share));
+    s_config.pre_announce_count = std::max(0, config.pre_announce_count);
+    s_active_window = -2;
+    s_dirty = true;
+    
+    LOG_INFO("File de téléchargement configurée - simultanés: " +
+             std::to_string(s_config.max_concurrent_downloads) +
+             ", plages horaires: " + std::to_string(s_config.windows.size()));
+}
+
+DownloadSchedulerConfig DownloadScheduler::getConfig() {
+    return s_config;
+}
+
+#ifndef NO_LIBTORRENT
+void DownloadScheduler::enqueue(const std::string& name, const libtorrent::torrent_handle& handle,
+                                DownloadPriority priority) {
+    remove(name);
+    
+    QueueEntry entry;
+    entry.info = {};
+    entry.info.name = name;
+    entry.info.priority = priority;
+    entry.info.queue_position = s_next_position++;
+    entry.handle = handle;
+    s_queue.push_back(entry);
+    
+    s_dirty = true;
+    LOG_DEBUG("Téléchargement ajouté à la file: " + name);
+}
+#endif
+
+void DownloadScheduler::remove(const std::string& name) {
+    auto it = std::find_if(s_queue.begin(), s_queue.end(), [&name](const QueueEntry& entry) {
+        return entry.info.name == name;
+    });
+    
+    if (it != s_queue.end()) {
+        s_queue.erase(it);
+        s_dirty = true;
+    }
+}
+
+bool DownloadScheduler::setPriority(const std::string& name, DownloadPriority priority) {
+    for (auto& entry : s_queue) {
+        if (entry.info.name == name) {
+            entry.info.priority = priority;
+            s_dirty = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+bool DownloadScheduler::moveTo(const std::string& name, int position) {
+    sortQueue();
+    
+    auto it = std::find_if(s_queue.begin(), s_queue.end(), [&name](const QueueEntry& entry) {
+        return entry.info.name == name;
+    });
+    if (it == s_queue.end()) {
+        return false;
+    }
+    
+    QueueEntry entry = *it;
+    s_queue.erase(it);
+    
+    position = std::max(0, std::min<int>(position, s_queue.size()));
+    s_queue.insert(s_queue.begin() + position, entry);
+    
+    // Renumérotation pour que l'ordre imposé survive aux tris suivants
+    for (size_t i = 0; i < s_queue.size(); i++) {
+        s_queue[i].info.queue_position = static_cast<int>(i);
+    }
+    s_next_position = static_cast<int>(s_queue.size());
+    
+    s_dirty = true;
+    return true;
+}
+
+bool DownloadScheduler::setUserPaused(const std::string& name, bool paused) {
+    for (auto& entry : s_queue) {
+        if (entry.info.name == name) {
+            entry.info.user_paused = paused;
+            s_dirty = true;
+            return true;
+        }
+    }
+    return false;
+}
+
+std::vector<QueuedDownload> DownloadScheduler::getQueue() {
+    sortQueue();
+    
+    std::vector<QueuedDownload> queue;
+    queue.reserve(s_queue.size());
+    for (const auto& entry : s_queue) {
+        queue.push_back(entry.info);
+    }
+    return queue;
+}
+
+void DownloadScheduler::update() {
+    int64_t now = Utils::getCurrentTimestamp();
+    if (!s_dirty && now - s_last_tick < SCHEDULER_TICK_MS) return;
+    s_last_tick = now;
+    s_dirty = false;
+    
+    applyBandwidthWindow();
+    
+    if (s_queue.empty()) return;
+    
+    sortQueue();
+    applyActivation();
+    applyThroughputShares();
+}
+
+void DownloadScheduler::clear() {
+    s_queue.clear();
+    s_next_position = 0;
+    s_active_window = -2;
+    s_applied_limits = {-1, -1, 0, 0};
+    s_capacity_estimate = 0;
+}
+
+BandwidthWindow DownloadScheduler::limitsAt(const DownloadSchedulerConfig& config, int minute_of_day) {
+    int window = findWindow(config, minute_of_day);
+    if (window >= 0) {
+        return config.windows[window];
+    }
+    return {-1, -1, config.default_download_limit, config.default_upload_limit};
+}
+
+BandwidthWindow DownloadScheduler::getAppliedLimits() {
+    return s_applied_limits;
+}
+
+std::vector<BandwidthWindow> DownloadScheduler::parseWindows(const std::string& spec) {
+    std::vector<BandwidthWindow> windows;
+    
+    for (const std::string& raw : Utils::split(spec, ',')) {
+        std::string item = Utils::trim(raw);
+        if (item.empty()) continue;
+        
+        int start_h, start_m, end_h, end_m, down_kb, up_kb;
+        if (sscanf(item.c_str(), "%d:%d-%d:%d=%d/%d",
+                   &start_h, &start_m, &end_h, &end_m, &down_kb, &up_kb) != 6 ||
+            start_h < 0 || start_h > 23 || end_h < 0 || end_h > 24 ||
+            start_m < 0 || start_m > 59 || end_m < 0 || end_m > 59 ||
+            (end_h == 24 && end_m != 0) ||
+            down_kb < 0 || up_kb < 0) {
+            LOG_WARNING("Plage horaire invalide ignorée: " + item);
+            continue;
+        }
+        
+        BandwidthWindow window;
+        window.start_minute = start_h * 60 + start_m;
+        window.end_minute = end_h * 60 + end_m;
+        window.download_limit = down_kb * 1024;
+        window.upload_limit = up_kb * 1024;
+        windows.push_back(window);
+    }
+    
+    return windows;
+}
+
+// Méthodes privées
+void DownloadScheduler::sortQueue() {
+    std::stable_sort(s_queue.begin(), s_queue.end(), [](const QueueEntry& a, const QueueEntry& b) {
+        if (a.info.priority != b.info.priority) return a.info.priority > b.info.priority;
+        return a.info.queue_position < b.info.queue_position;
+    });
+}
+
+void DownloadScheduler::applyBandwidthWindow() {
+    std::time_t now = std::time(nullptr);
+    std::tm local = *std::localtime(&now);
+    int minute = local.tm_hour * 60 + local.tm_min;
+    
+    // Sans plage horaire (ou hors plage): limites de base de config.ini
+    int window = findWindow(s_config, minute);
+    if (window == s_active_window) return;
+    s_active_window = window;
+    
+    if (window >= 0) {
+        LOG_INFO("Plage horaire de bande passante active: " + std::to_string(window));
+    }
+    s_applied_limits = limitsAt(s_config, minute);
+    TorrentManager::setBandwidthLimits(s_applied_limits.download_limit, s_applied_limits.upload_limit);
+    
+    // Le débit disponible change: l'estimation repart de zéro
+    s_capacity_estimate = 0;
+}
+
+void DownloadScheduler::applyActivation() {
+#ifndef NO_LIBTORRENT
+    int slots = s_config.max_concurrent_downloads;
+    int warm_slots = s_config.pre_announce_count;
+    
+    for (auto& entry : s_queue) {
+        bool wanted = !entry.info.user_paused && slots > 0;
+        if (wanted) slots--;
+        
+        // Suivants de la file: annoncés en mode upload (peers et métadonnées prêts, aucune donnée demandée)
+        bool warming = !wanted && !entry.info.user_paused && warm_slots > 0;
+        if (warming) warm_slots--;
+        
+        if (entry.handle.is_valid()) {
+            if (entry.info.pre_announced && !warming) {
+                entry.handle.unset_flags(libtorrent::torrent_flags::upload_mode);
+                entry.handle.set_max_connections(-1);
+            }
+            
+            if (wanted && !entry.info.active) {
+                entry.handle.resume();
+                LOG_DEBUG("Téléchargement activé: " + entry.info.name);
+            } else if (warming && !entry.info.pre_announced) {
+                entry.handle.set_flags(libtorrent::torrent_flags::upload_mode);
+                entry.handle.set_max_connections(PRE_ANNOUNCE_CONNECTIONS);
+                entry.handle.resume();
+                LOG_DEBUG("Téléchargement annoncé en avance: " + entry.info.name);
+            } else if (!wanted && !warming && (entry.info.active || entry.info.pre_announced)) {
+                entry.handle.pause();
+                LOG_DEBUG("Téléchargement mis en attente: " + entry.info.name);
+            }
+        }
+        entry.info.active = wanted;
+        entry.info.pre_announced = warming;
+    }
+#endif
+}
+
+void DownloadScheduler::applyThroughputShares() {
+#ifndef NO_LIBTORRENT
+    std::vector<QueueEntry*> active;
+    int64_t total_rate = 0;
+    
+    for (auto& entry : s_queue) {
+        if (!entry.info.active || !entry.handle.is_valid()) continue;
+        active.push_back(&entry);
+        total_rate += entry.handle.status().download_payload_rate;
+    }
+    
+    if (active.empty()) return;
+    
+    // Capacité: limite de la plage horaire, sinon pic de débit observé avec décroissance lente
+    int64_t capacity = 0;
+    if (s_active_window >= 0 && s_config.windows[s_active_window].download_limit > 0) {
+        capacity = s_config.windows[s_active_window].download_limit;
+    } else if (s_active_window < 0 && s_config.default_download_limit > 0) {
+        capacity = s_config.default_download_limit;
+    } else {
+        s_capacity_estimate = std::max<int64_t>(total_rate, s_capacity_estimate * 98 / 100);
+        capacity = s_capacity_estimate;
+    }
+    
+    // Tête de file sans limite, les suivants se partagent une fraction de la capacité
+    int secondary_limit = 0;
+    if (active.size() > 1 && capacity > 0) {
+        int64_t share = static_cast<int64_t>(capacity * s_config.secondary_share) /
+                        static_cast<int64_t>(active.size() - 1);
+        secondary_limit = static_cast<int>(std::max<int64_t>(share, s_config.min_secondary_rate));
+    }
+    
+    for (size_t i = 0; i < active.size(); i++) {
+        int limit = (i == 0) ? 0 : secondary_limit;
+        if (active[i]->info.download_limit != limit) {
+            active[i]->handle.set_download_limit(limit == 0 ? -1 : limit);
+            active[i]->info.download_limit = limit;
+        }
+    }
+#endif
+}
+
+int DownloadScheduler::findWindow(const DownloadSchedulerConfig& config, int minute_of_day) {
+    for (size_t i = 0; i < config.windows.size(); i++) {
+        const BandwidthWindow& w = config.windows[i];
+        bool inside = (w.start_minute <= w.end_minute)
+            ? (minute_of_day >= w.start_minute && minute_of_day < w.end_minute)
+            : (minute_of_day >= w.start_minute || minute_of_day < w.end_minute);
+        if (inside) {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
@@ -0,0 +1,402 @@
+/**
+ * PS4 Store P2P - Implémentation du Démarrage Rapide
+ */
+
+#include "p2p/fast_start.h"
+#include "utils/utils.h"
+
+#ifndef NO_LIBTORRENT
+#include <libtorrent/settings_pack.hpp>
+#include <libtorrent/add_torrent_params.hpp>
+#include <libtorrent/torrent_handle.hpp>
+#include <libtorrent/torrent_status.hpp>
+#include <libtorrent/peer_info.hpp>
+#include <libtorrent/address.hpp>
+#include <libtorrent/version.hpp>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <fstream>
+#include <sstream>
+
+// Mesure en cours
+struct FastStart::Tracking {
+#ifndef NO_LIBTORRENT
+    libtorrent::torrent_handle handle;  // Invalide tant que add_torrent_alert n'est pas reçu
+#endif
+};
+
+// Variables statiques
+FastStartConfig FastStart::s_config;
+std::map<std::string, std::vector<FastStart::CachedPeer>> FastStart::s_peer_cache;
+std::map<std::string, FastStart::Tracking> FastStart::s_tracking;
+std::vector<TtfbRecord> FastStart::s_records;
+bool FastStart::s_cache_dirty = false;
+int64_t FastStart::s_last_poll = 0;
+
+// Période de relevé des mesures en cours
+static const int64_t POLL_INTERVAL_MS = 250;
+
+// Mesures conservées (les plus anciennes terminées sont retirées)
+static const size_t MAX_RECORDS = 64;
+
+// Connexions tentées dès le démarrage d'un torrent (libtorrent: 30)
+static const int CONNECT_BOOST = 50;
+
+// Écart de dernier contact qui justifie une réécriture du cache (l'expiration se compte en heures)
+static const int64_t PEER_SEEN_RESOLUTION_S = 3600;
+
+#ifndef NO_LIBTORRENT
+static std::string toHex(const char* data, int size) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(size * 2);
+    for (int i = 0; i < size; i++) {
+        unsigned char byte = static_cast<unsigned char>(data[i]);
+        hex += digits[byte >> 4];
+        hex += digits[byte & 0x0F];
+    }
+    return hex;
+}
+
+static std::string paramsKey(const libtorrent::add_torrent_params& params) {
+#if LIBTORRENT_VERSION_NUM >= 20000
+    libtorrent::sha1_hash hash = params.info_hashes.get_best();
+#else
+    libtorrent::sha1_hash hash = params.info_hash;
+#endif
+    return toHex(hash.data(), static_cast<int>(hash.size()));
+}
+
+static std::string statusKey(const libtorrent::torrent_status& status) {
+#if LIBTORRENT_VERSION_NUM >= 20000
+    libtorrent::sha1_hash hash = status.info_hashes.get_best();
+#else
+    libtorrent::sha1_hash hash = status.info_hash;
+#endif
+    return toHex(hash.data(), static_cast<int>(hash.size()));
+}
+#endif
+
+void FastStart::configure(const FastStartConfig& config) {
+    s_config = config;
+    s_config.max_peers_per_torrent = std::max(1, s_config.max_peers_per_torrent);
+    s_config.max_cached_torrents = std::max(1, s_config.max_cached_torrents);
+    
+    s_peer_cache.clear();
+    s_cache_dirty = false;
+    if (!s_config.peer_cache_file.empty()) {
+        loadPeerCache();
+    }
+}
+
+FastStartConfig FastStart::getConfig() {
+    return s_config;
+}
+
+#ifndef NO_LIBTORRENT
+void FastStart::applySettings(libtorrent::settings_pack& settings) {
+    if (!s_config.enabled) return;
+    
+    // Tous les trackers de tous les niveaux annoncés en parallèle, sans attendre
+    // l'échec du niveau précédent
+    settings.set_bool(libtorrent::settings_pack::announce_to_all_tiers, true);
+    settings.set_bool(libtorrent::settings_pack::announce_to_all_trackers, true);
+    settings.set_int(libtorrent::settings_pack::torrent_connect_boost, CONNECT_BOOST);
+}
+
+void FastStart::prepare(const std::string& name, libtorrent::add_torrent_params& params) {
+    TtfbRecord record = {};
+    record.name = name;
+    record.started_at = Utils::getCurrentTimestamp();
+    record.metadata_ms = params.ti ? 0 : -1;
+    record.first_peer_ms = -1;
+    record.first_byte_ms = -1;
+    
+    if (s_config.enabled) {
+        record.added_trackers = addDefaultTrackers(params.trackers, params.tracker_tiers, s_config.default_trackers);
+        
+        // Peers connus: connexions tentées avant la première réponse de tracker ou du DHT
+        for (const auto& peer : getCachedPeers(paramsKey(params))) {
+            libtorrent::error_code ec;
+            libtorrent::address address = libtorrent::make_address(peer.first, ec);
+            if (ec) continue;
+            params.peers.push_back(libtorrent::tcp::endpoint(address, static_cast<unsigned short>(peer.second)));
+            record.cached_peers++;
+        }
+    }
+    
+    forget(name);
+    s_tracking[name] = Tracking();
+    s_records.push_back(record);
+    
+    // Limite de l'historique: les mesures terminées les plus anciennes partent en premier
+    while (s_records.size() > MAX_RECORDS) {
+        auto oldest = std::find_if(s_records.begin(), s_records.end(), [](const TtfbRecord& r) {
+            return s_tracking.find(r.name) == s_tracking.end();
+        });
+        if (oldest == s_records.end()) oldest = s_records.begin();
+        s_tracking.erase(oldest->name);
+        s_records.erase(oldest);
+    }
+    
+    LOG_DEBUG("Démarrage rapide de " + name + ": " + std::to_string(record.added_trackers) + " trackers ajoutés, " +
+              std::to_string(record.cached_peers) + " peers en cache");
+}
+
+void FastStart::attach(const std::string& name, const libtorrent::torrent_handle& handle) {
+    auto it = s_tracking.find(name);
+    if (it != s_tracking.end()) {
+        it->second.handle = handle;
+    }
+}
+
+void FastStart::recordPeers(const libtorrent::torrent_status& status, const std::vector<libtorrent::peer_info>& peers) {
+    if (!s_config.enabled) return;
+    
+    int64_t now = static_cast<int64_t>(std::time(nullptr));
+    std::string key = statusKey(status);
+    
+    for (const auto& peer : peers) {
+        // Seuls les peers qui ont réellement fourni des données valent une connexion directe
+        if (peer.total_download <= 0) continue;
+        
+        // Connexion entrante: le port source n'est pas un port d'écoute
+        if (!static_cast<bool>(peer.flags & libtorrent::peer_info::local_connection)) continue;
+        
+        rememberPeer(key, peer.ip.address().to_string(), peer.ip.port(), now);
+    }
+}
+
+void FastStart::update() {
+    int64_t now = Utils::getCurrentTimestamp();
+    if (now - s_last_poll < POLL_INTERVAL_MS || s_tracking.empty()) return;
+    s_last_poll = now;
+    
+    for (auto it = s_tracking.begin(); it != s_tracking.end();) {
+        TtfbRecord* record = findRecord(it->first);
+        if (!record) {
+            it = s_tracking.erase(it);
+            continue;
+        }
+        if (!it->second.handle.is_valid()) {
+            ++it;
+            continue;
+        }
+        
+        try {
+            libtorrent::torrent_status status = it->second.handle.status();
+            int64_t elapsed = now - record->started_at;
+            
+            if (record->metadata_ms < 0 && status.has_metadata) {
+                record->metadata_ms = elapsed;
+            }
+            if (record->first_peer_ms < 0 && status.num_peers > 0) {
+                record->first_peer_ms = elapsed;
+            }
+            if (status.total_payload_download > 0) {
+                record->first_byte_ms = elapsed;
+                LOG_INFO("Premier octet reçu pour " + record->name + " en " + std::to_string(elapsed) +
+                         " ms (métadonnées: " + std::to_string(record->metadata_ms) + " ms, premier peer: " +
+                         std::to_string(record->first_peer_ms) + " ms, " + std::to_string(record->cached_peers) +
+                         " peers en cache)");
+                it = s_tracking.erase(it);
+                continue;
+            }
+        } catch (const std::exception& e) {
+            LOG_DEBUG("Mesure de démarrage interrompue pour " + it->first + ": " + std::string(e.what()));
+            it = s_tracking.erase(it);
+            continue;
+        }
+        ++it;
+    }
+}
+#endif
+
+int FastStart::addDefaultTrackers(std::vector<std::string>& trackers, std::vector<int>& tiers,
+                                  const std::vector<std::string>& defaults) {
+    // Trackers par défaut au niveau suivant ceux du lien magnet
+    int tier = 0;
+    for (size_t i = 0; i < tiers.size() && i < trackers.size(); i++) {
+        tier = std::max(tier, tiers[i] + 1);
+    }
+    if (tiers.empty() && !trackers.empty()) {
+        tier = 1;
+    }
+    
+    int added = 0;
+    for (const auto& tracker : defaults) {
+        if (tracker.empty()) continue;
+        if (std::find(trackers.begin(), trackers.end(), tracker) != trackers.end()) continue;
+        
+        // Niveaux alignés sur les trackers existants avant l'ajout
+        tiers.resize(trackers.size(), 0);
+        trackers.push_back(tracker);
+        tiers.push_back(tier);
+        added++;
+    }
+    return added;
+}
+
+bool FastStart::rememberPeer(const std::string& info_hash, const std::string& address, int port, int64_t now) {
+    std::vector<CachedPeer>& cached = s_peer_cache[info_hash];
+    bool changed = false;
+    
+    auto existing = std::find_if(cached.begin(), cached.end(), [&](const CachedPeer& c) {
+        return c.address == address && c.port == port;
+    });
+    if (existing != cached.end()) {
+        // Contact rafraîchi: écrit seulement à la précision utile à l'expiration (heures)
+        changed = now - existing->last_seen >= PEER_SEEN_RESOLUTION_S;
+        existing->last_seen = now;
+    } else {
+        cached.push_back({address, port, now});
+        changed = true;
+    }
+    
+    // Les plus récents en tête, dans la limite par torrent
+    std::sort(cached.begin(), cached.end(), [](const CachedPeer& a, const CachedPeer& b) {
+        return a.last_seen > b.last_seen;
+    });
+    if (static_cast<int>(cached.size()) > s_config.max_peers_per_torrent) {
+        cached.resize(s_config.max_peers_per_torrent);
+        changed = true;
+    }
+    
+    if (changed) {
+        s_cache_dirty = true;
+    }
+    if (static_cast<int>(s_peer_cache.size()) > s_config.max_cached_torrents) {
+        trimPeerCache();
+    }
+    return changed;
+}
+
+std::vector<std::pair<std::string, int>> FastStart::getCachedPeers(const std::string& info_hash) {
+    std::vector<std::pair<std::string, int>> peers;
+    auto it = s_peer_cache.find(info_hash);
+    if (it != s_peer_cache.end()) {
+        for (const auto& peer : it->second) {
+            peers.push_back({peer.address, peer.port});
+        }
+    }
+    return peers;
+}
+
+std::vector<TtfbRecord> FastStart::getRecords() {
+    return s_records;
+}
+
+int64_t FastStart::getTtfb(const std::string& name) {
+    TtfbRecord* record = findRecord(name);
+    return record ? record->first_byte_ms : -1;
+}
+
+void FastStart::forget(const std::string& name) {
+    s_tracking.erase(name);
+    s_records.erase(std::remove_if(s_records.begin(), s_records.end(), [&](const TtfbRecord& r) {
+        return r.name == name;
+    }), s_records.end());
+}
+
+bool FastStart::savePeerCache() {
+    if (s_config.peer_cache_file.empty() || !s_cache_dirty) return true;
+    
+    // Écriture dans un fichier temporaire puis renommage: jamais de cache tronqué
+    std::string temp_path = s_config.peer_cache_file + ".tmp";
+    {
+        std::ofstream file(temp_path, std::ios::trunc);
+        if (!file.is_open()) {
+            LOG_WARNING("Impossible d'écrire le cache de peers: " + temp_path);
+            return false;
+        }
+        
+        file << "# info_hash adresse port dernier_contact\n";
+        for (const auto& entry : s_peer_cache) {
+            for (const auto& peer : entry.second) {
+                file << entry.first << " " << peer.address << " " << peer.port << " " << peer.last_seen << "\n";
+            }
+        }
+        if (!file.good()) return false;
+    }
+    
+    if (std::rename(temp_path.c_str(), s_config.peer_cache_file.c_str()) != 0) {
+        LOG_WARNING("Impossible de remplacer le cache de peers: " + s_config.peer_cache_file);
+        return false;
+    }
+    
+    s_cache_dirty = false;
+    LOG_DEBUG("Cache de peers sauvegardé: " + std::to_string(s_peer_cache.size()) + " torrents");
+    return true;
+}
+
+void FastStart::clear() {
+    savePeerCache();
+    s_tracking.clear();
+    s_records.clear();
+    s_last_poll = 0;
+}
+
+// Méthodes privées
+bool FastStart::loadPeerCache() {
+    std::ifstream file(s_config.peer_cache_file);
+    if (!file.is_open()) return false;
+    
+    int64_t oldest = static_cast<int64_t>(std::time(nullptr)) - static_cast<int64_t>(s_config.peer_ttl_hours) * 3600;
+    int peers = 0;
+    std::string line;
+    while (std::getline(file, line)) {
+        if (line.empty() || line[0] == '#') continue;
+        
+        std::istringstream fields(line);
+        std::string hash;
+        CachedPeer peer;
+        if (!(fields >> hash >> peer.address >> peer.port >> peer.last_seen)) continue;
+        if (hash.size() != 40 || peer.port <= 0 || peer.port > 65535) continue;
+        if (peer.last_seen < oldest) {
+            s_cache_dirty = true;
+            continue;
+        }
+        
+        std::vector<CachedPeer>& cached = s_peer_cache[hash];
+        if (static_cast<int>(cached.size()) < s_config.max_peers_per_torrent) {
+            cached.push_back(peer);
+            peers++;
+        }
+    }
+    
+    trimPeerCache();
+    LOG_INFO("Cache de peers chargé: " + std::to_string(peers) + " peers pour " +
+             std::to_string(s_peer_cache.size()) + " torrents");
+    return true;
+}
+
+void FastStart::trimPeerCache() {
+    if (static_cast<int>(s_peer_cache.size()) <= s_config.max_cached_torrents) return;
+    
+    // Torrents classés par contact le plus récent, les moins récents sont oubliés
+    std::vector<std::pair<int64_t, std::string>> recency;
+    for (const auto& entry : s_peer_cache) {
+        int64_t latest = 0;
+        for (const auto& peer : entry.second) {
+            latest = std::max(latest, peer.last_seen);
+        }
+        recency.push_back({latest, entry.first});
+    }
+    std::sort(recency.begin(), recency.end());
+    
+    size_t excess = s_peer_cache.size() - static_cast<size_t>(s_config.max_cached_torrents);
+    for (size_t i = 0; i < excess; i++) {
+        s_peer_cache.erase(recency[i].second);
+    }
+    s_cache_dirty = true;
+}
+
+TtfbRecord* FastStart::findRecord(const std::string& name) {
+    for (auto& record : s_records) {
+        if (record.name == name) return &record;
+    }
+    return nullptr;
+}
@@ -0,0 +1,359 @@
+/**
+ * PS4 Store P2P - Implémentation de la Liste de Blocage IP
+ */
+
+#include "p2p/ip_blocklist.h"
+#include "utils/utils.h"
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+#include <sys/stat.h>
+
+// Intervalles publiés et index par préfixe /16: bucket_start[b] est l'indice du premier
+// intervalle commençant dans le préfixe b ou après (65537 entrées)
+struct IpBlocklist::Table {
+    std::vector<IpRange> ranges;
+    std::vector<uint32_t> bucket_start;
+};
+
+static const int BUCKET_SHIFT = 16;
+static const size_t BUCKET_COUNT = (1u << (32 - BUCKET_SHIFT)) + 1;
+
+// Variables statiques
+std::shared_ptr<const IpBlocklist::Table> IpBlocklist::s_table =
+    std::make_shared<const IpBlocklist::Table>(IpBlocklist::Table{{}, std::vector<uint32_t>(BUCKET_COUNT, 0)});
+std::atomic<const IpBlocklist::Table*> IpBlocklist::s_current(IpBlocklist::s_table.get());
+std::atomic<unsigned> IpBlocklist::s_epoch(0);
+std::atomic<int> IpBlocklist::s_readers[2] = {{0}, {0}};
+std::mutex IpBlocklist::s_mutex;
+
+// En-tête du cache binaire: signature, empreinte des sources, nombre d'intervalles
+static const char CACHE_MAGIC[8] = {'P', 'S', '4', 'B', 'L', 'K', '0', '1'};
+
+// Niveau d'accès DAT à partir duquel une plage est autorisée (convention eMule)
+static const int DAT_ALLOWED_LEVEL = 128;
+
+static void skipSpaces(const char*& p, const char* end) {
+    while (p < end && (*p == ' ' || *p == '\t')) p++;
+}
+
+// Lecture d'une adresse a.b.c.d (zéros de tête admis, format DAT "001.002.003.004")
+static bool parseAddress(const char*& p, const char* end, uint32_t& address) {
+    skipSpaces(p, end);
+    address = 0;
+    for (int octet = 0; octet < 4; octet++) {
+        if (octet > 0) {
+            if (p >= end || *p != '.') return false;
+            p++;
+        }
+        
+        int value = 0;
+        int digits = 0;
+        while (p < end && *p >= '0' && *p <= '9' && digits < 3) {
+            value = value * 10 + (*p - '0');
+            p++;
+            digits++;
+        }
+        if (digits == 0 || value > 255) return false;
+        address = (address << 8) | static_cast<uint32_t>(value);
+    }
+    skipSpaces(p, end);
+    return true;
+}
+
+static bool parseRange(const char*& p, const char* end, IpRange& range) {
+    if (!parseAddress(p, end, range.first)) return false;
+    if (p >= end || *p != '-') return false;
+    p++;
+    if (!parseAddress(p, end, range.last)) return false;
+    if (range.first > range.last) std::swap(range.first, range.last);
+    return true;
+}
+
+int64_t IpBlocklist::load(const std::vector<std::string>& sources, const std::string& cache_file,
+                          BlocklistStats* stats) {
+    auto start = std::chrono::steady_clock::now();
+    BlocklistStats result = {0, 0, 0, 0, false};
+    std::vector<IpRange> ranges;
+    
+    if (!cache_file.empty() && loadCache(cache_file, sources, ranges)) {
+        result.from_cache = true;
+        result.merged = static_cast<int64_t>(ranges.size());
+    } else {
+        bool readable = false;
+        for (const auto& source : sources) {
+            int64_t lines = 0;
+            if (parseFile(source, ranges, &lines)) {
+                readable = true;
+                result.lines += lines;
+            } else {
+                LOG_WARNING("Liste de blocage illisible: " + source);
+            }
+        }
+        if (!readable) {
+            return -1;
+        }
+        
+        result.parsed = static_cast<int64_t>(ranges.size());
+        mergeRanges(ranges);
+        result.merged = static_cast<int64_t>(ranges.size());
+        
+        if (!cache_file.empty() && !saveCache(cache_file, sources, ranges)) {
+            LOG_WARNING("Impossible d'écrire le cache de la liste de blocage: " + cache_file);
+        }
+    }
+    
+    // Intervalles déjà triés et fusionnés (cache ou fusion ci-dessus)
+    publish(std::move(ranges));
+    
+    result.load_ms = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start).count();
+    if (stats) *stats = result;
+    
+    LOG_INFO("Liste de blocage chargée: " + std::to_string(result.merged) + " plages en " +
+             std::to_string(result.load_ms) + " ms" + (result.from_cache ? " (cache)" : ""));
+    return result.merged;
+}
+
+void IpBlocklist::setRanges(std::vector<IpRange> ranges) {
+    mergeRanges(ranges);
+    publish(std::move(ranges));
+}
+
+std::shared_ptr<const std::vector<IpRange>> IpBlocklist::getRanges() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return std::shared_ptr<const std::vector<IpRange>>(s_table, &s_table->ranges);
+}
+
+bool IpBlocklist::isBlocked(uint32_t address) {
+    // Lecteur compté dans son époque: la table lue n'est pas libérée avant la fin de la recherche.
+    // Époque changée entre-temps: la publication n'attend plus ce compteur, nouvel essai
+    unsigned epoch = s_epoch.load();
+    s_readers[epoch & 1].fetch_add(1);
+    while (s_epoch.load() != epoch) {
+        s_readers[epoch & 1].fetch_sub(1);
+        epoch = s_epoch.load();
+        s_readers[epoch & 1].fetch_add(1);
+    }
+    const Table* table = s_current.load();
+    const IpRange* ranges = table->ranges.data();
+    
+    // Recherche limitée aux intervalles commençant dans le même /16; le précédent
+    // (commencé plus tôt) peut encore couvrir l'adresse
+    uint32_t bucket = address >> BUCKET_SHIFT;
+    const IpRange* begin = ranges + table->bucket_start[bucket];
+    const IpRange* end = ranges + table->bucket_start[bucket + 1];
+    const IpRange* it = std::upper_bound(begin, end, address,
+                                         [](uint32_t value, const IpRange& range) { return value < range.first; });
+    bool blocked = it != ranges && address <= (it - 1)->last;
+    
+    s_readers[epoch & 1].fetch_sub(1);
+    return blocked;
+}
+
+bool IpBlocklist::isBlocked(const std::string& address) {
+    const char* p = address.c_str();
+    const char* end = p + address.size();
+    uint32_t value;
+    if (!parseAddress(p, end, value) || p != end) return false;
+    return isBlocked(value);
+}
+
+void IpBlocklist::clear() {
+    publish(std::vector<IpRange>());
+}
+
+bool IpBlocklist::parseFile(const std::string& path, std::vector<IpRange>& ranges, int64_t* lines) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    // Lecture en flux: seule la ligne courante est en mémoire
+    std::string line;
+    int64_t count = 0;
+    IpRange range;
+    while (std::getline(file, line)) {
+        count++;
+        if (parseLine(line, range)) {
+            ranges.push_back(range);
+        }
+    }
+    
+    if (lines) *lines = count;
+    return true;
+}
+
+bool IpBlocklist::parseLine(const std::string& line, IpRange& range) {
+    const char* p = line.c_str();
+    const char* end = p + line.size();
+    while (end > p && (end[-1] == '\r' || end[-1] == ' ' || end[-1] == '\t')) end--;
+    skipSpaces(p, end);
+    
+    if (p >= end || *p == '#' || (*p == '/' && p + 1 < end && p[1] == '/')) {
+        return false;
+    }
+    
+    // DAT: "a.b.c.d - e.f.g.h , niveau , description"
+    const char* dat = p;
+    if (parseRange(dat, end, range)) {
+        if (dat < end && *dat == ',') {
+            dat++;
+            skipSpaces(dat, end);
+            int level = 0;
+            while (dat < end && *dat >= '0' && *dat <= '9') {
+                level = level * 10 + (*dat - '0');
+                dat++;
+            }
+            skipSpaces(dat, end);
+            if (level >= DAT_ALLOWED_LEVEL) return false;
+        }
+        return dat == end || *dat == ',';
+    }
+    
+    // P2P: "description:a.b.c.d-e.f.g.h" (la description peut contenir ':')
+    const char* colon = nullptr;
+    for (const char* c = end; c > p; c--) {
+        if (c[-1] == ':') {
+            colon = c - 1;
+            break;
+        }
+    }
+    if (!colon) return false;
+    
+    const char* p2p = colon + 1;
+    return parseRange(p2p, end, range) && p2p == end;
+}
+
+void IpBlocklist::mergeRanges(std::vector<IpRange>& ranges) {
+    if (ranges.empty()) return;
+    
+    std::sort(ranges.begin(), ranges.end(), [](const IpRange& a, const IpRange& b) {
+        return a.first < b.first;
+    });
+    
+    // Fusion sur place des intervalles qui se chevauchent ou sont contigus
+    size_t out = 0;
+    for (size_t i = 1; i < ranges.size(); i++) {
+        IpRange& current = ranges[out];
+        if (current.last == UINT32_MAX || ranges[i].first <= current.last + 1) {
+            current.last = std::max(current.last, ranges[i].last);
+        } else {
+            ranges[++out] = ranges[i];
+        }
+    }
+    ranges.resize(out + 1);
+    ranges.shrink_to_fit();
+}
+
+bool IpBlocklist::saveCache(const std::string& cache_file, const std::vector<std::string>& sources,
+                            const std::vector<IpRange>& ranges) {
+    // Écriture dans un fichier temporaire puis renommage: jamais de cache tronqué
+    std::string temp_file = cache_file + ".tmp";
+    {
+        std::ofstream file(temp_file, std::ios::binary | std::ios::trunc);
+        if (!file.is_open()) return false;
+        
+        uint64_t fingerprint = sourcesFingerprint(sources);
+        uint64_t count = ranges.size();
+        file.write(CACHE_MAGIC, sizeof(CACHE_MAGIC));
+        file.write(reinterpret_cast<const char*>(&fingerprint), sizeof(fingerprint));
+        file.write(reinterpret_cast<const char*>(&count), sizeof(count));
+        file.write(reinterpret_cast<const char*>(ranges.data()), count * sizeof(IpRange));
+        if (!file.good()) return false;
+    }
+    
+    return std::rename(temp_file.c_str(), cache_file.c_str()) == 0;
+}
+
+bool IpBlocklist::loadCache(const std::string& cache_file, const std::vector<std::string>& sources,
+                            std::vector<IpRange>& ranges) {
+    std::ifstream file(cache_file, std::ios::binary);
+    if (!file.is_open()) {
+        return false;
+    }
+    
+    char magic[sizeof(CACHE_MAGIC)];
+    uint64_t fingerprint = 0;
+    uint64_t count = 0;
+    file.read(magic, sizeof(magic));
+    file.read(reinterpret_cast<char*>(&fingerprint), sizeof(fingerprint));
+    file.read(reinterpret_cast<char*>(&count), sizeof(count));
+    if (!file.good() || std::memcmp(magic, CACHE_MAGIC, sizeof(magic)) != 0 ||
+        fingerprint != sourcesFingerprint(sources)) {
+        return false;
+    }
+    
+    // Taille annoncée cohérente avec le fichier avant toute allocation
+    int64_t expected = static_cast<int64_t>(sizeof(CACHE_MAGIC) + 2 * sizeof(uint64_t) + count * sizeof(IpRange));
+    if (Utils::getFileSize(cache_file) != expected) {
+        return false;
+    }
+    
+    ranges.resize(count);
+    file.read(reinterpret_cast<char*>(ranges.data()), count * sizeof(IpRange));
+    if (!file.good()) {
+        ranges.clear();
+        return false;
+    }
+    return true;
+}
+
+// Méthodes privées
+void IpBlocklist::publish(std::vector<IpRange>&& ranges) {
+    auto table = std::make_shared<Table>();
+    table->ranges = std::move(ranges);
+    table->bucket_start.resize(BUCKET_COUNT);
+    
+    size_t index = 0;
+    for (size_t bucket = 0; bucket < BUCKET_COUNT; bucket++) {
+        uint64_t bucket_first = static_cast<uint64_t>(bucket) << BUCKET_SHIFT;
+        while (index < table->ranges.size() && table->ranges[index].first < bucket_first) {
+            index++;
+        }
+        table->bucket_start[bucket] = static_cast<uint32_t>(index);
+    }
+    
+    // Publication atomique puis changement d'époque: les nouvelles recherches sont comptées dans
+    // l'autre compteur, celui de l'ancienne époque ne fait que décroître. L'attente est bornée par
+    // les recherches déjà commencées, même sous un flux continu de lectures (les détenteurs de
+    // getRanges() conservent l'ancienne table par leur propre référence)
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_current.store(table.get());
+    unsigned previous = s_epoch.fetch_add(1);
+    while (s_readers[previous & 1].load() != 0) {
+        std::this_thread::yield();
+    }
+    s_table = std::move(table);
+}
+
+uint64_t IpBlocklist::sourcesFingerprint(const std::vector<std::string>& sources) {
+    // FNV-1a sur le chemin, la taille et la date de modification de chaque source
+    uint64_t hash = 14695981039346656037ULL;
+    auto mix = [&hash](const void* data, size_t size) {
+        const unsigned char* bytes = static_cast<const unsigned char*>(data);
+        for (size_t i = 0; i < size; i++) {
+            hash = (hash ^ bytes[i]) * 1099511628211ULL;
+        }
+    };
+    
+    for (const auto& source : sources) {
+        struct stat info;
+        int64_t size = -1;
+        int64_t modified = 0;
+        if (stat(source.c_str(), &info) == 0) {
+            size = static_cast<int64_t>(info.st_size);
+            modified = static_cast<int64_t>(info.st_mtime);
+        }
+        mix(source.data(), source.size());
+        mix(&size, sizeof(size));
+        mix(&modified, sizeof(modified));
+    }
+    return hash;
+}
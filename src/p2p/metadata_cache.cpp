@@ -0,0 +1,279 @@
+/**
+ * PS4 Store P2P - Implémentation du Cache de Métadonnées
+ */
+
+#include "p2p/metadata_cache.h"
+#include "utils/utils.h"
+
+#ifndef NO_LIBTORRENT
+#include <libtorrent/session.hpp>
+#include <libtorrent/add_torrent_params.hpp>
+#include <libtorrent/torrent_handle.hpp>
+#include <libtorrent/torrent_info.hpp>
+#include <libtorrent/alert_types.hpp>
+#include <libtorrent/magnet_uri.hpp>
+#include <libtorrent/create_torrent.hpp>
+#include <libtorrent/bencode.hpp>
+#include <libtorrent/version.hpp>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+
+// Résolution en cours
+struct MetadataCache::Resolution {
+#ifndef NO_LIBTORRENT
+    libtorrent::torrent_handle handle;  // Invalide tant que add_torrent_alert n'est pas reçu
+#endif
+    int64_t started_at;
+};
+
+// Variables statiques
+std::map<std::string, MetadataCache::Resolution> MetadataCache::s_resolving;
+std::vector<std::string> MetadataCache::s_queue;
+std::set<std::string> MetadataCache::s_failed;
+std::set<std::string> MetadataCache::s_cancelled;
+std::string MetadataCache::s_cache_dir = "/data/ps4_store/cache/metadata";
+int MetadataCache::s_max_concurrent = 2;
+int MetadataCache::s_timeout_s = 120;
+
+// Préfixe des noms internes des résolutions
+static const std::string RESOLVER_PREFIX = "metadata:";
+
+void MetadataCache::configure(const std::string& cache_path, int max_concurrent, int timeout_s) {
+    s_cache_dir = cache_path + "/metadata";
+    s_max_concurrent = std::max(1, max_concurrent);
+    s_timeout_s = std::max(10, timeout_s);
+    
+    if (!Utils::directoryExists(s_cache_dir)) {
+        Utils::createDirectory(s_cache_dir);
+    }
+}
+
+void MetadataCache::prefetch(const std::vector<std::string>& magnet_links) {
+    for (const auto& magnet : magnet_links) {
+        if (magnet.empty()) continue;
+        if (std::find(s_queue.begin(), s_queue.end(), magnet) == s_queue.end()) {
+            s_queue.push_back(magnet);
+        }
+    }
+    
+    LOG_DEBUG("Métadonnées à résoudre: " + std::to_string(s_queue.size()));
+}
+
+bool MetadataCache::isCached(const std::string& magnet_link) {
+#ifndef NO_LIBTORRENT
+    libtorrent::add_torrent_params params;
+    libtorrent::error_code ec;
+    libtorrent::parse_magnet_uri(magnet_link, params, ec);
+    return !ec && Utils::fileExists(cacheFile(hashKey(params)));
+#else
+    (void)magnet_link;
+    return false;
+#endif
+}
+
+int MetadataCache::getPendingCount() {
+    return static_cast<int>(s_queue.size() + s_resolving.size());
+}
+
+#ifndef NO_LIBTORRENT
+std::shared_ptr<libtorrent::torrent_info> MetadataCache::lookup(const libtorrent::add_torrent_params& params) {
+    std::string path = cacheFile(hashKey(params));
+    if (!Utils::fileExists(path)) {
+        return nullptr;
+    }
+    
+    libtorrent::error_code ec;
+    auto ti = std::make_shared<libtorrent::torrent_info>(path, ec);
+    if (ec) {
+        LOG_WARNING("Métadonnées en cache invalides, suppression: " + path);
+        Utils::deleteFile(path);
+        return nullptr;
+    }
+    
+    return ti;
+}
+
+void MetadataCache::cancel(libtorrent::session& session, const libtorrent::add_torrent_params& params) {
+    std::string hash = hashKey(params);
+    
+    auto it = s_resolving.find(hash);
+    if (it != s_resolving.end()) {
+        if (it->second.handle.is_valid()) {
+            session.remove_torrent(it->second.handle, libtorrent::session::delete_partfile);
+        } else {
+            // Ajout encore en cours: retiré à la réception de son add_torrent_alert
+            s_cancelled.insert(hash);
+        }
+        s_resolving.erase(it);
+    }
+}
+
+bool MetadataCache::takeCancelled(const libtorrent::add_torrent_params& params) {
+    return s_cancelled.erase(hashKey(params)) > 0;
+}
+
+bool MetadataCache::isResolver(const std::string& name) {
+    return Utils::startsWith(name, RESOLVER_PREFIX);
+}
+
+void MetadataCache::handleAdded(libtorrent::session& session, const libtorrent::add_torrent_alert* alert) {
+    if (!alert) return;
+    
+    std::string hash = alert->params.name.substr(RESOLVER_PREFIX.size());
+    auto it = s_resolving.find(hash);
+    
+    if (alert->error) {
+        LOG_DEBUG("Résolution impossible " + hash + ": " + alert->error.message());
+        if (it != s_resolving.end()) s_resolving.erase(it);
+        s_failed.insert(hash);
+        
+        // Annulée entre-temps: l'ajout du téléchargement ne sera pas refusé, rien à reprendre
+        s_cancelled.erase(hash);
+        return;
+    }
+    
+    // Annulée entre-temps (téléchargement démarré)
+    if (it == s_resolving.end()) {
+        session.remove_torrent(alert->handle, libtorrent::session::delete_partfile);
+        return;
+    }
+    
+    it->second.handle = alert->handle;
+}
+
+bool MetadataCache::handleMetadataReceived(libtorrent::session& session, const libtorrent::torrent_handle& handle) {
+    auto it = std::find_if(s_resolving.begin(), s_resolving.end(),
+                           [&handle](const std::pair<const std::string, Resolution>& pair) {
+                               return pair.second.handle == handle;
+                           });
+    if (it == s_resolving.end()) {
+        return false;
+    }
+    
+    if (saveMetadata(handle, it->first)) {
+        LOG_DEBUG("Métadonnées mises en cache: " + it->first);
+    } else {
+        s_failed.insert(it->first);
+    }
+    
+    session.remove_torrent(handle, libtorrent::session::delete_partfile);
+    s_resolving.erase(it);
+    return true;
+}
+
+void MetadataCache::update(libtorrent::session& session) {
+    int64_t now = Utils::getCurrentTimestamp();
+    
+    // Abandon des résolutions sans réponse (aucun peer ne détient le torrent)
+    for (auto it = s_resolving.begin(); it != s_resolving.end();) {
+        if (now - it->second.started_at >= s_timeout_s * 1000LL) {
+            LOG_DEBUG("Résolution expirée: " + it->first);
+            if (it->second.handle.is_valid()) {
+                session.remove_torrent(it->second.handle, libtorrent::session::delete_partfile);
+            }
+            s_failed.insert(it->first);
+            it = s_resolving.erase(it);
+        } else {
+            ++it;
+        }
+    }
+    
+    while (static_cast<int>(s_resolving.size()) < s_max_concurrent && !s_queue.empty()) {
+        std::string magnet = s_queue.front();
+        s_queue.erase(s_queue.begin());
+        
+        libtorrent::add_torrent_params params;
+        libtorrent::error_code ec;
+        libtorrent::parse_magnet_uri(magnet, params, ec);
+        if (ec) continue;
+        
+        std::string hash = hashKey(params);
+        if (s_resolving.count(hash) || s_failed.count(hash) || Utils::fileExists(cacheFile(hash))) {
+            continue;
+        }
+        
+        // Torrent déjà présent dans la session: ses métadonnées arriveront par ailleurs
+#if LIBTORRENT_VERSION_NUM >= 20000
+        if (session.find_torrent(params.info_hashes.get_best()).is_valid()) continue;
+#else
+        if (session.find_torrent(params.info_hash).is_valid()) continue;
+#endif
+
+        // Mode upload: métadonnées échangées, aucune pièce demandée
+        params.name = RESOLVER_PREFIX + hash;
+        params.save_path = s_cache_dir;
+        params.flags |= libtorrent::torrent_flags::upload_mode;
+        params.flags |= libtorrent::torrent_flags::duplicate_is_error;
+        params.flags &= ~libtorrent::torrent_flags::paused;
+        params.flags &= ~libtorrent::torrent_flags::auto_managed;
+        
+        s_resolving[hash] = Resolution{libtorrent::torrent_handle(), now};
+        session.async_add_torrent(std::move(params));
+    }
+}
+#endif
+
+void MetadataCache::clear() {
+    s_resolving.clear();
+    s_queue.clear();
+    s_failed.clear();
+    s_cancelled.clear();
+}
+
+// Méthodes privées
+std::string MetadataCache::cacheFile(const std::string& hash) {
+    return s_cache_dir + "/" + hash + ".torrent";
+}
+
+#ifndef NO_LIBTORRENT
+static std::string toHex(const libtorrent::sha1_hash& hash) {
+    static const char digits[] = "0123456789abcdef";
+    std::string hex;
+    hex.reserve(hash.size() * 2);
+    for (int i = 0; i < static_cast<int>(hash.size()); i++) {
+        unsigned char byte = static_cast<unsigned char>(hash.data()[i]);
+        hex += digits[byte >> 4];
+        hex += digits[byte & 0x0F];
+    }
+    return hex;
+}
+
+std::string MetadataCache::hashKey(const libtorrent::add_torrent_params& params) {
+#if LIBTORRENT_VERSION_NUM >= 20000
+    return toHex(params.info_hashes.get_best());
+#else
+    return toHex(params.info_hash);
+#endif
+}
+
+bool MetadataCache::saveMetadata(const libtorrent::torrent_handle& handle, const std::string& hash) {
+    try {
+        auto ti = handle.torrent_file();
+        if (!ti) return false;
+        
+        std::vector<char> data;
+        libtorrent::create_torrent torrent(*ti);
+        libtorrent::bencode(std::back_inserter(data), torrent.generate());
+        
+        // Écriture dans un fichier temporaire puis renommage: jamais de fichier tronqué en cache
+        std::string path = cacheFile(hash);
+        std::string temp_path = path + ".tmp";
+        {
+            std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+            if (!file.is_open()) return false;
+            file.write(data.data(), data.size());
+            if (!file.good()) return false;
+        }
+        
+        return std::rename(temp_path.c_str(), path.c_str()) == 0;
+    
+    } catch (const std::exception& e) {
+        LOG_ERROR("Erreur lors de la mise en cache des métadonnées " + hash + ": " + std::string(e.what()));
+        return false;
+    }
+}
+#endif
@@ -0,0 +1,528 @@
+/**
+ * PS4 Store P2P - Implémentation du Cache Mémoire des Pièces
+ */
+
+#include "p2p/piece_cache.h"
+#include "utils/utils.h"
+
+#ifndef NO_LIBTORRENT
+#include <libtorrent/session.hpp>
+#include <libtorrent/session_params.hpp>
+#include <libtorrent/settings_pack.hpp>
+#include <libtorrent/version.hpp>
+#if LIBTORRENT_VERSION_NUM >= 20000
+#include "p2p/disk_io_forwarder.h"
+#include <libtorrent/file_storage.hpp>
+#include <boost/asio/post.hpp>
+#endif
+#endif
+
+#include <algorithm>
+#include <cstring>
+
+#include <unistd.h>
+
+// Variables statiques
+PieceCacheConfig PieceCache::s_config;
+PieceCacheStats PieceCache::s_stats = {};
+std::list<PieceCache::Entry> PieceCache::s_lru;
+std::list<PieceCache::Entry> PieceCache::s_probation;
+int64_t PieceCache::s_probation_bytes = 0;
+std::unordered_map<uint64_t, std::list<PieceCache::Entry>::iterator> PieceCache::s_index;
+std::unordered_map<int, PieceCache::Geometry> PieceCache::s_storages;
+std::vector<uint8_t> PieceCache::s_sketch;
+std::vector<uint64_t> PieceCache::s_doorkeeper;
+uint64_t PieceCache::s_sketch_mask = 0;
+int64_t PieceCache::s_samples = 0;
+int64_t PieceCache::s_sample_limit = 0;
+int64_t PieceCache::s_clock = 0;
+std::mutex PieceCache::s_mutex;
+
+// Lignes du count-min et plafond des compteurs (4 bits)
+static const int SKETCH_ROWS = 4;
+static const uint8_t SKETCH_MAX = 15;
+
+// Flux séquentiels suivis par stockage
+static const size_t MAX_STREAMS = 4;
+
+// Part de la capacité réservée aux blocs lus en avance pas encore demandés (probation)
+static const int64_t PROBATION_DIVISOR = 8;
+
+static uint64_t mixKey(uint64_t key) {
+    // splitmix64: dispersion des clés voisines (blocs consécutifs)
+    key += 0x9E3779B97F4A7C15ULL;
+    key = (key ^ (key >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    key = (key ^ (key >> 27)) * 0x94D049BB133111EBULL;
+    return key ^ (key >> 31);
+}
+
+#if !defined(NO_LIBTORRENT) && LIBTORRENT_VERSION_NUM >= 20000
+namespace {
+
+/**
+ * Stockage de libtorrent précédé du cache: les lectures passent par
+ * PieceCache, les écritures et suppressions invalident les blocs concernés,
+ * tout le reste est transmis tel quel
+ */
+class CachedDiskIO final : public DiskIOForwarder {
+public:
+    using DiskIOForwarder::DiskIOForwarder;
+    
+    libtorrent::storage_holder new_torrent(libtorrent::storage_params const& params,
+                                           std::shared_ptr<void> const& torrent) override {
+        libtorrent::storage_holder holder = DiskIOForwarder::new_torrent(params, torrent);
+        int id = storageId(holder.index());
+        PieceCache::invalidate(id);
+        PieceCache::registerStorage(id, params.files.piece_length(), params.files.total_size());
+        return holder;
+    }
+    
+    void remove_torrent(libtorrent::storage_index_t storage) override {
+        PieceCache::invalidate(storageId(storage));
+        DiskIOForwarder::remove_torrent(storage);
+    }
+    
+    void async_read(libtorrent::storage_index_t storage, libtorrent::peer_request const& request,
+                    std::function<void(libtorrent::disk_buffer_holder, libtorrent::storage_error const&)> handler,
+                    libtorrent::disk_job_flags_t flags) override {
+        int id = storageId(storage);
+        int piece = static_cast<int>(request.piece);
+        std::vector<ReadAheadBlock> read_ahead;
+        
+        std::vector<char> block(PieceCache::BLOCK_SIZE);
+        bool hit = request.length <= PieceCache::BLOCK_SIZE &&
+                   PieceCache::lookup(id, piece, request.start, request.length, block.data(), &read_ahead);
+        
+        if (hit) {
+            // Réponse différée: libtorrent n'attend pas d'appel réentrant
+            libtorrent::disk_buffer_holder holder = copyBuffer(block.data(), request.length);
+            boost::asio::post(m_ioc, [handler = std::move(handler), holder = std::move(holder)]() mutable {
+                handler(std::move(holder), libtorrent::storage_error());
+            });
+        } else {
+            int start = request.start;
+            int length = request.length;
+            m_disk->async_read(storage, request,
+                [handler = std::move(handler), id, piece, start, length](libtorrent::disk_buffer_holder holder,
+                                                                       libtorrent::storage_error const& error) mutable {
+                    if (!error && holder) {
+                        PieceCache::offer(id, piece, start, holder.data(), std::min(length, static_cast<int>(holder.size())));
+                    }
+                    handler(std::move(holder), error);
+                }, flags);
+        }
+        
+        // Lecture anticipée: blocs suivants d'un flux séquentiel, destinés au cache seulement
+        for (const auto& ahead : read_ahead) {
+            libtorrent::peer_request next;
+            next.piece = libtorrent::piece_index_t(ahead.piece);
+            next.start = ahead.offset;
+            next.length = ahead.length;
+            m_disk->async_read(storage, next,
+                [id, ahead](libtorrent::disk_buffer_holder holder, libtorrent::storage_error const& error) {
+                    if (!error && holder) {
+                        PieceCache::offer(id, ahead.piece, ahead.offset, holder.data(),
+                                          std::min(ahead.length, static_cast<int>(holder.size())), true);
+                    }
+                }, flags);
+        }
+    }
+    
+    bool async_write(libtorrent::storage_index_t storage, libtorrent::peer_request const& request,
+                     char const* buffer, std::shared_ptr<libtorrent::disk_observer> observer,
+                     std::function<void(libtorrent::storage_error const&)> handler,
+                     libtorrent::disk_job_flags_t flags) override {
+        PieceCache::invalidate(storageId(storage), static_cast<int>(request.piece), request.start);
+        return m_disk->async_write(storage, request, buffer, std::move(observer), std::move(handler), flags);
+    }
+    
+    void async_check_files(libtorrent::storage_index_t storage, libtorrent::add_torrent_params const* resume_data,
+                           libtorrent::aux::vector<std::string, libtorrent::file_index_t> links,
+                           std::function<void(libtorrent::status_t, libtorrent::storage_error const&)> handler) override {
+        PieceCache::invalidate(storageId(storage));
+        m_disk->async_check_files(storage, resume_data, std::move(links), std::move(handler));
+    }
+    
+    void async_delete_files(libtorrent::storage_index_t storage, libtorrent::remove_flags_t options,
+                            std::function<void(libtorrent::storage_error const&)> handler) override {
+        PieceCache::invalidate(storageId(storage));
+        m_disk->async_delete_files(storage, options, std::move(handler));
+    }
+    
+    void async_clear_piece(libtorrent::storage_index_t storage, libtorrent::piece_index_t index,
+                           std::function<void(libtorrent::piece_index_t)> handler) override {
+        PieceCache::invalidate(storageId(storage), static_cast<int>(index));
+        m_disk->async_clear_piece(storage, index, std::move(handler));
+    }
+};
+
+} // namespace
+#endif
+
+void PieceCache::configure(const PieceCacheConfig& config) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_config = config;
+    s_config.read_ahead_blocks = std::max(0, config.read_ahead_blocks);
+    s_config.sequential_threshold = std::max(1, config.sequential_threshold);
+    
+    // Capacité bornée par la mémoire physique libre, lorsque le système l'expose
+    int64_t capacity = std::max<int64_t>(0, config.capacity);
+#ifdef _SC_AVPHYS_PAGES
+    long pages = sysconf(_SC_AVPHYS_PAGES);
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && page_size > 0) {
+        int64_t budget = static_cast<int64_t>(static_cast<double>(pages) * page_size * config.max_memory_fraction);
+        capacity = std::min(capacity, budget);
+    }
+#endif
+    s_config.capacity = capacity / BLOCK_SIZE * BLOCK_SIZE;
+    
+    s_lru.clear();
+    s_probation.clear();
+    s_probation_bytes = 0;
+    s_index.clear();
+    s_stats = {};
+    s_stats.capacity = s_config.capacity;
+    resetSketch(s_config.capacity / BLOCK_SIZE);
+    
+    LOG_INFO("Cache des pièces partagées: " + Utils::formatFileSize(s_config.capacity) +
+             (s_config.enabled ? "" : " (désactivé)") + ", lecture anticipée de " +
+             std::to_string(s_config.read_ahead_blocks) + " blocs");
+}
+
+PieceCacheConfig PieceCache::getConfig() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_config;
+}
+
+PieceCacheStats PieceCache::getStats() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_stats;
+}
+
+double PieceCache::getHitRate() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    int64_t requests = s_stats.hits + s_stats.misses;
+    return requests > 0 ? static_cast<double>(s_stats.hits) / requests : 0.0;
+}
+
+#ifndef NO_LIBTORRENT
+void PieceCache::install(libtorrent::session_params& params) {
+    PieceCacheConfig config = getConfig();
+    if (!config.enabled || config.capacity <= 0) return;
+
+#if LIBTORRENT_VERSION_NUM >= 20000
+    // Stockage déjà installé (par défaut: fichiers mappés) enveloppé par le cache
+    libtorrent::disk_io_constructor_type inner = DiskIOForwarder::innerConstructor(params);
+    params.disk_io_constructor = [inner](libtorrent::io_context& ioc, libtorrent::settings_interface const& settings,
+                                         libtorrent::counters& counters) -> std::unique_ptr<libtorrent::disk_interface> {
+        return std::unique_ptr<libtorrent::disk_interface>(new CachedDiskIO(ioc, inner(ioc, settings, counters)));
+    };
+#else
+    // libtorrent 1.2: cache de lecture intégré (ARC), taille en blocs de 16 KiB
+    params.settings.set_int(libtorrent::settings_pack::cache_size, static_cast<int>(config.capacity / BLOCK_SIZE));
+    params.settings.set_bool(libtorrent::settings_pack::use_read_cache, true);
+    params.settings.set_int(libtorrent::settings_pack::read_cache_line_size, std::max(1, config.read_ahead_blocks));
+    params.settings.set_int(libtorrent::settings_pack::suggest_mode, libtorrent::settings_pack::suggest_read_cache);
+#endif
+}
+#endif
+
+void PieceCache::registerStorage(int storage, int piece_length, int64_t total_size) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    Geometry& geometry = s_storages[storage];
+    geometry.id = storage;
+    geometry.piece_length = piece_length;
+    geometry.total_size = total_size;
+    geometry.streams.clear();
+}
+
+bool PieceCache::lookup(int storage, int piece, int offset, int length, char* out,
+                        std::vector<ReadAheadBlock>* read_ahead) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!s_config.enabled || s_config.capacity <= 0) return false;
+    
+    uint64_t key = makeKey(storage, piece, offset);
+    recordAccess(key);
+    
+    auto geometry = s_storages.find(storage);
+    if (read_ahead && geometry != s_storages.end() && s_config.read_ahead_blocks > 0) {
+        planReadAhead(geometry->second, piece, offset, length, *read_ahead);
+    }
+    
+    auto it = s_index.find(key);
+    if (offset % BLOCK_SIZE != 0 || it == s_index.end() || static_cast<int>(it->second->data.size()) < length) {
+        s_stats.misses++;
+        return false;
+    }
+    
+    Entry& entry = *it->second;
+    std::memcpy(out, entry.data.data(), length);
+    s_stats.hits++;
+    
+    if (!entry.probation) {
+        s_lru.splice(s_lru.begin(), s_lru, it->second);
+        return true;
+    }
+    
+    // Bloc lu en avance puis demandé: il quitte la probation s'il passe l'admission TinyLFU,
+    // sinon il y reste, rafraîchi
+    if (!entry.requested) {
+        entry.requested = true;
+        s_stats.read_ahead_hits++;
+    }
+    int64_t size = static_cast<int64_t>(entry.data.size());
+    if (makeRoom(key, size)) {
+        entry.probation = false;
+        s_probation_bytes -= size;
+        s_lru.splice(s_lru.begin(), s_probation, it->second);
+    } else {
+        s_probation.splice(s_probation.begin(), s_probation, it->second);
+    }
+    return true;
+}
+
+bool PieceCache::offer(int storage, int piece, int offset, const char* data, int length, bool read_ahead) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (!s_config.enabled || length <= 0 || length > BLOCK_SIZE || offset % BLOCK_SIZE != 0 ||
+        length > s_config.capacity) {
+        return false;
+    }
+    
+    uint64_t key = makeKey(storage, piece, offset);
+    if (s_index.count(key)) return true;
+    
+    // Lecture anticipée: segment de probation borné, jamais aux dépens des blocs déjà demandés,
+    // pour qu'un lecteur séquentiel ne vide pas les blocs populaires
+    if (read_ahead) {
+        if (length > probationCapacity()) return false;
+        while (s_probation_bytes + length > probationCapacity()) {
+            evictOne(s_probation);
+        }
+        
+        s_probation.push_front({key, std::vector<char>(data, data + length), true, false});
+        s_index[key] = s_probation.begin();
+        s_probation_bytes += length;
+        s_stats.bytes += length;
+        s_stats.admitted++;
+        s_stats.read_ahead++;
+        return true;
+    }
+    
+    if (length > s_config.capacity - probationCapacity()) return false;
+    if (!makeRoom(key, length)) {
+        s_stats.rejected++;
+        return false;
+    }
+    
+    s_lru.push_front({key, std::vector<char>(data, data + length), false, true});
+    s_index[key] = s_lru.begin();
+    s_stats.bytes += length;
+    s_stats.admitted++;
+    return true;
+}
+
+void PieceCache::invalidate(int storage, int piece, int offset) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    
+    if (piece >= 0 && offset >= 0) {
+        eraseKey(makeKey(storage, piece, offset - offset % BLOCK_SIZE));
+        return;
+    }
+    
+    // Pièce entière: ses blocs sont énumérés si la géométrie est connue
+    auto geometry = s_storages.find(storage);
+    if (piece >= 0 && geometry != s_storages.end()) {
+        for (int block = 0; block < geometry->second.piece_length; block += BLOCK_SIZE) {
+            eraseKey(makeKey(storage, piece, block));
+        }
+        return;
+    }
+    
+    const uint64_t storage_bits = static_cast<uint64_t>(storage & 0xFFFF) << 48;
+    const uint64_t piece_bits = static_cast<uint64_t>(static_cast<uint32_t>(piece)) << 16;
+    for (std::list<Entry>* segment : {&s_lru, &s_probation}) {
+        for (auto it = segment->begin(); it != segment->end();) {
+            bool match = (it->key & 0xFFFF000000000000ULL) == storage_bits &&
+                         (piece < 0 || (it->key & 0x0000FFFFFFFF0000ULL) == piece_bits);
+            if (match) {
+                s_stats.bytes -= static_cast<int64_t>(it->data.size());
+                if (it->probation) s_probation_bytes -= static_cast<int64_t>(it->data.size());
+                s_index.erase(it->key);
+                it = segment->erase(it);
+            } else {
+                ++it;
+            }
+        }
+    }
+    if (piece < 0) {
+        s_storages.erase(storage);
+    }
+}
+
+void PieceCache::clear() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_lru.clear();
+    s_probation.clear();
+    s_probation_bytes = 0;
+    s_index.clear();
+    s_storages.clear();
+    s_stats = {};
+    s_stats.capacity = s_config.capacity;
+    resetSketch(s_config.capacity / BLOCK_SIZE);
+}
+
+// Méthodes privées
+uint64_t PieceCache::makeKey(int storage, int piece, int offset) {
+    return (static_cast<uint64_t>(storage & 0xFFFF) << 48) |
+           (static_cast<uint64_t>(static_cast<uint32_t>(piece)) << 16) |
+           static_cast<uint64_t>((offset / BLOCK_SIZE) & 0xFFFF);
+}
+
+void PieceCache::recordAccess(uint64_t key) {
+    if (s_sketch.empty()) return;
+    
+    uint64_t hash = mixKey(key);
+    size_t width = static_cast<size_t>(s_sketch_mask) + 1;
+    
+    // Première occurrence: seulement le filtre, les blocs vus une fois ne polluent pas le sketch
+    uint64_t bit_a = hash % (s_doorkeeper.size() * 64);
+    uint64_t bit_b = (hash >> 32) % (s_doorkeeper.size() * 64);
+    bool seen = (s_doorkeeper[bit_a / 64] >> (bit_a % 64) & 1) && (s_doorkeeper[bit_b / 64] >> (bit_b % 64) & 1);
+    if (!seen) {
+        s_doorkeeper[bit_a / 64] |= 1ULL << (bit_a % 64);
+        s_doorkeeper[bit_b / 64] |= 1ULL << (bit_b % 64);
+    } else {
+        // Mise à jour conservatrice: seuls les compteurs minimaux augmentent
+        int minimum = estimateFrequency(key) - 1;
+        for (int row = 0; row < SKETCH_ROWS; row++) {
+            uint8_t& counter = s_sketch[row * width + ((hash >> (row * 16)) & s_sketch_mask)];
+            if (counter == minimum && counter < SKETCH_MAX) counter++;
+        }
+    }
+    
+    // Vieillissement: après une fenêtre d'échantillons, toutes les fréquences sont divisées par deux
+    if (++s_samples >= s_sample_limit) {
+        for (auto& counter : s_sketch) counter >>= 1;
+        std::fill(s_doorkeeper.begin(), s_doorkeeper.end(), 0);
+        s_samples /= 2;
+    }
+}
+
+int PieceCache::estimateFrequency(uint64_t key) {
+    if (s_sketch.empty()) return 0;
+    
+    uint64_t hash = mixKey(key);
+    size_t width = static_cast<size_t>(s_sketch_mask) + 1;
+    int frequency = SKETCH_MAX;
+    for (int row = 0; row < SKETCH_ROWS; row++) {
+        frequency = std::min<int>(frequency, s_sketch[row * width + ((hash >> (row * 16)) & s_sketch_mask)]);
+    }
+    
+    uint64_t bit_a = hash % (s_doorkeeper.size() * 64);
+    uint64_t bit_b = (hash >> 32) % (s_doorkeeper.size() * 64);
+    bool seen = (s_doorkeeper[bit_a / 64] >> (bit_a % 64) & 1) && (s_doorkeeper[bit_b / 64] >> (bit_b % 64) & 1);
+    return frequency + (seen ? 1 : 0);
+}
+
+void PieceCache::resetSketch(int64_t capacity_blocks) {
+    // Largeur: puissance de deux d'au moins 4 compteurs par bloc du cache
+    size_t width = 1024;
+    while (static_cast<int64_t>(width) < capacity_blocks * 4) width <<= 1;
+    
+    s_sketch.assign(width * SKETCH_ROWS, 0);
+    s_sketch_mask = width - 1;
+    s_doorkeeper.assign(width / 8, 0);
+    s_samples = 0;
+    s_sample_limit = std::max<int64_t>(1024, capacity_blocks * 10);
+}
+
+int64_t PieceCache::probationCapacity() {
+    if (s_config.read_ahead_blocks <= 0) return 0;
+    return s_config.capacity / PROBATION_DIVISOR / BLOCK_SIZE * BLOCK_SIZE;
+}
+
+bool PieceCache::makeRoom(uint64_t key, int64_t length) {
+    const int64_t capacity = s_config.capacity - probationCapacity();
+    
+    // Segment principal plein: le candidat doit être plus demandé que la victime (TinyLFU)
+    if (s_stats.bytes - s_probation_bytes + length > capacity && !s_lru.empty()) {
+        if (estimateFrequency(key) <= estimateFrequency(s_lru.back().key)) {
+            return false;
+        }
+    }
+    while (s_stats.bytes - s_probation_bytes + length > capacity && !s_lru.empty()) {
+        evictOne(s_lru);
+    }
+    return true;
+}
+
+void PieceCache::evictOne(std::list<Entry>& segment) {
+    Entry& victim = segment.back();
+    s_stats.bytes -= static_cast<int64_t>(victim.data.size());
+    if (victim.probation) s_probation_bytes -= static_cast<int64_t>(victim.data.size());
+    s_stats.evictions++;
+    s_index.erase(victim.key);
+    segment.pop_back();
+}
+
+void PieceCache::eraseKey(uint64_t key) {
+    auto it = s_index.find(key);
+    if (it == s_index.end()) return;
+    
+    s_stats.bytes -= static_cast<int64_t>(it->second->data.size());
+    if (it->second->probation) {
+        s_probation_bytes -= static_cast<int64_t>(it->second->data.size());
+        s_probation.erase(it->second);
+    } else {
+        s_lru.erase(it->second);
+    }
+    s_index.erase(it);
+}
+
+void PieceCache::planReadAhead(Geometry& geometry, int piece, int offset, int length,
+                               std::vector<ReadAheadBlock>& read_ahead) {
+    if (geometry.piece_length <= 0) return;
+    
+    int64_t position = static_cast<int64_t>(piece) * geometry.piece_length + offset;
+    int64_t end = position + length;
+    
+    // Flux dont cette requête est la suite, sinon nouveau flux à la place du moins récent
+    auto stream = std::find_if(geometry.streams.begin(), geometry.streams.end(), [position](const Stream& s) {
+        return s.next == position;
+    });
+    if (stream == geometry.streams.end()) {
+        if (geometry.streams.size() < MAX_STREAMS) {
+            geometry.streams.push_back({end, end, 1, ++s_clock});
+        } else {
+            auto oldest = std::min_element(geometry.streams.begin(), geometry.streams.end(),
+                [](const Stream& a, const Stream& b) { return a.last_used < b.last_used; });
+            *oldest = {end, end, 1, ++s_clock};
+        }
+        return;
+    }
+    
+    stream->next = end;
+    stream->run++;
+    stream->last_used = ++s_clock;
+    if (stream->run < s_config.sequential_threshold) return;
+    
+    // Blocs suivants jusqu'à la fenêtre de lecture anticipée, sans redemander ceux déjà lus
+    int64_t target = std::min(end + static_cast<int64_t>(s_config.read_ahead_blocks) * BLOCK_SIZE,
+                              geometry.total_size);
+    int64_t next = std::max(stream->prefetched, end);
+    next = (next + BLOCK_SIZE - 1) / BLOCK_SIZE * BLOCK_SIZE;
+    
+    for (; next < target; next += BLOCK_SIZE) {
+        int block_piece = static_cast<int>(next / geometry.piece_length);
+        int block_offset = static_cast<int>(next % geometry.piece_length);
+        int64_t piece_end = std::min(static_cast<int64_t>(block_piece + 1) * geometry.piece_length,
+                                     geometry.total_size);
+        int block_length = static_cast<int>(std::min<int64_t>(BLOCK_SIZE, piece_end - next));
+        
+        if (block_length > 0 && !s_index.count(makeKey(geometry.id, block_piece, block_offset))) {
+            read_ahead.push_back({block_piece, block_offset, block_length});
+        }
+    }
+    stream->prefetched = std::max(stream->prefetched, target);
+}
@@ -0,0 +1,329 @@
+/**
+ * PS4 Store P2P - Implémentation du Planificateur de Pièces PKG
+ */
+
+#include "p2p/piece_planner.h"
+#include "utils/utils.h"
+
+#ifndef NO_LIBTORRENT
+#include <libtorrent/torrent_handle.hpp>
+#include <libtorrent/torrent_status.hpp>
+#include <libtorrent/torrent_info.hpp>
+#include <libtorrent/file_storage.hpp>
+#endif
+
+#include <algorithm>
+#include <fstream>
+#include <set>
+
+// Entrée interne: état public, handle et découpage du fichier PKG
+struct PiecePlanner::PlanEntry {
+    PiecePlan info;
+#ifndef NO_LIBTORRENT
+    libtorrent::torrent_handle handle;
+#endif
+    int file_index = -1;
+    int first_piece = 0;        // Première pièce du fichier PKG
+    int last_piece = -1;        // Dernière pièce du fichier PKG
+    int deadline_end = 0;       // Pièces < deadline_end déjà dotées d'une échéance
+    std::set<int> head;         // Pièces de métadonnées PKG
+    bool head_refined = false;  // Table des entrées analysée
+    int refine_attempts = 0;
+};
+
+// Variables statiques
+std::map<std::string, PiecePlanner::PlanEntry> PiecePlanner::s_plans;
+PiecePlannerConfig PiecePlanner::s_config;
+int64_t PiecePlanner::s_last_tick = 0;
+
+// Période de réévaluation
+static const int64_t PLANNER_TICK_MS = 1000;
+
+// Tentatives de lecture de la table des entrées (données pas encore écrites sur disque)
+static const int MAX_REFINE_ATTEMPTS = 10;
+
+// Format PKG PS4 (champs big-endian)
+static const uint32_t PKG_MAGIC = 0x7F434E54;
+static const int PKG_ENTRY_COUNT_OFFSET = 0x10;
+static const int PKG_TABLE_OFFSET_OFFSET = 0x18;
+static const int PKG_ENTRY_SIZE = 32;
+static const int PKG_ENTRY_DATA_OFFSET = 16;
+static const int PKG_ENTRY_DATA_SIZE = 20;
+static const uint32_t PKG_MAX_ENTRIES = 4096;
+static const uint32_t PKG_ENTRY_PARAM_SFO = 0x1000;
+static const uint32_t PKG_ENTRY_ICON0 = 0x1200;
+
+static uint32_t readBigEndian32(const unsigned char* data) {
+    return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) |
+           (static_cast<uint32_t>(data[2]) << 8) | static_cast<uint32_t>(data[3]);
+}
+
+void PiecePlanner::configure(const PiecePlannerConfig& config) {
+    s_config = config;
+    s_config.min_window_pieces = std::max(1, config.min_window_pieces);
+    s_config.max_window_pieces = std::max(s_config.min_window_pieces, config.max_window_pieces);
+}
+
+PiecePlannerConfig PiecePlanner::getConfig() {
+    return s_config;
+}
+
+#ifndef NO_LIBTORRENT
+void PiecePlanner::track(const std::string& name, const libtorrent::torrent_handle& handle) {
+    PlanEntry entry;
+    entry.info = {name, PiecePhase::WAITING_METADATA, 0, 0, 0};
+    entry.handle = handle;
+    s_plans[name] = entry;
+}
+#endif
+
+void PiecePlanner::untrack(const std::string& name) {
+    s_plans.erase(name);
+}
+
+void PiecePlanner::update() {
+#ifndef NO_LIBTORRENT
+    int64_t now = Utils::getCurrentTimestamp();
+    if (now - s_last_tick < PLANNER_TICK_MS) return;
+    s_last_tick = now;
+    
+    for (auto& pair : s_plans) {
+        PlanEntry& entry = pair.second;
+        if (entry.info.phase == PiecePhase::DISABLED || !entry.handle.is_valid()) continue;
+        
+        try {
+            libtorrent::torrent_status status = entry.handle.status(
+                libtorrent::torrent_handle::query_pieces |
+                libtorrent::torrent_handle::query_distributed_copies);
+            
+            // En attente dans la file: rien à ordonner
+            if (status.paused || status.is_finished) continue;
+            
+            if (entry.info.phase == PiecePhase::WAITING_METADATA) {
+                if (!status.has_metadata) continue;
+                if (!preparePlan(entry)) {
+                    entry.info.phase = PiecePhase::DISABLED;
+                    continue;
+                }
+            }
+            
+            if (entry.info.phase == PiecePhase::HEAD) {
+                bool head_done = std::all_of(entry.head.begin(), entry.head.end(), [&status](int piece) {
+                    return status.pieces[libtorrent::piece_index_t(piece)];
+                });
+                if (!head_done) continue;
+                
+                // En-tête reçu: param.sfo et icône peuvent se trouver plus loin
+                if (!entry.head_refined && refineHead(entry, status)) continue;
+                
+                LOG_DEBUG("Métadonnées PKG reçues: " + entry.info.name);
+                entry.info.phase = PiecePhase::RAREST_FIRST;
+            }
+            
+            bool healthy = status.num_seeds >= s_config.min_seeds ||
+                           status.distributed_copies >= s_config.min_distributed_copies;
+            
+            if (healthy) {
+                entry.info.phase = PiecePhase::SEQUENTIAL;
+                advanceWindow(entry, status);
+            } else if (entry.info.phase == PiecePhase::SEQUENTIAL) {
+                // Essaim affaibli: retour au rarest-first pour préserver les pièces rares
+                entry.handle.clear_piece_deadlines();
+                entry.deadline_end = 0;
+                entry.info.window = 0;
+                entry.info.phase = PiecePhase::RAREST_FIRST;
+                LOG_DEBUG("Retour au rarest-first: " + entry.info.name);
+            }
+        
+        } catch (const std::exception& e) {
+            LOG_ERROR("Erreur du planificateur de pièces pour " + entry.info.name + ": " + std::string(e.what()));
+            entry.info.phase = PiecePhase::DISABLED;
+        }
+    }
+#endif
+}
+
+PiecePlan PiecePlanner::getPlan(const std::string& name) {
+    auto it = s_plans.find(name);
+    if (it == s_plans.end()) {
+        return {name, PiecePhase::DISABLED, 0, 0, 0};
+    }
+    return it->second.info;
+}
+
+std::string PiecePlanner::getPhaseString(PiecePhase phase) {
+    switch (phase) {
+        case PiecePhase::WAITING_METADATA: return "Métadonnées";
+        case PiecePhase::HEAD:             return "En-tête PKG";
+        case PiecePhase::SEQUENTIAL:       return "Séquentiel";
+        case PiecePhase::RAREST_FIRST:     return "Pièces rares";
+        case PiecePhase::DISABLED:         return "Standard";
+        default:                           return "Inconnu";
+    }
+}
+
+void PiecePlanner::clear() {
+    s_plans.clear();
+    s_last_tick = 0;
+}
+
+// Méthodes privées
+#ifndef NO_LIBTORRENT
+bool PiecePlanner::preparePlan(PlanEntry& entry) {
+    auto ti = entry.handle.torrent_file();
+    if (!ti) return false;
+    
+    // Le plus gros fichier .pkg du torrent
+    const libtorrent::file_storage& files = ti->files();
+    int64_t largest = 0;
+    for (int i = 0; i < files.num_files(); i++) {
+        libtorrent::file_index_t index(i);
+        if (Utils::endsWith(Utils::toLowerCase(files.file_name(index)), ".pkg") &&
+            files.file_size(index) > largest) {
+            largest = files.file_size(index);
+            entry.file_index = i;
+        }
+    }
+    
+    if (entry.file_index < 0) {
+        LOG_DEBUG("Aucun fichier PKG, sélection standard: " + entry.info.name);
+        return false;
+    }
+    
+    libtorrent::file_index_t index(entry.file_index);
+    int64_t file_size = files.file_size(index);
+    entry.first_piece = static_cast<int>(ti->map_file(index, 0, 1).piece);
+    entry.last_piece = static_cast<int>(ti->map_file(index, file_size - 1, 1).piece);
+    entry.deadline_end = entry.first_piece;
+    
+    std::vector<int> pieces;
+    addRange(entry, 0, std::min(s_config.head_bytes, file_size), pieces);
+    prioritizeHead(entry, pieces);
+    
+    entry.info.phase = PiecePhase::HEAD;
+    LOG_DEBUG("Téléchargement PKG ordonné: " + entry.info.name + " (" +
+              std::to_string(pieces.size()) + " pièces d'en-tête)");
+    return true;
+}
+
+void PiecePlanner::prioritizeHead(PlanEntry& entry, const std::vector<int>& pieces) {
+    std::vector<std::pair<libtorrent::piece_index_t, libtorrent::download_priority_t>> priorities;
+    int rank = 0;
+    
+    for (int piece : pieces) {
+        priorities.emplace_back(libtorrent::piece_index_t(piece), libtorrent::top_priority);
+        entry.handle.set_piece_deadline(libtorrent::piece_index_t(piece), ++rank * s_config.deadline_step_ms);
+    }
+    
+    entry.handle.prioritize_pieces(priorities);
+    entry.info.head_pieces = static_cast<int>(entry.head.size());
+}
+
+bool PiecePlanner::refineHead(PlanEntry& entry, const libtorrent::torrent_status& status) {
+    auto ti = entry.handle.torrent_file();
+    if (!ti) return false;
+    
+    libtorrent::file_index_t index(entry.file_index);
+    const libtorrent::file_storage& files = ti->files();
+    int64_t file_size = files.file_size(index);
+    std::string path = status.save_path + "/" + files.file_path(index);
+    
+    // Les pièces reçues peuvent ne pas encore être écrites: nouvelle tentative au tick suivant
+    auto retry = [&entry]() {
+        entry.head_refined = ++entry.refine_attempts >= MAX_REFINE_ATTEMPTS;
+        return !entry.head_refined;
+    };
+    
+    std::ifstream file(path, std::ios::binary);
+    unsigned char header[0x20];
+    if (!file.is_open() || !file.read(reinterpret_cast<char*>(header), sizeof(header)) ||
+        readBigEndian32(header) != PKG_MAGIC) {
+        return retry();
+    }
+    
+    uint32_t entry_count = std::min(readBigEndian32(header + PKG_ENTRY_COUNT_OFFSET), PKG_MAX_ENTRIES);
+    uint32_t table_offset = readBigEndian32(header + PKG_TABLE_OFFSET_OFFSET);
+    int64_t table_size = static_cast<int64_t>(entry_count) * PKG_ENTRY_SIZE;
+    
+    if (table_offset + table_size > file_size) {
+        entry.head_refined = true;
+        return false;
+    }
+    
+    // Table des entrées hors de l'en-tête: on la récupère d'abord
+    std::vector<int> pieces;
+    if (table_offset + table_size > s_config.head_bytes) {
+        addRange(entry, table_offset, table_size, pieces);
+        if (!pieces.empty()) {
+            prioritizeHead(entry, pieces);
+            return true;
+        }
+    }
+    
+    std::vector<unsigned char> table(table_size);
+    file.seekg(table_offset);
+    if (!file.read(reinterpret_cast<char*>(table.data()), table_size)) {
+        return retry();
+    }
+    
+    for (uint32_t i = 0; i < entry_count; i++) {
+        const unsigned char* raw = table.data() + i * PKG_ENTRY_SIZE;
+        uint32_t id = readBigEndian32(raw);
+        if (id != PKG_ENTRY_PARAM_SFO && id != PKG_ENTRY_ICON0) continue;
+        
+        int64_t offset = readBigEndian32(raw + PKG_ENTRY_DATA_OFFSET);
+        int64_t size = readBigEndian32(raw + PKG_ENTRY_DATA_SIZE);
+        if (size > 0 && offset + size <= file_size) {
+            addRange(entry, offset, size, pieces);
+        }
+    }
+    
+    entry.head_refined = true;
+    if (pieces.empty()) return false;
+    
+    prioritizeHead(entry, pieces);
+    return true;
+}
+
+void PiecePlanner::advanceWindow(PlanEntry& entry, const libtorrent::torrent_status& status) {
+    // Curseur: première pièce manquante du corps
+    int cursor = entry.first_piece;
+    while (cursor <= entry.last_piece && status.pieces[libtorrent::piece_index_t(cursor)]) {
+        cursor++;
+    }
+    entry.info.cursor = cursor;
+    if (cursor > entry.last_piece) return;
+    
+    // Fenêtre dimensionnée sur le débit courant
+    auto ti = entry.handle.torrent_file();
+    int piece_length = ti ? std::max(1, ti->piece_length()) : 1;
+    int64_t window_bytes = static_cast<int64_t>(status.download_payload_rate) * s_config.window_seconds;
+    int window = static_cast<int>(std::min<int64_t>(window_bytes / piece_length, s_config.max_window_pieces));
+    window = std::max(window, s_config.min_window_pieces);
+    entry.info.window = window;
+    
+    // Échéances croissantes pour les pièces entrant dans la fenêtre
+    int end = std::min(cursor + window, entry.last_piece + 1);
+    for (int piece = std::max(cursor, entry.deadline_end); piece < end; piece++) {
+        if (status.pieces[libtorrent::piece_index_t(piece)]) continue;
+        entry.handle.set_piece_deadline(libtorrent::piece_index_t(piece),
+                                        (piece - cursor + 1) * s_config.deadline_step_ms);
+    }
+    entry.deadline_end = std::max(entry.deadline_end, end);
+}
+
+void PiecePlanner::addRange(PlanEntry& entry, int64_t offset, int64_t size, std::vector<int>& pieces) {
+    auto ti = entry.handle.torrent_file();
+    if (!ti || size <= 0) return;
+    
+    libtorrent::file_index_t index(entry.file_index);
+    int first = static_cast<int>(ti->map_file(index, offset, 1).piece);
+    int last = static_cast<int>(ti->map_file(index, offset + size - 1, 1).piece);
+    
+    for (int piece = first; piece <= last; piece++) {
+        if (entry.head.insert(piece).second) {
+            pieces.push_back(piece);
+        }
+    }
+}
+#endif
@@ -0,0 +1,454 @@
+/**
+ * PS4 Store P2P - Implémentation du Service de Scrape UDP
+ */
+
+#include "p2p/scrape_service.h"
+#include "p2p/ip_blocklist.h"
+#include "utils/utils.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstring>
+#include <random>
+
+#include <unistd.h>
+#include <netdb.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <netinet/in.h>
+
+// Entrée de cache d'un essaim
+struct ScrapeService::SwarmEntry {
+    std::vector<std::string> trackers;
+    SwarmCounts counts = {-1, -1, -1, 0};
+    int64_t next_refresh = 0;   // Pas de nouveau scrape avant ce timestamp (ms)
+    bool pending = false;
+};
+
+// État d'un tracker (connexion BEP 15 et recul après échec)
+struct ScrapeService::TrackerState {
+    sockaddr_storage address;
+    socklen_t address_length = 0;
+    uint64_t connection_id = 0;
+    int64_t connected_at = 0;
+    int64_t backoff_until = 0;
+    int failures = 0;
+};
+
+// Variables statiques
+std::map<std::string, ScrapeService::SwarmEntry> ScrapeService::s_entries;
+std::map<std::string, std::string> ScrapeService::s_magnet_hashes;
+std::map<std::string, ScrapeService::TrackerState> ScrapeService::s_trackers;
+std::vector<std::string> ScrapeService::s_pending;
+std::vector<std::string> ScrapeService::s_default_trackers;
+int ScrapeService::s_ttl_s = 1800;
+
+std::mutex ScrapeService::s_mutex;
+std::condition_variable ScrapeService::s_wakeup;
+std::thread ScrapeService::s_worker;
+std::atomic<bool> ScrapeService::s_running(false);
+
+// Protocole UDP tracker (BEP 15)
+static const uint64_t UDP_PROTOCOL_ID = 0x41727101980ULL;
+static const uint32_t ACTION_CONNECT = 0;
+static const uint32_t ACTION_SCRAPE = 2;
+static const uint32_t ACTION_ERROR = 3;
+static const int64_t CONNECTION_ID_LIFETIME_MS = 60000;
+
+// Délais réseau
+static const int RESPONSE_TIMEOUT_MS = 2000;
+static const int MAX_ATTEMPTS = 2;
+static const int64_t RETRY_DELAY_MS = 5 * 60 * 1000;    // Nouvel essai d'un essaim sans réponse
+static const int64_t MAX_BACKOFF_MS = 10 * 60 * 1000;
+
+static void writeUint32(std::vector<uint8_t>& buffer, uint32_t value) {
+    for (int shift = 24; shift >= 0; shift -= 8) {
+        buffer.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+static void writeUint64(std::vector<uint8_t>& buffer, uint64_t value) {
+    writeUint32(buffer, static_cast<uint32_t>(value >> 32));
+    writeUint32(buffer, static_cast<uint32_t>(value));
+}
+
+static uint32_t readUint32(const uint8_t* data) {
+    return (static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) |
+           (static_cast<uint32_t>(data[2]) << 8) | static_cast<uint32_t>(data[3]);
+}
+
+static uint64_t readUint64(const uint8_t* data) {
+    return (static_cast<uint64_t>(readUint32(data)) << 32) | readUint32(data + 4);
+}
+
+static uint32_t nextTransactionId() {
+    static std::mt19937 generator(std::random_device{}());
+    return generator();
+}
+
+// Décodage des paramètres de lien magnet (%XX)
+static std::string urlDecode(const std::string& value) {
+    std::string result;
+    for (size_t i = 0; i < value.size(); i++) {
+        if (value[i] == '%' && i + 2 < value.size() && isxdigit(value[i + 1]) && isxdigit(value[i + 2])) {
+            result += static_cast<char>(std::stoi(value.substr(i + 1, 2), nullptr, 16));
+            i += 2;
+        } else if (value[i] == '+') {
+            result += ' ';
+        } else {
+            result += value[i];
+        }
+    }
+    return result;
+}
+
+static bool decodeHex(const std::string& hex, std::string& raw) {
+    raw.clear();
+    for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+        if (!isxdigit(hex[i]) || !isxdigit(hex[i + 1])) return false;
+        raw += static_cast<char>(std::stoi(hex.substr(i, 2), nullptr, 16));
+    }
+    return raw.size() == 20;
+}
+
+static bool decodeBase32(const std::string& text, std::string& raw) {
+    raw.clear();
+    uint32_t buffer = 0;
+    int bits = 0;
+    
+    for (char c : text) {
+        int value;
+        if (c >= 'A' && c <= 'Z') value = c - 'A';
+        else if (c >= 'a' && c <= 'z') value = c - 'a';
+        else if (c >= '2' && c <= '7') value = c - '2' + 26;
+        else return false;
+        
+        buffer = (buffer << 5) | value;
+        bits += 5;
+        if (bits >= 8) {
+            bits -= 8;
+            raw += static_cast<char>((buffer >> bits) & 0xFF);
+        }
+    }
+    return raw.size() == 20;
+}
+
+int ScrapeService::initialize() {
+    if (s_running) return 0;
+    
+    s_running = true;
+    s_worker = std::thread(workerLoop);
+    
+    LOG_INFO("Service de scrape démarré");
+    return 0;
+}
+
+void ScrapeService::cleanup() {
+    if (!s_running) return;
+    
+    s_running = false;
+    s_wakeup.notify_all();
+    if (s_worker.joinable()) {
+        s_worker.join();
+    }
+    
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_entries.clear();
+    s_magnet_hashes.clear();
+    s_pending.clear();
+    s_trackers.clear();
+    
+    LOG_INFO("Service de scrape arrêté");
+}
+
+void ScrapeService::setDefaultTrackers(const std::vector<std::string>& trackers) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_default_trackers.clear();
+    for (const auto& tracker : trackers) {
+        if (Utils::startsWith(tracker, "udp://")) {
+            s_default_trackers.push_back(tracker);
+        }
+    }
+}
+
+void ScrapeService::setTtl(int seconds) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_ttl_s = std::max(1, seconds);
+}
+
+void ScrapeService::requestRefresh(const std::vector<std::string>& magnet_links) {
+    int64_t now = Utils::getCurrentTimestamp();
+    bool queued = false;
+    
+    std::lock_guard<std::mutex> lock(s_mutex);
+    for (const auto& magnet : magnet_links) {
+        auto known = s_magnet_hashes.find(magnet);
+        if (known == s_magnet_hashes.end()) {
+            std::string hash;
+            std::vector<std::string> trackers;
+            if (!parseMagnet(magnet, hash, trackers)) continue;
+            
+            SwarmEntry& entry = s_entries[hash];
+            for (const auto& tracker : trackers.empty() ? s_default_trackers : trackers) {
+                if (std::find(entry.trackers.begin(), entry.trackers.end(), tracker) == entry.trackers.end()) {
+                    entry.trackers.push_back(tracker);
+                }
+            }
+            known = s_magnet_hashes.emplace(magnet, hash).first;
+        }
+        
+        SwarmEntry& entry = s_entries[known->second];
+        if (!entry.pending && !entry.trackers.empty() && now >= entry.next_refresh) {
+            entry.pending = true;
+            s_pending.push_back(known->second);
+            queued = true;
+        }
+    }
+    
+    if (queued) {
+        s_wakeup.notify_one();
+    }
+}
+
+bool ScrapeService::getCounts(const std::string& magnet_link, SwarmCounts& counts) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    
+    auto known = s_magnet_hashes.find(magnet_link);
+    if (known == s_magnet_hashes.end()) return false;
+    
+    const SwarmEntry& entry = s_entries[known->second];
+    if (entry.counts.updated_at == 0) return false;
+    
+    counts = entry.counts;
+    return true;
+}
+
+bool ScrapeService::parseMagnet(const std::string& magnet_link, std::string& info_hash,
+                                std::vector<std::string>& trackers) {
+    info_hash.clear();
+    trackers.clear();
+    
+    size_t query = magnet_link.find('?');
+    if (!Utils::startsWith(magnet_link, "magnet:") || query == std::string::npos) {
+        return false;
+    }
+    
+    for (const std::string& param : Utils::split(magnet_link.substr(query + 1), '&')) {
+        if (Utils::startsWith(param, "xt=urn:btih:")) {
+            std::string value = param.substr(12);
+            bool valid = value.size() == 40 ? decodeHex(value, info_hash) :
+                         value.size() == 32 ? decodeBase32(value, info_hash) : false;
+            if (!valid) info_hash.clear();
+        } else if (Utils::startsWith(param, "tr=")) {
+            std::string tracker = urlDecode(param.substr(3));
+            if (Utils::startsWith(tracker, "udp://")) {
+                trackers.push_back(tracker);
+            }
+        }
+    }
+    
+    return info_hash.size() == 20;
+}
+
+// Méthodes privées
+void ScrapeService::workerLoop() {
+    while (s_running) {
+        // Regroupement des info-hashes en attente par tracker
+        std::map<std::string, std::vector<std::string>> batches;
+        std::vector<std::string> hashes;
+        {
+            std::unique_lock<std::mutex> lock(s_mutex);
+            s_wakeup.wait_for(lock, std::chrono::seconds(1), []() {
+                return !s_running || !s_pending.empty();
+            });
+            if (!s_running) break;
+            
+            hashes.swap(s_pending);
+            for (const auto& hash : hashes) {
+                for (const auto& tracker : s_entries[hash].trackers) {
+                    batches[tracker].push_back(hash);
+                }
+            }
+        }
+        
+        if (hashes.empty()) continue;
+        
+        std::map<std::string, SwarmCounts> results;
+        for (const auto& batch : batches) {
+            for (size_t start = 0; start < batch.second.size() && s_running; start += MAX_HASHES_PER_SCRAPE) {
+                size_t end = std::min(batch.second.size(), start + MAX_HASHES_PER_SCRAPE);
+                std::vector<std::string> chunk(batch.second.begin() + start, batch.second.begin() + end);
+                if (!scrapeTracker(batch.first, chunk, results)) break;
+            }
+        }
+        
+        int64_t now = Utils::getCurrentTimestamp();
+        std::lock_guard<std::mutex> lock(s_mutex);
+        for (const auto& hash : hashes) {
+            SwarmEntry& entry = s_entries[hash];
+            entry.pending = false;
+            
+            auto result = results.find(hash);
+            if (result != results.end()) {
+                entry.counts = result->second;
+                entry.counts.updated_at = now;
+                entry.next_refresh = now + s_ttl_s * 1000LL;
+            } else {
+                entry.next_refresh = now + std::min<int64_t>(RETRY_DELAY_MS, s_ttl_s * 1000LL);
+            }
+        }
+        
+        LOG_DEBUG("Scrape terminé: " + std::to_string(results.size()) + "/" +
+                  std::to_string(hashes.size()) + " essaims");
+    }
+}
+
+bool ScrapeService::scrapeTracker(const std::string& tracker, const std::vector<std::string>& hashes,
+                                  std::map<std::string, SwarmCounts>& results) {
+    TrackerState& state = s_trackers[tracker];
+    int64_t now = Utils::getCurrentTimestamp();
+    if (now < state.backoff_until) return false;
+    
+    // Résolution de l'adresse (une seule fois par tracker)
+    if (state.address_length == 0) {
+        std::string host_port = tracker.substr(6);
+        host_port = host_port.substr(0, host_port.find('/'));
+        size_t colon = host_port.rfind(':');
+        if (colon == std::string::npos) return false;
+        
+        std::string host = host_port.substr(0, colon);
+        std::string port = host_port.substr(colon + 1);
+        if (!host.empty() && host.front() == '[' && host.back() == ']') {
+            host = host.substr(1, host.size() - 2);
+        }
+        
+        addrinfo hints = {};
+        hints.ai_family = AF_UNSPEC;
+        hints.ai_socktype = SOCK_DGRAM;
+        addrinfo* info = nullptr;
+        if (getaddrinfo(host.c_str(), port.c_str(), &hints, &info) != 0 || !info) {
+            LOG_DEBUG("Tracker introuvable: " + tracker);
+            state.backoff_until = now + MAX_BACKOFF_MS;
+            return false;
+        }
+        
+        std::memcpy(&state.address, info->ai_addr, info->ai_addrlen);
+        state.address_length = static_cast<socklen_t>(info->ai_addrlen);
+        freeaddrinfo(info);
+    }
+    
+    // Trackers listés comme malveillants: jamais contactés
+    if (state.address.ss_family == AF_INET) {
+        const sockaddr_in* ipv4 = reinterpret_cast<const sockaddr_in*>(&state.address);
+        if (IpBlocklist::isBlocked(ntohl(ipv4->sin_addr.s_addr))) {
+            LOG_DEBUG("Tracker bloqué: " + tracker);
+            state.backoff_until = now + MAX_BACKOFF_MS;
+            return false;
+        }
+    }
+    
+    int sock = socket(state.address.ss_family, SOCK_DGRAM, 0);
+    if (sock < 0) return false;
+    
+    bool success = false;
+    if (connectTracker(sock, state)) {
+        uint32_t transaction_id = nextTransactionId();
+        std::vector<uint8_t> request;
+        writeUint64(request, state.connection_id);
+        writeUint32(request, ACTION_SCRAPE);
+        writeUint32(request, transaction_id);
+        for (const auto& hash : hashes) {
+            request.insert(request.end(), hash.begin(), hash.end());
+        }
+        
+        std::vector<uint8_t> response;
+        if (transact(sock, state, request, response, transaction_id) &&
+            readUint32(response.data()) == ACTION_SCRAPE) {
+            size_t count = std::min(hashes.size(), (response.size() - 8) / 12);
+            for (size_t i = 0; i < count; i++) {
+                const uint8_t* data = response.data() + 8 + i * 12;
+                SwarmCounts counts = {static_cast<int>(readUint32(data)),
+                                      static_cast<int>(readUint32(data + 8)),
+                                      static_cast<int>(readUint32(data + 4)), 0};
+                
+                // Plusieurs trackers: on retient le plus grand essaim observé
+                auto it = results.find(hashes[i]);
+                if (it == results.end()) {
+                    results[hashes[i]] = counts;
+                } else {
+                    it->second.seeders = std::max(it->second.seeders, counts.seeders);
+                    it->second.leechers = std::max(it->second.leechers, counts.leechers);
+                    it->second.completed = std::max(it->second.completed, counts.completed);
+                }
+            }
+            success = true;
+        } else if (response.size() > 8 && readUint32(response.data()) == ACTION_ERROR) {
+            LOG_DEBUG("Erreur du tracker " + tracker + ": " +
+                      std::string(response.begin() + 8, response.end()));
+        }
+    }
+    
+    close(sock);
+    
+    if (success) {
+        state.failures = 0;
+    } else {
+        // Recul exponentiel: 15 s, 30 s, ... jusqu'à 10 min
+        state.failures++;
+        state.connection_id = 0;
+        state.backoff_until = now + std::min<int64_t>(15000LL << std::min(state.failures, 6), MAX_BACKOFF_MS);
+    }
+    return success;
+}
+
+bool ScrapeService::connectTracker(int sock, TrackerState& state) {
+    int64_t now = Utils::getCurrentTimestamp();
+    if (state.connection_id != 0 && now - state.connected_at < CONNECTION_ID_LIFETIME_MS) {
+        return true;
+    }
+    
+    uint32_t transaction_id = nextTransactionId();
+    std::vector<uint8_t> request;
+    writeUint64(request, UDP_PROTOCOL_ID);
+    writeUint32(request, ACTION_CONNECT);
+    writeUint32(request, transaction_id);
+    
+    std::vector<uint8_t> response;
+    if (!transact(sock, state, request, response, transaction_id) ||
+        response.size() < 16 || readUint32(response.data()) != ACTION_CONNECT) {
+        return false;
+    }
+    
+    state.connection_id = readUint64(response.data() + 8);
+    state.connected_at = now;
+    return true;
+}
+
+bool ScrapeService::transact(int sock, TrackerState& state, const std::vector<uint8_t>& request,
+                             std::vector<uint8_t>& response, uint32_t transaction_id) {
+    uint8_t buffer[2048];
+    
+    for (int attempt = 0; attempt < MAX_ATTEMPTS && s_running; attempt++) {
+        if (sendto(sock, request.data(), request.size(), 0,
+                   reinterpret_cast<const sockaddr*>(&state.address), state.address_length) < 0) {
+            return false;
+        }
+        
+        // Attente d'une réponse portant notre identifiant de transaction
+        int64_t deadline = Utils::getCurrentTimestamp() + (RESPONSE_TIMEOUT_MS << attempt);
+        int64_t remaining;
+        while ((remaining = deadline - Utils::getCurrentTimestamp()) > 0) {
+            pollfd fd = {sock, POLLIN, 0};
+            if (poll(&fd, 1, static_cast<int>(remaining)) <= 0) break;
+            
+            ssize_t length = recv(sock, buffer, sizeof(buffer), 0);
+            if (length >= 8 && readUint32(buffer + 4) == transaction_id) {
+                response.assign(buffer, buffer + length);
+                return true;
+            }
+        }
+    }
+    
+    return false;
+}
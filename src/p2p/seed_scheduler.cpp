@@ -0,0 +1,289 @@
+/**
+ * PS4 Store P2P - Implémentation du Planificateur de Partage
+ */
+
+#include "p2p/seed_scheduler.h"
+#include "utils/utils.h"
+
+#ifndef NO_LIBTORRENT
+#include <libtorrent/torrent_handle.hpp>
+#include <libtorrent/torrent_status.hpp>
+#endif
+
+#include <algorithm>
+
+// Entrée interne: demande observée et handle associé
+struct SeedScheduler::SeedEntry {
+    SeedDemand demand;
+#ifndef NO_LIBTORRENT
+    libtorrent::torrent_handle handle;
+#endif
+};
+
+// Variables statiques
+std::map<std::string, SeedScheduler::SeedEntry> SeedScheduler::s_seeds;
+SeedSchedulerConfig SeedScheduler::s_config;
+int64_t SeedScheduler::s_last_tick = 0;
+int64_t SeedScheduler::s_last_rebalance = 0;
+bool SeedScheduler::s_rebalance_requested = false;
+
+void SeedScheduler::configure(const SeedSchedulerConfig& config) {
+    s_config = config;
+    s_config.max_active_seeds = std::max(1, config.max_active_seeds);
+    s_config.scrapes_per_tick = std::max(1, config.scrapes_per_tick);
+    s_rebalance_requested = true;
+    
+    LOG_INFO("Rotation des partages configurée - actifs max: " + std::to_string(s_config.max_active_seeds) +
+             ", rééquilibrage: " + std::to_string(s_config.rebalance_interval_s) + "s");
+}
+
+SeedSchedulerConfig SeedScheduler::getConfig() {
+    return s_config;
+}
+
+#ifndef NO_LIBTORRENT
+void SeedScheduler::registerSeed(const std::string& name, const libtorrent::torrent_handle& handle) {
+    SeedEntry entry;
+    entry.demand = {};
+    entry.demand.name = name;
+    entry.demand.seeders = -1;
+    entry.demand.leechers = -1;
+    entry.demand.score = computeScore(entry.demand);
+    entry.handle = handle;
+    
+    // Téléchargement terminé encore actif: en pause jusqu'au rééquilibrage, dans le budget des partages
+    setActive(entry, false, Utils::getCurrentTimestamp());
+    
+    s_seeds[name] = entry;
+    s_rebalance_requested = true;
+    
+    LOG_DEBUG("Partage placé sous rotation: " + name);
+}
+
+void SeedScheduler::handleScrapeReply(const libtorrent::torrent_handle& handle, int seeders, int leechers) {
+    for (auto& pair : s_seeds) {
+        SeedEntry& entry = pair.second;
+        if (entry.handle == handle) {
+            entry.demand.seeders = std::max(0, seeders);
+            entry.demand.leechers = std::max(0, leechers);
+            entry.demand.score = computeScore(entry.demand);
+            
+            LOG_DEBUG("Scrape " + pair.first + ": " + std::to_string(entry.demand.seeders) +
+                      " seeders, " + std::to_string(entry.demand.leechers) + " leechers");
+            return;
+        }
+    }
+}
+#endif
+
+void SeedScheduler::unregisterSeed(const std::string& name) {
+    s_seeds.erase(name);
+}
+
+void SeedScheduler::update() {
+    if (s_seeds.empty()) return;
+    
+    int64_t now = Utils::getCurrentTimestamp();
+    
+    // Cadence d'une seconde: les décisions ne nécessitent pas plus de précision
+    if (now - s_last_tick < 1000) return;
+    s_last_tick = now;
+    
+    sendScrapes(now);
+    parkIdleSeeds(now);
+    
+    if (s_rebalance_requested ||
+        now - s_last_rebalance >= static_cast<int64_t>(s_config.rebalance_interval_s) * 1000) {
+        refreshUploadStats(now);
+        rebalance(now);
+        s_last_rebalance = now;
+        s_rebalance_requested = false;
+    }
+}
+
+void SeedScheduler::requestRebalance() {
+    s_rebalance_requested = true;
+}
+
+std::vector<SeedDemand> SeedScheduler::getSeedDemand() {
+    std::vector<SeedDemand> demands;
+    demands.reserve(s_seeds.size());
+    
+    for (const auto& pair : s_seeds) {
+        demands.push_back(pair.second.demand);
+    }
+    
+    std::sort(demands.begin(), demands.end(), [](const SeedDemand& a, const SeedDemand& b) {
+        return a.score > b.score;
+    });
+    
+    return demands;
+}
+
+std::vector<bool> SeedScheduler::planRotation(const std::vector<SeedDemand>& demands,
+                                              const SeedSchedulerConfig& config, int64_t now) {
+    const int64_t min_active = static_cast<int64_t>(config.min_active_s) * 1000;
+    
+    std::vector<size_t> ranked(demands.size());
+    for (size_t i = 0; i < ranked.size(); i++) {
+        ranked[i] = i;
+    }
+    
+    // Classement par demande, les partages en pause depuis longtemps d'abord à égalité
+    std::stable_sort(ranked.begin(), ranked.end(), [&demands](size_t a, size_t b) {
+        if (demands[a].score != demands[b].score) return demands[a].score > demands[b].score;
+        return demands[a].activated_at < demands[b].activated_at;
+    });
+    
+    // Les partages récemment activés conservent leur place (évite les oscillations)
+    int slots = config.max_active_seeds;
+    for (const SeedDemand& demand : demands) {
+        if (demand.active && now - demand.activated_at < min_active) {
+            slots--;
+        }
+    }
+    
+    std::vector<bool> wanted(demands.size(), false);
+    for (size_t index : ranked) {
+        const SeedDemand& demand = demands[index];
+        if (demand.active && now - demand.activated_at < min_active) {
+            wanted[index] = true;
+            continue;
+        }
+        
+        wanted[index] = slots > 0 && demand.score > 0.0f;
+        if (wanted[index]) slots--;
+    }
+    
+    return wanted;
+}
+
+bool SeedScheduler::isIdle(const SeedDemand& demand, const SeedSchedulerConfig& config, int64_t now) {
+    if (!demand.active) return false;
+    
+    // Inactif: aucun leecher connu et aucun upload depuis le délai
+    int64_t last_activity = std::max(demand.last_upload, demand.activated_at);
+    return demand.leechers == 0 && now - last_activity >= static_cast<int64_t>(config.idle_timeout_s) * 1000;
+}
+
+void SeedScheduler::clear() {
+    s_seeds.clear();
+    s_last_tick = 0;
+    s_last_rebalance = 0;
+    s_rebalance_requested = false;
+}
+
+// Méthodes privées
+void SeedScheduler::sendScrapes(int64_t now) {
+#ifndef NO_LIBTORRENT
+    const int64_t scrape_interval = static_cast<int64_t>(s_config.scrape_interval_s) * 1000;
+    
+    // Les partages jamais scrapés passent en premier, puis les plus anciens
+    std::vector<SeedEntry*> candidates;
+    for (auto& pair : s_seeds) {
+        SeedEntry& entry = pair.second;
+        if (entry.demand.last_scrape == 0 || now - entry.demand.last_scrape >= scrape_interval) {
+            candidates.push_back(&entry);
+        }
+    }
+    
+    std::sort(candidates.begin(), candidates.end(), [](const SeedEntry* a, const SeedEntry* b) {
+        return a->demand.last_scrape < b->demand.last_scrape;
+    });
+    
+    int sent = 0;
+    for (SeedEntry* entry : candidates) {
+        if (sent >= s_config.scrapes_per_tick) break;
+        if (!entry->handle.is_valid()) continue;
+        
+        entry->handle.scrape_tracker();
+        entry->demand.last_scrape = now;
+        sent++;
+    }
+#else
+    (void)now;
+#endif
+}
+
+void SeedScheduler::refreshUploadStats(int64_t now) {
+#ifndef NO_LIBTORRENT
+    for (auto& pair : s_seeds) {
+        SeedEntry& entry = pair.second;
+        if (!entry.demand.active || !entry.handle.is_valid()) continue;
+        
+        libtorrent::torrent_status status = entry.handle.status();
+        if (status.all_time_upload > entry.demand.total_upload || status.upload_payload_rate > 0) {
+            entry.demand.total_upload = status.all_time_upload;
+            entry.demand.last_upload = now;
+        }
+    }
+#else
+    (void)now;
+#endif
+}
+
+void SeedScheduler::parkIdleSeeds(int64_t now) {
+    for (auto& pair : s_seeds) {
+        SeedEntry& entry = pair.second;
+        if (isIdle(entry.demand, s_config, now)) {
+            LOG_DEBUG("Partage inactif mis en pause: " + pair.first);
+            setActive(entry, false, now);
+            s_rebalance_requested = true;
+        }
+    }
+}
+
+void SeedScheduler::rebalance(int64_t now) {
+    std::vector<SeedEntry*> entries;
+    std::vector<SeedDemand> demands;
+    entries.reserve(s_seeds.size());
+    demands.reserve(s_seeds.size());
+    for (auto& pair : s_seeds) {
+        entries.push_back(&pair.second);
+        demands.push_back(pair.second.demand);
+    }
+    
+    std::vector<bool> wanted = planRotation(demands, s_config, now);
+    
+    int activated = 0;
+    int parked = 0;
+    for (size_t i = 0; i < entries.size(); i++) {
+        if (wanted[i] != entries[i]->demand.active) {
+            setActive(*entries[i], wanted[i], now);
+            if (wanted[i]) activated++; else parked++;
+        }
+    }
+    
+    if (activated > 0 || parked > 0) {
+        LOG_INFO("Rotation des partages: " + std::to_string(activated) + " activés, " +
+                 std::to_string(parked) + " mis en pause");
+    }
+}
+
+float SeedScheduler::computeScore(const SeedDemand& demand) {
+    // Demande inconnue: score neutre pour laisser une chance au partage d'être scrapé/servi
+    if (demand.seeders < 0 || demand.leechers < 0) {
+        return 1.0f;
+    }
+    
+    return static_cast<float>(demand.leechers) / (demand.seeders + 1.0f);
+}
+
+void SeedScheduler::setActive(SeedEntry& entry, bool active, int64_t now) {
+    entry.demand.active = active;
+    
+#ifndef NO_LIBTORRENT
+    if (!entry.handle.is_valid()) return;
+    
+    if (active) {
+        entry.demand.activated_at = now;
+        entry.handle.resume();
+    } else {
+        entry.handle.pause();
+    }
+#else
+    if (active) {
+        entry.demand.activated_at = now;
+    }
+#endif
+}
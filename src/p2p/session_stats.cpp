@@ -0,0 +1,205 @@
+/**
+ * PS4 Store P2P - Implémentation des Statistiques de Session
+ */
+
+#include "p2p/session_stats.h"
+#include "utils/utils.h"
+
+#ifndef NO_LIBTORRENT
+#include <libtorrent/alert_types.hpp>
+#include <libtorrent/session_stats.hpp>
+#endif
+
+#include <algorithm>
+#include <vector>
+
+// Variables statiques
+const int SessionStats::HISTORY_SIZE;
+std::array<SessionSample, SessionStats::HISTORY_SIZE> SessionStats::s_history;
+std::array<int, SESSION_METRIC_COUNT> SessionStats::s_metric_index;
+int SessionStats::s_head = 0;
+int SessionStats::s_count = 0;
+
+// Noms des compteurs libtorrent par métrique, par ordre de préférence
+// (certains noms diffèrent entre les versions de libtorrent)
+static const std::vector<const char*> METRIC_NAMES[] = {
+    {"net.recv_bytes"},
+    {"net.sent_bytes"},
+    {"net.recv_payload_bytes"},
+    {"net.sent_payload_bytes"},
+    {"peer.num_peers_connected"},
+    {"peer.num_tcp_peers"},
+    {"peer.num_utp_peers"},
+    {"peer.num_peers_down_disk"},
+    {"peer.num_peers_up_disk"},
+    {"disk.queued_disk_jobs"},
+    {"disk.queued_write_bytes"},
+    {"disk.num_blocks_read"},
+    {"disk.num_blocks_written"},
+    {"disk.num_blocks_cache_hits"},
+    {"disk.num_read_ops"},
+    {"disk.num_write_ops"},
+    {"disk.disk_hash_time"},
+    {"disk.num_fenced_hash", "disk.num_running_disk_jobs"},
+    {"net.limiter_up_queue"},
+    {"net.limiter_down_queue"},
+    {"disk.write_cache_blocks"},
+    {"disk.num_blocks_hashed"},
+    {"disk.num_read_back"},
+};
+
+static_assert(sizeof(METRIC_NAMES) / sizeof(METRIC_NAMES[0]) == SESSION_METRIC_COUNT,
+              "METRIC_NAMES doit couvrir chaque SessionMetric");
+
+// Seuils de classification du facteur limitant
+static const int64_t DISK_QUEUE_SATURATED = 32;        // Travaux disque en file (p90)
+static const double HASH_TIME_SATURATED = 0.85;        // Part du temps passée à hacher
+static const double IDLE_RATE_THRESHOLD = 4 * 1024;    // Débit en dessous duquel la session est inactive
+
+void SessionStats::initialize() {
+    int resolved = 0;
+    
+    for (int i = 0; i < SESSION_METRIC_COUNT; i++) {
+        s_metric_index[i] = -1;
+
+#ifndef NO_LIBTORRENT
+        for (const char* name : METRIC_NAMES[i]) {
+            int index = libtorrent::find_metric_idx(name);
+            if (index >= 0) {
+                s_metric_index[i] = index;
+                resolved++;
+                break;
+            }
+        }
+#endif
+    }
+    
+    clear();
+    LOG_DEBUG("Compteurs de session résolus: " + std::to_string(resolved) + "/" +
+              std::to_string(SESSION_METRIC_COUNT));
+}
+
+#ifndef NO_LIBTORRENT
+void SessionStats::handleStatsAlert(const libtorrent::session_stats_alert* alert) {
+    if (!alert) return;
+    
+    auto counters = alert->counters();
+    
+    SessionSample sample;
+    sample.timestamp = Utils::getCurrentTimestamp();
+    for (int i = 0; i < SESSION_METRIC_COUNT; i++) {
+        int index = s_metric_index[i];
+        sample.values[i] = index >= 0 ? counters[index] : 0;
+    }
+    
+    record(sample);
+}
+#endif
+
+void SessionStats::record(const SessionSample& sample) {
+    s_history[s_head] = sample;
+    s_head = (s_head + 1) % HISTORY_SIZE;
+    s_count = std::min(s_count + 1, HISTORY_SIZE);
+}
+
+void SessionStats::clear() {
+    s_head = 0;
+    s_count = 0;
+}
+
+int SessionStats::getSampleCount() {
+    return s_count;
+}
+
+int64_t SessionStats::getLatest(SessionMetric metric) {
+    if (s_count == 0) return 0;
+    return sampleAt(0).values[static_cast<int>(metric)];
+}
+
+double SessionStats::getRate(SessionMetric metric, int window) {
+    window = std::min(window, s_count);
+    if (window < 2) return 0.0;
+    
+    const SessionSample& newest = sampleAt(0);
+    const SessionSample& oldest = sampleAt(window - 1);
+    
+    int64_t elapsed_ms = newest.timestamp - oldest.timestamp;
+    if (elapsed_ms <= 0) return 0.0;
+    
+    int index = static_cast<int>(metric);
+    return (newest.values[index] - oldest.values[index]) * 1000.0 / elapsed_ms;
+}
+
+int64_t SessionStats::getPercentile(SessionMetric metric, float percentile, int window) {
+    window = std::min(window, s_count);
+    if (window == 0) return 0;
+    
+    int index = static_cast<int>(metric);
+    std::vector<int64_t> values(window);
+    for (int age = 0; age < window; age++) {
+        values[age] = sampleAt(age).values[index];
+    }
+    
+    percentile = std::min(1.0f, std::max(0.0f, percentile));
+    size_t rank = static_cast<size_t>(percentile * (window - 1) + 0.5f);
+    std::nth_element(values.begin(), values.begin() + rank, values.end());
+    return values[rank];
+}
+
+double SessionStats::getWriteCacheHitRatio(int window) {
+    window = std::min(window, s_count);
+    if (window < 2) return -1.0;
+    
+    // Bloc haché sans relecture: encore présent dans le cache d'écriture
+    int64_t hashed = sampleAt(0).values[static_cast<int>(SessionMetric::DISK_BLOCKS_HASHED)] -
+                     sampleAt(window - 1).values[static_cast<int>(SessionMetric::DISK_BLOCKS_HASHED)];
+    int64_t read_back = sampleAt(0).values[static_cast<int>(SessionMetric::DISK_READ_BACK)] -
+                        sampleAt(window - 1).values[static_cast<int>(SessionMetric::DISK_READ_BACK)];
+    if (hashed <= 0) return -1.0;
+    
+    return std::min(1.0, std::max(0.0, static_cast<double>(hashed - read_back) / hashed));
+}
+
+Bottleneck SessionStats::classifyBottleneck(int window) {
+    window = std::min(window, s_count);
+    if (window < 2) return Bottleneck::IDLE;
+    
+    double payload_rate = getRate(SessionMetric::RECV_PAYLOAD_BYTES, window) +
+                          getRate(SessionMetric::SENT_PAYLOAD_BYTES, window);
+    if (payload_rate < IDLE_RATE_THRESHOLD) {
+        return Bottleneck::IDLE;
+    }
+    
+    // CPU: le hachage occupe la quasi-totalité du temps écoulé
+    double hash_busy = getRate(SessionMetric::DISK_HASH_TIME, window) / 1000000.0;
+    if (hash_busy >= HASH_TIME_SATURATED) {
+        return Bottleneck::CPU;
+    }
+    
+    // Disque: des peers attendent le disque ou la file disque reste profonde
+    int64_t peers_on_disk = getPercentile(SessionMetric::PEERS_DOWN_DISK, 0.5f, window) +
+                            getPercentile(SessionMetric::PEERS_UP_DISK, 0.5f, window);
+    int64_t disk_queue = getPercentile(SessionMetric::DISK_QUEUE_DEPTH, 0.9f, window);
+    if (peers_on_disk > 0 || disk_queue >= DISK_QUEUE_SATURATED) {
+        return Bottleneck::DISK;
+    }
+    
+    return Bottleneck::NETWORK;
+}
+
+std::string SessionStats::getBottleneckString(Bottleneck bottleneck) {
+    switch (bottleneck) {
+        case Bottleneck::IDLE:    return "Inactif";
+        case Bottleneck::NETWORK: return "Réseau";
+        case Bottleneck::DISK:    return "Disque";
+        case Bottleneck::CPU:     return "CPU";
+        default:                  return "Inconnu";
+    }
+}
+
+// Méthodes privées
+const SessionSample& SessionStats::sampleAt(int age) {
+    // age 0 = échantillon le plus récent
+    int index = (s_head - 1 - age + HISTORY_SIZE * 2) % HISTORY_SIZE;
+    return s_history[index];
+}
@@ -0,0 +1,290 @@
+/**
+ * PS4 Store P2P - Implémentation du Réglage Automatique de la Session
+ */
+
+#include "p2p/session_tuner.h"
+#include "p2p/session_stats.h"
+#include "p2p/piece_cache.h"
+#include "p2p/write_coalescer.h"
+#include "utils/utils.h"
+
+#ifndef NO_LIBTORRENT
+#include <libtorrent/session.hpp>
+#include <libtorrent/settings_pack.hpp>
+#include <libtorrent/version.hpp>
+#endif
+
+#include <algorithm>
+#include <cstdio>
+
+#include <unistd.h>
+#include <sys/resource.h>
+
+// Variables statiques
+SessionTunerConfig SessionTuner::s_config;
+SessionTuning SessionTuner::s_tuning = {50, 8, 500};
+std::vector<TuningDecision> SessionTuner::s_decisions;
+int64_t SessionTuner::s_last_decision = 0;
+int64_t SessionTuner::s_last_cpu_time = 0;
+int64_t SessionTuner::s_last_cpu_sample = 0;
+
+// Valeurs de départ (réglages par défaut de libtorrent), ramenées dans les bornes
+static const int INITIAL_UNCHOKE_SLOTS = 8;
+static const int INITIAL_REQUEST_QUEUE = 500;
+
+// Modèle de la file de requêtes: libtorrent vise request_queue_time secondes de données en vol par peer
+static const double REQUEST_QUEUE_SECONDS = 3.0;
+static const double BLOCK_SIZE = 16 * 1024;
+
+// Mémoire estimée d'un peer connecté (tampons d'envoi et de réception)
+static const int64_t PEER_MEMORY = 64 * 1024;
+
+static int clampInt(int value, int low, int high) {
+    return std::max(low, std::min(high, value));
+}
+
+static std::string formatTuning(const SessionTuning& tuning) {
+    return std::to_string(tuning.connections_limit) + " connexions, " + std::to_string(tuning.unchoke_slots) +
+           " slots, file " + std::to_string(tuning.request_queue);
+}
+
+static SessionTuning initialTuning(const SessionTunerConfig& config) {
+    return {
+        config.max_connections,
+        clampInt(INITIAL_UNCHOKE_SLOTS, config.min_unchoke_slots, config.max_unchoke_slots),
+        clampInt(INITIAL_REQUEST_QUEUE, config.min_request_queue, config.max_request_queue)
+    };
+}
+
+void SessionTuner::configure(const SessionTunerConfig& config) {
+    s_config = config;
+    s_config.max_connections = std::max(1, s_config.max_connections);
+    s_config.min_connections = clampInt(s_config.min_connections, 1, s_config.max_connections);
+    s_config.max_unchoke_slots = std::max(1, s_config.max_unchoke_slots);
+    s_config.min_unchoke_slots = clampInt(s_config.min_unchoke_slots, 1, s_config.max_unchoke_slots);
+    s_config.max_request_queue = std::max(1, s_config.max_request_queue);
+    s_config.min_request_queue = clampInt(s_config.min_request_queue, 1, s_config.max_request_queue);
+    s_config.interval_ms = std::max(1000, s_config.interval_ms);
+    
+    s_tuning = initialTuning(s_config);
+    
+    LOG_INFO("Réglage automatique " + std::string(s_config.enabled ? "activé" : "désactivé") +
+             " - connexions " + std::to_string(s_config.min_connections) + "-" +
+             std::to_string(s_config.max_connections) + ", slots " +
+             std::to_string(s_config.min_unchoke_slots) + "-" + std::to_string(s_config.max_unchoke_slots));
+}
+
+SessionTunerConfig SessionTuner::getConfig() {
+    return s_config;
+}
+
+SessionTuning SessionTuner::getTuning() {
+    return s_tuning;
+}
+
+std::vector<TuningDecision> SessionTuner::getDecisions() {
+    return s_decisions;
+}
+
+#ifndef NO_LIBTORRENT
+void SessionTuner::applyInitial(libtorrent::settings_pack& settings) {
+    settings.set_int(libtorrent::settings_pack::connections_limit, s_tuning.connections_limit);
+    settings.set_int(libtorrent::settings_pack::unchoke_slots_limit, s_tuning.unchoke_slots);
+    settings.set_int(libtorrent::settings_pack::max_out_request_queue, s_tuning.request_queue);
+}
+
+void SessionTuner::update(libtorrent::session& session) {
+    if (!s_config.enabled) return;
+    
+    int64_t now = Utils::getCurrentTimestamp();
+    if (now - s_last_decision < s_config.interval_ms) return;
+    
+    // Fenêtre: les échantillons de la dernière période (un par seconde)
+    int window = std::min(SessionStats::getSampleCount(), s_config.interval_ms / 1000);
+    if (window < 2) return;
+    s_last_decision = now;
+    
+    TuningDecision decision;
+    decision.timestamp = now;
+    decision.before = s_tuning;
+    decision.after = s_tuning;
+    decision.peers = static_cast<int>(SessionStats::getLatest(SessionMetric::PEERS_CONNECTED));
+    decision.download_rate_per_peer = SessionStats::getRate(SessionMetric::RECV_PAYLOAD_BYTES, window) /
+                                      std::max(1, decision.peers);
+    decision.upload_rate_per_slot = SessionStats::getRate(SessionMetric::SENT_PAYLOAD_BYTES, window) /
+                                    std::max(1, s_tuning.unchoke_slots);
+    decision.cpu_load = sampleCpuLoad(now);
+    decision.memory_headroom = memoryHeadroom(decision.peers);
+    
+    libtorrent::settings_pack current_settings = session.get_settings();
+    int upload_limit = current_settings.get_int(libtorrent::settings_pack::upload_rate_limit);
+    int download_limit = current_settings.get_int(libtorrent::settings_pack::download_rate_limit);
+    bool rate_limited = isRateLimited(SessionStats::getPercentile(SessionMetric::LIMITER_UP_QUEUE, 0.5f, window),
+                                      SessionStats::getPercentile(SessionMetric::LIMITER_DOWN_QUEUE, 0.5f, window),
+                                      upload_limit, download_limit);
+    
+    if (!decide(s_config, s_tuning, upload_limit, rate_limited, decision)) {
+        LOG_DEBUG("Réglage maintenu (" + formatTuning(s_tuning) + "): " + decision.reason);
+        return;
+    }
+    
+    libtorrent::settings_pack settings;
+    settings.set_int(libtorrent::settings_pack::connections_limit, decision.after.connections_limit);
+    settings.set_int(libtorrent::settings_pack::unchoke_slots_limit, decision.after.unchoke_slots);
+    settings.set_int(libtorrent::settings_pack::max_out_request_queue, decision.after.request_queue);
+    session.apply_settings(settings);
+    
+    s_tuning = decision.after;
+    record(decision);
+}
+#endif
+
+bool SessionTuner::decide(const SessionTunerConfig& config, const SessionTuning& current,
+                          int upload_limit, bool rate_limited, TuningDecision& decision) {
+    SessionTuning after = current;
+    std::vector<std::string> reasons;
+    
+    char measures[256];
+    std::snprintf(measures, sizeof(measures), "%d peers, %.1f KB/s reçus par peer, %.1f KB/s envoyés par slot, "
+                  "CPU %.0f%%, marge %lld MB", decision.peers, decision.download_rate_per_peer / 1024.0,
+                  decision.upload_rate_per_slot / 1024.0, decision.cpu_load * 100.0f,
+                  static_cast<long long>(decision.memory_headroom / (1024 * 1024)));
+    
+    bool cpu_constrained = decision.cpu_load > config.max_cpu_load;
+    bool memory_constrained = decision.memory_headroom < config.min_memory_headroom;
+    
+    if (cpu_constrained || memory_constrained) {
+        // Ressources saturées: réduction sur les trois axes
+        after.connections_limit = std::max(config.min_connections, current.connections_limit * 4 / 5);
+        after.unchoke_slots = std::max(config.min_unchoke_slots, current.unchoke_slots - 1);
+        after.request_queue = std::max(config.min_request_queue, current.request_queue * 3 / 4);
+        reasons.push_back(cpu_constrained ? "CPU saturé" : "marge mémoire insuffisante");
+    } else {
+        bool resources_available = decision.memory_headroom >= 2 * config.min_memory_headroom &&
+                                   decision.cpu_load < config.max_cpu_load * 0.75f;
+        
+        // Slots d'unchoke: upload plafonnée = limite / débit visé par slot,
+        // sinon ouverture tant que chaque slot est productif
+        if (upload_limit > 0) {
+            after.unchoke_slots = clampInt(upload_limit / std::max(1, config.slot_upload_rate),
+                                           config.min_unchoke_slots, config.max_unchoke_slots);
+            if (after.unchoke_slots != current.unchoke_slots) reasons.push_back("upload plafonné");
+        } else if (decision.upload_rate_per_slot >= config.slot_upload_rate && resources_available) {
+            after.unchoke_slots = std::min(config.max_unchoke_slots,
+                                           current.unchoke_slots + std::max(1, current.unchoke_slots / 4));
+            if (after.unchoke_slots != current.unchoke_slots) reasons.push_back("slots productifs");
+        } else if (decision.upload_rate_per_slot < config.slot_upload_rate / 4.0) {
+            after.unchoke_slots = std::max(config.min_unchoke_slots, current.unchoke_slots - 1);
+            if (after.unchoke_slots != current.unchoke_slots) reasons.push_back("slots sous-utilisés");
+        }
+        
+        // Connexions: inutiles au-delà de ce que le limiteur de débit laisse passer,
+        // utiles quand la limite est atteinte et que les ressources le permettent
+        if (rate_limited) {
+            after.connections_limit = std::max(config.min_connections, current.connections_limit * 9 / 10);
+            if (after.connections_limit != current.connections_limit) reasons.push_back("débit plafonné");
+        } else if (decision.peers * 10 >= current.connections_limit * 9 && resources_available) {
+            after.connections_limit = std::min(config.max_connections,
+                                               current.connections_limit + std::max(1, current.connections_limit / 4));
+            if (after.connections_limit != current.connections_limit) reasons.push_back("limite de connexions atteinte");
+        }
+        
+        // File de requêtes: produit débit x délai visé, avec 50% de marge; réduite si largement surdimensionnée
+        int needed = static_cast<int>(decision.download_rate_per_peer * REQUEST_QUEUE_SECONDS / BLOCK_SIZE);
+        if (needed * 5 > current.request_queue * 4) {
+            int64_t extra_memory = static_cast<int64_t>(needed * 3 / 2 - current.request_queue) *
+                                   static_cast<int64_t>(BLOCK_SIZE) * std::max(1, decision.peers);
+            if (extra_memory < decision.memory_headroom - config.min_memory_headroom) {
+                after.request_queue = clampInt(needed * 3 / 2, config.min_request_queue, config.max_request_queue);
+                if (after.request_queue != current.request_queue) reasons.push_back("file de requêtes saturée");
+            }
+        } else if (needed * 4 < current.request_queue) {
+            after.request_queue = clampInt(std::max(needed * 2, current.request_queue / 2),
+                                           config.min_request_queue, config.max_request_queue);
+            if (after.request_queue != current.request_queue) reasons.push_back("file de requêtes surdimensionnée");
+        }
+    }
+    
+    decision.before = current;
+    decision.after = after;
+    decision.reason = (reasons.empty() ? std::string("stable") : Utils::join(reasons, ", ")) + " (" + measures + ")";
+    
+    return after.connections_limit != current.connections_limit ||
+           after.unchoke_slots != current.unchoke_slots ||
+           after.request_queue != current.request_queue;
+}
+
+bool SessionTuner::isRateLimited(int64_t up_queue, int64_t down_queue, int upload_limit, int download_limit) {
+    // Une direction compte seulement si elle est plafonnée. L'upload plafonnée est déjà absorbée
+    // par les slots d'unchoke: seule, elle ne retire pas de connexions aux téléchargements libres
+    bool download_limited = download_limit > 0 && down_queue > 0;
+    bool upload_limited = upload_limit > 0 && up_queue > 0;
+    return download_limited || (upload_limited && download_limit > 0);
+}
+
+int64_t SessionTuner::getReservedMemory() {
+    PieceCacheConfig cache = PieceCache::getConfig();
+    int64_t reserved = cache.enabled ? cache.capacity : 0;
+    
+    // Réserve d'écriture: placée devant le stockage avec libtorrent 2.0 seulement
+#if LIBTORRENT_VERSION_NUM >= 20000
+    WriteCoalescerConfig writes = WriteCoalescer::getConfig();
+    if (writes.enabled) reserved += writes.pool_bytes;
+#endif
+    return reserved;
+}
+
+void SessionTuner::clear() {
+    s_decisions.clear();
+    s_last_decision = 0;
+    s_last_cpu_time = 0;
+    s_last_cpu_sample = 0;
+    s_tuning = initialTuning(s_config);
+}
+
+// Méthodes privées
+float SessionTuner::sampleCpuLoad(int64_t now) {
+    // Charge du processus: le thread réseau de libtorrent n'est pas identifiable de l'extérieur
+    rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) return 0.0f;
+    
+    int64_t cpu_time = (usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000LL +
+                       usage.ru_utime.tv_usec + usage.ru_stime.tv_usec;
+    float load = 0.0f;
+    if (s_last_cpu_sample > 0 && now > s_last_cpu_sample) {
+        load = static_cast<float>(cpu_time - s_last_cpu_time) / ((now - s_last_cpu_sample) * 1000.0f);
+    }
+    
+    s_last_cpu_time = cpu_time;
+    s_last_cpu_sample = now;
+    return load;
+}
+
+int64_t SessionTuner::memoryHeadroom(int peers) {
+    // Les blocs en réserve n'atteignent le disque (et ses écritures en attente)
+    // qu'au vidage, qui les retire de la réserve: comptés une seule fois
+    int64_t used = static_cast<int64_t>(peers) * PEER_MEMORY +
+                   SessionStats::getLatest(SessionMetric::DISK_QUEUED_WRITE_BYTES);
+    int64_t headroom = s_config.memory_budget - getReservedMemory() - used;
+    
+    // Mémoire physique libre, lorsque le système l'expose
+#ifdef _SC_AVPHYS_PAGES
+    long pages = sysconf(_SC_AVPHYS_PAGES);
+    long page_size = sysconf(_SC_PAGESIZE);
+    if (pages > 0 && page_size > 0) {
+        headroom = std::min(headroom, static_cast<int64_t>(pages) * page_size);
+    }
+#endif
+
+    return headroom;
+}
+
+void SessionTuner::record(const TuningDecision& decision) {
+    LOG_INFO("Réglage automatique: " + formatTuning(decision.before) + " -> " +
+             formatTuning(decision.after) + " - " + decision.reason);
+    
+    s_decisions.push_back(decision);
+    if (static_cast<int>(s_decisions.size()) > MAX_DECISIONS) {
+        s_decisions.erase(s_decisions.begin());
+    }
+}
@@ -3,10 +3,24 @@
  */
 
 #include "p2p/torrent_manager.h"
+#include "p2p/seed_scheduler.h"
+#include "p2p/download_scheduler.h"
+#include "p2p/session_stats.h"
+#include "p2p/piece_planner.h"
+#include "p2p/metadata_cache.h"
+#include "p2p/ip_blocklist.h"
+#include "p2p/session_tuner.h"
+#include "p2p/fast_start.h"
+#include "p2p/piece_cache.h"
+#include "p2p/write_coalescer.h"
 #include "utils/utils.h"
+#include "utils/trace.h"
+#include "utils/metrics.h"
+#include "utils/event_queue.h"
 
 #ifndef NO_LIBTORRENT
 #include <libtorrent/session.hpp>
+#include <libtorrent/session_params.hpp>
 #include <libtorrent/add_torrent_params.hpp>
 #include <libtorrent/torrent_handle.hpp>
 #include <libtorrent/torrent_status.hpp>
@@ -15,11 +29,15 @@
 #include <libtorrent/create_torrent.hpp>
 #include <libtorrent/file_storage.hpp>
 #include <libtorrent/bencode.hpp>
+#include <libtorrent/ip_filter.hpp>
+#include <libtorrent/peer_class.hpp>
 #endif
 
 #include <fstream>
 #include <iostream>
 #include <thread>
+#include <atomic>
+#include <algorithm>
 
 // Variables statiques
 #ifndef NO_LIBTORRENT
@@ -28,13 +46,57 @@ std::map<std::string, libtorrent::torrent_handle> TorrentManager::s_torrents;
 #endif
 std::string TorrentManager::s_download_path = "/data/ps4_store/downloads";
 std::string TorrentManager::s_state_file = "/data/ps4_store/session.state";
+SessionOptions TorrentManager::s_session_options;
 
 DownloadProgressCallback TorrentManager::s_progress_callback = nullptr;
 DownloadCompleteCallback TorrentManager::s_complete_callback = nullptr;
 DownloadErrorCallback TorrentManager::s_error_callback = nullptr;
 
+#ifndef NO_LIBTORRENT
+// Torrent préparé en attente d'ajout à la session
+struct TorrentManager::PendingAdmission {
+    std::string name;
+    libtorrent::add_torrent_params params;
+    int64_t memory_estimate = 0;
+};
+
+std::vector<TorrentManager::PendingAdmission> TorrentManager::s_admission_queue;
+std::map<std::string, int64_t> TorrentManager::s_admissions_in_flight;
+std::vector<std::string> TorrentManager::s_staged_activations;
+std::vector<TaskFuture<void>> TorrentManager::s_admission_jobs;
+std::mutex TorrentManager::s_admission_mutex;
+AdmissionBudget TorrentManager::s_admission_budget;
+int64_t TorrentManager::s_admitted_memory = 0;
+bool TorrentManager::s_admission_held = false;
+int64_t TorrentManager::s_last_activation_time = 0;
+
+// Coût mémoire fixe estimé d'un torrent dans la session (hors métadonnées)
+static const int64_t TORRENT_BASE_MEMORY = 32 * 1024;
+#endif
+
+int TorrentManager::s_lan_peer_class = -1;
+std::string TorrentManager::s_lan_subnets;
+int64_t TorrentManager::s_last_lan_check = 0;
+
+// Période de vérification des interfaces réseau pour la classe LAN
+static const int64_t LAN_CHECK_INTERVAL_MS = 60000;
+
+int64_t TorrentManager::s_last_stats_request = 0;
+
+// Période d'échantillonnage des compteurs de session
+static const int64_t STATS_INTERVAL_MS = 1000;
+
+std::string TorrentManager::s_listen_interfaces;
+PeerFamilyCounts TorrentManager::s_peer_counts = {};
+int64_t TorrentManager::s_last_peer_count = 0;
+int64_t TorrentManager::s_last_state_save = 0;
+
+// Période du décompte des peers par famille d'adresses
+static const int64_t PEER_COUNT_INTERVAL_MS = 10000;
+
 int TorrentManager::initialize() {
     LOG_INFO("Initialisation du gestionnaire de torrents...");
+    subscribeEvents();
     
 #ifndef NO_LIBTORRENT
     try {
@@ -42,11 +104,18 @@ int TorrentManager::initialize() {
         libtorrent::settings_pack settings;
         
         // Configuration de base
-        settings.set_str(libtorrent::settings_pack::listen_interfaces, "0.0.0.0:6881");
-        settings.set_bool(libtorrent::settings_pack::enable_dht, true);
-        settings.set_bool(libtorrent::settings_pack::enable_lsd, true);
-        settings.set_bool(libtorrent::settings_pack::enable_upnp, true);
-        settings.set_bool(libtorrent::settings_pack::enable_natpmp, true);
+        // Écoute IPv4 et IPv6, sur toutes les interfaces ou sur celles demandées
+        s_listen_interfaces = buildListenInterfaces(s_session_options, Utils::getNetworkInterfaces());
+        settings.set_str(libtorrent::settings_pack::listen_interfaces, s_listen_interfaces);
+        if (!s_session_options.outgoing_interfaces.empty()) {
+            settings.set_str(libtorrent::settings_pack::outgoing_interfaces, s_session_options.outgoing_interfaces);
+        }
+        // DHT démarré après le chargement de l'état: amorçage depuis la table de routage sauvegardée
+        settings.set_bool(libtorrent::settings_pack::enable_dht, false);
+        settings.set_bool(libtorrent::settings_pack::enable_lsd, s_session_options.enable_lsd);
+        settings.set_int(libtorrent::settings_pack::local_service_announce_interval, 60);
+        settings.set_bool(libtorrent::settings_pack::enable_upnp, s_session_options.enable_port_mapping);
+        settings.set_bool(libtorrent::settings_pack::enable_natpmp, s_session_options.enable_port_mapping);
         
         // Optimisations pour PS4
         settings.set_int(libtorrent::settings_pack::alert_mask, 
@@ -55,12 +124,21 @@ int TorrentManager::initialize() {
                         libtorrent::alert::tracker_notification |
                         libtorrent::alert::status_notification);
         
-        // Limites de connexions adaptées à la PS4
-        settings.set_int(libtorrent::settings_pack::connections_limit, 50);
-        settings.set_int(libtorrent::settings_pack::unchoke_slots_limit, 8);
+        // Limites de connexions, slots d'unchoke et file de requêtes (ajustées ensuite par SessionTuner)
+        SessionTuner::applyInitial(settings);
+        
+        // Annonces parallèles à tous les trackers pour les nouveaux téléchargements
+        FastStart::applySettings(settings);
         
-        // Création de la session
-        s_session = std::make_unique<libtorrent::session>(settings);
+        // Création de la session: stockage précédé de la réserve d'écriture, puis du cache des pièces partagées
+        libtorrent::session_params params(settings);
+        WriteCoalescer::install(params);
+        PieceCache::install(params);
+        s_session = std::make_unique<libtorrent::session>(std::move(params));
+        SessionStats::initialize();
+        
+        // Peers du réseau local exemptés des limites globales
+        refreshLanPeerClass();
         
         // Création du dossier de téléchargement
         if (!Utils::directoryExists(s_download_path)) {
@@ -69,7 +147,13 @@ int TorrentManager::initialize() {
         
         // Chargement de l'état précédent si disponible
         loadState(s_state_file);
+        s_last_state_save = Utils::getCurrentTimestamp();
+        
+        libtorrent::settings_pack dht_settings;
+        dht_settings.set_bool(libtorrent::settings_pack::enable_dht, s_session_options.enable_dht);
+        s_session->apply_settings(dht_settings);
         
+        LOG_INFO("Interfaces d'écoute: " + s_listen_interfaces);
         LOG_INFO("Gestionnaire de torrents initialisé avec succès");
         return 0;
         
@@ -83,11 +167,43 @@ int TorrentManager::initialize() {
 #endif
 }
 
+void TorrentManager::setSessionOptions(const SessionOptions& options) {
+    s_session_options = options;
+    s_download_path = options.download_path;
+    s_state_file = options.state_file;
+}
+
 void TorrentManager::cleanup() {
     LOG_INFO("Nettoyage du gestionnaire de torrents...");
     
 #ifndef NO_LIBTORRENT
     if (s_session) {
+        // Attente des préparations d'admission en cours
+        for (auto& job : s_admission_jobs) {
+            if (job.valid()) job.wait();
+        }
+        s_admission_jobs.clear();
+        
+        {
+            std::lock_guard<std::mutex> lock(s_admission_mutex);
+            s_admission_queue.clear();
+        }
+        s_admissions_in_flight.clear();
+        s_staged_activations.clear();
+        SeedScheduler::clear();
+        DownloadScheduler::clear();
+        PiecePlanner::clear();
+        MetadataCache::clear();
+        SessionStats::clear();
+        SessionTuner::clear();
+        FastStart::clear();
+        PieceCache::clear();
+        WriteCoalescer::clear();
+        s_admitted_memory = 0;
+        s_admission_held = false;
+        s_listen_interfaces.clear();
+        s_peer_counts = {};
+        
         // Sauvegarde de l'état
         saveState(s_state_file);
         
@@ -113,6 +229,50 @@ void TorrentManager::update() {
     
     // Traitement des alertes
     processAlerts();
+    
+    // Admission et activation progressive des torrents en attente
+    pumpAdmissions();
+    
+    // Résolution des métadonnées du catalogue
+    MetadataCache::update(*s_session);
+    
+    // Échantillon des compteurs de session (reçu via session_stats_alert)
+    int64_t now = Utils::getCurrentTimestamp();
+    if (now - s_last_stats_request >= STATS_INTERVAL_MS) {
+        s_last_stats_request = now;
+        s_session->post_session_stats();
+    }
+    
+    // Ajustement des limites de la session selon les compteurs échantillonnés
+    SessionTuner::update(*s_session);
+    
+    // Mesure du délai jusqu'au premier octet des téléchargements démarrés
+    FastStart::update();
+    
+    // Sauvegarde périodique de l'état (table de routage DHT) et du cache de peers
+    if (s_session_options.state_save_interval > 0 &&
+        now - s_last_state_save >= static_cast<int64_t>(s_session_options.state_save_interval) * 1000) {
+        s_last_state_save = now;
+        saveState(s_state_file);
+        FastStart::savePeerCache();
+    }
+    
+    // Suivi des changements d'interfaces pour la classe LAN et les sockets d'écoute
+    if (now - s_last_lan_check >= LAN_CHECK_INTERVAL_MS) {
+        refreshLanPeerClass();
+        refreshListenInterfaces();
+    }
+    
+    // Répartition IPv4 / IPv6 des peers connectés
+    if (now - s_last_peer_count >= PEER_COUNT_INTERVAL_MS) {
+        s_last_peer_count = now;
+        countPeersByFamily();
+    }
+    
+    // File de téléchargement, ordre des pièces PKG et rotation des partages
+    DownloadScheduler::update();
+    PiecePlanner::update();
+    SeedScheduler::update();
 #endif
 }
 
@@ -138,29 +298,41 @@ bool TorrentManager::startDownload(const std::string& magnet_link,
             return false;
         }
         
+        // Métadonnées déjà résolues: le transfert des données commence immédiatement
+        MetadataCache::cancel(*s_session, params);
+        auto cached = MetadataCache::lookup(params);
+        if (cached) {
+            params.ti = cached;
+            LOG_DEBUG("Métadonnées trouvées en cache: " + name);
+        }
+        
+        // Trackers par défaut, peers en cache et début de la mesure du TTFB
+        FastStart::prepare(name, params);
+        
         // Configuration du téléchargement
         params.save_path = save_path.empty() ? s_download_path : save_path;
-        params.flags |= libtorrent::torrent_flags::auto_managed;
+        params.name = name;
         params.flags |= libtorrent::torrent_flags::duplicate_is_error;
         
-        // Ajout du torrent à la session
-        libtorrent::torrent_handle handle = s_session->add_torrent(params, ec);
-        
-        if (ec) {
-            LOG_ERROR("Erreur lors de l'ajout du torrent: " + ec.message());
-            return false;
-        }
+        // Ajouté en pause: la file de téléchargement décide de l'activation
+        params.flags |= libtorrent::torrent_flags::paused;
+        params.flags &= ~libtorrent::torrent_flags::auto_managed;
         
-        // Stockage du handle
-        s_torrents[name] = handle;
+        // Ajout asynchrone: le handle est enregistré à la réception de add_torrent_alert
+        s_admissions_in_flight[name] = 0;
+        s_session->async_add_torrent(std::move(params));
         
-        LOG_INFO("Téléchargement démarré avec succès: " + name);
+        LOG_INFO("Téléchargement en cours d'ajout: " + name);
         return true;
         
     } catch (const std::exception& e) {
         LOG_ERROR("Exception lors du démarrage du téléchargement: " + std::string(e.what()));
         return false;
     }
+#else
+    LOG_WARNING("Téléchargement P2P non disponible (mode développement)");
+    return false;
+#endif
 }
 
 bool TorrentManager::stopDownload(const std::string& name) {
@@ -173,6 +345,8 @@ bool TorrentManager::stopDownload(const std::string& name) {
     
     try {
         it->second.pause();
+        SeedScheduler::unregisterSeed(name);
+        DownloadScheduler::setUserPaused(name, true);
         LOG_INFO("Téléchargement arrêté: " + name);
         return true;
     } catch (const std::exception& e) {
@@ -200,6 +374,10 @@ bool TorrentManager::removeDownload(const std::string& name, bool delete_files)
         }
         
         s_session->remove_torrent(it->second, flags);
+        SeedScheduler::unregisterSeed(name);
+        DownloadScheduler::remove(name);
+        PiecePlanner::untrack(name);
+        FastStart::forget(name);
         s_torrents.erase(it);
         
         LOG_INFO("Téléchargement supprimé: " + name);
@@ -221,41 +399,89 @@ bool TorrentManager::sharePackage(const std::string& pkg_path, const std::string
         return false;
     }
     
-    try {
-        LOG_INFO("Création du torrent pour: " + name);
-        
-        // Création du fichier torrent
-        std::string torrent_path = s_download_path + "/" + name + ".torrent";
-        createTorrentFile(pkg_path, torrent_path);
-        
-        // Ajout du torrent en mode seed
-        libtorrent::add_torrent_params params;
-        params.ti = std::make_shared<libtorrent::torrent_info>(torrent_path);
-        params.save_path = Utils::directoryExists(pkg_path) ? pkg_path : 
-                          pkg_path.substr(0, pkg_path.find_last_of('/'));
-        params.flags |= libtorrent::torrent_flags::seed_mode;
-        params.flags |= libtorrent::torrent_flags::auto_managed;
-        
-        libtorrent::error_code ec;
-        libtorrent::torrent_handle handle = s_session->add_torrent(params, ec);
-        
-        if (ec) {
-            LOG_ERROR("Erreur lors de l'ajout du torrent en seed: " + ec.message());
-            return false;
+    return shareLibrary({ShareRequest{pkg_path, name}}) == 1;
+#else
+    LOG_WARNING("Partage P2P non disponible (mode développement)");
+    return false;
+#endif
+}
+
+int TorrentManager::shareLibrary(const std::vector<ShareRequest>& packages) {
+#ifndef NO_LIBTORRENT
+    if (!s_session) {
+        LOG_ERROR("Session non initialisée");
+        return 0;
+    }
+    
+    std::vector<ShareRequest> requests;
+    for (const auto& request : packages) {
+        if (!Utils::fileExists(request.pkg_path)) {
+            LOG_WARNING("Fichier PKG non trouvé, partage ignoré: " + request.pkg_path);
+            continue;
         }
-        
-        s_torrents[name] = handle;
-        
-        LOG_INFO("Package partagé avec succès: " + name);
-        return true;
-        
-    } catch (const std::exception& e) {
-        LOG_ERROR("Erreur lors du partage du package: " + std::string(e.what()));
-        return false;
+        requests.push_back(request);
+    }
+    
+    if (requests.empty()) {
+        return 0;
+    }
+    
+    LOG_INFO("Partage groupé de " + std::to_string(requests.size()) + " packages");
+    
+    // Préparation en arrière-plan: lecture/création des .torrent en parallèle dans la réserve de threads
+    for (const auto& request : requests) {
+        s_admission_jobs.push_back(ThreadPool::submit([request]() {
+            PendingAdmission admission;
+            if (!prepareSeedParams(request, admission)) {
+                return;
+            }
+            
+            std::lock_guard<std::mutex> lock(s_admission_mutex);
+            s_admission_queue.push_back(std::move(admission));
+        }, TaskPriority::BULK));
     }
+    
+    return static_cast<int>(requests.size());
 #else
     LOG_WARNING("Partage P2P non disponible (mode développement)");
-    return false;
+    return 0;
+#endif
+}
+
+void TorrentManager::setAdmissionBudget(const AdmissionBudget& budget) {
+#ifndef NO_LIBTORRENT
+    s_admission_budget = budget;
+    s_admission_budget.max_in_flight = std::max(1, budget.max_in_flight);
+    s_admission_budget.max_activations_per_tick = std::max(1, budget.max_activations_per_tick);
+    s_admission_budget.connections_per_torrent = std::max(1, budget.connections_per_torrent);
+    
+    LOG_INFO("Budget d'admission défini - mémoire: " + Utils::formatFileSize(budget.memory_budget) +
+             ", ajouts simultanés: " + std::to_string(s_admission_budget.max_in_flight));
+#endif
+}
+
+size_t TorrentManager::countAdmissible(const std::vector<int64_t>& estimates, int in_flight, int64_t in_flight_memory,
+                                       const AdmissionBudget& budget) {
+    size_t count = 0;
+    while (count < estimates.size() && in_flight < budget.max_in_flight) {
+        // Une admission plus grosse que le budget passe seule
+        if (in_flight_memory + estimates[count] > budget.memory_budget && in_flight_memory > 0) {
+            break;
+        }
+        in_flight_memory += estimates[count];
+        in_flight++;
+        count++;
+    }
+    return count;
+}
+
+int TorrentManager::getPendingAdmissions() {
+#ifndef NO_LIBTORRENT
+    std::lock_guard<std::mutex> lock(s_admission_mutex);
+    return static_cast<int>(s_admission_queue.size() + s_admissions_in_flight.size() +
+                            s_staged_activations.size());
+#else
+    return 0;
 #endif
 }
 
@@ -275,6 +501,7 @@ std::vector<DownloadInfo> TorrentManager::getDownloads() {
 DownloadInfo TorrentManager::getDownloadInfo(const std::string& name) {
     DownloadInfo info;
     info.name = name;
+    info.ttfb_ms = -1;
     
 #ifndef NO_LIBTORRENT
     auto it = s_torrents.find(name);
@@ -297,6 +524,7 @@ DownloadInfo TorrentManager::getDownloadInfo(const std::string& name) {
         info.is_seeding = status.is_seeding;
         info.status = getStatusString(status.state);
         info.save_path = status.save_path;
+        info.ttfb_ms = FastStart::getTtfb(name);
         
         // Génération du lien magnet si disponible
         if (status.has_metadata) {
@@ -326,6 +554,31 @@ void TorrentManager::setErrorCallback(DownloadErrorCallback callback) {
     s_error_callback = callback;
 }
 
+void TorrentManager::subscribeEvents() {
+    // Callbacks appelés par EventQueue::dispatch, sur le thread principal
+    static bool subscribed = false;
+    if (subscribed) return;
+    subscribed = true;
+    
+    EventQueue::subscribe(EventType::DOWNLOAD_PROGRESS, [](const UiEvent& event) {
+        if (s_progress_callback) s_progress_callback(event.job, event.progress);
+    });
+    EventQueue::subscribe(EventType::DOWNLOAD_COMPLETE, [](const UiEvent& event) {
+        if (s_complete_callback) s_complete_callback(event.job, event.text);
+    });
+    EventQueue::subscribe(EventType::DOWNLOAD_ERROR, [](const UiEvent& event) {
+        if (s_error_callback) s_error_callback(event.job, event.text);
+    });
+}
+
+void TorrentManager::postError(const std::string& name, const std::string& message) {
+    UiEvent event;
+    event.type = EventType::DOWNLOAD_ERROR;
+    event.job = name;
+    event.text = message;
+    EventQueue::post(std::move(event));
+}
+
 void TorrentManager::setBandwidthLimits(int download_limit, int upload_limit) {
 #ifndef NO_LIBTORRENT
     if (!s_session) return;
@@ -340,20 +593,167 @@ void TorrentManager::setBandwidthLimits(int download_limit, int upload_limit) {
 #endif
 }
 
+bool TorrentManager::refreshLanPeerClass() {
+#ifndef NO_LIBTORRENT
+    if (!s_session) return false;
+    
+    s_last_lan_check = Utils::getCurrentTimestamp();
+    
+    // Plages des sous-réseaux locaux (loopback inclus pour les sessions de test locales)
+    std::vector<NetworkInterface> interfaces = Utils::getNetworkInterfaces();
+    std::vector<std::string> subnets;
+    for (const auto& iface : interfaces) {
+        subnets.push_back(iface.first_address + "-" + iface.last_address);
+    }
+    std::sort(subnets.begin(), subnets.end());
+    subnets.erase(std::unique(subnets.begin(), subnets.end()), subnets.end());
+    
+    std::string fingerprint = Utils::join(subnets, ",");
+    if (s_lan_peer_class >= 0 && fingerprint == s_lan_subnets) {
+        return true;
+    }
+    
+    try {
+        if (s_lan_peer_class < 0) {
+            libtorrent::peer_class_t lan_class = s_session->create_peer_class("lan");
+            s_lan_peer_class = static_cast<int>(static_cast<std::uint32_t>(lan_class));
+            
+            // Sans limite de débit, hors quota d'unchoke, prioritaire sur la bande passante
+            libtorrent::peer_class_info info = s_session->get_peer_class(lan_class);
+            info.upload_limit = 0;
+            info.download_limit = 0;
+            info.ignore_unchoke_slots = true;
+            info.connection_limit_factor = 50;
+            info.upload_priority = 2;
+            info.download_priority = 2;
+            s_session->set_peer_class(lan_class, info);
+        }
+        
+        // Filtre reconstruit: tout en classe globale, puis les plages LAN quittent
+        // la classe globale (et ses limites) pour la classe LAN
+        const std::uint32_t global_mask = 1u << static_cast<std::uint32_t>(libtorrent::session::global_peer_class_id);
+        const std::uint32_t lan_mask = 1u << s_lan_peer_class;
+        
+        libtorrent::ip_filter filter;
+        filter.add_rule(libtorrent::make_address("0.0.0.0"), libtorrent::make_address("255.255.255.255"), global_mask);
+        filter.add_rule(libtorrent::make_address("::"),
+                        libtorrent::make_address("ffff:ffff:ffff:ffff:ffff:ffff:ffff:ffff"), global_mask);
+        
+        int ranges = 0;
+        for (const auto& iface : interfaces) {
+            libtorrent::error_code ec_first, ec_last;
+            libtorrent::address first = libtorrent::make_address(iface.first_address, ec_first);
+            libtorrent::address last = libtorrent::make_address(iface.last_address, ec_last);
+            if (ec_first || ec_last) continue;
+            
+            filter.add_rule(first, last, lan_mask);
+            ranges++;
+        }
+        s_session->set_peer_class_filter(filter);
+        s_lan_subnets = fingerprint;
+        
+        LOG_INFO("Classe de peers LAN appliquée sur " + std::to_string(ranges) + " sous-réseaux");
+        return true;
+        
+    } catch (const std::exception& e) {
+        LOG_ERROR("Erreur lors de la configuration de la classe LAN: " + std::string(e.what()));
+        return false;
+    }
+#else
+    return false;
+#endif
+}
+
+bool TorrentManager::applyIpBlocklist() {
+#ifndef NO_LIBTORRENT
+    if (!s_session) return false;
+    
+    try {
+        // Intervalles triés et disjoints: une règle par intervalle, sans recouvrement à résoudre
+        std::shared_ptr<const std::vector<IpRange>> ranges = IpBlocklist::getRanges();
+        libtorrent::ip_filter filter;
+        for (const IpRange& range : *ranges) {
+            filter.add_rule(libtorrent::address_v4(range.first), libtorrent::address_v4(range.last),
+                            libtorrent::ip_filter::blocked);
+        }
+        s_session->set_ip_filter(filter);
+        
+        libtorrent::settings_pack settings;
+        settings.set_bool(libtorrent::settings_pack::apply_ip_filter_to_trackers, true);
+        s_session->apply_settings(settings);
+        
+        LOG_INFO("Filtre IP appliqué: " + std::to_string(ranges->size()) + " plages bloquées");
+        return true;
+        
+    } catch (const std::exception& e) {
+        LOG_ERROR("Erreur lors de l'application du filtre IP: " + std::string(e.what()));
+        return false;
+    }
+#else
+    return false;
+#endif
+}
+
+bool TorrentManager::addPeer(const std::string& name, const std::string& address, int port) {
+#ifndef NO_LIBTORRENT
+    auto it = s_torrents.find(name);
+    if (it == s_torrents.end()) {
+        return false;
+    }
+
+    libtorrent::error_code ec;
+    libtorrent::address ip = libtorrent::make_address(address, ec);
+    if (ec) {
+        LOG_WARNING("Adresse de peer invalide: " + address);
+        return false;
+    }
+
+    it->second.connect_peer(libtorrent::tcp::endpoint(ip, static_cast<unsigned short>(port)));
+    LOG_DEBUG("Peer ajouté à " + name + ": " + address + ":" + std::to_string(port));
+    return true;
+#else
+    return false;
+#endif
+}
+
 bool TorrentManager::setListenPort(int port) {
 #ifndef NO_LIBTORRENT
     if (!s_session) return false;
     
+    s_session_options.listen_port = port;
+    s_session_options.listen_interfaces.clear();
+    if (!refreshListenInterfaces()) {
+        LOG_ERROR("Erreur lors de la définition du port: " + std::to_string(port));
+        return false;
+    }
+    
+    LOG_INFO("Port d'écoute défini: " + std::to_string(port));
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool TorrentManager::refreshListenInterfaces() {
+#ifndef NO_LIBTORRENT
+    if (!s_session) return false;
+    
+    std::string interfaces = buildListenInterfaces(s_session_options, Utils::getNetworkInterfaces());
+    if (interfaces == s_listen_interfaces) {
+        return true;
+    }
+    
     try {
+        // apply_settings ferme et rouvre les sockets concernés, les torrents restent actifs
         libtorrent::settings_pack settings;
-        settings.set_str(libtorrent::settings_pack::listen_interfaces, 
-                        "0.0.0.0:" + std::to_string(port));
+        settings.set_str(libtorrent::settings_pack::listen_interfaces, interfaces);
         s_session->apply_settings(settings);
+        s_listen_interfaces = interfaces;
         
-        LOG_INFO("Port d'écoute défini: " + std::to_string(port));
+        LOG_INFO("Interfaces d'écoute: " + interfaces);
         return true;
     } catch (const std::exception& e) {
-        LOG_ERROR("Erreur lors de la définition du port: " + std::string(e.what()));
+        LOG_ERROR("Erreur lors du changement des interfaces d'écoute: " + std::string(e.what()));
         return false;
     }
 #else
@@ -361,6 +761,61 @@ bool TorrentManager::setListenPort(int port) {
 #endif
 }
 
+std::string TorrentManager::buildListenInterfaces(const SessionOptions& options,
+                                                  const std::vector<NetworkInterface>& interfaces) {
+    if (!options.listen_interfaces.empty()) {
+        return options.listen_interfaces;
+    }
+    
+    std::string port = std::to_string(options.listen_port);
+    
+    // Adresse IPv6 lien-local (fe80::/10): inutilisable sans identifiant de zone
+    auto is_link_local = [](const NetworkInterface& iface) {
+        std::string prefix = Utils::toLowerCase(iface.address.substr(0, 4));
+        return iface.is_ipv6 && prefix.size() == 4 && prefix.compare(0, 3, "fe8") >= 0 &&
+               prefix.compare(0, 3, "feb") <= 0;
+    };
+    
+    std::vector<std::string> endpoints;
+    if (options.listen_devices.empty()) {
+        endpoints.push_back("0.0.0.0:" + port);
+        
+        bool has_ipv6 = std::any_of(interfaces.begin(), interfaces.end(), [&](const NetworkInterface& iface) {
+            return iface.is_ipv6 && !iface.is_loopback && !is_link_local(iface);
+        });
+        if (options.enable_ipv6 && has_ipv6) {
+            endpoints.push_back("[::]:" + port);
+        }
+        return Utils::join(endpoints, ",");
+    }
+    
+    for (const auto& device : options.listen_devices) {
+        for (const auto& iface : interfaces) {
+            if (iface.name != device) continue;
+            if (iface.is_ipv6 && (!options.enable_ipv6 || is_link_local(iface))) continue;
+            
+            std::string endpoint = iface.is_ipv6 ? "[" + iface.address + "]:" + port : iface.address + ":" + port;
+            if (std::find(endpoints.begin(), endpoints.end(), endpoint) == endpoints.end()) {
+                endpoints.push_back(endpoint);
+            }
+        }
+    }
+    
+    // Aucune interface demandée n'est présente: écoute sur toutes plutôt que sur aucune
+    if (endpoints.empty()) {
+        LOG_WARNING("Aucune adresse pour les interfaces demandées (" + Utils::join(options.listen_devices, ",") +
+                    "), écoute sur toutes les interfaces");
+        SessionOptions fallback = options;
+        fallback.listen_devices.clear();
+        return buildListenInterfaces(fallback, interfaces);
+    }
+    return Utils::join(endpoints, ",");
+}
+
+PeerFamilyCounts TorrentManager::getPeerFamilyCounts() {
+    return s_peer_counts;
+}
+
 void TorrentManager::getGlobalStats(int64_t& total_download, int64_t& total_upload,
                                    int& download_rate, int& upload_rate) {
 #ifndef NO_LIBTORRENT
@@ -369,11 +824,10 @@ void TorrentManager::getGlobalStats(int64_t& total_download, int64_t& total_uplo
         return;
     }
     
-    libtorrent::session_status stats = s_session->status();
-    total_download = stats.total_download;
-    total_upload = stats.total_upload;
-    download_rate = stats.download_rate;
-    upload_rate = stats.upload_rate;
+    total_download = SessionStats::getLatest(SessionMetric::RECV_BYTES);
+    total_upload = SessionStats::getLatest(SessionMetric::SENT_BYTES);
+    download_rate = static_cast<int>(SessionStats::getRate(SessionMetric::RECV_BYTES));
+    upload_rate = static_cast<int>(SessionStats::getRate(SessionMetric::SENT_BYTES));
 #else
     total_download = total_upload = download_rate = upload_rate = 0;
 #endif
@@ -441,36 +895,102 @@ void TorrentManager::processAlerts() {
 #ifndef NO_LIBTORRENT
     if (!s_session) return;
     
+    TRACE_SCOPE("p2p", "processAlerts");
+    static MetricHistogram& drain_time = Metrics::histogram("alert_drain_us", "Traitement d'un lot d'alertes libtorrent (µs)");
+    static MetricCounter& alert_count = Metrics::counter("alerts_total", "Alertes libtorrent traitées");
+    MetricTimer drain_timer(drain_time);
+    
     std::vector<libtorrent::alert*> alerts;
     s_session->pop_alerts(&alerts);
+    TRACE_COUNTER("alerts", alerts.size());
+    alert_count.add(static_cast<int64_t>(alerts.size()));
     
     for (libtorrent::alert* alert : alerts) {
         switch (alert->type()) {
+            case libtorrent::add_torrent_alert::alert_type: {
+                handleAddTorrentAlert(libtorrent::alert_cast<libtorrent::add_torrent_alert>(alert));
+                break;
+            }
+            
+            case libtorrent::session_stats_alert::alert_type: {
+                SessionStats::handleStatsAlert(libtorrent::alert_cast<libtorrent::session_stats_alert>(alert));
+                break;
+            }
+            
+            case libtorrent::metadata_received_alert::alert_type: {
+                auto* metadata_alert = libtorrent::alert_cast<libtorrent::metadata_received_alert>(alert);
+                if (metadata_alert) {
+                    MetadataCache::handleMetadataReceived(*s_session, metadata_alert->handle);
+                }
+                break;
+            }
+            
+            case libtorrent::scrape_reply_alert::alert_type: {
+                auto* scrape_alert = libtorrent::alert_cast<libtorrent::scrape_reply_alert>(alert);
+                if (scrape_alert) {
+                    SeedScheduler::handleScrapeReply(scrape_alert->handle, scrape_alert->complete,
+                                                     scrape_alert->incomplete);
+                }
+                break;
+            }
+            
             case libtorrent::torrent_finished_alert::alert_type: {
                 auto* finished_alert = libtorrent::alert_cast<libtorrent::torrent_finished_alert>(alert);
-                if (finished_alert && s_complete_callback) {
-                    std::string name = finished_alert->handle.status().name;
-                    std::string save_path = finished_alert->handle.status().save_path;
-                    s_complete_callback(name, save_path);
+                
+                // Téléchargement terminé: il quitte la file et rejoint la rotation des partages
+                std::string key = finished_alert ? findTorrentName(finished_alert->handle) : "";
+                if (!key.empty()) {
+                    DownloadScheduler::remove(key);
+                    PiecePlanner::untrack(key);
+                    SeedScheduler::registerSeed(key, finished_alert->handle);
+                }
+                
+                if (finished_alert) {
+                    UiEvent event;
+                    event.type = EventType::DOWNLOAD_COMPLETE;
+                    event.job = finished_alert->handle.status().name;
+                    event.success = true;
+                    event.text = finished_alert->handle.status().save_path;
+                    EventQueue::post(std::move(event));
                 }
                 break;
             }
             
             case libtorrent::torrent_error_alert::alert_type: {
                 auto* error_alert = libtorrent::alert_cast<libtorrent::torrent_error_alert>(alert);
-                if (error_alert && s_error_callback) {
-                    std::string name = error_alert->handle.status().name;
-                    s_error_callback(name, error_alert->error.message());
+                if (error_alert) {
+                    postError(error_alert->handle.status().name, error_alert->error.message());
+                }
+                break;
+            }
+            
+            case libtorrent::listen_succeeded_alert::alert_type: {
+                auto* listen_alert = libtorrent::alert_cast<libtorrent::listen_succeeded_alert>(alert);
+                if (listen_alert) {
+                    LOG_INFO("Écoute active: " + listen_alert->address.to_string() + ":" +
+                             std::to_string(listen_alert->port));
+                }
+                break;
+            }
+            
+            case libtorrent::listen_failed_alert::alert_type: {
+                auto* listen_alert = libtorrent::alert_cast<libtorrent::listen_failed_alert>(alert);
+                if (listen_alert) {
+                    LOG_WARNING("Écoute impossible sur " + std::string(listen_alert->listen_interface()) + ": " +
+                                listen_alert->error.message());
                 }
                 break;
             }
             
             case libtorrent::state_update_alert::alert_type: {
                 auto* update_alert = libtorrent::alert_cast<libtorrent::state_update_alert>(alert);
-                if (update_alert && s_progress_callback) {
+                if (update_alert) {
                     for (const auto& status : update_alert->status) {
-                        std::string name = status.name;
-                        s_progress_callback(name, status.progress);
+                        UiEvent event;
+                        event.type = EventType::DOWNLOAD_PROGRESS;
+                        event.job = status.name;
+                        event.progress = status.progress;
+                        EventQueue::post(std::move(event));
                     }
                 }
                 break;
@@ -480,6 +1000,210 @@ void TorrentManager::processAlerts() {
 #endif
 }
 
+#ifndef NO_LIBTORRENT
+void TorrentManager::countPeersByFamily() {
+    std::vector<libtorrent::torrent_status> statuses;
+    s_session->get_torrent_status(&statuses, [](const libtorrent::torrent_status& status) {
+        return status.num_peers > 0;
+    });
+    
+    PeerFamilyCounts counts = {};
+    std::vector<libtorrent::peer_info> peers;
+    for (const auto& status : statuses) {
+        try {
+            status.handle.get_peer_info(peers);
+        } catch (const std::exception&) {
+            continue;
+        }
+        
+        // Peers ayant fourni des données: candidats du cache de démarrage rapide
+        FastStart::recordPeers(status, peers);
+        
+        for (const auto& peer : peers) {
+            bool ipv6 = peer.ip.address().is_v6();
+            bool incoming = !static_cast<bool>(peer.flags & libtorrent::peer_info::local_connection);
+            (ipv6 ? counts.ipv6 : counts.ipv4)++;
+            if (incoming) {
+                (ipv6 ? counts.incoming_ipv6 : counts.incoming_ipv4)++;
+            }
+        }
+    }
+    
+    if (counts.ipv4 != s_peer_counts.ipv4 || counts.ipv6 != s_peer_counts.ipv6) {
+        LOG_DEBUG("Peers IPv4: " + std::to_string(counts.ipv4) + " (" + std::to_string(counts.incoming_ipv4) +
+                  " entrants), IPv6: " + std::to_string(counts.ipv6) + " (" + std::to_string(counts.incoming_ipv6) +
+                  " entrants)");
+    }
+    s_peer_counts = counts;
+}
+
+std::string TorrentManager::findTorrentName(const libtorrent::torrent_handle& handle) {
+    for (const auto& pair : s_torrents) {
+        if (pair.second == handle) {
+            return pair.first;
+        }
+    }
+    return "";
+}
+
+void TorrentManager::handleAddTorrentAlert(const libtorrent::add_torrent_alert* alert) {
+    if (!alert) return;
+    
+    // Le nom interne est transporté dans params.name
+    const std::string& name = alert->params.name;
+    if (MetadataCache::isResolver(name)) {
+        MetadataCache::handleAdded(*s_session, alert);
+        return;
+    }
+    
+    auto it = s_admissions_in_flight.find(name);
+    bool is_seed = static_cast<bool>(alert->params.flags & libtorrent::torrent_flags::seed_mode);
+    
+    // Refus dû à une résolution de métadonnées annulée: elle est retirée, nouvel essai
+    if (alert->error && !is_seed && MetadataCache::takeCancelled(alert->params)) {
+        s_session->async_add_torrent(libtorrent::add_torrent_params(alert->params));
+        return;
+    }
+    
+    if (alert->error) {
+        LOG_ERROR("Erreur lors de l'ajout du torrent " + name + ": " + alert->error.message());
+        if (it != s_admissions_in_flight.end()) {
+            s_admitted_memory -= it->second;
+            s_admissions_in_flight.erase(it);
+        }
+        FastStart::forget(name);
+        postError(name, alert->error.message());
+        return;
+    }
+    
+    // Métadonnées chargées par la session: l'estimation quitte le budget des ajouts en cours
+    if (it != s_admissions_in_flight.end()) {
+        s_admitted_memory -= it->second;
+        s_admissions_in_flight.erase(it);
+    }
+    
+    s_torrents[name] = alert->handle;
+    
+    // Torrent encore en pause: aucune annonce n'a été envoyée
+    if (!s_session_options.enable_trackers) {
+        alert->handle.replace_trackers({});
+    }
+    
+    if (is_seed) {
+        s_staged_activations.push_back(name);
+    } else {
+        DownloadScheduler::enqueue(name, alert->handle);
+        PiecePlanner::track(name, alert->handle);
+        FastStart::attach(name, alert->handle);
+    }
+    
+    LOG_DEBUG("Torrent ajouté à la session: " + name);
+}
+
+void TorrentManager::pumpAdmissions() {
+    // Ajouts asynchrones dans la limite des ajouts simultanés et du budget mémoire
+    {
+        std::lock_guard<std::mutex> lock(s_admission_mutex);
+        
+        std::vector<int64_t> estimates;
+        estimates.reserve(s_admission_queue.size());
+        for (const PendingAdmission& admission : s_admission_queue) {
+            estimates.push_back(admission.memory_estimate);
+        }
+        
+        size_t issued = countAdmissible(estimates, static_cast<int>(s_admissions_in_flight.size()),
+                                        s_admitted_memory, s_admission_budget);
+        for (size_t i = 0; i < issued; i++) {
+            PendingAdmission& admission = s_admission_queue[i];
+            s_admitted_memory += admission.memory_estimate;
+            s_admissions_in_flight[admission.name] = admission.memory_estimate;
+            s_session->async_add_torrent(std::move(admission.params));
+        }
+        
+        if (issued > 0) {
+            s_admission_queue.erase(s_admission_queue.begin(), s_admission_queue.begin() + issued);
+        }
+        
+        // Retenue par le budget mémoire: signalée une fois par attente
+        bool held = !s_admission_queue.empty() &&
+                    static_cast<int>(s_admissions_in_flight.size()) < s_admission_budget.max_in_flight;
+        if (held && !s_admission_held) {
+            LOG_INFO("Admission retenue par le budget mémoire - en cours: " + Utils::formatFileSize(s_admitted_memory) +
+                     ", en file: " + std::to_string(s_admission_queue.size()));
+        }
+        s_admission_held = held;
+    }
+    
+    // Nettoyage des préparations terminées
+    s_admission_jobs.erase(std::remove_if(s_admission_jobs.begin(), s_admission_jobs.end(),
+        [](const TaskFuture<void>& job) {
+            return job.isReady();
+        }), s_admission_jobs.end());
+    
+    // Activation progressive des torrents ajoutés en pause
+    if (s_staged_activations.empty()) return;
+    
+    int64_t now = Utils::getCurrentTimestamp();
+    if (now - s_last_activation_time < s_admission_budget.activation_interval_ms) return;
+    s_last_activation_time = now;
+    
+    // Les seeds sont confiés au planificateur, qui les active selon la demande
+    int activations = std::min<int>(s_admission_budget.max_activations_per_tick,
+                                    s_staged_activations.size());
+    for (int i = 0; i < activations; i++) {
+        auto it = s_torrents.find(s_staged_activations[i]);
+        if (it != s_torrents.end() && it->second.is_valid()) {
+            SeedScheduler::registerSeed(it->first, it->second);
+        }
+    }
+    s_staged_activations.erase(s_staged_activations.begin(), s_staged_activations.begin() + activations);
+    
+    // Nombre de seeds actifs dérivé du budget de connexions
+    SeedSchedulerConfig config = SeedScheduler::getConfig();
+    int max_active = std::max(1, s_session->get_settings().get_int(libtorrent::settings_pack::connections_limit) /
+                                 s_admission_budget.connections_per_torrent);
+    if (config.max_active_seeds != max_active) {
+        config.max_active_seeds = max_active;
+        SeedScheduler::configure(config);
+    }
+}
+
+bool TorrentManager::prepareSeedParams(const ShareRequest& request, PendingAdmission& admission) {
+    try {
+        std::string torrent_path = s_download_path + "/" + request.name + ".torrent";
+        
+        // Réutilisation du .torrent existant, création sinon
+        if (!Utils::fileExists(torrent_path)) {
+            LOG_INFO("Création du torrent pour: " + request.name);
+            createTorrentFile(request.pkg_path, torrent_path);
+        }
+        
+        libtorrent::error_code ec;
+        auto ti = std::make_shared<libtorrent::torrent_info>(torrent_path, ec);
+        if (ec) {
+            LOG_ERROR("Fichier torrent invalide " + torrent_path + ": " + ec.message());
+            return false;
+        }
+        
+        admission.name = request.name;
+        admission.memory_estimate = TORRENT_BASE_MEMORY + ti->metadata_size();
+        
+        admission.params.ti = ti;
+        admission.params.name = request.name;
+        admission.params.save_path = Utils::directoryExists(request.pkg_path) ? request.pkg_path :
+                                     request.pkg_path.substr(0, request.pkg_path.find_last_of('/'));
+        admission.params.flags |= libtorrent::torrent_flags::seed_mode;
+        admission.params.flags |= libtorrent::torrent_flags::paused;
+        admission.params.flags &= ~libtorrent::torrent_flags::auto_managed;
+        return true;
+        
+    } catch (const std::exception& e) {
+        LOG_ERROR("Erreur lors de la préparation du partage " + request.name + ": " + std::string(e.what()));
+        return false;
+    }
+}
+#endif
+
 std::string TorrentManager::getStatusString(int state) {
 #ifndef NO_LIBTORRENT
     switch (state) {
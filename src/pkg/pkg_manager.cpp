@@ -4,6 +4,10 @@
 
 #include "pkg/pkg_manager.h"
 #include "utils/utils.h"
+#include "utils/trace.h"
+#include "utils/metrics.h"
+#include "utils/event_queue.h"
+#include "utils/progress_publisher.h"
 
 #include <fstream>
 #include <iostream>
@@ -54,13 +58,16 @@ struct SfoIndexTableEntry {
 std::string PkgManager::s_install_path = "/user/app";
 std::string PkgManager::s_temp_path = "/data/ps4_store/temp";
 InstallProgress PkgManager::s_current_install;
-bool PkgManager::s_install_in_progress = false;
+std::mutex PkgManager::s_install_mutex;
+std::atomic<bool> PkgManager::s_install_in_progress(false);
+TaskFuture<bool> PkgManager::s_install_task;
 
 InstallProgressCallback PkgManager::s_progress_callback = nullptr;
 InstallCompleteCallback PkgManager::s_complete_callback = nullptr;
 
 int PkgManager::initialize() {
     LOG_INFO("Initialisation du gestionnaire de packages...");
+    subscribeEvents();
     
     // Création des dossiers nécessaires
     if (!Utils::directoryExists(s_install_path)) {
@@ -78,7 +85,10 @@ int PkgManager::initialize() {
     }
     
     // Initialisation de l'état d'installation
-    s_current_install = {};
+    {
+        std::lock_guard<std::mutex> lock(s_install_mutex);
+        s_current_install = {};
+    }
     s_install_in_progress = false;
     
     LOG_INFO("Gestionnaire de packages initialisé avec succès");
@@ -92,6 +102,9 @@ void PkgManager::cleanup() {
     if (s_install_in_progress) {
         cancelCurrentInstall();
     }
+    if (s_install_task.valid()) {
+        s_install_task.wait();
+    }
     
     // Nettoyage des fichiers temporaires
     cleanupTempFiles();
@@ -99,13 +112,6 @@ void PkgManager::cleanup() {
     LOG_INFO("Gestionnaire de packages nettoyé");
 }
 
-void PkgManager::update() {
-    // Mise à jour du progrès d'installation si nécessaire
-    if (s_install_in_progress && s_progress_callback) {
-        s_progress_callback(s_current_install);
-    }
-}
-
 PackageInfo PkgManager::analyzePackage(const std::string& pkg_path) {
     PackageInfo info = {};
     info.file_path = pkg_path;
@@ -154,6 +160,7 @@ PackageInfo PkgManager::analyzePackage(const std::string& pkg_path) {
 }
 
 bool PkgManager::verifyPackage(const std::string& pkg_path, const std::string& expected_checksum) {
+    TRACE_SCOPE("pkg", "verifyPackage");
     LOG_INFO("Vérification du package: " + pkg_path);
     
     if (!Utils::fileExists(pkg_path)) {
@@ -181,68 +188,95 @@ bool PkgManager::verifyPackage(const std::string& pkg_path, const std::string& e
 }
 
 bool PkgManager::installPackage(const std::string& pkg_path, bool force_install) {
-    if (s_install_in_progress) {
+    if (s_install_in_progress.exchange(true)) {
         LOG_WARNING("Installation déjà en cours");
         return false;
     }
     
     LOG_INFO("Démarrage de l'installation: " + pkg_path);
     
-    // Analyse du package
-    PackageInfo info = analyzePackage(pkg_path);
-    if (!info.is_valid) {
-        LOG_ERROR("Package invalide, installation annulée");
-        return false;
+    // Initialisation du suivi d'installation (nom et taille connus après l'analyse)
+    {
+        std::lock_guard<std::mutex> lock(s_install_mutex);
+        s_current_install = {};
+        s_current_install.package_name = pkg_path.substr(pkg_path.find_last_of('/') + 1);
+        s_current_install.status = InstallStatus::NOT_STARTED;
+        s_current_install.progress = 0.0f;
+        s_current_install.total_bytes = 0;
+        s_current_install.bytes_copied = 0;
+        s_current_install.bytes_per_second = 0;
+        s_current_install.eta_seconds = -1;
     }
     
-    // Vérification si déjà installé
-    if (!force_install && isPackageInstalled(info.title_id)) {
-        LOG_WARNING("Package déjà installé: " + info.title_id);
-        return false;
-    }
-    
-    // Vérification de l'espace disque
-    if (!checkDiskSpace(info.file_size * 2)) { // x2 pour l'extraction
-        LOG_ERROR("Espace disque insuffisant");
-        return false;
-    }
-    
-    // Initialisation du suivi d'installation
-    s_current_install = {};
-    s_current_install.package_name = info.title;
-    s_current_install.status = InstallStatus::COPYING;
-    s_current_install.progress = 0.0f;
-    s_current_install.total_bytes = info.file_size;
-    s_current_install.bytes_copied = 0;
-    s_install_in_progress = true;
-    
-    // Lancement de l'installation dans un thread séparé
-    std::thread install_thread([pkg_path, info]() {
+    // Analyse, vérifications et installation dans la réserve de threads: le thread
+    // appelant (l'interface) ne lit aucun fichier; annulable entre deux étapes
+    CancellationToken token;
+    s_install_task = ThreadPool::submit([pkg_path, force_install, token]() {
+        TRACE_SCOPE("pkg", "installPackage");
         bool success = false;
         
+        auto checkCancelled = [&token]() {
+            if (token.isCancelled()) throw std::runtime_error("Installation annulée");
+        };
+        
         try {
+            // Étape 0: Analyse du package
+            updateInstallProgress("Analyse du package...", 0.0f);
+            PackageInfo info = analyzePackage(pkg_path);
+            if (!info.is_valid) {
+                throw std::runtime_error("Package invalide");
+            }
+            
+            if (!force_install && isPackageInstalled(info.title_id)) {
+                throw std::runtime_error("Package déjà installé: " + info.title_id);
+            }
+            
+            if (!checkDiskSpace(info.file_size * 2)) { // x2 pour l'extraction
+                throw std::runtime_error("Espace disque insuffisant");
+            }
+            
+            {
+                std::lock_guard<std::mutex> lock(s_install_mutex);
+                s_current_install.package_name = info.title;
+                s_current_install.total_bytes = info.file_size;
+            }
+            checkCancelled();
+            
             // Étape 1: Copie vers le dossier temporaire
+            setInstallStatus(InstallStatus::COPYING);
             updateInstallProgress("Copie du package...", 0.1f);
             std::string temp_pkg = s_temp_path + "/" + info.title_id + ".pkg";
             
-            if (!copyFileWithProgress(pkg_path, temp_pkg)) {
-                throw std::runtime_error("Erreur lors de la copie");
+            {
+                MetricTimer stage(Metrics::histogram("install_copy_us", "Étape de copie d'une installation (µs)"));
+                if (!copyFileWithProgress(pkg_path, temp_pkg, token)) {
+                    checkCancelled();
+                    throw std::runtime_error("Erreur lors de la copie");
+                }
             }
+            checkCancelled();
             
             // Étape 2: Vérification
             updateInstallProgress("Vérification...", 0.3f);
-            s_current_install.status = InstallStatus::VERIFYING;
+            setInstallStatus(InstallStatus::VERIFYING);
             
-            if (!verifyPackage(temp_pkg)) {
-                throw std::runtime_error("Vérification échouée");
+            {
+                MetricTimer stage(Metrics::histogram("install_verify_us", "Étape de vérification d'une installation (µs)"));
+                if (!verifyPackage(temp_pkg)) {
+                    throw std::runtime_error("Vérification échouée");
+                }
             }
+            checkCancelled();
             
             // Étape 3: Installation via Debug Settings
             updateInstallProgress("Installation...", 0.5f);
-            s_current_install.status = InstallStatus::INSTALLING;
+            setInstallStatus(InstallStatus::INSTALLING);
             
-            if (!triggerDebugInstall(temp_pkg)) {
-                throw std::runtime_error("Installation échouée");
+            {
+                MetricTimer stage(Metrics::histogram("install_register_us", "Étape d'installation système (µs)"));
+                if (!triggerDebugInstall(temp_pkg)) {
+                    throw std::runtime_error("Installation échouée");
+                }
             }
             
             // Étape 4: Finalisation
@@ -252,26 +286,62 @@ bool PkgManager::installPackage(const std::string& pkg_path, bool force_install)
             Utils::deleteFile(temp_pkg);
             
             updateInstallProgress("Terminé", 1.0f);
-            s_current_install.status = InstallStatus::COMPLETED;
+            setInstallStatus(InstallStatus::COMPLETED);
             success = true;
             
         } catch (const std::exception& e) {
-            LOG_ERROR("Erreur d'installation: " + std::string(e.what()));
-            s_current_install.status = InstallStatus::FAILED;
-            s_current_install.error_message = e.what();
+            if (token.isCancelled()) {
+                LOG_INFO("Installation annulée: " + pkg_path);
+                setInstallStatus(InstallStatus::CANCELLED, e.what());
+                cleanupTempFiles();
+            } else {
+                LOG_ERROR("Erreur d'installation: " + std::string(e.what()));
+                setInstallStatus(InstallStatus::FAILED, e.what());
+            }
         }
         
-        s_install_in_progress = false;
+        finishInstall(success);
+        return success;
+    }, TaskPriority::BULK, token);
+    
+    // Annulée avant d'avoir démarré: la tâche n'a pas été exécutée, la fin est signalée ici
+    s_install_task.then([pkg_path](const TaskFuture<bool>& task) {
+        if (!task.isCancelled()) return;
         
-        if (s_complete_callback) {
-            s_complete_callback(s_current_install.package_name, success);
-        }
+        LOG_INFO("Installation annulée avant son démarrage: " + pkg_path);
+        setInstallStatus(InstallStatus::CANCELLED, "Installation annulée");
+        finishInstall(false);
     });
     
-    install_thread.detach();
     return true;
 }
 
+TaskFuture<PackageInfo> PkgManager::analyzePackageAsync(const std::string& pkg_path, PackageInfoCallback on_done) {
+    auto task = ThreadPool::submit([pkg_path]() { return analyzePackage(pkg_path); }, TaskPriority::INTERACTIVE);
+    if (on_done) {
+        task.then([on_done](TaskFuture<PackageInfo> result) {
+            PackageInfo info = result.get();
+            EventQueue::postCall([on_done, info]() { on_done(info); });
+        }, TaskPriority::INTERACTIVE);
+    }
+    return task;
+}
+
+TaskFuture<bool> PkgManager::verifyPackageAsync(const std::string& pkg_path, const std::string& expected_checksum,
+                                                VerifyCallback on_done) {
+    // Hachage du fichier entier: travail de fond
+    auto task = ThreadPool::submit([pkg_path, expected_checksum]() {
+        return verifyPackage(pkg_path, expected_checksum);
+    }, TaskPriority::BULK);
+    if (on_done) {
+        task.then([on_done](TaskFuture<bool> result) {
+            bool valid = result.get();
+            EventQueue::postCall([on_done, valid]() { on_done(valid); });
+        }, TaskPriority::INTERACTIVE);
+    }
+    return task;
+}
+
 bool PkgManager::uninstallPackage(const std::string& title_id) {
     LOG_INFO("Désinstallation du package: " + title_id);
     
@@ -379,6 +449,7 @@ PackageInfo PkgManager::getInstalledPackageInfo(const std::string& title_id) {
 }
 
 InstallProgress PkgManager::getCurrentInstallProgress() {
+    std::lock_guard<std::mutex> lock(s_install_mutex);
     return s_current_install;
 }
 
@@ -389,11 +460,10 @@ bool PkgManager::cancelCurrentInstall() {
     
     LOG_INFO("Annulation de l'installation en cours");
     
-    s_current_install.status = InstallStatus::CANCELLED;
-    s_install_in_progress = false;
-    
-    // Nettoyage des fichiers temporaires
-    cleanupTempFiles();
+    // La tâche s'arrête d'elle-même et nettoie ses fichiers temporaires
+    if (s_install_task.valid()) {
+        s_install_task.cancel();
+    }
     
     return true;
 }
@@ -403,6 +473,7 @@ bool PkgManager::copyPackageToInstallDir(const std::string& source_path, const s
 }
 
 bool PkgManager::triggerDebugInstall(const std::string& pkg_path) {
+    TRACE_SCOPE("pkg", "triggerDebugInstall");
     LOG_INFO("Déclenchement de l'installation via Debug Settings");
     
     // Sur PS4, ceci nécessiterait l'utilisation des APIs système
@@ -453,6 +524,7 @@ void PkgManager::setInstallCompleteCallback(InstallCompleteCallback callback) {
 
 std::string PkgManager::calculateSHA256(const std::string& file_path) {
     // Implémentation simplifiée - dans un vrai projet, utiliser une lib crypto
+    TRACE_SCOPE("pkg", "calculateSHA256");
     LOG_DEBUG("Calcul du SHA256 pour: " + file_path);
     
     // Pour le moment, retourner un hash fictif
@@ -541,14 +613,23 @@ bool PkgManager::validatePkgStructure(const std::string& pkg_path) {
 }
 
 void PkgManager::updateInstallProgress(const std::string& operation, float progress) {
-    s_current_install.current_operation = operation;
-    s_current_install.progress = progress;
+    UiEvent event;
+    event.type = EventType::INSTALL_PROGRESS;
+    event.progress = progress;
+    {
+        std::lock_guard<std::mutex> lock(s_install_mutex);
+        s_current_install.current_operation = operation;
+        s_current_install.progress = progress;
+        event.job = s_current_install.package_name;
+    }
+    EventQueue::post(std::move(event));
     
-    LOG_DEBUG("Progrès d'installation: " + operation + " (" + 
-              Utils::formatPercentage(progress) + ")");
+    LOG_DEBUGF("Progrès d'installation: {} ({})", operation, Utils::formatPercentage(progress));
 }
 
-bool PkgManager::copyFileWithProgress(const std::string& source, const std::string& dest) {
+bool PkgManager::copyFileWithProgress(const std::string& source, const std::string& dest,
+                                      const CancellationToken& token) {
+    TRACE_SCOPE("pkg", "copyFileWithProgress");
     std::ifstream src(source, std::ios::binary);
     std::ofstream dst(dest, std::ios::binary);
     
@@ -560,26 +641,78 @@ bool PkgManager::copyFileWithProgress(const std::string& source, const std::stri
     std::vector<char> buffer(buffer_size);
     
     int64_t total_size = Utils::getFileSize(source);
-    int64_t copied = 0;
-    
-    while (src.read(buffer.data(), buffer_size) || src.gcount() > 0) {
-        dst.write(buffer.data(), src.gcount());
-        copied += src.gcount();
-        
-        s_current_install.bytes_copied = copied;
+    auto start = std::chrono::steady_clock::now();
+    
+    // Progression publiée toutes les 50 ms au plus, pas à chaque bloc
+    ProgressPublisher publisher(total_size, [](const ProgressSample& sample) {
+        {
+            std::lock_guard<std::mutex> lock(s_install_mutex);
+            s_current_install.bytes_copied = sample.done;
+            s_current_install.bytes_per_second = sample.bytes_per_second;
+            s_current_install.eta_seconds = sample.eta_seconds;
+        }
+        TRACE_COUNTER("install_copied_bytes", sample.done);
         
-        if (total_size > 0) {
-            float progress = static_cast<float>(copied) / total_size;
-            updateInstallProgress("Copie en cours...", progress * 0.2f); // 20% pour la copie
+        if (sample.total > 0) {
+            updateInstallProgress("Copie en cours...", sample.fraction * 0.2f); // 20% pour la copie
         }
+    });
+    
+    while (!token.isCancelled() && (src.read(buffer.data(), buffer_size) || src.gcount() > 0)) {
+        dst.write(buffer.data(), src.gcount());
+        publisher.add(src.gcount());
     }
     
     src.close();
     dst.close();
+    publisher.finish();
+    int64_t copied = publisher.done();
+    
+    // Débit de la dernière copie, et total pour un débit moyen côté collecteur
+    static MetricCounter& copied_bytes = Metrics::counter("install_copied_bytes_total", "Octets copiés par les installations");
+    static MetricGauge& copy_rate = Metrics::gauge("install_copy_bytes_per_second", "Débit de la dernière copie d'installation");
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    copied_bytes.add(copied);
+    if (seconds > 0) {
+        copy_rate.set(static_cast<int64_t>(static_cast<double>(copied) / seconds));
+    }
     
     return copied == total_size;
 }
 
+void PkgManager::setInstallStatus(InstallStatus status, const std::string& error_message) {
+    std::lock_guard<std::mutex> lock(s_install_mutex);
+    s_current_install.status = status;
+    s_current_install.error_message = error_message;
+}
+
+void PkgManager::finishInstall(bool success) {
+    s_install_in_progress = false;
+    
+    // Fin livrée sur le thread principal, après la dernière progression
+    InstallProgress progress = getCurrentInstallProgress();
+    UiEvent event;
+    event.type = EventType::INSTALL_COMPLETE;
+    event.job = progress.package_name;
+    event.success = success;
+    event.text = progress.error_message;
+    EventQueue::post(std::move(event));
+}
+
+void PkgManager::subscribeEvents() {
+    // Callbacks appelés par EventQueue::dispatch, sur le thread principal
+    static bool subscribed = false;
+    if (subscribed) return;
+    subscribed = true;
+    
+    EventQueue::subscribe(EventType::INSTALL_PROGRESS, [](const UiEvent&) {
+        if (s_progress_callback) s_progress_callback(getCurrentInstallProgress());
+    });
+    EventQueue::subscribe(EventType::INSTALL_COMPLETE, [](const UiEvent& event) {
+        if (s_complete_callback) s_complete_callback(event.job, event.success, event.text);
+    });
+}
+
 std::string PkgManager::formatFileSize(int64_t bytes) {
     return Utils::formatFileSize(bytes);
 }
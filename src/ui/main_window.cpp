@@ -4,12 +4,18 @@
 
 #include "ui/main_window.h"
 #include "utils/utils.h"
+#include "utils/trace.h"
+#include "utils/startup.h"
 #include "p2p/torrent_manager.h"
+#include "p2p/metadata_cache.h"
+#include "p2p/scrape_service.h"
 #include "pkg/pkg_manager.h"
 
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 #include <iostream>
+#include <fstream>
+#include <iterator>
 #include <algorithm>
 
 // Variables statiques
@@ -91,6 +97,13 @@ int MainWindow::initialize() {
     // Initialisation des données de test
     initializeTestData();
     
+    // Résolution des métadonnées du catalogue en arrière-plan
+    std::vector<std::string> magnets;
+    for (const auto& game : s_available_games) {
+        magnets.push_back(game.magnet_link);
+    }
+    MetadataCache::prefetch(magnets);
+    
     // Configuration des callbacks
     TorrentManager::setProgressCallback([](const std::string& name, float progress) {
         updateDownloadProgress(name, progress);
@@ -105,6 +118,15 @@ int MainWindow::initialize() {
         showNotification("Erreur de téléchargement: " + error, NotificationType::ERROR);
     });
     
+    // Installation conduite par la réserve de threads, fin livrée par EventQueue::dispatch
+    PkgManager::setInstallCompleteCallback([](const std::string& name, bool success, const std::string& error) {
+        if (success) {
+            showNotification("Installation terminée: " + name, NotificationType::SUCCESS);
+        } else {
+            showNotification("Échec de l'installation: " + error, NotificationType::ERROR);
+        }
+    });
+    
     LOG_INFO("Interface utilisateur initialisée avec succès");
     return 0;
 }
@@ -150,6 +172,7 @@ bool MainWindow::handleEvents() {
 }
 
 void MainWindow::render() {
+    TRACE_SCOPE("ui", "MainWindow::render");
     // Effacement de l'écran
     SDL_SetRenderDrawColor(s_renderer, COLOR_BACKGROUND.r, COLOR_BACKGROUND.g, COLOR_BACKGROUND.b, COLOR_BACKGROUND.a);
     SDL_RenderClear(s_renderer);
@@ -212,16 +235,34 @@ bool MainWindow::loadFonts() {
     // Chargement des polices (utilisation d'une police système par défaut)
     // Sur PS4, il faudrait utiliser les polices système disponibles
     
-    const char* font_path = "/system/fonts/SCE-PS3-RD-R-LATIN.TTF"; // Police PS4 fictive
+    const char* system_font = "/system/fonts/SCE-PS3-RD-R-LATIN.TTF"; // Police PS4 fictive
+    const char* font_path = system_font;
     
     // Fallback vers une police par défaut si la police PS4 n'est pas disponible
     if (!Utils::fileExists(font_path)) {
         font_path = nullptr; // SDL utilisera une police par défaut
     }
     
-    s_font_large = TTF_OpenFont(font_path, 32);
-    s_font_medium = TTF_OpenFont(font_path, 24);
-    s_font_small = TTF_OpenFont(font_path, 16);
+    // Fichier lu une fois pour les trois tailles (gardé en mémoire tant que les polices servent)
+    static std::string font_data;
+    if (font_path && font_data.empty()) {
+        std::ifstream file(font_path, std::ios::binary);
+        font_data.assign(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+    if (font_data.empty()) {
+        // Aucun appel SDL_ttf n'a échoué: TTF_GetError ne décrirait pas cette erreur
+        LOG_ERROR("Erreur de chargement des polices: fichier introuvable ou illisible: " +
+                  std::string(system_font));
+        return false;
+    }
+    
+    auto openFont = [](int size) -> TTF_Font* {
+        return TTF_OpenFontRW(SDL_RWFromConstMem(font_data.data(), static_cast<int>(font_data.size())), 1, size);
+    };
+    
+    s_font_large = openFont(32);
+    s_font_medium = openFont(24);
+    s_font_small = openFont(16);
     
     if (!s_font_large || !s_font_medium || !s_font_small) {
         LOG_ERROR("Erreur de chargement des polices: " + std::string(TTF_GetError()));
@@ -457,7 +498,9 @@ void MainWindow::handleDownloadsSelect() {
         if (download.is_finished) {
             // Installer le package
             showNotification("Installation de " + download.name + "...", NotificationType::INFO);
-            PkgManager::installPackage(download.save_path + "/" + download.name + ".pkg");
+            if (!PkgManager::installPackage(download.save_path + "/" + download.name + ".pkg")) {
+                showNotification("Une installation est déjà en cours", NotificationType::INFO);
+            }
         } else {
             // Pause/reprise du téléchargement
             TorrentManager::stopDownload(download.name);
@@ -467,6 +510,8 @@ void MainWindow::handleDownloadsSelect() {
 }
 
 void MainWindow::updateDownloadsList() {
+    // Session encore en création dans la réserve de threads: liste vide
+    if (!Startup::isReady("p2p")) return;
     s_active_downloads = TorrentManager::getDownloads();
 }
 
@@ -505,6 +550,8 @@ void MainWindow::renderGameList() {
     // Titre
     renderText("Jeux disponibles", 100, 50, s_font_large, COLOR_TEXT);
     
+    refreshSwarmCounts();
+    
     // Liste des jeux
     const int items_per_page = 8;
     const int item_height = 100;
@@ -544,6 +591,14 @@ void MainWindow::renderDownloads() {
     // Titre
     renderText("Téléchargements actifs", 100, 50, s_font_large, COLOR_TEXT);
     
+    // Peers connectés par famille d'adresses
+    PeerFamilyCounts peers = {};
+    if (Startup::isReady("p2p")) {
+        peers = TorrentManager::getPeerFamilyCounts();
+    }
+    renderText("Peers: " + std::to_string(peers.ipv4) + " IPv4 / " + std::to_string(peers.ipv6) + " IPv6",
+               1400, 60, s_font_small, COLOR_TEXT_SECONDARY);
+    
     if (s_active_downloads.empty()) {
         renderText("Aucun téléchargement en cours", 960, 400, s_font_medium, COLOR_TEXT_SECONDARY, true);
         return;
@@ -633,6 +688,29 @@ void MainWindow::renderGameDetails() {
     renderText("Entrée: Télécharger | Retour: Liste des jeux", 100, 1000, s_font_small, COLOR_TEXT_SECONDARY);
 }
 
+void MainWindow::refreshSwarmCounts() {
+    if (!Startup::isReady("scrape")) return;
+    
+    // Lignes visibles plus une page de part et d'autre: le défilement trouve des valeurs fraîches
+    const int items_per_page = 8;
+    int first = std::max(0, s_scroll_offset - items_per_page);
+    int last = std::min(static_cast<int>(s_available_games.size()), s_scroll_offset + 2 * items_per_page);
+    
+    std::vector<std::string> magnets;
+    for (int i = first; i < last; i++) {
+        magnets.push_back(s_available_games[i].magnet_link);
+    }
+    ScrapeService::requestRefresh(magnets);
+    
+    for (int i = first; i < last; i++) {
+        SwarmCounts counts;
+        if (ScrapeService::getCounts(s_available_games[i].magnet_link, counts)) {
+            s_available_games[i].seeders = counts.seeders;
+            s_available_games[i].leechers = counts.leechers;
+        }
+    }
+}
+
 void MainWindow::renderNotifications() {
     if (s_notification_text.empty()) {
         return;
@@ -665,6 +743,8 @@ void MainWindow::renderText(const std::string& text, int x, int y, TTF_Font* fon
         return;
     }
     
+    TRACE_SCOPE("ui", "renderText");
+    
     SDL_Surface* surface = TTF_RenderText_Blended(font, text.c_str(), color);
     if (!surface) {
         return;
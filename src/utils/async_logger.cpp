@@ -0,0 +1,353 @@
+/**
+ * PS4 Store P2P - Implémentation du Journal Asynchrone
+ */
+
+#include "utils/async_logger.h"
+#include "utils/trace.h"
+
+#include <chrono>
+#include <ctime>
+#include <vector>
+#include <algorithm>
+
+// Variables statiques
+std::unique_ptr<AsyncLogger::Slot[]> AsyncLogger::s_slots;
+size_t AsyncLogger::s_mask = 0;
+std::atomic<size_t> AsyncLogger::s_enqueue_pos(0);
+size_t AsyncLogger::s_dequeue_pos = 0;
+std::atomic<bool> AsyncLogger::s_running(false);
+std::atomic<int64_t> AsyncLogger::s_dropped(0);
+std::atomic<int64_t> AsyncLogger::s_pushed(0);
+std::atomic<int64_t> AsyncLogger::s_written(0);
+std::atomic<int> AsyncLogger::s_producers(0);
+int64_t AsyncLogger::s_reported_dropped = 0;
+std::thread AsyncLogger::s_thread;
+std::mutex AsyncLogger::s_wakeup_mutex;
+std::condition_variable AsyncLogger::s_wakeup;
+std::condition_variable AsyncLogger::s_drained;
+std::mutex AsyncLogger::s_output_mutex;
+std::string AsyncLogger::s_file_path;
+FILE* AsyncLogger::s_file = nullptr;
+int64_t AsyncLogger::s_file_size = 0;
+int64_t AsyncLogger::s_max_file_size = 0;
+int AsyncLogger::s_backups = 2;
+int64_t AsyncLogger::s_cached_second = -1;
+std::string AsyncLogger::s_cached_time;
+
+// Intervalle d'écriture des lots, et remplissage qui réveille le thread plus tôt
+static const int WRITE_INTERVAL_MS = 50;
+static const size_t WAKEUP_FRACTION = 4;
+
+void AsyncLogger::start(size_t capacity) {
+    if (s_running.load()) return;
+    
+    // L'anneau est conservé après stop(): un producteur peut encore le lire
+    if (!s_slots) {
+        size_t size = 64;
+        while (size < capacity) size <<= 1;
+        s_slots.reset(new Slot[size]);
+        s_mask = size - 1;
+        for (size_t i = 0; i < size; i++) {
+            s_slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+        s_enqueue_pos.store(0, std::memory_order_relaxed);
+        s_dequeue_pos = 0;
+    }
+    
+    s_running.store(true);
+    s_thread = std::thread(&AsyncLogger::run);
+}
+
+void AsyncLogger::stop() {
+    if (!s_running.exchange(false)) return;
+    
+    s_wakeup.notify_one();
+    if (s_thread.joinable()) {
+        s_thread.join();
+    }
+    
+    // Producteurs entrés avant l'arrêt: leurs messages, déposés après le dernier
+    // passage du thread d'écriture, sont écrits ici
+    while (s_producers.load() != 0) {
+        std::this_thread::yield();
+    }
+    std::vector<Record> records;
+    Record record;
+    while (pop(record)) {
+        records.push_back(std::move(record));
+    }
+    writeRecords(records);
+    
+    std::lock_guard<std::mutex> lock(s_output_mutex);
+    if (s_file) {
+        fclose(s_file);
+        s_file = nullptr;
+    }
+}
+
+bool AsyncLogger::isRunning() {
+    return s_running.load(std::memory_order_relaxed);
+}
+
+bool AsyncLogger::push(Utils::LogLevel level, int64_t timestamp, const char* file, int line, std::string message) {
+    // Compté avant de lire s_running: stop() attend la fin des dépôts commencés
+    s_producers.fetch_add(1);
+    if (!s_running.load()) {
+        s_producers.fetch_sub(1, std::memory_order_release);
+        
+        // Avant start() ou après stop(): écriture directe
+        std::string out;
+        Record record{level, timestamp, file, line, std::move(message)};
+        std::lock_guard<std::mutex> lock(s_output_mutex);
+        appendFormatted(out, record);
+        writeBatch(out);
+        return true;
+    }
+    
+    // File bornée de Vyukov: chaque case porte un numéro de séquence
+    size_t position = s_enqueue_pos.load(std::memory_order_relaxed);
+    Slot* slot;
+    while (true) {
+        slot = &s_slots[position & s_mask];
+        size_t sequence = slot->sequence.load(std::memory_order_acquire);
+        intptr_t difference = static_cast<intptr_t>(sequence) - static_cast<intptr_t>(position);
+        if (difference == 0) {
+            if (s_enqueue_pos.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                break;
+            }
+        } else if (difference < 0) {
+            s_dropped.fetch_add(1, std::memory_order_relaxed);
+            s_producers.fetch_sub(1, std::memory_order_release);
+            return false;
+        } else {
+            position = s_enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+    
+    slot->record.level = level;
+    slot->record.timestamp = timestamp;
+    slot->record.file = file;
+    slot->record.line = line;
+    slot->record.message = std::move(message);
+    slot->sequence.store(position + 1, std::memory_order_release);
+    s_pushed.fetch_add(1, std::memory_order_relaxed);
+    s_producers.fetch_sub(1, std::memory_order_release);
+    
+    // Réveil anticipé tous les quarts d'anneau et pour une erreur (sans verrou: au pire, le délai d'écriture)
+    if (level == Utils::LogLevel::ERROR || (position & (s_mask / WAKEUP_FRACTION)) == 0) {
+        s_wakeup.notify_one();
+    }
+    return true;
+}
+
+void AsyncLogger::flush() {
+    if (!s_running.load()) return;
+    
+    int64_t target = s_pushed.load();
+    s_wakeup.notify_one();
+    
+    std::unique_lock<std::mutex> lock(s_wakeup_mutex);
+    s_drained.wait_for(lock, std::chrono::seconds(2), [target] {
+        return s_written.load() >= target || !s_running.load();
+    });
+}
+
+void AsyncLogger::setFile(const std::string& path) {
+    std::lock_guard<std::mutex> lock(s_output_mutex);
+    if (s_file) {
+        fclose(s_file);
+        s_file = nullptr;
+    }
+    s_file_path = path;
+}
+
+void AsyncLogger::setMaxFileSize(int64_t bytes, int backups) {
+    std::lock_guard<std::mutex> lock(s_output_mutex);
+    s_max_file_size = bytes > 0 ? bytes : 0;
+    s_backups = backups > 0 ? backups : 1;
+}
+
+int64_t AsyncLogger::getDropped() {
+    return s_dropped.load(std::memory_order_relaxed);
+}
+
+int64_t AsyncLogger::getQueueDepth() {
+    return std::max<int64_t>(0, s_pushed.load(std::memory_order_relaxed) - s_written.load(std::memory_order_relaxed));
+}
+
+std::string AsyncLogger::formatRecord(Utils::LogLevel level, int64_t timestamp, const char* file, int line,
+                                      const std::string& message) {
+    std::string out;
+    Record record{level, timestamp, file, line, message};
+    std::lock_guard<std::mutex> lock(s_output_mutex);
+    appendFormatted(out, record);
+    out.pop_back();
+    return out;
+}
+
+// Méthodes privées
+bool AsyncLogger::pop(Record& record) {
+    Slot& slot = s_slots[s_dequeue_pos & s_mask];
+    size_t sequence = slot.sequence.load(std::memory_order_acquire);
+    if (sequence != s_dequeue_pos + 1) {
+        return false;
+    }
+    
+    record = std::move(slot.record);
+    slot.sequence.store(s_dequeue_pos + s_mask + 1, std::memory_order_release);
+    s_dequeue_pos++;
+    return true;
+}
+
+void AsyncLogger::run() {
+    TRACE_THREAD_NAME("log");
+    std::vector<Record> records;
+    Record record;
+    
+    while (true) {
+        bool running = s_running.load();
+        while (pop(record)) {
+            records.push_back(std::move(record));
+        }
+        
+        writeRecords(records);
+        
+        // Arrêt après le dernier passage, une fois l'anneau vidé
+        if (!running) break;
+        
+        std::unique_lock<std::mutex> lock(s_wakeup_mutex);
+        s_wakeup.wait_for(lock, std::chrono::milliseconds(WRITE_INTERVAL_MS));
+    }
+    
+    std::lock_guard<std::mutex> lock(s_wakeup_mutex);
+    s_drained.notify_all();
+}
+
+void AsyncLogger::writeRecords(std::vector<Record>& records) {
+    if (!records.empty() || s_dropped.load(std::memory_order_relaxed) != s_reported_dropped) {
+        std::string batch;
+        std::lock_guard<std::mutex> lock(s_output_mutex);
+        for (const auto& pending : records) {
+            appendFormatted(batch, pending);
+        }
+        
+        // Pertes signalées une fois par lot, dans le journal lui-même
+        int64_t dropped = s_dropped.load(std::memory_order_relaxed);
+        if (dropped != s_reported_dropped) {
+            Record notice{Utils::LogLevel::WARNING, Utils::getCurrentTimestamp(), nullptr, 0,
+                          std::to_string(dropped - s_reported_dropped) +
+                          " messages de log perdus (file d'attente pleine)"};
+            appendFormatted(batch, notice);
+            s_reported_dropped = dropped;
+        }
+        writeBatch(batch);
+    }
+    
+    if (!records.empty()) {
+        s_written.fetch_add(static_cast<int64_t>(records.size()));
+        records.clear();
+        std::lock_guard<std::mutex> lock(s_wakeup_mutex);
+        s_drained.notify_all();
+    }
+}
+
+void AsyncLogger::writeBatch(const std::string& batch) {
+    if (batch.empty()) return;
+    
+    fwrite(batch.data(), 1, batch.size(), stdout);
+    fflush(stdout);
+    
+    if (s_file_path.empty()) return;
+    
+    // Lot découpé aux fins de ligne pour que le fichier ne dépasse pas sa taille maximale
+    size_t offset = 0;
+    while (offset < batch.size()) {
+        if (!s_file) {
+            openFile();
+            if (!s_file) return;
+        }
+        
+        size_t end = batch.size();
+        if (s_max_file_size > 0 && s_file_size + static_cast<int64_t>(end - offset) > s_max_file_size) {
+            int64_t room = s_max_file_size - s_file_size;
+            size_t cut = room > 0 ? batch.rfind('\n', offset + static_cast<size_t>(room) - 1) : std::string::npos;
+            if (cut != std::string::npos && cut >= offset) {
+                end = cut + 1;
+            } else if (s_file_size > 0) {
+                rotateFile();
+                continue;
+            } else {
+                // Ligne plus longue que la taille maximale: écrite seule
+                end = batch.find('\n', offset) + 1;
+            }
+        }
+        
+        // Erreurs d'écriture ignorées pour éviter les boucles de log
+        s_file_size += static_cast<int64_t>(fwrite(batch.data() + offset, 1, end - offset, s_file));
+        offset = end;
+    }
+    fflush(s_file);
+}
+
+void AsyncLogger::openFile() {
+    s_file = fopen(s_file_path.c_str(), "a");
+    if (!s_file) return;
+    
+    fseek(s_file, 0, SEEK_END);
+    long size = ftell(s_file);
+    s_file_size = size > 0 ? size : 0;
+}
+
+void AsyncLogger::rotateFile() {
+    if (s_file) {
+        fclose(s_file);
+        s_file = nullptr;
+    }
+    
+    // ps4_store.log -> .1 -> .2 ..., le plus ancien est écrasé
+    for (int i = s_backups - 1; i >= 1; i--) {
+        std::rename((s_file_path + "." + std::to_string(i)).c_str(),
+                    (s_file_path + "." + std::to_string(i + 1)).c_str());
+    }
+    std::rename(s_file_path.c_str(), (s_file_path + ".1").c_str());
+    s_file_size = 0;
+}
+
+void AsyncLogger::appendFormatted(std::string& out, const Record& record) {
+    // Date mise en forme une fois par seconde
+    int64_t second = record.timestamp / 1000;
+    if (second != s_cached_second) {
+        std::time_t time = static_cast<std::time_t>(second);
+        std::tm local = {};
+#ifdef _WIN32
+        localtime_s(&local, &time);
+#else
+        localtime_r(&time, &local);
+#endif
+        char text[32];
+        std::strftime(text, sizeof(text), "%Y-%m-%d %H:%M:%S", &local);
+        s_cached_time = text;
+        s_cached_second = second;
+    }
+    
+    out += '[';
+    out += s_cached_time;
+    out += "] [";
+    out += Utils::getLogLevelString(record.level);
+    out += "] ";
+    
+    if (record.file && record.line > 0) {
+        const char* name = record.file;
+        for (const char* p = record.file; *p; p++) {
+            if (*p == '/' || *p == '\\') name = p + 1;
+        }
+        out += '[';
+        out += name;
+        out += ':';
+        out += std::to_string(record.line);
+        out += "] ";
+    }
+    
+    out += record.message;
+    out += '\n';
+}
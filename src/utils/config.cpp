@@ -0,0 +1,498 @@
+/**
+ * PS4 Store P2P - Implémentation de la Configuration Typée
+ */
+
+#include "utils/config.h"
+
+#include <fstream>
+#include <sstream>
+#include <filesystem>
+#include <cerrno>
+#include <cstdlib>
+
+// Variables statiques
+std::string Config::s_path;
+std::shared_ptr<const AppConfig> Config::s_current = std::make_shared<AppConfig>();
+std::mutex Config::s_mutex;
+std::map<int, ConfigListener> Config::s_listeners;
+int Config::s_next_listener = 1;
+int Config::s_watch_interval_ms = 2000;
+int64_t Config::s_last_check = 0;
+int64_t Config::s_seen_mtime = -1;
+int64_t Config::s_seen_size = -1;
+int64_t Config::s_loaded_mtime = -1;
+int64_t Config::s_loaded_size = -1;
+
+// Application d'une clé: immédiate (abonnés) ou à la création de la session
+static const bool LIVE = true;
+static const bool RESTART = false;
+
+/**
+ * Liste unique des clés de config.ini: section, nom, champ, bornes, application.
+ * Parcourue pour lire le fichier (FieldLoader) et pour le décrire (FieldWriter)
+ */
+template <typename Visitor>
+static void visitFields(AppConfig& c, Visitor& v) {
+    v.integer("Network", "listen_port", c.network.listen_port, 1, 65535, RESTART);
+    v.boolean("Network", "enable_ipv6", c.network.enable_ipv6, RESTART);
+    v.list("Network", "listen_devices", c.network.listen_devices, RESTART);
+    v.integer("Network", "download_limit", c.network.download_limit, 0, 1000000, LIVE);
+    v.integer("Network", "upload_limit", c.network.upload_limit, 0, 1000000, LIVE);
+    v.text("Network", "bandwidth_schedule", c.network.bandwidth_schedule, LIVE);
+    v.integer("Network", "max_connections", c.network.max_connections, 1, 10000, LIVE);
+    v.boolean("Network", "autotune", c.network.autotune, LIVE);
+    v.integer("Network", "min_connections", c.network.min_connections, 1, 10000, LIVE);
+    v.integer("Network", "max_unchoke_slots", c.network.max_unchoke_slots, 1, 1000, LIVE);
+    v.boolean("Network", "enable_dht", c.network.enable_dht, RESTART);
+    v.boolean("Network", "enable_lsd", c.network.enable_lsd, RESTART);
+    v.boolean("Network", "enable_upnp", c.network.enable_upnp, RESTART);
+    
+    v.text("Paths", "download_path", c.paths.download_path, RESTART);
+    v.text("Paths", "install_path", c.paths.install_path, RESTART);
+    v.text("Paths", "temp_path", c.paths.temp_path, RESTART);
+    v.text("Paths", "cache_path", c.paths.cache_path, RESTART);
+    v.text("Paths", "state_file", c.paths.state_file, RESTART);
+    
+    v.integer("UI", "screen_width", c.ui.screen_width, 320, 7680, RESTART);
+    v.integer("UI", "screen_height", c.ui.screen_height, 240, 4320, RESTART);
+    v.boolean("UI", "fullscreen", c.ui.fullscreen, RESTART);
+    v.text("UI", "language", c.ui.language, RESTART);
+    v.choice("UI", "theme", c.ui.theme, {"dark", "light"}, RESTART);
+    
+    v.logLevel("Logging", "log_level", c.logging.log_level, LIVE);
+    v.boolean("Logging", "file_logging", c.logging.file_logging, LIVE);
+    v.text("Logging", "log_file", c.logging.log_file, LIVE);
+    v.integer("Logging", "max_log_size", c.logging.max_log_size, 0, 4096, LIVE);
+    
+    v.boolean("Security", "verify_checksums", c.security.verify_checksums, LIVE);
+    v.boolean("Security", "scan_downloads", c.security.scan_downloads, LIVE);
+    v.boolean("Security", "block_malicious_trackers", c.security.block_malicious_trackers, RESTART);
+    v.list("Security", "blocklist_files", c.security.blocklist_files, RESTART);
+    
+    v.integer("Performance", "disk_cache_size", c.performance.disk_cache_size, 0, 4096, LIVE);
+    v.integer("Performance", "memory_budget", c.performance.memory_budget, 16, 16384, LIVE);
+    v.integer("Performance", "read_ahead_blocks", c.performance.read_ahead_blocks, 0, 256, LIVE);
+    v.boolean("Performance", "write_coalescing", c.performance.write_coalescing, RESTART);
+    v.integer("Performance", "write_pool_size", c.performance.write_pool_size, 0, 1024, RESTART);
+    v.integer("Performance", "write_flush_delay", c.performance.write_flush_delay, 10, 60000, RESTART);
+    v.choice("Performance", "write_sync", c.performance.write_sync, {"none", "batch"}, RESTART);
+    v.integer("Performance", "io_threads", c.performance.io_threads, 1, 64, RESTART);
+    v.integer("Performance", "worker_threads", c.performance.worker_threads, 0, 8, RESTART);
+    v.integer("Performance", "auto_save_interval", c.performance.auto_save_interval, 0, 86400, RESTART);
+    v.boolean("Performance", "auto_cleanup", c.performance.auto_cleanup, LIVE);
+    
+    v.list("Trackers", "default_trackers", c.trackers.default_trackers, RESTART);
+    v.boolean("Trackers", "fast_start", c.trackers.fast_start, RESTART);
+    v.integer("Trackers", "tracker_timeout", c.trackers.tracker_timeout, 1, 600, RESTART);
+    v.integer("Trackers", "max_tracker_retries", c.trackers.max_tracker_retries, 0, 100, RESTART);
+    v.integer("Trackers", "scrape_ttl", c.trackers.scrape_ttl, 1, 86400, LIVE);
+    
+    v.boolean("Advanced", "debug_mode", c.advanced.debug_mode, LIVE);
+    v.boolean("Advanced", "trace_enabled", c.advanced.trace_enabled, RESTART);
+    v.text("Advanced", "trace_file", c.advanced.trace_file, RESTART);
+    v.integer("Advanced", "trace_buffer_events", c.advanced.trace_buffer_events, 4096, 16777216, RESTART);
+    v.boolean("Advanced", "metrics_enabled", c.advanced.metrics_enabled, RESTART);
+    v.integer("Advanced", "metrics_interval", c.advanced.metrics_interval, 1, 3600, RESTART);
+    v.integer("Advanced", "metrics_file_size", c.advanced.metrics_file_size, 0, 1024, RESTART);
+    v.integer("Advanced", "ui_update_interval", c.advanced.ui_update_interval, 10, 10000, LIVE);
+    v.integer("Advanced", "error_retry_delay", c.advanced.error_retry_delay, 0, 3600, LIVE);
+    v.integer("Advanced", "max_concurrent_downloads", c.advanced.max_concurrent_downloads, 1, 64, LIVE);
+    v.integer("Advanced", "pre_announce_downloads", c.advanced.pre_announce_downloads, 0, 64, LIVE);
+    v.boolean("Advanced", "enable_compression", c.advanced.enable_compression, LIVE);
+    v.integer("Advanced", "network_timeout", c.advanced.network_timeout, 1, 600, LIVE);
+}
+
+// Libellés de config.ini (Utils::getLogLevelString écrit WARN)
+static const char* logLevelName(Utils::LogLevel level) {
+    switch (level) {
+        case Utils::LogLevel::DEBUG: return "DEBUG";
+        case Utils::LogLevel::WARNING: return "WARNING";
+        case Utils::LogLevel::ERROR: return "ERROR";
+        default: return "INFO";
+    }
+}
+
+/**
+ * Lit les valeurs des sections dans les champs; valeur invalide: signalée,
+ * le champ garde sa valeur par défaut (relevée dans invalid au rechargement)
+ */
+class FieldLoader {
+public:
+    FieldLoader(const std::map<std::string, std::map<std::string, std::string>>& sections,
+                std::vector<std::string>* warnings, std::set<std::string>* invalid)
+        : m_sections(sections), m_warnings(warnings), m_invalid(invalid) {}
+    
+    void integer(const char* section, const char* key, int& field, int min, int max, bool) {
+        const std::string* value = find(section, key);
+        if (!value) return;
+        
+        errno = 0;
+        char* end = nullptr;
+        long parsed = std::strtol(value->c_str(), &end, 10);
+        if (value->empty() || *end != '\0' || errno != 0 || parsed < min || parsed > max) {
+            invalid(section, key, *value, "entier de " + std::to_string(min) + " à " + std::to_string(max));
+            return;
+        }
+        field = static_cast<int>(parsed);
+    }
+    
+    void boolean(const char* section, const char* key, bool& field, bool) {
+        const std::string* value = find(section, key);
+        if (!value) return;
+        
+        if (*value == "true" || *value == "1") field = true;
+        else if (*value == "false" || *value == "0") field = false;
+        else invalid(section, key, *value, "true ou false");
+    }
+    
+    void text(const char* section, const char* key, std::string& field, bool) {
+        const std::string* value = find(section, key);
+        if (value) field = *value;
+    }
+    
+    void list(const char* section, const char* key, std::vector<std::string>& field, bool) {
+        const std::string* value = find(section, key);
+        if (!value) return;
+        
+        field.clear();
+        for (const auto& item : Utils::split(*value, ',')) {
+            std::string trimmed = Utils::trim(item);
+            if (!trimmed.empty()) field.push_back(trimmed);
+        }
+    }
+    
+    void choice(const char* section, const char* key, std::string& field,
+                std::initializer_list<const char*> allowed, bool) {
+        const std::string* value = find(section, key);
+        if (!value) return;
+        
+        std::string expected;
+        for (const char* option : allowed) {
+            if (*value == option) {
+                field = *value;
+                return;
+            }
+            expected += expected.empty() ? option : std::string(", ") + option;
+        }
+        invalid(section, key, *value, expected);
+    }
+    
+    void logLevel(const char* section, const char* key, Utils::LogLevel& field, bool) {
+        const std::string* value = find(section, key);
+        if (!value) return;
+        
+        for (Utils::LogLevel level : {Utils::LogLevel::DEBUG, Utils::LogLevel::INFO, Utils::LogLevel::WARNING,
+                                      Utils::LogLevel::ERROR}) {
+            if (*value == logLevelName(level)) {
+                field = level;
+                return;
+            }
+        }
+        invalid(section, key, *value, "DEBUG, INFO, WARNING, ERROR");
+    }
+    
+    // Clés du fichier absentes de la liste des champs
+    void reportUnknown() {
+        if (!m_warnings) return;
+        for (const auto& section : m_sections) {
+            for (const auto& entry : section.second) {
+                if (!m_known.count(section.first + "." + entry.first)) {
+                    m_warnings->push_back("Clé inconnue ignorée: [" + section.first + "] " + entry.first);
+                }
+            }
+        }
+    }
+
+private:
+    const std::map<std::string, std::map<std::string, std::string>>& m_sections;
+    std::vector<std::string>* m_warnings;
+    std::set<std::string>* m_invalid;
+    std::set<std::string> m_known;
+    
+    const std::string* find(const char* section, const char* key) {
+        m_known.insert(std::string(section) + "." + key);
+        auto found_section = m_sections.find(section);
+        if (found_section == m_sections.end()) return nullptr;
+        auto found = found_section->second.find(key);
+        return found != found_section->second.end() ? &found->second : nullptr;
+    }
+    
+    void invalid(const char* section, const char* key, const std::string& value, const std::string& expected) {
+        if (m_invalid) {
+            m_invalid->insert(std::string(section) + "." + key);
+        }
+        if (m_warnings) {
+            m_warnings->push_back("Valeur invalide [" + std::string(section) + "] " + key + "=" + value +
+                                  " (attendu: " + expected + "), valeur " +
+                                  (m_invalid ? "actuelle" : "par défaut") + " conservée");
+        }
+    }
+};
+
+// Décrit chaque champ sous forme de texte, dans l'ordre de visitFields
+class FieldWriter {
+public:
+    std::vector<ConfigEntry> entries;
+    
+    void integer(const char* section, const char* key, int& field, int, int, bool live) {
+        entries.push_back({section, key, std::to_string(field), live});
+    }
+    
+    void boolean(const char* section, const char* key, bool& field, bool live) {
+        entries.push_back({section, key, field ? "true" : "false", live});
+    }
+    
+    void text(const char* section, const char* key, std::string& field, bool live) {
+        entries.push_back({section, key, field, live});
+    }
+    
+    void list(const char* section, const char* key, std::vector<std::string>& field, bool live) {
+        std::string joined;
+        for (const auto& item : field) {
+            joined += joined.empty() ? item : "," + item;
+        }
+        entries.push_back({section, key, joined, live});
+    }
+    
+    void choice(const char* section, const char* key, std::string& field, std::initializer_list<const char*>,
+                bool live) {
+        entries.push_back({section, key, field, live});
+    }
+    
+    void logLevel(const char* section, const char* key, Utils::LogLevel& field, bool live) {
+        entries.push_back({section, key, logLevelName(field), live});
+    }
+};
+
+bool Config::load(const std::string& path) {
+    s_path = path;
+    statFile(s_loaded_mtime, s_loaded_size);
+    s_seen_mtime = s_loaded_mtime;
+    s_seen_size = s_loaded_size;
+    s_last_check = Utils::getCurrentTimestamp();
+    
+    std::string text;
+    if (!readFile(path, text)) {
+        LOG_WARNING("Fichier de configuration non trouvé, valeurs par défaut: " + path);
+        setCurrent(AppConfig());
+        return false;
+    }
+    
+    std::vector<std::string> warnings;
+    AppConfig config = parse(text, &warnings);
+    for (const auto& warning : warnings) {
+        LOG_WARNING(warning);
+    }
+    setCurrent(config);
+    
+    LOG_INFO("Configuration chargée: " + path);
+    return true;
+}
+
+const AppConfig& Config::get() {
+    return *s_current;
+}
+
+std::shared_ptr<const AppConfig> Config::snapshot() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_current;
+}
+
+int Config::subscribe(ConfigListener listener) {
+    int id = s_next_listener++;
+    s_listeners[id] = std::move(listener);
+    return id;
+}
+
+void Config::unsubscribe(int id) {
+    s_listeners.erase(id);
+}
+
+void Config::update() {
+    if (s_path.empty() || s_watch_interval_ms <= 0) return;
+    
+    int64_t now = Utils::getCurrentTimestamp();
+    if (now - s_last_check < s_watch_interval_ms) return;
+    s_last_check = now;
+    
+    int64_t mtime = -1;
+    int64_t size = -1;
+    if (!statFile(mtime, size)) return;
+    
+    bool changed = mtime != s_loaded_mtime || size != s_loaded_size;
+    bool stable = mtime == s_seen_mtime && size == s_seen_size;
+    s_seen_mtime = mtime;
+    s_seen_size = size;
+    
+    // Fichier relu lorsqu'il n'a plus bougé depuis la vérification précédente
+    // (un éditeur peut le vider avant de le réécrire)
+    if (!changed || !stable) return;
+    
+    s_loaded_mtime = mtime;
+    s_loaded_size = size;
+    reload();
+}
+
+bool Config::reload() {
+    std::string text;
+    if (!readFile(s_path, text)) {
+        LOG_WARNING("Configuration illisible, valeurs actuelles conservées: " + s_path);
+        return false;
+    }
+    
+    std::vector<std::string> warnings;
+    std::set<std::string> invalid;
+    Sections sections = parseSections(text, &warnings);
+    AppConfig next = build(sections, &warnings, &invalid);
+    for (const auto& warning : warnings) {
+        LOG_WARNING(warning);
+    }
+    
+    // Clés appliquées à la création de la session, et valeurs invalides: valeur en cours conservée
+    std::vector<ConfigEntry> before = describe(*s_current);
+    std::vector<ConfigEntry> after = describe(next);
+    ConfigChanges changes;
+    Sections merged;
+    bool restored = false;
+    
+    for (size_t i = 0; i < after.size(); i++) {
+        const ConfigEntry& entry = after[i];
+        merged[entry.section][entry.key] = entry.value;
+        if (entry.value == before[i].value) continue;
+        
+        if (invalid.count(entry.section + "." + entry.key)) {
+            merged[entry.section][entry.key] = before[i].value;
+            restored = true;
+        } else if (entry.live) {
+            changes.add(entry.section, entry.key);
+        } else {
+            LOG_WARNING("[" + entry.section + "] " + entry.key + " modifié: " +
+                       "pris en compte au prochain démarrage");
+            merged[entry.section][entry.key] = before[i].value;
+            restored = true;
+        }
+    }
+    
+    if (changes.empty()) return false;
+    if (restored) {
+        next = build(merged, nullptr);
+    }
+    setCurrent(next);
+    
+    std::string keys;
+    for (const auto& key : changes.keys()) {
+        keys += keys.empty() ? key : ", " + key;
+    }
+    LOG_INFO("Configuration rechargée: " + keys);
+    
+    // Copie: un abonné peut se désabonner pendant l'appel
+    std::map<int, ConfigListener> listeners = s_listeners;
+    for (const auto& listener : listeners) {
+        try {
+            listener.second(*s_current, changes);
+        } catch (const std::exception& e) {
+            LOG_ERROR("Erreur d'application de la configuration: " + std::string(e.what()));
+        }
+    }
+    return true;
+}
+
+void Config::setWatchInterval(int interval_ms) {
+    s_watch_interval_ms = interval_ms;
+}
+
+AppConfig Config::parse(const std::string& text, std::vector<std::string>* warnings) {
+    return build(parseSections(text, warnings), warnings);
+}
+
+std::vector<ConfigEntry> Config::describe(const AppConfig& config) {
+    AppConfig copy = config;
+    FieldWriter writer;
+    visitFields(copy, writer);
+    return writer.entries;
+}
+
+ConfigChanges Config::diff(const AppConfig& before, const AppConfig& after) {
+    std::vector<ConfigEntry> old_entries = describe(before);
+    std::vector<ConfigEntry> new_entries = describe(after);
+    
+    ConfigChanges changes;
+    for (size_t i = 0; i < new_entries.size(); i++) {
+        if (new_entries[i].value != old_entries[i].value) {
+            changes.add(new_entries[i].section, new_entries[i].key);
+        }
+    }
+    return changes;
+}
+
+// Méthodes privées
+Config::Sections Config::parseSections(const std::string& text, std::vector<std::string>* warnings) {
+    Sections sections;
+    std::string section;
+    std::istringstream stream(text);
+    std::string line;
+    
+    while (std::getline(stream, line)) {
+        line = Utils::trim(line);
+        
+        // Ignorer les commentaires et lignes vides
+        if (line.empty() || line[0] == '#' || line[0] == ';') {
+            continue;
+        }
+        
+        if (line.front() == '[' && line.back() == ']') {
+            section = Utils::trim(line.substr(1, line.size() - 2));
+            continue;
+        }
+        
+        size_t pos = line.find('=');
+        if (pos == std::string::npos) continue;
+        
+        std::string key = Utils::trim(line.substr(0, pos));
+        std::string value = Utils::trim(line.substr(pos + 1));
+        auto inserted = sections[section].insert({key, value});
+        if (!inserted.second) {
+            inserted.first->second = value;
+            if (warnings) {
+                warnings->push_back("Clé en double: [" + section + "] " + key + " (dernière valeur retenue)");
+            }
+        }
+    }
+    return sections;
+}
+
+AppConfig Config::build(const Sections& sections, std::vector<std::string>* warnings,
+                        std::set<std::string>* invalid) {
+    AppConfig config;
+    FieldLoader loader(sections, warnings, invalid);
+    visitFields(config, loader);
+    loader.reportUnknown();
+    return config;
+}
+
+bool Config::readFile(const std::string& path, std::string& text) {
+    std::ifstream file(path);
+    if (!file.is_open()) return false;
+    
+    std::ostringstream content;
+    content << file.rdbuf();
+    text = content.str();
+    return true;
+}
+
+bool Config::statFile(int64_t& mtime, int64_t& size) {
+    std::error_code error;
+    auto time = std::filesystem::last_write_time(s_path, error);
+    if (error) return false;
+    auto bytes = std::filesystem::file_size(s_path, error);
+    if (error) return false;
+    
+    mtime = static_cast<int64_t>(time.time_since_epoch().count());
+    size = static_cast<int64_t>(bytes);
+    return true;
+}
+
+void Config::setCurrent(const AppConfig& config) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_current = std::make_shared<const AppConfig>(config);
+}
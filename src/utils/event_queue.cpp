@@ -0,0 +1,109 @@
+/**
+ * PS4 Store P2P - Implémentation de la File d'Événements
+ */
+
+#include "utils/event_queue.h"
+#include "utils/utils.h"
+#include "utils/trace.h"
+#include "utils/metrics.h"
+
+#include <algorithm>
+#include <set>
+#include <utility>
+
+// Variables statiques
+std::atomic<EventQueue::Node*> EventQueue::s_head(nullptr);
+std::atomic<int> EventQueue::s_next_id(1);
+std::vector<EventQueue::Subscription> EventQueue::s_handlers[static_cast<int>(EventType::COUNT)];
+
+void EventQueue::post(UiEvent event) {
+    Node* node = new Node{std::move(event), nullptr};
+    node->next = s_head.load(std::memory_order_relaxed);
+    while (!s_head.compare_exchange_weak(node->next, node, std::memory_order_release, std::memory_order_relaxed)) {
+    }
+}
+
+void EventQueue::postCall(std::function<void()> call) {
+    UiEvent event;
+    event.type = EventType::CALL;
+    event.call = std::move(call);
+    post(std::move(event));
+}
+
+int EventQueue::subscribe(EventType type, EventHandler handler) {
+    // Ajouté par dispatch, avant les événements déposés après l'appel
+    int id = s_next_id.fetch_add(1);
+    postCall([type, id, handler]() {
+        s_handlers[static_cast<int>(type)].push_back({id, handler});
+    });
+    return id;
+}
+
+void EventQueue::unsubscribe(int id) {
+    // Retiré par dispatch: jamais pendant le parcours des abonnés
+    postCall([id]() {
+        for (auto& handlers : s_handlers) {
+            handlers.erase(std::remove_if(handlers.begin(), handlers.end(),
+                                          [id](const Subscription& subscription) { return subscription.id == id; }),
+                           handlers.end());
+        }
+    });
+}
+
+int EventQueue::dispatch() {
+    static MetricCounter& delivered_total = Metrics::counter("ui_events_total", "Événements livrés à l'interface");
+    static MetricCounter& coalesced_total = Metrics::counter("ui_events_coalesced_total",
+                                                             "Progressions remplacées par une plus récente");
+    
+    std::vector<UiEvent> events = drain();
+    if (events.empty()) return 0;
+    
+    TRACE_SCOPE("ui", "EventQueue::dispatch");
+    
+    // Parcours à rebours: seule la dernière progression de chaque travail est gardée
+    std::vector<bool> superseded(events.size(), false);
+    std::set<std::pair<EventType, std::string>> seen;
+    for (size_t i = events.size(); i-- > 0;) {
+        if (isCoalesced(events[i].type) && !seen.insert({events[i].type, events[i].job}).second) {
+            superseded[i] = true;
+        }
+    }
+    
+    int delivered = 0;
+    for (size_t i = 0; i < events.size(); i++) {
+        if (superseded[i]) continue;
+        
+        const UiEvent& event = events[i];
+        if (event.type == EventType::CALL) {
+            if (event.call) event.call();
+        }
+        for (const auto& subscription : s_handlers[static_cast<int>(event.type)]) {
+            subscription.handler(event);
+        }
+        delivered++;
+    }
+    
+    delivered_total.add(delivered);
+    coalesced_total.add(static_cast<int64_t>(events.size()) - delivered);
+    return delivered;
+}
+
+bool EventQueue::isCoalesced(EventType type) {
+    return type == EventType::DOWNLOAD_PROGRESS || type == EventType::INSTALL_PROGRESS;
+}
+
+// Fonctions internes
+std::vector<UiEvent> EventQueue::drain() {
+    // Pile entière prise d'un coup, du plus récent au plus ancien
+    Node* node = s_head.exchange(nullptr, std::memory_order_acquire);
+    
+    std::vector<UiEvent> events;
+    while (node) {
+        Node* next = node->next;
+        events.push_back(std::move(node->event));
+        delete node;
+        node = next;
+    }
+    std::reverse(events.begin(), events.end());
+    return events;
+}
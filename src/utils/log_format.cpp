@@ -0,0 +1,68 @@
+/**
+ * PS4 Store P2P - Implémentation de la Mise en Forme Différée des Logs
+ */
+
+#include "utils/log_format.h"
+
+#include <cstdio>
+#include <cstring>
+
+std::string& LogFormat::threadBuffer() {
+    thread_local std::string buffer;
+    buffer.clear();
+    return buffer;
+}
+
+void LogFormat::append(std::string& out, const void* value) {
+    char text[24];
+    int length = std::snprintf(text, sizeof(text), "%p", value);
+    out.append(text, length > 0 ? static_cast<size_t>(length) : 0);
+}
+
+void LogFormat::appendSigned(std::string& out, int64_t value) {
+    if (value < 0) {
+        out += '-';
+        // Négation en non signé: INT64_MIN reste représentable
+        appendUnsigned(out, 0 - static_cast<uint64_t>(value));
+    } else {
+        appendUnsigned(out, static_cast<uint64_t>(value));
+    }
+}
+
+void LogFormat::appendUnsigned(std::string& out, uint64_t value) {
+    char text[20];
+    char* end = text + sizeof(text);
+    char* begin = end;
+    do {
+        *--begin = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value != 0);
+    out.append(begin, end);
+}
+
+void LogFormat::appendFloating(std::string& out, double value) {
+    char text[32];
+    int length = std::snprintf(text, sizeof(text), "%g", value);
+    out.append(text, length > 0 ? static_cast<size_t>(length) : 0);
+}
+
+// Méthodes privées
+const char* LogFormat::appendLiteral(std::string& out, const char* format) {
+    const char* start = format;
+    while (*format) {
+        if (format[0] == '{' && format[1] == '}') {
+            out.append(start, format);
+            return format + 2;
+        }
+        if ((format[0] == '{' && format[1] == '{') || (format[0] == '}' && format[1] == '}')) {
+            // Accolade doublée: une seule est écrite
+            out.append(start, format + 1);
+            format += 2;
+            start = format;
+            continue;
+        }
+        format++;
+    }
+    out.append(start, format);
+    return nullptr;
+}
@@ -0,0 +1,280 @@
+/**
+ * PS4 Store P2P - Implémentation des Métriques
+ */
+
+#include "utils/metrics.h"
+#include "utils/utils.h"
+#include "utils/trace.h"
+
+#include <algorithm>
+#include <limits>
+#include <utility>
+#include <cstdio>
+
+// Variables statiques
+std::map<std::string, Metrics::Entry> Metrics::s_entries;
+std::mutex Metrics::s_mutex;
+std::string Metrics::s_path;
+int Metrics::s_interval_seconds = 10;
+int64_t Metrics::s_max_file_size = 0;
+std::thread Metrics::s_thread;
+std::mutex Metrics::s_export_mutex;
+std::condition_variable Metrics::s_wakeup;
+bool Metrics::s_stop = false;
+
+// Préfixe des noms exportés
+static const char* METRIC_PREFIX = "ps4store_";
+
+// Quantiles exportés pour chaque histogramme (le maximum est exporté à part)
+static const std::pair<const char*, double> QUANTILES[] = {{"0.5", 0.5}, {"0.9", 0.9}, {"0.99", 0.99}, {"0.999", 0.999}};
+
+// Tranche du thread appelant, attribuée à tour de rôle au premier enregistrement
+static std::atomic<int> s_next_shard(0);
+static thread_local int t_shard = -1;
+
+static int threadShard() {
+    if (t_shard < 0) {
+        t_shard = s_next_shard.fetch_add(1, std::memory_order_relaxed) % METRIC_SHARDS;
+    }
+    return t_shard;
+}
+
+void MetricCounter::add(int64_t delta) {
+    m_shards[threadShard()].value.fetch_add(delta, std::memory_order_relaxed);
+}
+
+int64_t MetricCounter::value() const {
+    int64_t total = 0;
+    for (const Shard& shard : m_shards) {
+        total += shard.value.load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+MetricHistogram::MetricHistogram() : m_shards(new Shard[METRIC_SHARDS]()) {
+    for (int i = 0; i < METRIC_SHARDS; i++) {
+        m_shards[i].min.store(std::numeric_limits<int64_t>::max(), std::memory_order_relaxed);
+    }
+}
+
+int MetricHistogram::bucketIndex(int64_t value) {
+    if (value < 2 * HISTOGRAM_SUB_BUCKETS) {
+        return value > 0 ? static_cast<int>(value) : 0;
+    }
+    
+    // Puissance de deux puis 32 sous-intervalles: [32, 63] << shift
+    int exponent = 63 - __builtin_clzll(static_cast<uint64_t>(value));
+    if (exponent >= HISTOGRAM_MAX_EXPONENT) {
+        return HISTOGRAM_BUCKETS - 1;
+    }
+    int shift = exponent - 5;
+    return shift * HISTOGRAM_SUB_BUCKETS + static_cast<int>(value >> shift);
+}
+
+int64_t MetricHistogram::bucketUpperBound(int index) {
+    if (index < 2 * HISTOGRAM_SUB_BUCKETS) {
+        return index;
+    }
+    
+    int shift = index / HISTOGRAM_SUB_BUCKETS - 1;
+    int64_t top = index - shift * HISTOGRAM_SUB_BUCKETS;
+    return ((top + 1) << shift) - 1;
+}
+
+void MetricHistogram::record(int64_t value) {
+    if (value < 0) value = 0;
+    
+    Shard& shard = m_shards[threadShard()];
+    shard.buckets[bucketIndex(value)].fetch_add(1, std::memory_order_relaxed);
+    shard.sum.fetch_add(value, std::memory_order_relaxed);
+    
+    // Extrêmes: échange seulement si la valeur les dépasse
+    int64_t current = shard.min.load(std::memory_order_relaxed);
+    while (value < current && !shard.min.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+    current = shard.max.load(std::memory_order_relaxed);
+    while (value > current && !shard.max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+HistogramSnapshot MetricHistogram::snapshot() const {
+    HistogramSnapshot snapshot;
+    snapshot.buckets.assign(HISTOGRAM_BUCKETS, 0);
+    snapshot.min = std::numeric_limits<int64_t>::max();
+    
+    // Lecture sans verrou: un relevé peut manquer les mesures en cours d'écriture
+    for (int i = 0; i < METRIC_SHARDS; i++) {
+        const Shard& shard = m_shards[i];
+        for (int b = 0; b < HISTOGRAM_BUCKETS; b++) {
+            int64_t value = shard.buckets[b].load(std::memory_order_relaxed);
+            snapshot.buckets[b] += value;
+            snapshot.count += value;
+        }
+        snapshot.sum += shard.sum.load(std::memory_order_relaxed);
+        snapshot.min = std::min(snapshot.min, shard.min.load(std::memory_order_relaxed));
+        snapshot.max = std::max(snapshot.max, shard.max.load(std::memory_order_relaxed));
+    }
+    
+    if (snapshot.count == 0) {
+        snapshot.min = 0;
+    }
+    return snapshot;
+}
+
+int64_t HistogramSnapshot::percentile(double quantile) const {
+    if (count == 0) return 0;
+    
+    int64_t rank = static_cast<int64_t>(quantile * static_cast<double>(count) + 0.5);
+    rank = std::max<int64_t>(1, std::min(rank, count));
+    
+    int64_t seen = 0;
+    for (size_t i = 0; i < buckets.size(); i++) {
+        seen += buckets[i];
+        if (seen >= rank) {
+            return std::min(MetricHistogram::bucketUpperBound(static_cast<int>(i)), max);
+        }
+    }
+    return max;
+}
+
+MetricCounter& Metrics::counter(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    Entry& found = entry(name, help);
+    if (!found.counter) found.counter.reset(new MetricCounter());
+    return *found.counter;
+}
+
+MetricGauge& Metrics::gauge(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    Entry& found = entry(name, help);
+    if (!found.gauge) found.gauge.reset(new MetricGauge());
+    return *found.gauge;
+}
+
+void Metrics::sampledGauge(const std::string& name, std::function<int64_t()> sample, const std::string& help) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    entry(name, help).sample = std::move(sample);
+}
+
+MetricHistogram& Metrics::histogram(const std::string& name, const std::string& help) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    Entry& found = entry(name, help);
+    if (!found.histogram) found.histogram.reset(new MetricHistogram());
+    return *found.histogram;
+}
+
+std::string Metrics::format(int64_t timestamp) {
+    std::string out;
+    std::string suffix = " " + std::to_string(timestamp) + "\n";
+    
+    auto header = [&out](const std::string& name, const std::string& help, const char* type) {
+        if (!help.empty()) out += "# HELP " + name + " " + help + "\n";
+        out += "# TYPE " + name + " " + type + "\n";
+    };
+    
+    std::lock_guard<std::mutex> lock(s_mutex);
+    for (const auto& item : s_entries) {
+        const Entry& metric = item.second;
+        std::string name = METRIC_PREFIX + item.first;
+        
+        if (metric.counter) {
+            header(name, metric.help, "counter");
+            out += name + " " + std::to_string(metric.counter->value()) + suffix;
+        } else if (metric.gauge || metric.sample) {
+            header(name, metric.help, "gauge");
+            int64_t value = metric.sample ? metric.sample() : metric.gauge->value();
+            out += name + " " + std::to_string(value) + suffix;
+        } else if (metric.histogram) {
+            HistogramSnapshot snapshot = metric.histogram->snapshot();
+            header(name, metric.help, "summary");
+            for (const auto& quantile : QUANTILES) {
+                out += name + "{quantile=\"" + quantile.first + "\"} " +
+                       std::to_string(snapshot.percentile(quantile.second)) + suffix;
+            }
+            out += name + "{quantile=\"1\"} " + std::to_string(snapshot.max) + suffix;
+            out += name + "_sum " + std::to_string(snapshot.sum) + suffix;
+            out += name + "_count " + std::to_string(snapshot.count) + suffix;
+        }
+    }
+    return out;
+}
+
+void Metrics::startExporter(const std::string& path, int interval_seconds, int64_t max_file_size) {
+    stopExporter();
+    
+    {
+        std::lock_guard<std::mutex> lock(s_export_mutex);
+        s_path = path;
+        s_interval_seconds = std::max(1, interval_seconds);
+        s_max_file_size = std::max<int64_t>(0, max_file_size);
+        s_stop = false;
+    }
+    
+    s_thread = std::thread(run);
+    LOG_INFO("Export des métriques: " + path + " (toutes les " + std::to_string(s_interval_seconds) + " s)");
+}
+
+void Metrics::stopExporter() {
+    if (!s_thread.joinable()) return;
+    
+    {
+        std::lock_guard<std::mutex> lock(s_export_mutex);
+        s_stop = true;
+    }
+    s_wakeup.notify_all();
+    s_thread.join();
+    
+    // Dernier relevé: la fin de session figure dans le fichier
+    exportNow();
+}
+
+bool Metrics::exportNow() {
+    std::string path;
+    int64_t max_file_size;
+    {
+        std::lock_guard<std::mutex> lock(s_export_mutex);
+        path = s_path;
+        max_file_size = s_max_file_size;
+    }
+    if (path.empty()) return false;
+    
+    std::string text = "# relevé " + std::to_string(Utils::getCurrentTimestamp()) + "\n" +
+                       format(Utils::getCurrentTimestamp());
+    
+    // metrics.prom -> .1 (un seul fichier conservé)
+    if (max_file_size > 0 && Utils::fileExists(path) &&
+        Utils::getFileSize(path) + static_cast<int64_t>(text.size()) > max_file_size) {
+        std::rename(path.c_str(), (path + ".1").c_str());
+    }
+    
+    FILE* file = fopen(path.c_str(), "a");
+    if (!file) {
+        LOG_WARNING("Impossible d'écrire les métriques: " + path);
+        return false;
+    }
+    
+    fwrite(text.data(), 1, text.size(), file);
+    bool ok = ferror(file) == 0;
+    fclose(file);
+    return ok;
+}
+
+// Fonctions internes
+Metrics::Entry& Metrics::entry(const std::string& name, const std::string& help) {
+    Entry& found = s_entries[name];
+    if (found.help.empty()) found.help = help;
+    return found;
+}
+
+void Metrics::run() {
+    TRACE_THREAD_NAME("metrics");
+    std::unique_lock<std::mutex> lock(s_export_mutex);
+    while (!s_stop) {
+        s_wakeup.wait_for(lock, std::chrono::seconds(s_interval_seconds), [] { return s_stop; });
+        if (s_stop) break;
+        
+        lock.unlock();
+        exportNow();
+        lock.lock();
+    }
+}
@@ -0,0 +1,74 @@
+/**
+ * PS4 Store P2P - Implémentation de la Publication de Progression
+ */
+
+#include "utils/progress_publisher.h"
+
+#include <algorithm>
+#include <cmath>
+#include <utility>
+
+// Écart minimal par défaut, et constante de temps du lissage du débit
+static const int64_t DEFAULT_MIN_DELTA = 1024 * 1024;
+static const double RATE_SMOOTHING_SECONDS = 2.0;
+
+ProgressPublisher::ProgressPublisher(int64_t total, ProgressSink sink, int interval_ms, int64_t min_delta)
+    : m_total(std::max<int64_t>(0, total)),
+      m_min_delta(min_delta > 0 ? min_delta : std::max(DEFAULT_MIN_DELTA, total / 1000)),
+      m_interval(std::chrono::milliseconds(std::max(0, interval_ms))),
+      m_sink(std::move(sink)),
+      m_last_time(std::chrono::steady_clock::now()) {
+    m_sample = {0, m_total, 0.0f, 0, -1};
+    m_next_check.store(m_min_delta, std::memory_order_relaxed);
+}
+
+void ProgressPublisher::finish() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    publish(done(), std::chrono::steady_clock::now());
+}
+
+ProgressSample ProgressPublisher::lastSample() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_sample;
+}
+
+// Fonctions internes
+void ProgressPublisher::publishIfDue(int64_t done) {
+    // Un autre thread publie déjà: ses octets suffisent
+    std::unique_lock<std::mutex> lock(m_mutex, std::try_to_lock);
+    if (!lock.owns_lock()) return;
+    
+    // Prochaine lecture de l'horloge après un nouvel écart, publication ou non
+    m_next_check.store(done + m_min_delta, std::memory_order_relaxed);
+    
+    auto now = std::chrono::steady_clock::now();
+    if (now - m_last_time < m_interval) return;
+    publish(done, now);
+}
+
+void ProgressPublisher::publish(int64_t done, std::chrono::steady_clock::time_point now) {
+    double seconds = std::chrono::duration<double>(now - m_last_time).count();
+    if (seconds > 0) {
+        double instant = static_cast<double>(done - m_last_done) / seconds;
+        if (m_last_done == 0) {
+            m_rate = instant;
+        } else {
+            // Poids fonction du temps écoulé: lissage indépendant de l'intervalle de publication
+            double alpha = 1.0 - std::exp(-seconds / RATE_SMOOTHING_SECONDS);
+            m_rate += alpha * (instant - m_rate);
+        }
+    }
+    m_last_time = now;
+    m_last_done = done;
+    
+    m_sample.done = done;
+    m_sample.fraction = m_total > 0 ? std::min(1.0f, static_cast<float>(done) / static_cast<float>(m_total)) : 0.0f;
+    m_sample.bytes_per_second = static_cast<int64_t>(m_rate);
+    m_sample.eta_seconds = m_total > 0 && m_rate > 0
+                               ? static_cast<int64_t>(static_cast<double>(std::max<int64_t>(0, m_total - done)) / m_rate)
+                               : -1;
+    
+    if (m_sink) {
+        m_sink(m_sample);
+    }
+}
@@ -0,0 +1,262 @@
+/**
+ * PS4 Store P2P - Implémentation du Démarrage par Étapes
+ */
+
+#include "utils/startup.h"
+#include "utils/utils.h"
+#include "utils/trace.h"
+#include "utils/metrics.h"
+#include "utils/thread_pool.h"
+
+#include <algorithm>
+#include <cstdio>
+
+// Variables statiques
+std::vector<Startup::Stage> Startup::s_stages;
+std::mutex Startup::s_mutex;
+std::condition_variable Startup::s_finished;
+std::chrono::steady_clock::time_point Startup::s_begin = std::chrono::steady_clock::now();
+int64_t Startup::s_first_frame_us = -1;
+int64_t Startup::s_complete_us = -1;
+int Startup::s_running = 0;
+bool Startup::s_abandoned = false;
+bool Startup::s_failed = false;
+
+static const char* threadName(StageThread thread) {
+    return thread == StageThread::MAIN ? "main" : "pool";
+}
+
+static const char* stateName(StageState state) {
+    switch (state) {
+        case StageState::PENDING: return "en attente";
+        case StageState::RUNNING: return "en cours";
+        case StageState::DONE: return "ok";
+        case StageState::FAILED: return "échec";
+        case StageState::SKIPPED: return "sautée";
+    }
+    return "";
+}
+
+void Startup::begin() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_begin = std::chrono::steady_clock::now();
+}
+
+void Startup::add(const char* name, const std::vector<std::string>& after, std::function<bool()> run,
+                  StageThread thread, bool required) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_stages.push_back({name, after, std::move(run), thread, required, StageState::PENDING, -1, -1});
+}
+
+bool Startup::pump() {
+    size_t main_stage = s_stages.size();
+    std::vector<size_t> ready;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (s_complete_us >= 0) return true;
+        
+        ready = scheduleReady();
+        
+        // Une étape du thread principal par image: l'affichage continue entre deux
+        for (size_t i = 0; i < s_stages.size(); i++) {
+            if (s_stages[i].thread == StageThread::MAIN && s_stages[i].state == StageState::RUNNING &&
+                s_stages[i].start_us < 0) {
+                s_stages[i].start_us = elapsedUs();
+                s_running++;
+                main_stage = i;
+                break;
+            }
+        }
+    }
+    
+    launch(ready);
+    if (main_stage < s_stages.size()) {
+        runStage(main_stage);
+    }
+    
+    {
+        // Étape du thread principal prête mais pas commencée: RUNNING sans compter dans s_running
+        std::lock_guard<std::mutex> lock(s_mutex);
+        bool complete = s_running == 0 && std::none_of(s_stages.begin(), s_stages.end(), [](const Stage& stage) {
+            return stage.state == StageState::PENDING || stage.state == StageState::RUNNING;
+        });
+        if (!complete) return false;
+        s_complete_us = elapsedUs();
+    }
+    
+    logReport();
+    return true;
+}
+
+void Startup::markFirstFrame() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (s_first_frame_us < 0) {
+        s_first_frame_us = elapsedUs();
+        Metrics::gauge("startup_first_frame_ms", "Délai d'affichage de la première image (ms)").set(s_first_frame_us / 1000);
+    }
+}
+
+bool Startup::isReady(const std::string& name) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    for (const Stage& stage : s_stages) {
+        if (name == stage.name) return stage.state == StageState::DONE;
+    }
+    return false;
+}
+
+bool Startup::isComplete() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_complete_us >= 0;
+}
+
+bool Startup::hasFailed() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_failed;
+}
+
+float Startup::getProgress() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (s_stages.empty()) return 1.0f;
+    
+    size_t finished = std::count_if(s_stages.begin(), s_stages.end(), [](const Stage& stage) {
+        return stage.state != StageState::PENDING && stage.state != StageState::RUNNING;
+    });
+    return static_cast<float>(finished) / static_cast<float>(s_stages.size());
+}
+
+void Startup::wait() {
+    std::unique_lock<std::mutex> lock(s_mutex);
+    s_abandoned = true;
+    s_finished.wait(lock, [] { return s_running == 0; });
+}
+
+std::string Startup::report() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    
+    std::vector<const Stage*> ordered;
+    for (const Stage& stage : s_stages) {
+        ordered.push_back(&stage);
+    }
+    std::stable_sort(ordered.begin(), ordered.end(), [](const Stage* a, const Stage* b) {
+        return (a->start_us < 0 ? INT64_MAX : a->start_us) < (b->start_us < 0 ? INT64_MAX : b->start_us);
+    });
+    
+    std::string out;
+    char line[160];
+    std::snprintf(line, sizeof(line), "Démarrage: première image à %lld ms, terminé à %lld ms\n",
+                  static_cast<long long>(s_first_frame_us / 1000), static_cast<long long>(s_complete_us / 1000));
+    out += line;
+    for (const Stage* stage : ordered) {
+        if (stage->start_us < 0 || stage->end_us < 0) {
+            std::snprintf(line, sizeof(line), "  %-16s %-4s %19s  %s\n", stage->name, threadName(stage->thread), "",
+                          stateName(stage->state));
+        } else {
+            // Début: mise en file de l'étape; durée: attente d'un thread comprise
+            std::snprintf(line, sizeof(line), "  %-16s %-4s +%5lld ms %6lld ms  %s\n", stage->name,
+                          threadName(stage->thread), static_cast<long long>(stage->start_us / 1000),
+                          static_cast<long long>((stage->end_us - stage->start_us) / 1000), stateName(stage->state));
+        }
+        out += line;
+    }
+    return out;
+}
+
+// Fonctions internes (sous s_mutex, sauf launch, runStage, finishStage et logReport)
+int64_t Startup::elapsedUs() {
+    return std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - s_begin).count();
+}
+
+std::vector<size_t> Startup::scheduleReady() {
+    std::vector<size_t> ready_pool;
+    if (s_abandoned) return ready_pool;
+    
+    // Jusqu'à stabilité: une étape sautée peut en faire sauter d'autres
+    bool changed = true;
+    while (changed) {
+        changed = false;
+        for (size_t i = 0; i < s_stages.size(); i++) {
+            Stage& stage = s_stages[i];
+            if (stage.state != StageState::PENDING) continue;
+            
+            bool ready = true;
+            bool blocked = false;
+            for (const std::string& dependency : stage.after) {
+                auto it = std::find_if(s_stages.begin(), s_stages.end(), [&dependency](const Stage& other) {
+                    return dependency == other.name;
+                });
+                if (it == s_stages.end() || it->state == StageState::FAILED || it->state == StageState::SKIPPED) {
+                    blocked = true;
+                } else if (it->state != StageState::DONE) {
+                    ready = false;
+                }
+            }
+            
+            if (blocked) {
+                LOG_WARNING(std::string("Étape de démarrage sautée: ") + stage.name);
+                stage.state = StageState::SKIPPED;
+                if (stage.required) s_failed = true;
+                changed = true;
+            } else if (ready) {
+                // Étape du thread principal: commencée et comptée par pump
+                stage.state = StageState::RUNNING;
+                if (stage.thread == StageThread::POOL) {
+                    stage.start_us = elapsedUs();
+                    s_running++;
+                    ready_pool.push_back(i);
+                }
+            }
+        }
+    }
+    return ready_pool;
+}
+
+void Startup::launch(const std::vector<size_t>& stages) {
+    // Hors verrou: réserve arrêtée, la tâche s'exécute sur place
+    for (size_t index : stages) {
+        ThreadPool::post([index]() { runStage(index); }, TaskPriority::INTERACTIVE);
+    }
+}
+
+void Startup::runStage(size_t index) {
+    const Stage& stage = s_stages[index];
+    bool ok = false;
+    try {
+        TRACE_SCOPE("startup", stage.name);
+        ok = stage.run();
+    } catch (const std::exception& e) {
+        LOG_ERROR(std::string("Exception dans l'étape de démarrage ") + stage.name + ": " + e.what());
+    }
+    finishStage(index, ok);
+}
+
+void Startup::finishStage(size_t index, bool ok) {
+    std::vector<size_t> ready;
+    {
+        std::lock_guard<std::mutex> lock(s_mutex);
+        Stage& stage = s_stages[index];
+        stage.end_us = elapsedUs();
+        stage.state = ok ? StageState::DONE : StageState::FAILED;
+        if (!ok) {
+            LOG_ERROR(std::string("Échec de l'étape de démarrage: ") + stage.name);
+            if (stage.required) s_failed = true;
+        }
+        s_running--;
+        
+        // Les étapes de la réserve qui attendaient celle-ci partent sans attendre l'image suivante
+        ready = scheduleReady();
+    }
+    s_finished.notify_all();
+    launch(ready);
+}
+
+void Startup::logReport() {
+    std::string text = report();
+    Metrics::gauge("startup_complete_ms", "Durée du démarrage complet (ms)").set(s_complete_us / 1000);
+    
+    size_t start = 0;
+    while (start < text.size()) {
+        size_t end = text.find('\n', start);
+        LOG_INFO(text.substr(start, end - start));
+        start = end + 1;
+    }
+}
@@ -0,0 +1,262 @@
+/**
+ * PS4 Store P2P - Implémentation de l'Exécuteur de Tâches
+ */
+
+#include "utils/thread_pool.h"
+#include "utils/utils.h"
+#include "utils/metrics.h"
+#include "utils/trace.h"
+
+#include <algorithm>
+#include <deque>
+#include <shared_mutex>
+#include <thread>
+
+#ifdef __linux__
+#include <sched.h>
+#endif
+
+// Plafond de threads: au-delà, la PS4 n'a plus de cœur à offrir
+static const int MAX_THREADS = 8;
+
+struct PoolTask {
+    std::function<void()> run;
+    std::chrono::steady_clock::time_point queued;
+    TaskPriority priority;
+};
+
+// Files d'un thread: le propriétaire prend par l'avant, les voleurs par l'arrière
+struct PoolWorker {
+    std::mutex mutex;
+    std::deque<PoolTask> lanes[2];
+    std::thread thread;
+};
+
+enum PoolState {
+    POOL_IDLE,                  // Pas encore démarrée
+    POOL_RUNNING,
+    POOL_STOPPED                // Tâches exécutées sur le thread appelant
+};
+
+// Variables statiques
+static std::shared_mutex s_pool_mutex;          // Partagé pour soumettre, exclusif pour démarrer ou arrêter
+static std::atomic<int> s_state(POOL_IDLE);
+static std::vector<std::unique_ptr<PoolWorker>> s_workers;
+static std::atomic<size_t> s_next_worker(0);
+static std::atomic<int64_t> s_pending(0);
+static std::atomic<int> s_busy(0);
+static std::atomic<int64_t> s_completed(0);
+static std::atomic<int64_t> s_stolen(0);
+static std::mutex s_idle_mutex;
+static std::condition_variable s_idle_cv;
+static bool s_stopping = false;
+
+// Indice du thread dans la réserve, -1 ailleurs
+static thread_local int t_worker = -1;
+
+static int availableCores();
+static void workerLoop(int index);
+static bool takeTask(int index, PoolTask& task);
+static void execute(PoolTask& task);
+
+void ThreadPool::start(int threads) {
+    std::unique_lock<std::shared_mutex> lock(s_pool_mutex);
+    if (s_state.load() == POOL_RUNNING) return;
+    
+    if (threads <= 0) {
+        // Cœurs disponibles, moins celui du thread principal (interface)
+        int cores = availableCores();
+        threads = cores > 1 ? cores - 1 : 2;
+    }
+    threads = std::min(threads, MAX_THREADS);
+    
+    {
+        std::lock_guard<std::mutex> idle_lock(s_idle_mutex);
+        s_stopping = false;
+    }
+    s_workers.clear();
+    for (int i = 0; i < threads; i++) {
+        s_workers.emplace_back(new PoolWorker());
+    }
+    for (int i = 0; i < threads; i++) {
+        s_workers[i]->thread = std::thread(workerLoop, i);
+    }
+    
+    Metrics::sampledGauge("pool_busy_threads", []() { return static_cast<int64_t>(s_busy.load()); },
+                          "Threads de la réserve exécutant une tâche");
+    Metrics::sampledGauge("pool_queued_tasks", []() { return std::max<int64_t>(0, s_pending.load()); },
+                          "Tâches en attente dans la réserve");
+    
+    s_state.store(POOL_RUNNING);
+    LOG_INFO("Réserve de threads démarrée: " + std::to_string(threads) + " threads");
+}
+
+void ThreadPool::stop() {
+    {
+        // Plus aucune tâche déposée dans les files une fois le verrou rendu
+        std::unique_lock<std::shared_mutex> lock(s_pool_mutex);
+        if (s_state.load() != POOL_RUNNING) return;
+        s_state.store(POOL_STOPPED);
+        
+        std::lock_guard<std::mutex> idle_lock(s_idle_mutex);
+        s_stopping = true;
+    }
+    s_idle_cv.notify_all();
+    
+    // Sans verrou: une tâche en cours peut encore soumettre (exécutée sur place)
+    for (auto& worker : s_workers) {
+        if (worker->thread.joinable()) worker->thread.join();
+    }
+    
+    std::unique_lock<std::shared_mutex> lock(s_pool_mutex);
+    s_workers.clear();
+    LOG_INFO("Réserve de threads arrêtée (" + std::to_string(s_completed.load()) + " tâches exécutées)");
+}
+
+void ThreadPool::post(std::function<void()> task, TaskPriority priority) {
+    if (s_state.load() == POOL_IDLE) {
+        start();
+    }
+    
+    PoolTask pool_task{std::move(task), std::chrono::steady_clock::now(), priority};
+    {
+        std::shared_lock<std::shared_mutex> lock(s_pool_mutex);
+        if (s_state.load() != POOL_RUNNING) {
+            // Réserve arrêtée: exécution sur le thread appelant
+            lock.unlock();
+            execute(pool_task);
+            return;
+        }
+        
+        // Depuis un thread de la réserve: dans sa propre file (données chaudes dans son cache)
+        size_t index = t_worker >= 0 ? static_cast<size_t>(t_worker) : s_next_worker.fetch_add(1) % s_workers.size();
+        PoolWorker& worker = *s_workers[index];
+        {
+            std::lock_guard<std::mutex> worker_lock(worker.mutex);
+            worker.lanes[static_cast<int>(priority)].push_back(std::move(pool_task));
+        }
+        s_pending.fetch_add(1);
+    }
+    
+    {
+        std::lock_guard<std::mutex> idle_lock(s_idle_mutex);
+    }
+    s_idle_cv.notify_one();
+}
+
+bool ThreadPool::runPendingTask() {
+    if (t_worker < 0) return false;
+    
+    PoolTask task;
+    if (!takeTask(t_worker, task)) return false;
+    execute(task);
+    return true;
+}
+
+bool ThreadPool::isWorkerThread() {
+    return t_worker >= 0;
+}
+
+ThreadPoolStats ThreadPool::getStats() {
+    ThreadPoolStats stats;
+    {
+        std::shared_lock<std::shared_mutex> lock(s_pool_mutex);
+        stats.threads = s_state.load() == POOL_RUNNING ? static_cast<int>(s_workers.size()) : 0;
+    }
+    stats.busy = s_busy.load();
+    stats.queued = std::max<int64_t>(0, s_pending.load());
+    stats.completed = s_completed.load();
+    stats.stolen = s_stolen.load();
+    return stats;
+}
+
+// Fonctions internes
+static int availableCores() {
+#ifdef __linux__
+    // Cœurs accordés au processus (affinité, cpuset d'un conteneur), pas ceux de la machine
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        int count = CPU_COUNT(&set);
+        if (count > 0) return count;
+    }
+#endif
+    return static_cast<int>(std::thread::hardware_concurrency());
+}
+
+static void workerLoop(int index) {
+    t_worker = index;
+    TRACE_THREAD_NAME("pool");
+    
+    while (true) {
+        PoolTask task;
+        if (takeTask(index, task)) {
+            execute(task);
+            continue;
+        }
+        
+        std::unique_lock<std::mutex> lock(s_idle_mutex);
+        s_idle_cv.wait(lock, [] { return s_pending.load() > 0 || s_stopping; });
+        if (s_stopping && s_pending.load() <= 0) break;
+    }
+    
+    t_worker = -1;
+}
+
+static bool takeTask(int index, PoolTask& task) {
+    size_t count = s_workers.size();
+    
+    // Priorité interactive d'abord, dans toutes les files, puis le travail de fond
+    for (int lane = 0; lane < 2; lane++) {
+        {
+            PoolWorker& own = *s_workers[index];
+            std::lock_guard<std::mutex> lock(own.mutex);
+            if (!own.lanes[lane].empty()) {
+                task = std::move(own.lanes[lane].front());
+                own.lanes[lane].pop_front();
+                s_pending.fetch_sub(1);
+                return true;
+            }
+        }
+        
+        for (size_t offset = 1; offset < count; offset++) {
+            PoolWorker& victim = *s_workers[(index + offset) % count];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.lanes[lane].empty()) {
+                task = std::move(victim.lanes[lane].back());
+                victim.lanes[lane].pop_back();
+                s_pending.fetch_sub(1);
+                s_stolen.fetch_add(1, std::memory_order_relaxed);
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+static void execute(PoolTask& task) {
+    static MetricHistogram& interactive_wait = Metrics::histogram("pool_wait_interactive_us",
+                                                                   "Attente d'une tâche interactive dans la réserve (µs)");
+    static MetricHistogram& bulk_wait = Metrics::histogram("pool_wait_bulk_us",
+                                                            "Attente d'une tâche de fond dans la réserve (µs)");
+    static MetricHistogram& run_time = Metrics::histogram("pool_task_us", "Exécution d'une tâche de la réserve (µs)");
+    
+    auto started = std::chrono::steady_clock::now();
+    MetricHistogram& wait_time = task.priority == TaskPriority::INTERACTIVE ? interactive_wait : bulk_wait;
+    wait_time.record(std::chrono::duration_cast<std::chrono::microseconds>(started - task.queued).count());
+    
+    s_busy.fetch_add(1);
+    try {
+        TRACE_SCOPE("pool", "task");
+        task.run();
+    } catch (const std::exception& e) {
+        LOG_ERROR("Exception dans une tâche de la réserve: " + std::string(e.what()));
+    } catch (...) {
+        LOG_ERROR("Exception inconnue dans une tâche de la réserve");
+    }
+    s_busy.fetch_sub(1);
+    s_completed.fetch_add(1, std::memory_order_relaxed);
+    
+    run_time.record(std::chrono::duration_cast<std::chrono::microseconds>(
+        std::chrono::steady_clock::now() - started).count());
+}
@@ -0,0 +1,326 @@
+/**
+ * PS4 Store P2P - Implémentation du Traçage des Événements
+ */
+
+#include "utils/trace.h"
+#include "utils/utils.h"
+
+#include <mutex>
+#include <algorithm>
+#include <vector>
+#include <deque>
+#include <memory>
+#include <thread>
+#include <cstdio>
+
+// Événements par bloc: le verrou global n'est pris qu'au changement de bloc
+static const uint32_t CHUNK_EVENTS = 4096;
+
+struct TraceEvent {
+    const char* category;
+    const char* name;
+    uint64_t start;             // Tics
+    int64_t value;              // Durée en tics (X) ou valeur (C)
+    char type;                  // Phase Chrome: X, C, i
+};
+
+struct TraceChunk {
+    TraceEvent events[CHUNK_EVENTS];
+    std::atomic<uint32_t> count;    // Publié par le thread propriétaire (release)
+    uint32_t thread_id;
+};
+
+// Thread connu de la trace; current ne change que sous s_mutex
+struct TraceThread {
+    uint32_t id;
+    std::string name;
+    TraceChunk* current;
+};
+
+// Variables statiques
+std::atomic<bool> Trace::s_enabled(false);
+
+static std::mutex s_mutex;
+static std::vector<std::unique_ptr<TraceThread>> s_threads;
+static std::deque<TraceChunk*> s_full_chunks;     // Du plus ancien au plus récent
+static std::vector<TraceChunk*> s_free_chunks;
+static size_t s_allocated_chunks = 0;
+static size_t s_max_chunks = 0;
+static int64_t s_dropped = 0;
+static bool s_started = false;
+static uint64_t s_start_ticks = 0;
+static std::chrono::steady_clock::time_point s_start_time;
+static double s_ns_per_tick = 1.0;
+
+// Bloc rendu à la trace lorsque le thread se termine
+struct ThreadSlot {
+    TraceThread* state = nullptr;
+    ~ThreadSlot();
+};
+static thread_local ThreadSlot t_slot;
+
+// Copie sans destructeur lue à chaque événement (pas de garde d'initialisation)
+static thread_local TraceThread* t_state = nullptr;
+
+static void record(char type, const char* category, const char* name, uint64_t start, int64_t value);
+static TraceThread* registerThread();
+static TraceChunk* acquireChunk(TraceThread* state);
+
+void Trace::start(size_t max_events) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (s_started) {
+        s_enabled.store(true);
+        return;
+    }
+    
+    s_max_chunks = std::max<size_t>(2, (max_events + CHUNK_EVENTS - 1) / CHUNK_EVENTS);
+    
+    // Blocs alloués et remplis d'avance: pas de défaut de page pendant l'enregistrement
+    for (size_t i = 0; i < s_max_chunks; i++) {
+        s_free_chunks.push_back(new TraceChunk());
+    }
+    s_allocated_chunks = s_max_chunks;
+    
+    // Étalonnage du compteur du processeur sur 10 ms, affiné à chaque dump
+    s_start_time = std::chrono::steady_clock::now();
+    s_start_ticks = ticks();
+    std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    double elapsed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - s_start_time).count();
+    uint64_t elapsed_ticks = ticks() - s_start_ticks;
+    s_ns_per_tick = elapsed_ticks > 0 ? elapsed_ns / static_cast<double>(elapsed_ticks) : 1.0;
+    
+    s_started = true;
+    s_enabled.store(true);
+    LOG_INFO("Traçage démarré (" + std::to_string(s_max_chunks * CHUNK_EVENTS) + " événements conservés)");
+}
+
+void Trace::stop() {
+    s_enabled.store(false);
+}
+
+void Trace::setThreadName(const char* name) {
+    TraceThread* state = t_state ? t_state : registerThread();
+    std::lock_guard<std::mutex> lock(s_mutex);
+    state->name = name;
+}
+
+void Trace::complete(const char* category, const char* name, uint64_t start, uint64_t end) {
+    record('X', category, name, start, static_cast<int64_t>(end - start));
+}
+
+void Trace::counter(const char* name, int64_t value) {
+    if (!isEnabled()) return;
+    record('C', "", name, ticks(), value);
+}
+
+void Trace::instant(const char* category, const char* name) {
+    if (!isEnabled()) return;
+    record('i', category, name, ticks(), 0);
+}
+
+size_t Trace::getEventCount() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    size_t count = 0;
+    for (const TraceChunk* chunk : s_full_chunks) {
+        count += chunk->count.load(std::memory_order_relaxed);
+    }
+    for (const auto& state : s_threads) {
+        if (state->current) count += state->current->count.load(std::memory_order_acquire);
+    }
+    return count;
+}
+
+int64_t Trace::getDropped() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    return s_dropped;
+}
+
+// Échappement JSON des noms (guillemets, barres obliques inverses, contrôles)
+static void appendJsonString(std::string& out, const char* text) {
+    out += '"';
+    for (const char* p = text; *p; p++) {
+        unsigned char c = static_cast<unsigned char>(*p);
+        if (c == '"' || c == '\\') {
+            out += '\\';
+            out += static_cast<char>(c);
+        } else if (c < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            out += escaped;
+        } else {
+            out += static_cast<char>(c);
+        }
+    }
+    out += '"';
+}
+
+bool Trace::dump(const std::string& path) {
+    std::vector<TraceEvent> events;
+    std::vector<uint32_t> thread_ids;
+    std::vector<std::pair<uint32_t, std::string>> names;
+    uint64_t start_ticks;
+    double ns_per_tick;
+    int64_t dropped;
+    
+    {
+        // Copie sous verrou: aucun bloc ne change de main pendant la lecture
+        std::lock_guard<std::mutex> lock(s_mutex);
+        if (!s_started) return false;
+        
+        auto copyChunk = [&](const TraceChunk* chunk) {
+            uint32_t count = chunk->count.load(std::memory_order_acquire);
+            events.insert(events.end(), chunk->events, chunk->events + count);
+            thread_ids.insert(thread_ids.end(), count, chunk->thread_id);
+        };
+        for (const TraceChunk* chunk : s_full_chunks) {
+            copyChunk(chunk);
+        }
+        for (const auto& state : s_threads) {
+            if (state->current) copyChunk(state->current);
+            names.emplace_back(state->id, state->name.empty() ? "thread " + std::to_string(state->id) : state->name);
+        }
+        
+        // Étalonnage affiné sur toute la durée écoulée
+        double elapsed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - s_start_time).count();
+        uint64_t elapsed_ticks = ticks() - s_start_ticks;
+        if (elapsed_ns > 1e9 && elapsed_ticks > 0) {
+            s_ns_per_tick = elapsed_ns / static_cast<double>(elapsed_ticks);
+        }
+        start_ticks = s_start_ticks;
+        ns_per_tick = s_ns_per_tick;
+        dropped = s_dropped;
+    }
+    
+    FILE* file = fopen(path.c_str(), "w");
+    if (!file) {
+        LOG_ERROR("Impossible d'écrire la trace: " + path);
+        return false;
+    }
+    
+    std::string out = "{\"traceEvents\":[\n";
+    bool first = true;
+    char number[64];
+    
+    for (const auto& name : names) {
+        out += first ? "" : ",\n";
+        first = false;
+        out += "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" + std::to_string(name.first) +
+               ",\"args\":{\"name\":";
+        appendJsonString(out, name.second.c_str());
+        out += "}}";
+    }
+    
+    for (size_t i = 0; i < events.size(); i++) {
+        const TraceEvent& event = events[i];
+        // Événements antérieurs au démarrage (horloge d'un autre cœur): ramenés à 0
+        double ts = event.start > start_ticks ? static_cast<double>(event.start - start_ticks) * ns_per_tick / 1000.0 : 0.0;
+        
+        out += first ? "" : ",\n";
+        first = false;
+        out += "{\"name\":";
+        appendJsonString(out, event.name);
+        if (event.category[0]) {
+            out += ",\"cat\":";
+            appendJsonString(out, event.category);
+        }
+        std::snprintf(number, sizeof(number), ",\"ph\":\"%c\",\"pid\":1,\"tid\":%u,\"ts\":%.3f", event.type,
+                      thread_ids[i], ts);
+        out += number;
+        
+        if (event.type == 'X') {
+            std::snprintf(number, sizeof(number), ",\"dur\":%.3f", static_cast<double>(event.value) * ns_per_tick / 1000.0);
+            out += number;
+        } else if (event.type == 'C') {
+            out += ",\"args\":{\"value\":" + std::to_string(event.value) + "}";
+        } else if (event.type == 'i') {
+            out += ",\"s\":\"t\"";
+        }
+        out += '}';
+        
+        if (out.size() >= 1024 * 1024) {
+            fwrite(out.data(), 1, out.size(), file);
+            out.clear();
+        }
+    }
+    
+    out += "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"dropped_events\":" + std::to_string(dropped) + "}}\n";
+    fwrite(out.data(), 1, out.size(), file);
+    bool ok = ferror(file) == 0;
+    fclose(file);
+    
+    if (ok) {
+        LOG_INFO("Trace écrite: " + path + " (" + std::to_string(events.size()) + " événements)");
+    }
+    return ok;
+}
+
+// Fonctions internes
+static void record(char type, const char* category, const char* name, uint64_t start, int64_t value) {
+    TraceThread* state = t_state ? t_state : registerThread();
+    
+    // Seul le thread propriétaire écrit dans son bloc courant
+    TraceChunk* chunk = state->current;
+    uint32_t index = chunk ? chunk->count.load(std::memory_order_relaxed) : CHUNK_EVENTS;
+    if (index == CHUNK_EVENTS) {
+        chunk = acquireChunk(state);
+        index = 0;
+    }
+    
+    TraceEvent& event = chunk->events[index];
+    event.category = category;
+    event.name = name;
+    event.start = start;
+    event.value = value;
+    event.type = type;
+    chunk->count.store(index + 1, std::memory_order_release);
+}
+
+static TraceThread* registerThread() {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    s_threads.emplace_back(new TraceThread{static_cast<uint32_t>(s_threads.size() + 1), "", nullptr});
+    t_slot.state = s_threads.back().get();
+    t_state = t_slot.state;
+    return t_state;
+}
+
+static TraceChunk* acquireChunk(TraceThread* state) {
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (state->current) {
+        s_full_chunks.push_back(state->current);
+    }
+    
+    TraceChunk* chunk;
+    if (!s_free_chunks.empty()) {
+        chunk = s_free_chunks.back();
+        s_free_chunks.pop_back();
+    } else if (s_allocated_chunks < s_max_chunks || s_full_chunks.empty()) {
+        chunk = new TraceChunk();
+        s_allocated_chunks++;
+    } else {
+        // Limite atteinte: le bloc le plus ancien est recyclé
+        chunk = s_full_chunks.front();
+        s_full_chunks.pop_front();
+        s_dropped += chunk->count.load(std::memory_order_relaxed);
+    }
+    
+    chunk->thread_id = state->id;
+    chunk->count.store(0, std::memory_order_relaxed);
+    state->current = chunk;
+    return chunk;
+}
+
+ThreadSlot::~ThreadSlot() {
+    if (!state) return;
+    
+    // Bloc entamé conservé, bloc vide rendu
+    std::lock_guard<std::mutex> lock(s_mutex);
+    if (state->current) {
+        if (state->current->count.load(std::memory_order_relaxed) > 0) {
+            s_full_chunks.push_back(state->current);
+        } else {
+            s_free_chunks.push_back(state->current);
+        }
+        state->current = nullptr;
+    }
+    t_state = nullptr;
+}
@@ -3,6 +3,7 @@
  */
 
 #include "utils/utils.h"
+#include "utils/async_logger.h"
 
 #include <fstream>
 #include <sstream>
@@ -31,7 +32,8 @@ bool Utils::s_file_logging_enabled = false;
 std::string Utils::s_log_file = "ps4_store.log";
 
 int Utils::initialize() {
-    // Initialisation du système de logging
+    // Initialisation du système de logging (écriture en arrière-plan)
+    AsyncLogger::start();
     log(LogLevel::INFO, "Initialisation des utilitaires");
     
 #ifdef _WIN32
@@ -52,6 +54,9 @@ void Utils::cleanup() {
 #ifdef _WIN32
     WSACleanup();
 #endif
+    
+    // Derniers messages écrits avant l'arrêt du thread du journal
+    AsyncLogger::stop();
 }
 
 // === GESTION DES FICHIERS ===
@@ -279,30 +284,8 @@ void Utils::log(LogLevel level, const std::string& message, const char* file, in
         return;
     }
     
-    std::ostringstream oss;
-    oss << "[" << getCurrentDateTime() << "] ";
-    oss << "[" << getLogLevelString(level) << "] ";
-    
-    if (file && line > 0) {
-        std::string filename = file;
-        size_t pos = filename.find_last_of("/\\");
-        if (pos != std::string::npos) {
-            filename = filename.substr(pos + 1);
-        }
-        oss << "[" << filename << ":" << line << "] ";
-    }
-    
-    oss << message;
-    
-    std::string log_message = oss.str();
-    
-    // Affichage sur la console
-    std::cout << log_message << std::endl;
-    
-    // Écriture dans le fichier si activée
-    if (s_file_logging_enabled) {
-        writeToLogFile(log_message);
-    }
+    // Mise en forme et écriture (console, fichier) faites par le thread du journal
+    AsyncLogger::push(level, getCurrentTimestamp(), file, line, message);
 }
 
 void Utils::setLogLevel(LogLevel level) {
@@ -313,6 +296,7 @@ void Utils::setLogLevel(LogLevel level) {
 void Utils::setFileLogging(bool enabled, const std::string& log_file) {
     s_file_logging_enabled = enabled;
     s_log_file = log_file;
+    AsyncLogger::setFile(enabled ? log_file : "");
     
     if (enabled) {
         log(LogLevel::INFO, "Logging fichier activé: " + log_file);
@@ -321,46 +305,12 @@ void Utils::setFileLogging(bool enabled, const std::string& log_file) {
     }
 }
 
-// === CONFIGURATION ===
-
-std::map<std::string, std::string> Utils::loadConfig(const std::string& config_file) {
-    std::map<std::string, std::string> config;
-    
-    if (!fileExists(config_file)) {
-        log(LogLevel::WARNING, "Fichier de configuration non trouvé: " + config_file);
-        return config;
-    }
-    
-    try {
-        std::ifstream file(config_file);
-        std::string line;
-        
-        while (std::getline(file, line)) {
-            line = trim(line);
-            
-            // Ignorer les commentaires et lignes vides
-            if (line.empty() || line[0] == '#' || line[0] == ';') {
-                continue;
-            }
-            
-            size_t pos = line.find('=');
-            if (pos != std::string::npos) {
-                std::string key = trim(line.substr(0, pos));
-                std::string value = trim(line.substr(pos + 1));
-                config[key] = value;
-            }
-        }
-        
-        file.close();
-        log(LogLevel::INFO, "Configuration chargée: " + std::to_string(config.size()) + " paramètres");
-        
-    } catch (const std::exception& e) {
-        log(LogLevel::ERROR, "Erreur lors du chargement de la configuration: " + std::string(e.what()));
-    }
-    
-    return config;
+void Utils::setMaxLogSize(int64_t bytes) {
+    AsyncLogger::setMaxFileSize(bytes);
 }
 
+// === CONFIGURATION ===
+
 bool Utils::saveConfig(const std::string& config_file, const std::map<std::string, std::string>& config) {
     try {
         std::ofstream file(config_file);
@@ -441,6 +391,89 @@ std::string Utils::getLocalIP() {
 #endif
 }
 
+std::vector<NetworkInterface> Utils::getNetworkInterfaces() {
+    std::vector<NetworkInterface> interfaces;
+    
+#ifdef _WIN32
+    // Sans getifaddrs: adresse principale avec un masque /24 supposé
+    NetworkInterface iface = {};
+    iface.name = "default";
+    iface.address = getLocalIP();
+    iface.netmask = "255.255.255.0";
+    iface.is_loopback = iface.address == "127.0.0.1";
+    
+    struct in_addr addr;
+    if (inet_pton(AF_INET, iface.address.c_str(), &addr) == 1) {
+        char buffer[INET_ADDRSTRLEN];
+        uint32_t host = ntohl(addr.s_addr);
+        addr.s_addr = htonl(host & 0xFFFFFF00);
+        iface.first_address = inet_ntop(AF_INET, &addr, buffer, sizeof(buffer));
+        addr.s_addr = htonl(host | 0x000000FF);
+        iface.last_address = inet_ntop(AF_INET, &addr, buffer, sizeof(buffer));
+        interfaces.push_back(iface);
+    }
+#else
+    struct ifaddrs *ifaddrs_ptr, *ifa;
+    
+    if (getifaddrs(&ifaddrs_ptr) == -1) {
+        return interfaces;
+    }
+    
+    for (ifa = ifaddrs_ptr; ifa != NULL; ifa = ifa->ifa_next) {
+        if (!ifa->ifa_addr || !ifa->ifa_netmask) {
+            continue;
+        }
+        
+        NetworkInterface iface = {};
+        iface.name = ifa->ifa_name ? ifa->ifa_name : "";
+        
+        if (ifa->ifa_addr->sa_family == AF_INET) {
+            char buffer[INET_ADDRSTRLEN];
+            struct in_addr addr = ((struct sockaddr_in*)ifa->ifa_addr)->sin_addr;
+            struct in_addr mask = ((struct sockaddr_in*)ifa->ifa_netmask)->sin_addr;
+            
+            iface.is_ipv6 = false;
+            iface.address = inet_ntop(AF_INET, &addr, buffer, sizeof(buffer));
+            iface.netmask = inet_ntop(AF_INET, &mask, buffer, sizeof(buffer));
+            iface.is_loopback = (ntohl(addr.s_addr) >> 24) == 127;
+            
+            struct in_addr first, last;
+            first.s_addr = addr.s_addr & mask.s_addr;
+            last.s_addr = addr.s_addr | ~mask.s_addr;
+            iface.first_address = inet_ntop(AF_INET, &first, buffer, sizeof(buffer));
+            iface.last_address = inet_ntop(AF_INET, &last, buffer, sizeof(buffer));
+            
+        } else if (ifa->ifa_addr->sa_family == AF_INET6) {
+            char buffer[INET6_ADDRSTRLEN];
+            struct in6_addr addr = ((struct sockaddr_in6*)ifa->ifa_addr)->sin6_addr;
+            struct in6_addr mask = ((struct sockaddr_in6*)ifa->ifa_netmask)->sin6_addr;
+            
+            iface.is_ipv6 = true;
+            iface.address = inet_ntop(AF_INET6, &addr, buffer, sizeof(buffer));
+            iface.netmask = inet_ntop(AF_INET6, &mask, buffer, sizeof(buffer));
+            iface.is_loopback = IN6_IS_ADDR_LOOPBACK(&addr);
+            
+            struct in6_addr first, last;
+            for (int i = 0; i < 16; i++) {
+                first.s6_addr[i] = addr.s6_addr[i] & mask.s6_addr[i];
+                last.s6_addr[i] = addr.s6_addr[i] | static_cast<uint8_t>(~mask.s6_addr[i]);
+            }
+            iface.first_address = inet_ntop(AF_INET6, &first, buffer, sizeof(buffer));
+            iface.last_address = inet_ntop(AF_INET6, &last, buffer, sizeof(buffer));
+            
+        } else {
+            continue;
+        }
+        
+        interfaces.push_back(iface);
+    }
+    
+    freeifaddrs(ifaddrs_ptr);
+#endif
+    
+    return interfaces;
+}
+
 // Méthodes privées
 std::string Utils::getLogLevelString(LogLevel level) {
     switch (level) {
@@ -450,16 +483,4 @@ std::string Utils::getLogLevelString(LogLevel level) {
         case LogLevel::ERROR:   return "ERROR";
         default:                return "UNKNOWN";
     }
-}
-
-void Utils::writeToLogFile(const std::string& message) {
-    try {
-        std::ofstream file(s_log_file, std::ios::app);
-        if (file.is_open()) {
-            file << message << std::endl;
-            file.close();
-        }
-    } catch (const std::exception&) {
-        // Ignorer les erreurs d'écriture de log pour éviter les boucles infinies
-    }
 }
\ No newline at end of file
@@ -0,0 +1,178 @@
+/**
+ * @file blocklist_bench.cpp
+ * @brief Banc de mesure de la liste de blocage IP
+ * @author PS4 Store P2P Team
+ * @date 2024
+ *
+ * Génère une liste synthétique (moitié P2P, moitié DAT, plages qui se
+ * chevauchent), puis mesure le chargement à froid (analyse, fusion, écriture
+ * du cache), le rechargement depuis le cache binaire et le coût d'une
+ * recherche, comparé à un parcours linéaire des plages non fusionnées.
+ *
+ * Usage: blocklist_bench [--ranges N] [--lookups N] [--dir chemin]
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+
+#include "../include/utils/utils.h"
+#include "../include/p2p/ip_blocklist.h"
+
+// Paramètres du banc
+struct BenchOptions {
+    int ranges = 1000000;
+    int lookups = 10000000;
+    std::string dir = "/tmp/ps4_blocklist_bench";
+};
+
+static bool parseOptions(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        
+        if (arg == "--ranges" && has_value) {
+            options.ranges = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--lookups" && has_value) {
+            options.lookups = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--dir" && has_value) {
+            options.dir = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--ranges N] [--lookups N] [--dir chemin]" << std::endl;
+            return false;
+        }
+    }
+    return true;
+}
+
+static std::string formatAddress(uint32_t address, bool padded) {
+    char text[16];
+    std::snprintf(text, sizeof(text), padded ? "%03u.%03u.%03u.%03u" : "%u.%u.%u.%u",
+                  address >> 24, (address >> 16) & 0xFF, (address >> 8) & 0xFF, address & 0xFF);
+    return text;
+}
+
+// Liste synthétique: largeurs de 1 à 4096 adresses, environ 10% de chevauchements
+static bool generateList(const std::string& path, int count, std::vector<IpRange>& ranges) {
+    std::ofstream file(path);
+    if (!file.is_open()) return false;
+    
+    std::mt19937 generator(42);
+    std::uniform_int_distribution<uint32_t> any_address;
+    std::uniform_int_distribution<uint32_t> width(0, 4095);
+    
+    file << "# Liste de blocage synthétique\n";
+    for (int i = 0; i < count; i++) {
+        IpRange range;
+        if (i > 0 && i % 10 == 0) {
+            range.first = ranges.back().first + width(generator) / 2;
+        } else {
+            range.first = any_address(generator);
+        }
+        range.last = range.first + std::min(width(generator), UINT32_MAX - range.first);
+        ranges.push_back(range);
+        
+        if (i % 2 == 0) {
+            file << "Plage " << i << ":" << formatAddress(range.first, false) << "-"
+                 << formatAddress(range.last, false) << "\n";
+        } else {
+            file << formatAddress(range.first, true) << " - " << formatAddress(range.last, true)
+                 << " , 000 , Plage " << i << "\n";
+        }
+    }
+    return file.good();
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return 2;
+    }
+    
+    Utils::setLogLevel(Utils::LogLevel::WARNING);
+    Utils::createDirectory(options.dir);
+    
+    std::string list_path = options.dir + "/blocklist.p2p";
+    std::string cache_path = options.dir + "/blocklist.bin";
+    Utils::deleteFile(cache_path);
+    
+    std::vector<IpRange> raw_ranges;
+    std::printf("Génération de %d plages...\n", options.ranges);
+    if (!generateList(list_path, options.ranges, raw_ranges)) {
+        std::cerr << "Impossible d'écrire " << list_path << std::endl;
+        return 1;
+    }
+    
+    // Chargement à froid: analyse en flux, fusion, écriture du cache
+    BlocklistStats cold;
+    if (IpBlocklist::load({list_path}, cache_path, &cold) < 0) {
+        std::cerr << "Chargement impossible" << std::endl;
+        return 1;
+    }
+    
+    // Rechargement depuis le cache binaire
+    BlocklistStats warm;
+    IpBlocklist::load({list_path}, cache_path, &warm);
+    
+    std::printf("\nSource: %s (%s)\n", list_path.c_str(), Utils::formatFileSize(Utils::getFileSize(list_path)).c_str());
+    std::printf("Chargement à froid: %lld ms (%lld lignes, %lld plages, %lld après fusion)\n",
+                static_cast<long long>(cold.load_ms), static_cast<long long>(cold.lines),
+                static_cast<long long>(cold.parsed), static_cast<long long>(cold.merged));
+    std::printf("Rechargement depuis le cache: %lld ms%s (%s)\n", static_cast<long long>(warm.load_ms),
+                warm.from_cache ? "" : " [cache ignoré]",
+                Utils::formatFileSize(Utils::getFileSize(cache_path)).c_str());
+    
+    // Recherches: adresses uniformes, somme des résultats pour empêcher l'élimination du calcul
+    std::mt19937 generator(7);
+    std::uniform_int_distribution<uint32_t> any_address;
+    std::vector<uint32_t> addresses(options.lookups);
+    for (auto& address : addresses) {
+        address = any_address(generator);
+    }
+    
+    auto start = std::chrono::steady_clock::now();
+    int64_t blocked = 0;
+    for (uint32_t address : addresses) {
+        blocked += IpBlocklist::isBlocked(address) ? 1 : 0;
+    }
+    double lookup_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                       options.lookups;
+    
+    // Référence: parcours linéaire des plages brutes, sur un échantillon réduit
+    int linear_lookups = std::min(options.lookups, 1000);
+    start = std::chrono::steady_clock::now();
+    int64_t linear_blocked = 0;
+    for (int i = 0; i < linear_lookups; i++) {
+        uint32_t address = addresses[i];
+        linear_blocked += std::any_of(raw_ranges.begin(), raw_ranges.end(), [address](const IpRange& range) {
+            return address >= range.first && address <= range.last;
+        }) ? 1 : 0;
+    }
+    double linear_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                       linear_lookups;
+    
+    int64_t check = 0;
+    for (int i = 0; i < linear_lookups; i++) {
+        check += IpBlocklist::isBlocked(addresses[i]) ? 1 : 0;
+    }
+    
+    std::printf("Recherche (dichotomie): %.1f ns/adresse sur %d adresses (%lld bloquées)\n",
+                lookup_ns, options.lookups, static_cast<long long>(blocked));
+    std::printf("Recherche (linéaire, référence): %.1f ns/adresse sur %d adresses\n", linear_ns, linear_lookups);
+    std::printf("Mémoire des intervalles: %s\n",
+                Utils::formatFileSize(static_cast<int64_t>(IpBlocklist::getRanges()->size() * sizeof(IpRange))).c_str());
+    
+    if (check != linear_blocked) {
+        std::cerr << "Résultats divergents: " << check << " != " << linear_blocked << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,110 @@
+/**
+ * @file log_bench.cpp
+ * @brief Banc de mesure du coût des macros de log
+ * @author PS4 Store P2P Team
+ * @date 2024
+ *
+ * Reprend le message de PkgManager::updateInstallProgress, autrefois écrit pour chaque
+ * bloc de 64 KiB copié, au niveau DEBUG alors que le journal est en INFO.
+ * Compare la boucle vide, les macros filtrées (niveau vérifié avant
+ * l'évaluation du message), l'ancien appel qui construisait le message avant
+ * le filtre, et le coût de mise en forme seul (concaténation ou gabarit "{}"
+ * dans le tampon du thread) quand le message est écrit.
+ *
+ * Usage: log_bench [--iterations N]
+ */
+
+#include <iostream>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+
+#include "../include/utils/utils.h"
+
+// Empêche le compilateur de sortir le test de niveau de la boucle
+#define BENCH_BARRIER() asm volatile("" ::: "memory")
+
+template <typename Body>
+static double measure(int64_t iterations, Body body) {
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < iterations; i++) {
+        body(i);
+        BENCH_BARRIER();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return seconds * 1e9 / static_cast<double>(iterations);
+}
+
+static void printResult(const char* label, double nanoseconds, double baseline) {
+    std::printf("%-36s %8.2f ns/appel  (%+.2f ns par rapport à la boucle vide)\n", label, nanoseconds,
+                nanoseconds - baseline);
+}
+
+int main(int argc, char* argv[]) {
+    int64_t iterations = 20000000;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--iterations" && i + 1 < argc) {
+            iterations = std::max<int64_t>(1, std::atoll(argv[++i]));
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--iterations N]" << std::endl;
+            return 2;
+        }
+    }
+    
+    Utils::setLogLevel(Utils::LogLevel::INFO);
+    const std::string operation = "Copie en cours...";
+    float progress = 0.0f;
+    
+    std::printf("%lld appels par mesure, niveau INFO, messages DEBUG (LOG_COMPILE_LEVEL=%d)\n",
+                static_cast<long long>(iterations), LOG_COMPILE_LEVEL);
+    
+    double baseline = measure(iterations, [&](int64_t i) {
+        progress = static_cast<float>(i & 1023) / 1024.0f;
+    });
+    
+    double filtered = measure(iterations, [&](int64_t i) {
+        progress = static_cast<float>(i & 1023) / 1024.0f;
+        LOG_DEBUG("Progrès d'installation: " + operation + " (" + Utils::formatPercentage(progress) + ")");
+    });
+    
+    double filtered_format = measure(iterations, [&](int64_t i) {
+        progress = static_cast<float>(i & 1023) / 1024.0f;
+        LOG_DEBUGF("Progrès d'installation: {} ({})", operation, Utils::formatPercentage(progress));
+    });
+    
+    // Ancien comportement: message construit puis rejeté par Utils::log
+    int64_t eager_iterations = std::max<int64_t>(1, iterations / 20);
+    double eager = measure(eager_iterations, [&](int64_t i) {
+        progress = static_cast<float>(i & 1023) / 1024.0f;
+        Utils::log(Utils::LogLevel::DEBUG,
+                   "Progrès d'installation: " + operation + " (" + Utils::formatPercentage(progress) + ")",
+                   __FILE__, __LINE__);
+    });
+    
+    // Mise en forme seule, telle que faite pour un message écrit
+    size_t sink = 0;
+    double concatenation = measure(eager_iterations, [&](int64_t i) {
+        std::string message = "Torrent " + operation + ": " + std::to_string(i) + " pièces, " +
+                              std::to_string(i * 16384) + " octets";
+        sink += message.size();
+    });
+    
+    double formatted = measure(eager_iterations, [&](int64_t i) {
+        std::string& buffer = LogFormat::threadBuffer();
+        LogFormat::format(buffer, "Torrent {}: {} pièces, {} octets", operation, i, i * 16384);
+        sink += buffer.size();
+    });
+    
+    printResult("Boucle vide", baseline, baseline);
+    printResult("LOG_DEBUG filtré", filtered, baseline);
+    printResult("LOG_DEBUGF filtré", filtered_format, baseline);
+    printResult("Message construit avant le filtre", eager, baseline);
+    printResult("Mise en forme par concaténation", concatenation, baseline);
+    printResult("Mise en forme par gabarit", formatted, baseline);
+    std::printf("%zu octets mis en forme\n", sink);
+    return 0;
+}
@@ -0,0 +1,495 @@
+/**
+ * @file swarm_bench.cpp
+ * @brief Banc de mesure d'un essaim local pour TorrentManager
+ * @author PS4 Store P2P Team
+ * @date 2024
+ *
+ * Un processus partage un package synthétique via sharePackage, N processus
+ * le téléchargent via startDownload (lien magnet), chacun lié à sa propre
+ * adresse 127.0.0.x. DHT, LSD, UPnP/NAT-PMP et trackers sont désactivés:
+ * les leechers se connectent directement au seeder.
+ *
+ * Mesures par leecher: délai du premier octet, débit établi (10% -> 90%),
+ * temps CPU par MB et pic de mémoire résidente.
+ *
+ * Les décisions du réglage automatique du seeder (SessionTuner) sont listées
+ * à la fin; --no-autotune conserve les limites initiales pour comparaison.
+ *
+ * Usage: swarm_bench [--leechers N] [--size-mb MB] [--port P] [--dir chemin] [--no-autotune]
+ *
+ * Sous FreeBSD/macOS, les adresses 127.0.0.2+ doivent être ajoutées à lo0.
+ */
+
+#include <iostream>
+#include <fstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <chrono>
+#include <thread>
+#include <algorithm>
+#include <filesystem>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <cstdint>
+
+#include <unistd.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/wait.h>
+#include <sys/resource.h>
+
+#include "../include/utils/utils.h"
+#include "../include/p2p/torrent_manager.h"
+#include "../include/p2p/session_tuner.h"
+
+static const char* BENCH_NAME = "bench_pkg";
+static const int64_t SEED_TIMEOUT_MS = 30 * 60 * 1000;
+static const int64_t LEECH_TIMEOUT_MS = 30 * 60 * 1000;
+
+// Paramètres du banc
+struct BenchOptions {
+    int leechers = 4;
+    int size_mb = 2048;
+    int port = 16881;
+    std::string dir = "/tmp/ps4_swarm_bench";
+    bool autotune = true;
+    
+    // Mode leecher (processus enfant)
+    int leecher_index = -1;
+    std::string magnet;
+};
+
+// Résultat d'un leecher
+struct LeecherResult {
+    bool ok = false;
+    int64_t ttfb_ms = 0;
+    int64_t total_ms = 0;
+    double steady_mbps = 0.0;
+    double cpu_ms_per_mb = 0.0;
+    long peak_rss_kb = 0;
+};
+
+// Utilisation des ressources du processus courant
+static void getResourceUsage(double& cpu_ms, long& peak_rss_kb) {
+    struct rusage usage;
+    getrusage(RUSAGE_SELF, &usage);
+    cpu_ms = usage.ru_utime.tv_sec * 1000.0 + usage.ru_utime.tv_usec / 1000.0 +
+             usage.ru_stime.tv_sec * 1000.0 + usage.ru_stime.tv_usec / 1000.0;
+    peak_rss_kb = usage.ru_maxrss;
+}
+
+static bool parseOptions(int argc, char* argv[], BenchOptions& options) {
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        
+        if (arg == "--leechers" && has_value) {
+            options.leechers = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--size-mb" && has_value) {
+            options.size_mb = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--port" && has_value) {
+            options.port = std::atoi(argv[++i]);
+        } else if (arg == "--dir" && has_value) {
+            options.dir = argv[++i];
+        } else if (arg == "--no-autotune") {
+            options.autotune = false;
+        } else if (arg == "--leecher" && i + 2 < argc) {
+            options.leecher_index = std::atoi(argv[++i]);
+            options.magnet = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--leechers N] [--size-mb MB] [--port P] [--dir chemin] [--no-autotune]" << std::endl;
+            return false;
+        }
+    }
+    
+    return Utils::isValidPort(options.port);
+}
+
+/**
+ * Crée un package synthétique (en-tête PKG puis données pseudo-aléatoires)
+ * Réutilisé tel quel s'il existe déjà avec la bonne taille
+ */
+static bool createSyntheticPackage(const std::string& path, int size_mb) {
+    int64_t size = static_cast<int64_t>(size_mb) * 1024 * 1024;
+    if (Utils::fileExists(path) && Utils::getFileSize(path) == size) {
+        return true;
+    }
+    
+    std::ofstream file(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Impossible de créer " << path << std::endl;
+        return false;
+    }
+    
+    std::vector<uint64_t> chunk(1024 * 1024 / sizeof(uint64_t));
+    uint64_t state = 0x9E3779B97F4A7C15ULL;
+    
+    for (int mb = 0; mb < size_mb; mb++) {
+        // xorshift64: données incompressibles, aucune pièce identique
+        for (auto& word : chunk) {
+            state ^= state << 13;
+            state ^= state >> 7;
+            state ^= state << 17;
+            word = state;
+        }
+        
+        if (mb == 0) {
+            const unsigned char magic[4] = {0x7F, 'C', 'N', 'T'};
+            std::memcpy(chunk.data(), magic, sizeof(magic));
+        }
+        
+        file.write(reinterpret_cast<const char*>(chunk.data()), chunk.size() * sizeof(uint64_t));
+    }
+    
+    return file.good();
+}
+
+static SessionOptions makeSessionOptions(const std::string& address, int port, const std::string& dir) {
+    SessionOptions options;
+    options.listen_interfaces = address + ":" + std::to_string(port);
+    options.outgoing_interfaces = address;
+    options.download_path = dir;
+    options.state_file = dir + "/session.state";
+    options.enable_dht = false;
+    options.enable_lsd = false;
+    options.enable_port_mapping = false;
+    options.enable_trackers = false;
+    return options;
+}
+
+// Retire les trackers du lien magnet: les leechers ne doivent pas annoncer
+static std::string stripTrackers(const std::string& magnet) {
+    std::string result;
+    for (const std::string& part : Utils::split(magnet, '&')) {
+        if (Utils::startsWith(part, "tr=")) continue;
+        result += (result.empty() ? "" : "&") + part;
+    }
+    return result;
+}
+
+// Réglage automatique: intervalle court pour observer plusieurs décisions pendant le banc
+static void configureTuner(const BenchOptions& options) {
+    SessionTunerConfig config;
+    config.enabled = options.autotune;
+    config.interval_ms = 2000;
+    SessionTuner::configure(config);
+}
+
+static int runLeecher(const BenchOptions& options) {
+    std::string address = "127.0.0." + std::to_string(options.leecher_index + 2);
+    std::string dir = options.dir + "/leecher" + std::to_string(options.leecher_index);
+    
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directories(dir);
+    
+    configureTuner(options);
+    TorrentManager::setSessionOptions(makeSessionOptions(address, 0, dir));
+    if (TorrentManager::initialize() != 0) {
+        return 1;
+    }
+    
+    int64_t start = Utils::getCurrentTimestamp();
+    if (!TorrentManager::startDownload(options.magnet, dir, BENCH_NAME)) {
+        TorrentManager::cleanup();
+        return 1;
+    }
+    
+    LeecherResult result;
+    int64_t last_connect = 0;
+    int64_t first_byte = 0, mark_10 = 0, mark_90 = 0;
+    int64_t bytes_10 = 0, bytes_90 = 0, total_size = 0;
+    
+    while (Utils::getCurrentTimestamp() - start < LEECH_TIMEOUT_MS) {
+        TorrentManager::update();
+        
+        DownloadInfo info = TorrentManager::getDownloadInfo(BENCH_NAME);
+        int64_t now = Utils::getCurrentTimestamp();
+        
+        // Le torrent est ajouté de façon asynchrone: connexion au seeder
+        // renouvelée tant qu'aucune donnée n'est reçue
+        if (first_byte == 0 && info.downloaded == 0 && now - last_connect >= 1000 &&
+            TorrentManager::addPeer(BENCH_NAME, "127.0.0.1", options.port)) {
+            last_connect = now;
+        }
+        
+        if (info.downloaded > 0 && first_byte == 0) first_byte = now;
+        if (info.total_size > 0) total_size = info.total_size;
+        if (total_size > 0 && mark_10 == 0 && info.downloaded >= total_size / 10) {
+            mark_10 = now;
+            bytes_10 = info.downloaded;
+        }
+        if (total_size > 0 && mark_90 == 0 && info.downloaded >= total_size * 9 / 10) {
+            mark_90 = now;
+            bytes_90 = info.downloaded;
+        }
+        
+        if (info.is_finished) {
+            result.ok = true;
+            result.total_ms = now - start;
+            break;
+        }
+        
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    
+    double cpu_ms;
+    getResourceUsage(cpu_ms, result.peak_rss_kb);
+    TorrentManager::cleanup();
+    
+    if (!result.ok) {
+        std::cerr << "Leecher " << options.leecher_index << ": délai dépassé" << std::endl;
+        return 1;
+    }
+    
+    double total_mb = total_size / (1024.0 * 1024.0);
+    result.ttfb_ms = first_byte - start;
+    result.cpu_ms_per_mb = total_mb > 0 ? cpu_ms / total_mb : 0.0;
+    if (mark_90 > mark_10) {
+        result.steady_mbps = (bytes_90 - bytes_10) / (1024.0 * 1024.0) / ((mark_90 - mark_10) / 1000.0);
+    }
+    
+    // Ligne lue par le processus parent
+    std::printf("RESULT %lld %lld %.3f %.3f %ld\n",
+                static_cast<long long>(result.ttfb_ms), static_cast<long long>(result.total_ms),
+                result.steady_mbps, result.cpu_ms_per_mb, result.peak_rss_kb);
+    std::fflush(stdout);
+    return 0;
+}
+
+// Processus leecher en cours et sa sortie standard
+struct LeecherProcess {
+    pid_t pid;
+    int output_fd;
+    std::string output;
+    bool running;
+    int exit_code;
+};
+
+static bool spawnLeecher(const std::string& exe, const BenchOptions& options, int index,
+                         const std::string& magnet, LeecherProcess& process) {
+    int fds[2];
+    if (pipe(fds) != 0) return false;
+    
+    pid_t pid = fork();
+    if (pid < 0) {
+        close(fds[0]);
+        close(fds[1]);
+        return false;
+    }
+    
+    if (pid == 0) {
+        dup2(fds[1], STDOUT_FILENO);
+        close(fds[0]);
+        close(fds[1]);
+        
+        std::string index_arg = std::to_string(index);
+        std::string port_arg = std::to_string(options.port);
+        std::vector<const char*> args = {exe.c_str(), "--dir", options.dir.c_str(), "--port", port_arg.c_str(),
+                                         "--leecher", index_arg.c_str(), magnet.c_str()};
+        if (!options.autotune) args.push_back("--no-autotune");
+        args.push_back(nullptr);
+        execv(exe.c_str(), const_cast<char* const*>(args.data()));
+        _exit(127);
+    }
+    
+    close(fds[1]);
+    fcntl(fds[0], F_SETFL, fcntl(fds[0], F_GETFL) | O_NONBLOCK);
+    process = {pid, fds[0], "", true, -1};
+    return true;
+}
+
+static void pollLeecher(LeecherProcess& process) {
+    char buffer[512];
+    ssize_t count;
+    while ((count = read(process.output_fd, buffer, sizeof(buffer))) > 0) {
+        process.output.append(buffer, count);
+    }
+    
+    int status;
+    if (waitpid(process.pid, &status, WNOHANG) == process.pid) {
+        while ((count = read(process.output_fd, buffer, sizeof(buffer))) > 0) {
+            process.output.append(buffer, count);
+        }
+        close(process.output_fd);
+        process.running = false;
+        process.exit_code = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    }
+}
+
+static bool parseResult(const std::string& output, LeecherResult& result) {
+    size_t pos = output.find("RESULT ");
+    if (pos == std::string::npos) return false;
+    
+    long long ttfb, total;
+    if (std::sscanf(output.c_str() + pos, "RESULT %lld %lld %lf %lf %ld",
+                    &ttfb, &total, &result.steady_mbps, &result.cpu_ms_per_mb, &result.peak_rss_kb) != 5) {
+        return false;
+    }
+    
+    result.ttfb_ms = ttfb;
+    result.total_ms = total;
+    result.ok = true;
+    return true;
+}
+
+static int runSwarm(const std::string& exe, const BenchOptions& options) {
+    std::string seed_dir = options.dir + "/seed";
+    std::string pkg_path = seed_dir + "/" + BENCH_NAME + ".pkg";
+    std::filesystem::create_directories(seed_dir);
+    
+    std::cout << "Préparation du package synthétique (" << options.size_mb << " MB)..." << std::endl;
+    if (!createSyntheticPackage(pkg_path, options.size_mb)) {
+        return 1;
+    }
+    
+    // Le .torrent est régénéré: le contenu peut avoir changé de taille
+    std::filesystem::remove(seed_dir + "/" + BENCH_NAME + ".torrent");
+    
+    configureTuner(options);
+    TorrentManager::setSessionOptions(makeSessionOptions("127.0.0.1", options.port, seed_dir));
+    if (TorrentManager::initialize() != 0 || !TorrentManager::sharePackage(pkg_path, BENCH_NAME)) {
+        return 1;
+    }
+    
+    // Attente de la création du torrent et de l'activation du partage
+    std::string magnet;
+    int64_t start = Utils::getCurrentTimestamp();
+    while (Utils::getCurrentTimestamp() - start < SEED_TIMEOUT_MS) {
+        TorrentManager::update();
+        DownloadInfo info = TorrentManager::getDownloadInfo(BENCH_NAME);
+        if (info.is_seeding && !info.magnet_link.empty()) {
+            magnet = stripTrackers(info.magnet_link);
+            break;
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    }
+    
+    if (magnet.empty()) {
+        std::cerr << "Le partage n'a pas démarré" << std::endl;
+        TorrentManager::cleanup();
+        return 1;
+    }
+    
+    double seed_cpu_start;
+    long seed_rss;
+    getResourceUsage(seed_cpu_start, seed_rss);
+    
+    std::cout << "Partage prêt en " << (Utils::getCurrentTimestamp() - start) << " ms, lancement de "
+              << options.leechers << " leecher(s)" << std::endl;
+    
+    std::vector<LeecherProcess> processes(options.leechers);
+    for (int i = 0; i < options.leechers; i++) {
+        if (!spawnLeecher(exe, options, i, magnet, processes[i])) {
+            std::cerr << "Impossible de lancer le leecher " << i << std::endl;
+            processes[i].running = false;
+        }
+    }
+    
+    int64_t swarm_start = Utils::getCurrentTimestamp();
+    int64_t uploaded_start, uploaded_end, unused;
+    int rate_unused;
+    TorrentManager::getGlobalStats(unused, uploaded_start, rate_unused, rate_unused);
+    
+    // Le seeder continue de servir tant qu'un leecher tourne
+    bool running = true;
+    while (running) {
+        TorrentManager::update();
+        
+        running = false;
+        for (auto& process : processes) {
+            if (process.running) {
+                pollLeecher(process);
+                running = running || process.running;
+            }
+        }
+        
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+    
+    int64_t swarm_ms = Utils::getCurrentTimestamp() - swarm_start;
+    TorrentManager::getGlobalStats(unused, uploaded_end, rate_unused, rate_unused);
+    
+    double seed_cpu_end;
+    getResourceUsage(seed_cpu_end, seed_rss);
+    std::vector<TuningDecision> decisions = SessionTuner::getDecisions();
+    TorrentManager::cleanup();
+    
+    // Rapport
+    std::vector<LeecherResult> results;
+    std::printf("\n%-8s %10s %10s %10s %12s %12s\n", "leecher", "ttfb_ms", "total_ms", "MB/s", "cpu_ms/MB", "rss_kb");
+    for (size_t i = 0; i < processes.size(); i++) {
+        LeecherResult result;
+        if (processes[i].exit_code == 0 && parseResult(processes[i].output, result)) {
+            results.push_back(result);
+            std::printf("%-8zu %10lld %10lld %10.2f %12.2f %12ld\n", i,
+                        static_cast<long long>(result.ttfb_ms), static_cast<long long>(result.total_ms),
+                        result.steady_mbps, result.cpu_ms_per_mb, result.peak_rss_kb);
+        } else {
+            std::printf("%-8zu %10s\n", i, "échec");
+        }
+    }
+    
+    if (results.empty()) {
+        return 1;
+    }
+    
+    std::vector<int64_t> ttfb;
+    double total_mbps = 0.0, cpu_per_mb = 0.0;
+    long peak_rss = 0;
+    for (const auto& result : results) {
+        ttfb.push_back(result.ttfb_ms);
+        total_mbps += result.steady_mbps;
+        cpu_per_mb += result.cpu_ms_per_mb;
+        peak_rss = std::max(peak_rss, result.peak_rss_kb);
+    }
+    std::sort(ttfb.begin(), ttfb.end());
+    
+    double uploaded_mb = (uploaded_end - uploaded_start) / (1024.0 * 1024.0);
+    
+    std::printf("\nLeechers terminés: %zu/%d en %lld ms\n", results.size(), options.leechers,
+                static_cast<long long>(swarm_ms));
+    std::printf("TTFB médian: %lld ms (max %lld ms)\n",
+                static_cast<long long>(ttfb[ttfb.size() / 2]), static_cast<long long>(ttfb.back()));
+    std::printf("Débit établi cumulé: %.2f MB/s\n", total_mbps);
+    std::printf("CPU leecher moyen: %.2f ms/MB, pic RSS leecher: %ld KB\n",
+                cpu_per_mb / results.size(), peak_rss);
+    std::printf("Seeder: %.2f MB envoyés, %.2f ms CPU/MB, pic RSS %ld KB\n", uploaded_mb,
+                uploaded_mb > 0 ? (seed_cpu_end - seed_cpu_start) / uploaded_mb : 0.0, seed_rss);
+    
+    // Décisions du réglage automatique du seeder, avec leurs mesures
+    std::printf("\nRéglage automatique du seeder: %s, %zu décisions\n",
+                options.autotune ? "activé" : "désactivé", decisions.size());
+    for (const auto& decision : decisions) {
+        std::printf("  +%6lld ms  %3d/%2d/%4d -> %3d/%2d/%4d  %s\n",
+                    static_cast<long long>(decision.timestamp - swarm_start),
+                    decision.before.connections_limit, decision.before.unchoke_slots, decision.before.request_queue,
+                    decision.after.connections_limit, decision.after.unchoke_slots, decision.after.request_queue,
+                    decision.reason.c_str());
+    }
+    
+    return results.size() == processes.size() ? 0 : 1;
+}
+
+int main(int argc, char* argv[]) {
+    BenchOptions options;
+    if (!parseOptions(argc, argv, options)) {
+        return 2;
+    }
+    
+    Utils::setLogLevel(Utils::LogLevel::WARNING);
+    
+    if (options.leecher_index >= 0) {
+        return runLeecher(options);
+    }
+    
+    signal(SIGPIPE, SIG_IGN);
+    
+    char exe[4096];
+    ssize_t length = readlink("/proc/self/exe", exe, sizeof(exe) - 1);
+    std::string exe_path = length > 0 ? std::string(exe, length) : std::string(argv[0]);
+    
+    return runSwarm(exe_path, options);
+}
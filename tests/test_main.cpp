@@ -6,15 +6,42 @@
  */
 
 #include <iostream>
+#include <fstream>
 #include <cassert>
 #include <string>
 #include <vector>
 #include <chrono>
 #include <thread>
+#include <atomic>
+#include <cstdio>
+#include <ctime>
+
+#include <sys/socket.h>
+#include <netinet/in.h>
+#include <arpa/inet.h>
+#include <poll.h>
+#include <unistd.h>
 
 // Headers du projet à tester
 #include "../include/utils/utils.h"
+#include "../include/utils/async_logger.h"
+#include "../include/utils/trace.h"
+#include "../include/utils/config.h"
+#include "../include/utils/metrics.h"
+#include "../include/utils/thread_pool.h"
+#include "../include/utils/event_queue.h"
+#include "../include/utils/progress_publisher.h"
+#include "../include/utils/startup.h"
 #include "../include/p2p/torrent_manager.h"
+#include "../include/p2p/seed_scheduler.h"
+#include "../include/p2p/download_scheduler.h"
+#include "../include/p2p/session_stats.h"
+#include "../include/p2p/scrape_service.h"
+#include "../include/p2p/ip_blocklist.h"
+#include "../include/p2p/session_tuner.h"
+#include "../include/p2p/fast_start.h"
+#include "../include/p2p/piece_cache.h"
+#include "../include/p2p/write_coalescer.h"
 #include "../include/pkg/pkg_manager.h"
 #include "../include/ui/main_window.h"
 
@@ -148,6 +175,396 @@ bool test_utils_files() {
     bool invalid_port_high = Utils::IsValidPort(70000);
     TEST_ASSERT(invalid_port_high == false, "Invalid port number (too high)");
     
+    // Test d'énumération des interfaces (loopback toujours présente)
+    bool has_loopback = false;
+    for (const auto& iface : Utils::getNetworkInterfaces()) {
+        if (iface.is_loopback && !iface.is_ipv6) {
+            has_loopback = iface.first_address == "127.0.0.0" && iface.last_address == "127.255.255.255";
+        }
+    }
+    TEST_ASSERT(has_loopback, "Loopback subnet range");
+    
+    return true;
+}
+
+/**
+ * Test du journal asynchrone (écriture par lots et rotation du fichier)
+ */
+bool test_async_logger() {
+    const std::string log_file = "/tmp/ps4_store_test.log";
+    std::remove(log_file.c_str());
+    std::remove((log_file + ".1").c_str());
+    
+    AsyncLogger::start();
+    AsyncLogger::setFile(log_file);
+    AsyncLogger::setMaxFileSize(4096);
+    for (int i = 0; i < 200; i++) {
+        AsyncLogger::push(Utils::LogLevel::INFO, Utils::getCurrentTimestamp(), __FILE__, __LINE__,
+                          "Ligne " + std::to_string(i));
+    }
+    AsyncLogger::flush();
+    AsyncLogger::stop();
+    AsyncLogger::setFile("");
+    AsyncLogger::setMaxFileSize(0);
+    
+    TEST_ASSERT(Utils::getFileSize(log_file) <= 4096, "Log file rotated at max size");
+    TEST_ASSERT(Utils::fileExists(log_file + ".1"), "Previous log kept as .1");
+    
+    std::string line = AsyncLogger::formatRecord(Utils::LogLevel::WARNING, 0, "src/p2p/x.cpp", 12, "Message");
+    TEST_ASSERT(line.find("[WARN] [x.cpp:12] Message") != std::string::npos, "Record format");
+    
+    // Arrêt pendant des dépôts: chaque message accepté est écrit
+    std::remove(log_file.c_str());
+    std::remove((log_file + ".1").c_str());
+    AsyncLogger::start();
+    AsyncLogger::setFile(log_file);
+    std::atomic<int> accepted(0);
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 4; t++) {
+        producers.emplace_back([&accepted, t]() {
+            for (int i = 0; i < 50; i++) {
+                if (AsyncLogger::push(Utils::LogLevel::INFO, Utils::getCurrentTimestamp(), nullptr, 0,
+                                      "Arret " + std::to_string(t) + "-" + std::to_string(i))) {
+                    accepted++;
+                }
+            }
+        });
+    }
+    AsyncLogger::stop();
+    for (auto& producer : producers) {
+        producer.join();
+    }
+    AsyncLogger::setFile("");
+    
+    int written = 0;
+    std::ifstream in(log_file);
+    std::string text;
+    while (std::getline(in, text)) {
+        if (text.find("] Arret ") != std::string::npos) written++;
+    }
+    TEST_ASSERT(written == accepted.load(), "No record lost across stop");
+    
+    std::remove(log_file.c_str());
+    std::remove((log_file + ".1").c_str());
+    return true;
+}
+
+/**
+ * Test des macros de log filtrées et de la mise en forme différée
+ */
+bool test_log_format() {
+    std::string out;
+    LogFormat::format(out, "{} pièces sur {} ({}), {{ok}}", 3, static_cast<int64_t>(-4), std::string("pkg"));
+    TEST_ASSERT(out == "3 pièces sur -4 (pkg), {ok}", "Placeholders filled in order");
+    
+    out.clear();
+    LogFormat::format(out, "{} et {}", true);
+    TEST_ASSERT(out == "true et {}", "Missing argument keeps placeholder");
+    
+    // Message filtré: les arguments ne sont pas évalués
+    Utils::setLogLevel(Utils::LogLevel::INFO);
+    int evaluated = 0;
+    auto message = [&evaluated]() { evaluated++; return std::string("message"); };
+    LOG_DEBUG(message());
+    LOG_DEBUGF("{}", message());
+    TEST_ASSERT(evaluated == 0, "Filtered log does not evaluate its message");
+    
+    return true;
+}
+
+/**
+ * Test du traçage: durées de plusieurs threads écrites au format Chrome
+ */
+bool test_trace() {
+    const std::string trace_file = "/tmp/ps4_store_test_trace.json";
+    Trace::start(8192);
+    Trace::setThreadName("test");
+    {
+        TraceSpan span("test", "span principal");
+        Trace::counter("test_counter", 42);
+    }
+    std::thread worker([]() {
+        TraceSpan span("test", "span \"thread\"");
+    });
+    worker.join();
+    Trace::stop();
+    
+    TEST_ASSERT(Trace::getEventCount() >= 3, "Events recorded from both threads");
+    TEST_ASSERT(Trace::dump(trace_file), "Trace dumped");
+    
+    std::ifstream file(trace_file);
+    std::string json((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    TEST_ASSERT(json.find("\"traceEvents\"") != std::string::npos, "Chrome trace root");
+    TEST_ASSERT(json.find("\"name\":\"span principal\",\"cat\":\"test\",\"ph\":\"X\"") != std::string::npos,
+                "Complete event");
+    TEST_ASSERT(json.find("span \\\"thread\\\"") != std::string::npos, "Names escaped");
+    TEST_ASSERT(json.find("\"args\":{\"value\":42}") != std::string::npos, "Counter value");
+    TEST_ASSERT(json.find("\"args\":{\"name\":\"test\"}") != std::string::npos, "Thread name");
+    
+    std::remove(trace_file.c_str());
+    return true;
+}
+
+/**
+ * Test de la configuration typée: conversion, bornes, clés inconnues et différences
+ */
+bool test_config() {
+    std::vector<std::string> warnings;
+    AppConfig config = Config::parse(
+        "[Network]\n"
+        "download_limit = 2048\n"
+        "max_connections = -5\n"
+        "listen_devices = eth0, wlan0\n"
+        "[Logging]\n"
+        "log_level = DEBUG\n"
+        "download_limit = 10\n"
+        "[Advanced]\n"
+        "max_concurrent_downloads = 2\n"
+        "max_concurrent_downloads = 4\n", &warnings);
+    
+    TEST_ASSERT(config.network.download_limit == 2048, "Value read from its own section");
+    TEST_ASSERT(config.network.max_connections == NetworkSection().max_connections, "Out of range value keeps default");
+    TEST_ASSERT(config.network.listen_devices.size() == 2 && config.network.listen_devices[1] == "wlan0",
+                "List values split and trimmed");
+    TEST_ASSERT(config.logging.log_level == Utils::LogLevel::DEBUG, "Log level converted");
+    TEST_ASSERT(config.advanced.max_concurrent_downloads == 4, "Last duplicate wins");
+    TEST_ASSERT(warnings.size() == 3, "Invalid, unknown and duplicate keys reported");
+    
+    AppConfig changed = config;
+    changed.network.upload_limit = 128;
+    changed.logging.log_file = "autre.log";
+    ConfigChanges changes = Config::diff(config, changed);
+    TEST_ASSERT(changes.keys().size() == 2, "Only modified keys listed");
+    TEST_ASSERT(changes.has("Network", "upload_limit"), "Modified key found");
+    TEST_ASSERT(changes.has("Logging") && !changes.has("Paths"), "Section lookup");
+    TEST_ASSERT(!changes.has("Network", "download_limit"), "Unmodified key absent");
+    
+    // Rechargement: limites appliquées à chaud, valeur invalide remplacée par la valeur en cours
+    const std::string config_file = "/tmp/ps4_store_test_config.ini";
+    std::ofstream(config_file) << "[Network]\ndownload_limit = 2048\nmax_connections = 80\n";
+    Config::setWatchInterval(0);
+    Config::load(config_file);
+    ConfigChanges reloaded;
+    int listener = Config::subscribe([&reloaded](const AppConfig&, const ConfigChanges& keys) { reloaded = keys; });
+    std::ofstream(config_file) << "[Network]\ndownload_limit = 512\nmax_connections = beaucoup\n";
+    TEST_ASSERT(Config::reload(), "Reload reports changes");
+    Config::unsubscribe(listener);
+    TEST_ASSERT(reloaded.has("Network", "download_limit") && !reloaded.has("Network", "max_connections"),
+                "Only valid changes notified");
+    TEST_ASSERT(Config::get().network.download_limit == 512, "Live limit reloaded");
+    TEST_ASSERT(Config::get().network.max_connections == 80, "Invalid value keeps running value");
+    
+    Config::load("");
+    Config::setWatchInterval(2000);
+    std::remove(config_file.c_str());
+    return true;
+}
+
+/**
+ * Test des métriques: tranches additionnées, quantiles et export
+ */
+bool test_metrics() {
+    MetricCounter& counter = Metrics::counter("test_events_total");
+    MetricHistogram& histogram = Metrics::histogram("test_latency_us", "Latence de test");
+    
+    std::vector<std::thread> workers;
+    for (int t = 0; t < 4; t++) {
+        workers.emplace_back([&counter, &histogram]() {
+            for (int i = 1; i <= 1000; i++) {
+                counter.add();
+                histogram.record(i * 100);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    
+    TEST_ASSERT(counter.value() == 4000, "Counter shards merged");
+    TEST_ASSERT(&Metrics::counter("test_events_total") == &counter, "Registry returns the same metric");
+    
+    HistogramSnapshot snapshot = histogram.snapshot();
+    TEST_ASSERT(snapshot.count == 4000 && snapshot.min == 100 && snapshot.max == 100000, "Histogram shards merged");
+    int64_t median = snapshot.percentile(0.5);
+    TEST_ASSERT(median >= 50000 && median <= 50000 * 103 / 100, "Median within 3%");
+    TEST_ASSERT(snapshot.percentile(1.0) == 100000, "Top quantile is the maximum");
+    for (int64_t value : {0LL, 63LL, 64LL, 1000LL, 123456789LL}) {
+        int64_t upper = MetricHistogram::bucketUpperBound(MetricHistogram::bucketIndex(value));
+        TEST_ASSERT(upper >= value && upper <= value + value / 32, "Bucket bounds");
+    }
+    
+    std::string text = Metrics::format(1000);
+    TEST_ASSERT(text.find("# TYPE ps4store_test_events_total counter") != std::string::npos, "Counter type exported");
+    TEST_ASSERT(text.find("ps4store_test_events_total 4000 1000\n") != std::string::npos, "Counter line");
+    TEST_ASSERT(text.find("ps4store_test_latency_us_count 4000 1000\n") != std::string::npos, "Histogram count line");
+    TEST_ASSERT(text.find("ps4store_test_latency_us{quantile=\"0.99\"}") != std::string::npos, "Quantile line");
+    
+    return true;
+}
+
+/**
+ * Test de la réserve de threads: résultat, suite, exception, annulation et attente imbriquée
+ */
+bool test_thread_pool() {
+    auto value = ThreadPool::submit([]() { return 21; });
+    auto doubled = value.then([](TaskFuture<int> result) { return result.get() * 2; }, TaskPriority::INTERACTIVE);
+    TEST_ASSERT(doubled.get() == 42, "Continuation receives the result");
+    
+    auto failing = ThreadPool::submit([]() -> int { throw std::runtime_error("échec"); });
+    bool caught = false;
+    try {
+        failing.get();
+    } catch (const std::runtime_error&) {
+        caught = true;
+    }
+    TEST_ASSERT(caught, "Task exception rethrown by get");
+    
+    CancellationToken token;
+    token.cancel();
+    auto cancelled = ThreadPool::submit([]() { return 1; }, TaskPriority::BULK, token);
+    cancelled.wait();
+    TEST_ASSERT(cancelled.isCancelled(), "Cancelled task is skipped");
+    
+    // Attente depuis un thread de la réserve: les sous-tâches s'exécutent au lieu de bloquer
+    auto outer = ThreadPool::submit([]() {
+        std::vector<TaskFuture<int>> parts;
+        for (int i = 1; i <= 16; i++) {
+            parts.push_back(ThreadPool::submit([i]() { return i; }));
+        }
+        int sum = 0;
+        for (auto& part : parts) sum += part.get();
+        return sum;
+    });
+    TEST_ASSERT(outer.get() == 136, "Nested waits complete");
+    TEST_ASSERT(ThreadPool::getStats().completed >= 20, "Completed tasks counted");
+    
+    return true;
+}
+
+/**
+ * Test de la file d'événements: dépôts concurrents, fusion des progressions, ordre des fins
+ */
+bool test_event_queue() {
+    std::vector<std::string> order;
+    int progress_calls = 0;
+    float last_progress = 0.0f;
+    int progress_id = EventQueue::subscribe(EventType::DOWNLOAD_PROGRESS, [&](const UiEvent& event) {
+        if (event.job != "test_job") return;
+        progress_calls++;
+        last_progress = event.progress;
+        order.push_back("progress");
+    });
+    int complete_id = EventQueue::subscribe(EventType::DOWNLOAD_COMPLETE, [&](const UiEvent& event) {
+        if (event.job == "test_job") order.push_back("complete");
+    });
+    
+    std::vector<std::thread> producers;
+    for (int t = 0; t < 4; t++) {
+        producers.emplace_back([]() {
+            for (int i = 0; i < 1000; i++) {
+                UiEvent event;
+                event.type = EventType::DOWNLOAD_PROGRESS;
+                event.job = "test_job";
+                event.progress = 0.5f;
+                EventQueue::post(std::move(event));
+            }
+        });
+    }
+    for (auto& producer : producers) producer.join();
+    
+    UiEvent last;
+    last.type = EventType::DOWNLOAD_PROGRESS;
+    last.job = "test_job";
+    last.progress = 1.0f;
+    EventQueue::post(last);
+    UiEvent complete;
+    complete.type = EventType::DOWNLOAD_COMPLETE;
+    complete.job = "test_job";
+    EventQueue::post(complete);
+    bool called = false;
+    EventQueue::postCall([&called]() { called = true; });
+    
+    EventQueue::dispatch();
+    TEST_ASSERT(progress_calls == 1, "Progress events coalesced per job");
+    TEST_ASSERT(last_progress == 1.0f, "Latest progress delivered");
+    TEST_ASSERT(order.size() == 2 && order[0] == "progress" && order[1] == "complete", "Delivery order kept");
+    TEST_ASSERT(called, "Posted call runs on dispatch");
+    TEST_ASSERT(EventQueue::dispatch() == 0, "Queue drained");
+    
+    // Abonnés retirés: les variables locales capturées ne sont plus appelées
+    EventQueue::unsubscribe(progress_id);
+    EventQueue::unsubscribe(complete_id);
+    EventQueue::post(last);
+    EventQueue::dispatch();
+    TEST_ASSERT(progress_calls == 1, "Unsubscribed handler not called");
+    
+    return true;
+}
+
+/**
+ * Test de la publication de progression: limitée dans le temps, état final toujours publié
+ */
+bool test_progress_publisher() {
+    const int64_t chunk = 64 * 1024;
+    const int64_t total = 1024 * chunk;
+    int published = 0;
+    ProgressSample last = {};
+    ProgressPublisher publisher(total, [&](const ProgressSample& sample) {
+        published++;
+        last = sample;
+    }, 50);
+    
+    for (int i = 0; i < 1024; i++) {
+        publisher.add(chunk);
+    }
+    TEST_ASSERT(published <= 1, "Publications throttled by interval");
+    
+    std::this_thread::sleep_for(std::chrono::milliseconds(60));
+    publisher.finish();
+    TEST_ASSERT(last.done == total, "Final progress published");
+    TEST_ASSERT(last.fraction == 1.0f, "Final fraction");
+    TEST_ASSERT(last.bytes_per_second > 0, "Throughput computed");
+    TEST_ASSERT(last.eta_seconds == 0, "Nothing left at the end");
+    
+    return true;
+}
+
+/**
+ * Test du démarrage par étapes: dépendances, thread principal, étapes sautées
+ */
+bool test_startup() {
+    std::atomic<int> sequence(0);
+    int session = -1, queue = -1, ui = -1;
+    
+    Startup::begin();
+    Startup::add("test_session", {}, [&]() {
+        std::this_thread::sleep_for(std::chrono::milliseconds(20));
+        session = sequence++;
+        return true;
+    });
+    Startup::add("test_queue", {"test_session"}, [&]() {
+        queue = sequence++;
+        return true;
+    });
+    Startup::add("test_ui", {}, [&]() {
+        ui = sequence++;
+        return ThreadPool::isWorkerThread() == false;
+    }, StageThread::MAIN);
+    Startup::add("test_optional", {}, []() { return false; }, StageThread::POOL, false);
+    Startup::add("test_after_optional", {"test_optional"}, []() { return true; }, StageThread::POOL, false);
+    Startup::markFirstFrame();
+    
+    for (int frame = 0; frame < 500 && !Startup::pump(); frame++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    TEST_ASSERT(Startup::isComplete(), "All stages finished");
+    TEST_ASSERT(ui == 0, "Main-thread stage runs without waiting for pool stages");
+    TEST_ASSERT(session >= 0 && queue > session, "Dependency order kept");
+    TEST_ASSERT(Startup::isReady("test_ui") && Startup::isReady("test_queue"), "Stages ready");
+    TEST_ASSERT(!Startup::isReady("test_after_optional"), "Dependent of failed stage skipped");
+    TEST_ASSERT(!Startup::hasFailed(), "Optional failures do not stop startup");
+    TEST_ASSERT(Startup::report().find("test_session") != std::string::npos, "Timeline report");
+    
     return true;
 }
 
@@ -211,6 +628,580 @@ bool test_torrent_download_simulation() {
     return true;
 }
 
+/**
+ * Test du budget d'admission: plus de métadonnées que le budget, file vidée
+ */
+bool test_admission_budget() {
+    AdmissionBudget budget;
+    budget.max_in_flight = 8;
+    budget.memory_budget = 64LL * 1024 * 1024;
+    
+    // 40 torrents de 10 Mo: 400 Mo admis au total pour un budget de 64 Mo
+    std::vector<int64_t> queue(40, 10LL * 1024 * 1024);
+    int64_t in_flight_memory = 0;
+    int64_t admitted_total = 0;
+    int rounds = 0;
+    while (!queue.empty() && rounds < 100) {
+        size_t issued = TorrentManager::countAdmissible(queue, 0, in_flight_memory, budget);
+        if (issued == 0) break;
+        for (size_t i = 0; i < issued; i++) {
+            in_flight_memory += queue[i];
+        }
+        TEST_ASSERT(in_flight_memory <= budget.memory_budget, "In-flight memory within budget");
+        
+        // Réponse de la session: les estimations sont rendues
+        admitted_total += in_flight_memory;
+        in_flight_memory = 0;
+        queue.erase(queue.begin(), queue.begin() + issued);
+        rounds++;
+    }
+    TEST_ASSERT(queue.empty(), "Admission queue drained");
+    TEST_ASSERT(admitted_total > budget.memory_budget, "Admitted more than the budget over time");
+    
+    // Limite des ajouts simultanés, et admission plus grosse que le budget seule
+    TEST_ASSERT(TorrentManager::countAdmissible({1, 1, 1}, 7, 0, budget) == 1, "In-flight limit");
+    TEST_ASSERT(TorrentManager::countAdmissible({128LL * 1024 * 1024, 1}, 0, 0, budget) == 1,
+                "Oversized admission goes alone");
+    TEST_ASSERT(TorrentManager::countAdmissible({1}, 1, budget.memory_budget, budget) == 0, "Held by memory budget");
+    
+    return true;
+}
+
+/**
+ * Test de la rotation des partages: rééquilibrage et mise en pause
+ */
+bool test_seed_rotation() {
+    SeedSchedulerConfig config;
+    config.max_active_seeds = 2;
+    config.min_active_s = 600;
+    config.idle_timeout_s = 900;
+    const int64_t now = 10000000;
+    
+    auto seed = [](float score, bool active, int64_t activated_at) {
+        SeedDemand demand = {};
+        demand.seeders = 1;
+        demand.leechers = 1;
+        demand.score = score;
+        demand.active = active;
+        demand.activated_at = activated_at;
+        return demand;
+    };
+    
+    // Les deux plus demandés sont servis, sans demande jamais
+    std::vector<bool> wanted = SeedScheduler::planRotation(
+        {seed(0.5f, false, 0), seed(3.0f, false, 0), seed(0.0f, false, 0), seed(2.0f, true, 0)}, config, now);
+    TEST_ASSERT(!wanted[0] && wanted[1] && !wanted[2] && wanted[3], "Most demanded seeds are active");
+    
+    // Un partage activé récemment garde sa place et occupe un slot
+    wanted = SeedScheduler::planRotation(
+        {seed(0.1f, true, now - 1000), seed(3.0f, false, 0), seed(2.0f, false, 0)}, config, now);
+    TEST_ASSERT(wanted[0] && wanted[1] && !wanted[2], "Recently activated seed keeps its slot");
+    
+    // À égalité, le partage en pause depuis le plus longtemps passe d'abord
+    config.max_active_seeds = 1;
+    wanted = SeedScheduler::planRotation({seed(1.0f, false, 5000), seed(1.0f, false, 1000)}, config, now);
+    TEST_ASSERT(!wanted[0] && wanted[1], "Ties go to the longest parked seed");
+    
+    // Pause: actif, aucun leecher, aucun upload depuis le délai
+    SeedDemand idle = seed(0.0f, true, now - 1000000);
+    idle.leechers = 0;
+    idle.last_upload = now - 1000000;
+    TEST_ASSERT(SeedScheduler::isIdle(idle, config, now), "Idle seed is parked");
+    idle.last_upload = now - 1000;
+    TEST_ASSERT(!SeedScheduler::isIdle(idle, config, now), "Recent upload keeps seed active");
+    idle.last_upload = now - 1000000;
+    idle.leechers = 2;
+    TEST_ASSERT(!SeedScheduler::isIdle(idle, config, now), "Known leechers keep seed active");
+    idle.leechers = 0;
+    idle.active = false;
+    TEST_ASSERT(!SeedScheduler::isIdle(idle, config, now), "Paused seed is not parked again");
+    
+    return true;
+}
+
+/**
+ * Test des débits, percentiles et ratios calculés sur l'historique de session
+ */
+bool test_session_stats() {
+    SessionStats::clear();
+    TEST_ASSERT(SessionStats::getRate(SessionMetric::RECV_BYTES) == 0.0, "No rate without samples");
+    TEST_ASSERT(SessionStats::getWriteCacheHitRatio() < 0.0, "No ratio without samples");
+    
+    // Une seconde entre échantillons: 1 Mo/s reçu, 90 blocs hachés dont 9 relus sur disque
+    for (int i = 0; i < 11; i++) {
+        SessionSample sample = {};
+        sample.timestamp = 1000 * i;
+        sample.values[static_cast<int>(SessionMetric::RECV_BYTES)] = 1024LL * 1024 * i;
+        sample.values[static_cast<int>(SessionMetric::RECV_PAYLOAD_BYTES)] = 1024LL * 1024 * i;
+        sample.values[static_cast<int>(SessionMetric::DISK_QUEUE_DEPTH)] = i;
+        sample.values[static_cast<int>(SessionMetric::DISK_BLOCKS_HASHED)] = 9 * i;
+        sample.values[static_cast<int>(SessionMetric::DISK_READ_BACK)] = (9 * i) / 10;
+        SessionStats::record(sample);
+    }
+    
+    TEST_ASSERT(SessionStats::getSampleCount() == 11, "Samples recorded");
+    TEST_ASSERT(SessionStats::getLatest(SessionMetric::DISK_QUEUE_DEPTH) == 10, "Latest value");
+    TEST_ASSERT(SessionStats::getRate(SessionMetric::RECV_BYTES) == 1024.0 * 1024, "Rate over two samples");
+    TEST_ASSERT(SessionStats::getRate(SessionMetric::RECV_BYTES, 11) == 1024.0 * 1024, "Rate over the window");
+    TEST_ASSERT(SessionStats::getPercentile(SessionMetric::DISK_QUEUE_DEPTH, 0.5f, 11) == 5, "Median");
+    TEST_ASSERT(SessionStats::getPercentile(SessionMetric::DISK_QUEUE_DEPTH, 1.0f, 11) == 10, "Maximum");
+    
+    double ratio = SessionStats::getWriteCacheHitRatio(11);
+    TEST_ASSERT(ratio > 0.89 && ratio < 0.91, "Write cache hit ratio");
+    TEST_ASSERT(SessionStats::classifyBottleneck() == Bottleneck::NETWORK, "Network-bound transfer");
+    
+    SessionStats::clear();
+    return true;
+}
+
+/**
+ * Test de l'analyse des plages horaires de bande passante
+ */
+bool test_download_scheduler_windows() {
+    std::vector<BandwidthWindow> windows =
+        DownloadScheduler::parseWindows("01:00-07:00=0/0, 18:00-23:30=2048/256");
+    TEST_ASSERT(windows.size() == 2, "Parse two bandwidth windows");
+    TEST_ASSERT(windows[0].start_minute == 60 && windows[0].end_minute == 420, "Window minutes");
+    TEST_ASSERT(windows[1].download_limit == 2048 * 1024, "Window download limit in bytes");
+    TEST_ASSERT(windows[1].upload_limit == 256 * 1024, "Window upload limit in bytes");
+    
+    std::vector<BandwidthWindow> invalid = DownloadScheduler::parseWindows("25:00-07:00=0/0,garbage,24:59-07:00=0/0");
+    TEST_ASSERT(invalid.empty(), "Invalid windows are ignored");
+    TEST_ASSERT(DownloadScheduler::parseWindows("22:00-24:00=0/0").size() == 1, "Window may end at 24:00");
+    TEST_ASSERT(DownloadScheduler::parseWindows("22:00-24:30=0/0").empty(), "Window past 24:00 is rejected");
+    
+    // Limites de base hors plage, et sans aucune plage
+    DownloadSchedulerConfig config;
+    config.default_download_limit = 0;
+    config.default_upload_limit = 512 * 1024;
+    BandwidthWindow limits = DownloadScheduler::limitsAt(config, 600);
+    TEST_ASSERT(limits.start_minute == -1 && limits.upload_limit == 512 * 1024, "Base limits without windows");
+    config.windows = windows;
+    TEST_ASSERT(DownloadScheduler::limitsAt(config, 120).download_limit == 0 &&
+                DownloadScheduler::limitsAt(config, 120).start_minute == 60, "Window limits inside a window");
+    TEST_ASSERT(DownloadScheduler::limitsAt(config, 600).upload_limit == 512 * 1024, "Base limits outside windows");
+    
+    // Sans plage horaire, update applique les limites de base
+    config.windows.clear();
+    DownloadScheduler::configure(config);
+    DownloadScheduler::update();
+    TEST_ASSERT(DownloadScheduler::getAppliedLimits().upload_limit == 512 * 1024, "Base limits applied by update");
+    
+    // Rechargement de Network.upload_limit: nouvelles limites de base appliquées au prochain update
+    config.default_upload_limit = 128 * 1024;
+    DownloadScheduler::configure(config);
+    DownloadScheduler::update();
+    TEST_ASSERT(DownloadScheduler::getAppliedLimits().upload_limit == 128 * 1024, "Reloaded base limits applied");
+    DownloadScheduler::clear();
+    
+    // File sans torrent: priorités et positions sur des noms inconnus
+    TEST_ASSERT(!DownloadScheduler::setPriority("unknown", DownloadPriority::HIGH), "Priority on unknown download");
+    TEST_ASSERT(!DownloadScheduler::moveTo("unknown", 0), "Move unknown download");
+    TEST_ASSERT(DownloadScheduler::getQueue().empty(), "Empty queue");
+    
+    return true;
+}
+
+/**
+ * Test du service de scrape contre un tracker UDP local
+ */
+bool test_scrape_service_local_tracker() {
+    // Décodage des liens magnet (hexadécimal, base32, invalide)
+    std::string hash;
+    std::vector<std::string> trackers;
+    TEST_ASSERT(ScrapeService::parseMagnet(
+        "magnet:?xt=urn:btih:0123456789abcdef0123456789abcdef01234567&tr=udp%3A%2F%2Fexample.org%3A80", hash, trackers),
+        "Parse hex magnet");
+    TEST_ASSERT(hash.size() == 20 && static_cast<uint8_t>(hash[1]) == 0x23, "Hex info-hash");
+    TEST_ASSERT(trackers.size() == 1 && trackers[0] == "udp://example.org:80", "Decoded UDP tracker");
+    TEST_ASSERT(ScrapeService::parseMagnet("magnet:?xt=urn:btih:AERUKZ4JVPG66AJDIVTYTK6N54ASGRLH", hash, trackers),
+                "Parse base32 magnet");
+    TEST_ASSERT(static_cast<uint8_t>(hash[0]) == 0x01 && static_cast<uint8_t>(hash[1]) == 0x23, "Base32 info-hash");
+    TEST_ASSERT(!ScrapeService::parseMagnet("magnet:?xt=urn:btih:1234", hash, trackers), "Reject short info-hash");
+    
+    // Tracker local: seeders = octet 0 de l'info-hash, leechers = octet 1
+    int sock = socket(AF_INET, SOCK_DGRAM, 0);
+    sockaddr_in address = {};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t address_length = sizeof(address);
+    TEST_ASSERT(bind(sock, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0, "Bind local tracker");
+    getsockname(sock, reinterpret_cast<sockaddr*>(&address), &address_length);
+    
+    std::atomic<bool> tracker_running(true);
+    std::atomic<int> scrape_packets(0);
+    std::thread tracker([&]() {
+        uint8_t buffer[2048];
+        while (tracker_running) {
+            pollfd fd = {sock, POLLIN, 0};
+            if (poll(&fd, 1, 100) <= 0) continue;
+            
+            sockaddr_in peer = {};
+            socklen_t peer_length = sizeof(peer);
+            ssize_t length = recvfrom(sock, buffer, sizeof(buffer), 0, reinterpret_cast<sockaddr*>(&peer), &peer_length);
+            if (length < 16) continue;
+            
+            // Réponse: action et transaction recopiées, puis identifiant de connexion ou compteurs
+            std::vector<uint8_t> reply(buffer + 8, buffer + 16);
+            if (buffer[11] == 0) {
+                reply.insert(reply.end(), {0, 0, 0, 0, 0, 0, 0x12, 0x34});
+            } else if (buffer[11] == 2) {
+                scrape_packets++;
+                for (ssize_t offset = 16; offset + 20 <= length; offset += 20) {
+                    reply.insert(reply.end(), {0, 0, 0, buffer[offset], 0, 0, 0, 0, 0, 0, 0, buffer[offset + 1]});
+                }
+            }
+            sendto(sock, reply.data(), reply.size(), 0, reinterpret_cast<sockaddr*>(&peer), peer_length);
+        }
+    });
+    
+    // 100 essaims sur le même tracker: deux requêtes de scrape (74 + 26)
+    std::string tracker_url = "udp://127.0.0.1:" + std::to_string(ntohs(address.sin_port));
+    std::vector<std::string> magnets;
+    for (int i = 0; i < 100; i++) {
+        char hex[41];
+        snprintf(hex, sizeof(hex), "%02x%02x%036d", i, i + 1, i);
+        magnets.push_back("magnet:?xt=urn:btih:" + std::string(hex) + "&tr=" + tracker_url);
+    }
+    
+    ScrapeService::initialize();
+    ScrapeService::requestRefresh(magnets);
+    
+    SwarmCounts last = {}, first = {};
+    for (int i = 0; i < 50 && !ScrapeService::getCounts(magnets.back(), last); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    }
+    bool first_counted = ScrapeService::getCounts(magnets.front(), first);
+    int packets_after_scrape = scrape_packets;
+    
+    // Résultats encore valides: aucun nouveau scrape
+    ScrapeService::requestRefresh(magnets);
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    int packets_after_refresh = scrape_packets;
+    
+    ScrapeService::cleanup();
+    tracker_running = false;
+    tracker.join();
+    close(sock);
+    
+    TEST_ASSERT(last.seeders == 99 && last.leechers == 100, "Counts from local tracker");
+    TEST_ASSERT(first_counted && first.leechers == 1, "First swarm counted");
+    TEST_ASSERT(packets_after_scrape == 2, "100 info-hashes batched into 2 scrape packets");
+    TEST_ASSERT(packets_after_refresh == 2, "Cached counts are not scraped again");
+    
+    return true;
+}
+
+/**
+ * Test de la liste de blocage IP (formats, fusion, recherche, cache)
+ */
+bool test_ip_blocklist() {
+    IpRange range;
+    TEST_ASSERT(IpBlocklist::parseLine("Bad peers: test:1.2.3.0-1.2.3.255", range) &&
+                range.first == 0x01020300 && range.last == 0x010203FF, "Parse P2P line");
+    TEST_ASSERT(IpBlocklist::parseLine("001.002.004.000 - 001.002.004.255 , 000 , Test\r", range) &&
+                range.first == 0x01020400, "Parse DAT line");
+    TEST_ASSERT(!IpBlocklist::parseLine("001.002.005.000 - 001.002.005.255 , 200 , Allowed", range),
+                "DAT level >= 128 is not blocked");
+    TEST_ASSERT(!IpBlocklist::parseLine("# commentaire", range), "Skip comment");
+    TEST_ASSERT(!IpBlocklist::parseLine("garbage:1.2.3-1.2.3.4", range), "Reject invalid address");
+    
+    // Chevauchement et contiguïté fusionnés
+    std::vector<IpRange> ranges = {{30, 40}, {10, 20}, {15, 25}, {26, 28}, {50, 60}};
+    IpBlocklist::mergeRanges(ranges);
+    TEST_ASSERT(ranges.size() == 3 && ranges[0].first == 10 && ranges[0].last == 28 && ranges[1].first == 30,
+                "Merge overlapping and adjacent ranges");
+    
+    // Chargement, recherche et rechargement depuis le cache binaire
+    std::string list_file = "/tmp/test_blocklist.p2p";
+    std::string cache_file = "/tmp/test_blocklist.bin";
+    Utils::deleteFile(cache_file);
+    {
+        std::ofstream file(list_file);
+        file << "A:10.0.0.0-10.0.0.255\nB:10.0.0.128-10.0.1.10\n"
+             << "192.168.000.001 - 192.168.000.001 , 050 , C\n";
+    }
+    
+    BlocklistStats stats;
+    TEST_ASSERT(IpBlocklist::load({list_file}, cache_file, &stats) == 2 && !stats.from_cache, "Load blocklist");
+    TEST_ASSERT(IpBlocklist::isBlocked("10.0.1.10") && IpBlocklist::isBlocked("192.168.0.1"), "Blocked addresses");
+    TEST_ASSERT(!IpBlocklist::isBlocked("10.0.1.11") && !IpBlocklist::isBlocked("9.255.255.255"), "Allowed addresses");
+    
+    TEST_ASSERT(IpBlocklist::load({list_file}, cache_file, &stats) == 2 && stats.from_cache, "Reload from cache");
+    TEST_ASSERT(IpBlocklist::isBlocked("10.0.0.200"), "Cached ranges are active");
+    
+    IpBlocklist::clear();
+    TEST_ASSERT(!IpBlocklist::isBlocked("10.0.0.200"), "Cleared blocklist");
+    
+    Utils::deleteFile(list_file);
+    Utils::deleteFile(cache_file);
+    
+    return true;
+}
+
+/**
+ * Test des décisions du réglage automatique de la session
+ */
+bool test_session_tuner_decisions() {
+    SessionTunerConfig config;
+    config.max_connections = 100;
+    SessionTuning current = {50, 8, 500};
+    
+    TuningDecision idle = {};
+    idle.memory_headroom = 512LL * 1024 * 1024;
+    idle.peers = 10;
+    idle.upload_rate_per_slot = 16 * 1024;
+    idle.download_rate_per_peer = 500 * 1024;
+    
+    // Upload plafonnée à 128 KB/s: 4 slots de 32 KB/s
+    TuningDecision decision = idle;
+    TEST_ASSERT(SessionTuner::decide(config, current, 128 * 1024, false, decision), "Throttled upload changes slots");
+    TEST_ASSERT(decision.after.unchoke_slots == 4 && decision.after.connections_limit == 50, "Slots from upload limit");
+    
+    // CPU saturé: réduction des trois limites
+    decision = idle;
+    decision.cpu_load = 0.95f;
+    TEST_ASSERT(SessionTuner::decide(config, current, 0, false, decision), "CPU saturation changes limits");
+    TEST_ASSERT(decision.after.connections_limit == 40 && decision.after.unchoke_slots == 7 &&
+                decision.after.request_queue == 375, "Limits reduced under CPU saturation");
+    
+    // Limite de connexions atteinte, slots productifs, peers rapides
+    decision = idle;
+    decision.peers = 48;
+    decision.upload_rate_per_slot = 64 * 1024;
+    decision.download_rate_per_peer = 4 * 1024 * 1024;
+    TEST_ASSERT(SessionTuner::decide(config, current, 0, false, decision), "Saturated session grows");
+    TEST_ASSERT(decision.after.connections_limit == 62 && decision.after.unchoke_slots == 10 &&
+                decision.after.request_queue == config.max_request_queue, "Limits grow within bounds");
+    
+    // Débit plafonné par le limiteur: moins de connexions
+    decision = idle;
+    TEST_ASSERT(SessionTuner::decide(config, current, 0, true, decision) &&
+                decision.after.connections_limit == 45, "Rate-limited session sheds connections");
+    TEST_ASSERT(!decision.reason.empty(), "Decision carries a reason");
+    
+    // Limiteur compté dans les directions plafonnées seulement
+    TEST_ASSERT(!SessionTuner::isRateLimited(3, 0, 256 * 1024, 0), "Upload cap alone keeps download connections");
+    TEST_ASSERT(!SessionTuner::isRateLimited(3, 3, 0, 0), "Unthrottled session is not rate limited");
+    TEST_ASSERT(SessionTuner::isRateLimited(0, 2, 0, 1024 * 1024), "Download limiter sheds connections");
+    TEST_ASSERT(SessionTuner::isRateLimited(3, 0, 256 * 1024, 1024 * 1024), "Both directions capped");
+    
+    // Cache des pièces et réserve d'écriture: capacités réservées sur le budget, quel que soit leur remplissage
+    WriteCoalescerConfig write_config;
+    write_config.enabled = false;
+    WriteCoalescer::configure(write_config);
+    PieceCacheConfig cache_config;
+    cache_config.capacity = 4LL * 1024 * 1024;
+    PieceCache::configure(cache_config);
+    TEST_ASSERT(SessionTuner::getReservedMemory() == PieceCache::getConfig().capacity, "Cache capacity reserved");
+    
+    write_config.enabled = true;
+    WriteCoalescer::configure(write_config);
+    int64_t reserved = SessionTuner::getReservedMemory();
+    WriteCoalescer::recordPoolBytes(write_config.pool_bytes);
+    TEST_ASSERT(SessionTuner::getReservedMemory() == reserved, "Pool fill is not counted as usage");
+    WriteCoalescer::clear();
+    write_config.enabled = false;
+    WriteCoalescer::configure(write_config);
+    
+    cache_config.enabled = false;
+    PieceCache::configure(cache_config);
+    TEST_ASSERT(SessionTuner::getReservedMemory() == 0, "Disabled cache reserves nothing");
+    
+    return true;
+}
+
+/**
+ * Test de la liste d'écoute IPv4 / IPv6
+ */
+bool test_listen_interfaces() {
+    std::vector<NetworkInterface> interfaces = {
+        {"lo", "127.0.0.1", "255.0.0.0", "127.0.0.0", "127.255.255.255", false, true},
+        {"eth0", "192.168.1.20", "255.255.255.0", "192.168.1.0", "192.168.1.255", false, false},
+        {"eth0", "fe80::1", "ffff:ffff:ffff:ffff::", "fe80::", "fe80::ffff:ffff:ffff:ffff", true, false},
+        {"eth0", "2001:db8::20", "ffff:ffff:ffff:ffff::", "2001:db8::", "2001:db8::ffff:ffff:ffff:ffff", true, false},
+        {"wlan0", "10.0.0.5", "255.255.255.0", "10.0.0.0", "10.0.0.255", false, false},
+    };
+    
+    SessionOptions options;
+    TEST_ASSERT(TorrentManager::buildListenInterfaces(options, interfaces) == "0.0.0.0:6881,[::]:6881",
+                "Dual-stack wildcard listen");
+    
+    // Sans adresse IPv6 routable (lien-local seulement): IPv4 uniquement
+    std::vector<NetworkInterface> ipv4_only = {interfaces[0], interfaces[1], interfaces[2]};
+    TEST_ASSERT(TorrentManager::buildListenInterfaces(options, ipv4_only) == "0.0.0.0:6881",
+                "IPv6 skipped without routable address");
+    
+    options.listen_port = 7000;
+    options.listen_devices = {"eth0"};
+    TEST_ASSERT(TorrentManager::buildListenInterfaces(options, interfaces) == "192.168.1.20:7000,[2001:db8::20]:7000",
+                "Per-interface binding excludes link-local");
+    
+    options.enable_ipv6 = false;
+    options.listen_devices = {"eth0", "wlan0"};
+    TEST_ASSERT(TorrentManager::buildListenInterfaces(options, interfaces) == "192.168.1.20:7000,10.0.0.5:7000",
+                "IPv6 disabled");
+    
+    options.listen_devices = {"eth9"};
+    TEST_ASSERT(TorrentManager::buildListenInterfaces(options, interfaces) == "0.0.0.0:7000",
+                "Missing interface falls back to wildcard");
+    
+    options.listen_interfaces = "127.0.0.1:0";
+    TEST_ASSERT(TorrentManager::buildListenInterfaces(options, interfaces) == "127.0.0.1:0", "Explicit list kept");
+    
+    return true;
+}
+
+/**
+ * Test du démarrage rapide: niveaux des trackers et cache de peers
+ */
+bool test_fast_start() {
+    // Trackers du lien sur les niveaux 0 et 1: défauts au niveau 2, doublon ignoré
+    std::vector<std::string> trackers = {"udp://a:80", "udp://b:80"};
+    std::vector<int> tiers = {0, 1};
+    int added = FastStart::addDefaultTrackers(trackers, tiers, {"udp://b:80", "udp://c:80", "", "udp://d:80"});
+    TEST_ASSERT(added == 2 && trackers.size() == 4, "Default trackers appended once");
+    TEST_ASSERT(tiers.size() == 4 && tiers[2] == 2 && tiers[3] == 2, "Default trackers on the next tier");
+    
+    // Trackers sans niveau: niveau 0 implicite, défauts au niveau 1
+    trackers = {"udp://a:80"};
+    tiers.clear();
+    FastStart::addDefaultTrackers(trackers, tiers, {"udp://c:80"});
+    TEST_ASSERT(tiers.size() == 2 && tiers[0] == 0 && tiers[1] == 1, "Implicit tiers aligned");
+    
+    // Cache de peers: réécrit seulement quand l'ensemble change
+    std::string cache_file = "/tmp/ps4_fast_start_test.cache";
+    Utils::deleteFile(cache_file);
+    FastStartConfig config;
+    config.peer_cache_file = cache_file;
+    config.max_peers_per_torrent = 2;
+    FastStart::configure(config);
+    
+    std::string hash(40, 'a');
+    int64_t now = static_cast<int64_t>(std::time(nullptr));
+    TEST_ASSERT(FastStart::rememberPeer(hash, "10.0.0.1", 6881, now), "New peer changes the cache");
+    TEST_ASSERT(!FastStart::rememberPeer(hash, "10.0.0.1", 6881, now + 10), "Seen again: no rewrite");
+    TEST_ASSERT(FastStart::rememberPeer(hash, "10.0.0.2", 6881, now + 20), "Second peer");
+    TEST_ASSERT(FastStart::rememberPeer(hash, "10.0.0.3", 6881, now + 30), "Third peer evicts the oldest");
+    
+    std::vector<std::pair<std::string, int>> peers = FastStart::getCachedPeers(hash);
+    TEST_ASSERT(peers.size() == 2 && peers[0].first == "10.0.0.3" && peers[1].first == "10.0.0.2",
+                "Most recent peers kept first");
+    
+    // Sauvegarde puis rechargement
+    TEST_ASSERT(FastStart::savePeerCache(), "Peer cache saved");
+    FastStart::configure(config);
+    TEST_ASSERT(FastStart::getCachedPeers(hash).size() == 2, "Peer cache reloaded");
+    
+    FastStart::clear();
+    Utils::deleteFile(cache_file);
+    return true;
+}
+
+/**
+ * Test du cache des pièces partagées (admission TinyLFU et lecture anticipée)
+ */
+bool test_piece_cache() {
+    PieceCacheConfig config;
+    config.capacity = 2 * PieceCache::BLOCK_SIZE;
+    config.read_ahead_blocks = 2;
+    PieceCache::configure(config);
+    PieceCache::registerStorage(0, 4 * PieceCache::BLOCK_SIZE, 8 * PieceCache::BLOCK_SIZE);
+    
+    std::vector<char> block(PieceCache::BLOCK_SIZE, 'a');
+    std::vector<char> out(PieceCache::BLOCK_SIZE);
+    
+    TEST_ASSERT(!PieceCache::lookup(0, 0, 0, PieceCache::BLOCK_SIZE, out.data()), "Cold miss");
+    TEST_ASSERT(PieceCache::offer(0, 0, 0, block.data(), PieceCache::BLOCK_SIZE), "Admitted while free");
+    TEST_ASSERT(PieceCache::lookup(0, 0, 0, PieceCache::BLOCK_SIZE, out.data()), "Hit after admission");
+    TEST_ASSERT(out[0] == 'a', "Cached data returned");
+    
+    // Bloc populaire en cache, bloc demandé une seule fois refusé
+    for (int i = 0; i < 4; i++) {
+        PieceCache::lookup(0, 0, 0, PieceCache::BLOCK_SIZE, out.data());
+        PieceCache::lookup(0, 1, 0, PieceCache::BLOCK_SIZE, out.data());
+    }
+    PieceCache::offer(0, 1, 0, block.data(), PieceCache::BLOCK_SIZE);
+    PieceCache::lookup(0, 0, 0, PieceCache::BLOCK_SIZE, out.data());
+    PieceCache::lookup(0, 1, 0, PieceCache::BLOCK_SIZE, out.data());
+    TEST_ASSERT(!PieceCache::lookup(0, 3, 0, PieceCache::BLOCK_SIZE, out.data()), "One-hit block missed");
+    TEST_ASSERT(!PieceCache::offer(0, 3, 0, block.data(), PieceCache::BLOCK_SIZE), "One-hit block rejected");
+    TEST_ASSERT(PieceCache::lookup(0, 0, 0, PieceCache::BLOCK_SIZE, out.data()), "Popular block kept");
+    
+    // Lecture séquentielle: les blocs suivants sont demandés en avance
+    std::vector<ReadAheadBlock> read_ahead;
+    PieceCache::lookup(0, 0, PieceCache::BLOCK_SIZE, PieceCache::BLOCK_SIZE, out.data(), &read_ahead);
+    PieceCache::lookup(0, 0, 2 * PieceCache::BLOCK_SIZE, PieceCache::BLOCK_SIZE, out.data(), &read_ahead);
+    TEST_ASSERT(read_ahead.size() == 1, "Sequential stream triggers read-ahead");
+    TEST_ASSERT(read_ahead[0].piece == 0 && read_ahead[0].offset == 3 * PieceCache::BLOCK_SIZE,
+                "Read-ahead skips cached block of next piece");
+    
+    read_ahead.clear();
+    PieceCache::lookup(0, 0, 3 * PieceCache::BLOCK_SIZE, PieceCache::BLOCK_SIZE, out.data(), &read_ahead);
+    TEST_ASSERT(read_ahead.size() == 1 && read_ahead[0].piece == 1 && read_ahead[0].offset == PieceCache::BLOCK_SIZE,
+                "Read-ahead window advances across pieces");
+    
+    PieceCache::invalidate(0);
+    TEST_ASSERT(!PieceCache::lookup(0, 0, 0, PieceCache::BLOCK_SIZE, out.data()), "Invalidated storage");
+    TEST_ASSERT(PieceCache::getStats().bytes == 0, "No bytes left after invalidation");
+    
+    // Lecteur séquentiel: les blocs lus en avance restent en probation (2 blocs sur 16)
+    config.capacity = 16 * PieceCache::BLOCK_SIZE;
+    config.read_ahead_blocks = 8;
+    PieceCache::configure(config);
+    for (int piece = 0; piece < 14; piece++) {
+        for (int i = 0; i < 3; i++) PieceCache::lookup(1, piece, 0, PieceCache::BLOCK_SIZE, out.data());
+        PieceCache::offer(1, piece, 0, block.data(), PieceCache::BLOCK_SIZE);
+    }
+    bool read_ahead_admitted = true;
+    for (int piece = 100; piece < 140; piece++) {
+        read_ahead_admitted = PieceCache::offer(1, piece, 0, block.data(), PieceCache::BLOCK_SIZE, true) &&
+                              read_ahead_admitted;
+    }
+    TEST_ASSERT(read_ahead_admitted, "Read-ahead blocks enter probation");
+    bool hot_kept = true;
+    for (int piece = 0; piece < 14; piece++) {
+        hot_kept = hot_kept && PieceCache::lookup(1, piece, 0, PieceCache::BLOCK_SIZE, out.data());
+    }
+    TEST_ASSERT(hot_kept, "Read-ahead does not flush the hot set");
+    TEST_ASSERT(PieceCache::lookup(1, 139, 0, PieceCache::BLOCK_SIZE, out.data()), "Recent read-ahead block served");
+    TEST_ASSERT(!PieceCache::lookup(1, 100, 0, PieceCache::BLOCK_SIZE, out.data()), "Old read-ahead block evicted");
+    TEST_ASSERT(PieceCache::getStats().bytes <= config.capacity, "Cache within capacity");
+    
+    PieceCache::clear();
+    return true;
+}
+
+/**
+ * Test des compteurs du regroupement des écritures
+ */
+bool test_write_coalescing() {
+    const int block = 16 * 1024;
+    WriteCoalescer::clear();
+    
+    // Arrivées dans le désordre: une séquence par saut de position
+    WriteCoalescer::recordArrival(5 * block, block);
+    WriteCoalescer::recordArrival(0, block);
+    WriteCoalescer::recordArrival(1 * block, block);
+    WriteCoalescer::recordArrival(2 * block, block);
+    WriteCoalescer::recordArrival(6 * block, block / 2);
+    TEST_ASSERT(WriteCoalescer::getStats().arrival_runs == 3, "Arrival runs counted");
+    
+    WriteCoalescer::recordPoolBytes(4 * block + block / 2);
+    WriteCoalescer::recordFlush(5, 4 * block + block / 2, 2);
+    WriteCoalescer::clear();
+    WriteCoalescerStats stats = WriteCoalescer::getStats();
+    TEST_ASSERT(stats.flushes == 1 && stats.blocks == 5 && stats.runs == 2, "Flush counted");
+    TEST_ASSERT(stats.pool_bytes == 0 && stats.peak_pool_bytes == 4 * block + block / 2, "Pool peak kept");
+    
+    WriteCoalescer::clear();
+    WriteCoalescer::recordArrival(7 * block, block);
+    TEST_ASSERT(WriteCoalescer::getStats().arrival_runs == 1 && WriteCoalescer::getStats().runs == 0, "Stats cleared");
+    
+    WriteCoalescer::clear();
+    return true;
+}
+
 /**
  * Test d'initialisation du gestionnaire PKG
  */
@@ -253,6 +1244,74 @@ bool test_pkg_analysis_simulation() {
     return true;
 }
 
+/**
+ * Test de l'analyse asynchrone (résultat livré par update)
+ */
+bool test_pkg_async_analysis() {
+    bool delivered = false;
+    bool valid = true;
+    TaskFuture<PackageInfo> task = PkgManager::analyzePackageAsync("/path/to/nonexistent.pkg",
+        [&delivered, &valid](const PackageInfo& info) {
+            delivered = true;
+            valid = info.is_valid;
+        });
+    
+    TEST_ASSERT(task.get().is_valid == false, "Async analysis of nonexistent package");
+    
+    // Le callback n'est appelé que depuis EventQueue::dispatch
+    for (int i = 0; i < 100 && !delivered; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        EventQueue::dispatch();
+    }
+    TEST_ASSERT(delivered, "Async analysis callback delivered by update");
+    TEST_ASSERT(valid == false, "Async analysis callback result");
+    
+    return true;
+}
+
+/**
+ * Test d'une installation annulée avant son démarrage (fin signalée, nouvelle installation possible)
+ */
+bool test_pkg_install_cancelled_before_start() {
+    // Tous les threads de la réserve occupés: l'installation reste en file
+    ThreadPool::start();
+    int threads = ThreadPool::getStats().threads;
+    std::atomic<bool> release(false);
+    std::vector<TaskFuture<void>> blockers;
+    for (int i = 0; i < threads; i++) {
+        blockers.push_back(ThreadPool::submit([&release]() {
+            while (!release.load()) std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }, TaskPriority::INTERACTIVE));
+    }
+    for (int i = 0; i < 1000 && ThreadPool::getStats().busy < threads; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    
+    int cancelled = 0;
+    int subscription = EventQueue::subscribe(EventType::INSTALL_COMPLETE, [&cancelled](const UiEvent& event) {
+        if (!event.success && event.text == "Installation annulée") cancelled++;
+    });
+    EventQueue::dispatch();
+    TEST_ASSERT(PkgManager::installPackage("/path/to/nonexistent.pkg"), "Install queued");
+    TEST_ASSERT(PkgManager::cancelCurrentInstall(), "Queued install cancelled");
+    release = true;
+    for (auto& blocker : blockers) {
+        blocker.wait();
+    }
+    
+    for (int i = 0; i < 100 && cancelled == 0; i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        EventQueue::dispatch();
+    }
+    EventQueue::unsubscribe(subscription);
+    EventQueue::dispatch();
+    TEST_ASSERT(cancelled == 1, "Cancelled completion delivered");
+    TEST_ASSERT(PkgManager::getCurrentInstallProgress().status == InstallStatus::CANCELLED, "Install marked cancelled");
+    TEST_ASSERT(!PkgManager::cancelCurrentInstall(), "No install left in progress");
+    
+    return true;
+}
+
 /**
  * Test d'initialisation de l'interface utilisateur
  */
@@ -347,10 +1406,32 @@ int main() {
     RUN_TEST(test_utils_basic);
     RUN_TEST(test_utils_strings);
     RUN_TEST(test_utils_files);
+    RUN_TEST(test_async_logger);
+    RUN_TEST(test_log_format);
+    RUN_TEST(test_trace);
+    RUN_TEST(test_config);
+    RUN_TEST(test_metrics);
+    RUN_TEST(test_thread_pool);
+    RUN_TEST(test_event_queue);
+    RUN_TEST(test_progress_publisher);
+    RUN_TEST(test_startup);
     RUN_TEST(test_torrent_manager_init);
     RUN_TEST(test_torrent_download_simulation);
+    RUN_TEST(test_admission_budget);
+    RUN_TEST(test_seed_rotation);
+    RUN_TEST(test_session_stats);
+    RUN_TEST(test_download_scheduler_windows);
+    RUN_TEST(test_scrape_service_local_tracker);
+    RUN_TEST(test_ip_blocklist);
+    RUN_TEST(test_session_tuner_decisions);
+    RUN_TEST(test_listen_interfaces);
+    RUN_TEST(test_fast_start);
+    RUN_TEST(test_piece_cache);
+    RUN_TEST(test_write_coalescing);
     RUN_TEST(test_pkg_manager_init);
     RUN_TEST(test_pkg_analysis_simulation);
+    RUN_TEST(test_pkg_async_analysis);
+    RUN_TEST(test_pkg_install_cancelled_before_start);
     RUN_TEST(test_ui_initialization);
     RUN_TEST(test_performance);
     RUN_TEST(test_error_handling);
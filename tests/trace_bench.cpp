@@ -0,0 +1,125 @@
+/**
+ * @file trace_bench.cpp
+ * @brief Banc de mesure du coût du traçage
+ * @author PS4 Store P2P Team
+ * @date 2024
+ *
+ * Mesure le coût d'un TRACE_SCOPE (début et fin d'une durée) et d'un
+ * TRACE_COUNTER, traçage démarré puis arrêté, sur un thread puis sur
+ * plusieurs threads à la fois, et le temps d'écriture de la trace JSON.
+ * Les deux lectures d'horloge d'une durée sont mesurées seules: sous
+ * virtualisation, rdtsc peut être intercepté et dominer le coût.
+ * Compilé avec ENABLE_TRACING (voir BUILD_TRACE_BENCH dans CMakeLists.txt).
+ *
+ * Usage: trace_bench [--iterations N] [--threads N] [--output fichier.json]
+ */
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <chrono>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+
+#include "../include/utils/utils.h"
+#include "../include/utils/trace.h"
+
+// Empêche le compilateur de fusionner les itérations
+#define BENCH_BARRIER() asm volatile("" ::: "memory")
+
+static double measureSpans(int64_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < iterations; i++) {
+        TRACE_SCOPE("bench", "span");
+        BENCH_BARRIER();
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+           static_cast<double>(iterations);
+}
+
+// Deux lectures d'horloge: plancher d'une durée, quel que soit l'enregistrement
+static double measureClock(int64_t iterations) {
+    uint64_t sum = 0;
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < iterations; i++) {
+        uint64_t begin = Trace::ticks();
+        BENCH_BARRIER();
+        sum += Trace::ticks() - begin;
+    }
+    double elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+    return sum > 0 ? elapsed / static_cast<double>(iterations) : 0;
+}
+
+static double measureCounters(int64_t iterations) {
+    auto start = std::chrono::steady_clock::now();
+    for (int64_t i = 0; i < iterations; i++) {
+        TRACE_COUNTER("bench_counter", i);
+        BENCH_BARRIER();
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+           static_cast<double>(iterations);
+}
+
+int main(int argc, char* argv[]) {
+    int64_t iterations = 2000000;
+    int threads = std::max(1, std::min(4, static_cast<int>(std::thread::hardware_concurrency())));
+    std::string output = "/tmp/ps4_trace_bench.json";
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--iterations" && has_value) {
+            iterations = std::max<int64_t>(1, std::atoll(argv[++i]));
+        } else if (arg == "--threads" && has_value) {
+            threads = std::max(1, std::atoi(argv[++i]));
+        } else if (arg == "--output" && has_value) {
+            output = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0] << " [--iterations N] [--threads N] [--output fichier.json]" << std::endl;
+            return 2;
+        }
+    }
+    
+    Utils::setLogLevel(Utils::LogLevel::WARNING);
+    TRACE_THREAD_NAME("bench");
+    Trace::start(static_cast<size_t>(iterations) * 2);
+    
+    double clock = measureClock(iterations);
+    double span = measureSpans(iterations);
+    double counter = measureCounters(iterations);
+    
+    // Plusieurs threads tracent en même temps: aucun verrou partagé entre deux blocs
+    std::vector<double> per_thread(threads);
+    std::vector<std::thread> workers;
+    for (int t = 0; t < threads; t++) {
+        workers.emplace_back([t, iterations, &per_thread]() {
+            TRACE_THREAD_NAME("worker");
+            per_thread[t] = measureSpans(iterations);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    double parallel = 0;
+    for (double value : per_thread) parallel = std::max(parallel, value);
+    
+    size_t events = Trace::getEventCount();
+    auto dump_start = std::chrono::steady_clock::now();
+    bool dumped = Trace::dump(output);
+    double dump_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - dump_start).count();
+    
+    Trace::stop();
+    double stopped = measureSpans(iterations);
+    
+    std::printf("Deux lectures d'horloge             %8.2f ns\n", clock);
+    std::printf("TRACE_SCOPE, traçage démarré        %8.2f ns\n", span);
+    std::printf("TRACE_COUNTER, traçage démarré      %8.2f ns\n", counter);
+    std::printf("TRACE_SCOPE, %d threads (pire)       %8.2f ns\n", threads, parallel);
+    std::printf("TRACE_SCOPE, traçage arrêté         %8.2f ns\n", stopped);
+    std::printf("%zu événements conservés, %lld écartés, écrits en %.2f s dans %s (%s)\n", events,
+                static_cast<long long>(Trace::getDropped()), dump_seconds, output.c_str(),
+                dumped ? Utils::formatFileSize(Utils::getFileSize(output)).c_str() : "échec");
+    return dumped ? 0 : 1;
+}